@@ -221,6 +221,7 @@ SET(SRC_BASEQ2RTXP_CLGAME
 	baseq2rtxp/clgame/clg_events_player.cpp
 	baseq2rtxp/clgame/clg_events.cpp
 	baseq2rtxp/clgame/clg_input.cpp
+	baseq2rtxp/clgame/clg_jobs.cpp
 	baseq2rtxp/clgame/clg_local_entities.cpp
 	baseq2rtxp/clgame/clg_frame.cpp
 	baseq2rtxp/clgame/clg_gamemode.cpp
@@ -277,6 +278,7 @@ SET(HEADERS_BASEQ2RTXP_CLGAME
 	baseq2rtxp/clgame/clg_frame.h
 	baseq2rtxp/clgame/clg_hud.h
 	baseq2rtxp/clgame/clg_input.h
+	baseq2rtxp/clgame/clg_jobs.h
 	baseq2rtxp/clgame/clg_local.h
 	baseq2rtxp/clgame/clg_local_entities.h
 	baseq2rtxp/clgame/clg_packet_entities.h
@@ -319,6 +321,7 @@ SET(SRC_BASEQ2RTXP_SVGAME
 	baseq2rtxp/svgame/svg_edicts.cpp
 	baseq2rtxp/svgame/svg_edict_pool.cpp
 	baseq2rtxp/svgame/svg_entity_events.cpp
+	baseq2rtxp/svgame/svg_entity_profiler.cpp
 	baseq2rtxp/svgame/svg_gamemode.cpp
 	baseq2rtxp/svgame/svg_game_client.cpp
 	baseq2rtxp/svgame/svg_game_items.cpp
@@ -331,6 +334,7 @@ SET(SRC_BASEQ2RTXP_SVGAME
 	baseq2rtxp/svgame/svg_physics.cpp
 	baseq2rtxp/svgame/svg_save_pointers.cpp
 	baseq2rtxp/svgame/svg_save.cpp
+	baseq2rtxp/svgame/svg_scratch.cpp
 	baseq2rtxp/svgame/svg_signalio.cpp
 	baseq2rtxp/svgame/svg_spawn.cpp
 	baseq2rtxp/svgame/svg_stepmove.cpp
@@ -433,6 +437,7 @@ SET(SRC_BASEQ2RTXP_SVGAME
 	baseq2rtxp/svgame/player/svg_player_events.cpp
 	baseq2rtxp/svgame/player/svg_player_hud.cpp
 	baseq2rtxp/svgame/player/svg_player_move.cpp
+	baseq2rtxp/svgame/player/svg_player_move_bench.cpp
 	baseq2rtxp/svgame/player/svg_player_obituary.cpp
 	baseq2rtxp/svgame/player/svg_player_trail.cpp
 	baseq2rtxp/svgame/player/svg_player_usetargets.cpp
@@ -449,6 +454,7 @@ SET(HEADERS_BASEQ2RTXP_SVGAME
 	baseq2rtxp/svgame/svg_edict_pool.h
 	baseq2rtxp/svgame/svg_edicts.h
 	baseq2rtxp/svgame/svg_entity_events.h
+	baseq2rtxp/svgame/svg_entity_profiler.h
 	baseq2rtxp/svgame/svg_game_client.h
 	baseq2rtxp/svgame/svg_game_items.h
 	baseq2rtxp/svgame/svg_game_locals.h
@@ -459,6 +465,7 @@ SET(HEADERS_BASEQ2RTXP_SVGAME
 	baseq2rtxp/svgame/svg_misc.h
 	baseq2rtxp/svgame/svg_pushmove_info.h
 	baseq2rtxp/svgame/svg_save.h
+	baseq2rtxp/svgame/svg_scratch.h
 	baseq2rtxp/svgame/svg_signalio.cpp
 	baseq2rtxp/svgame/svg_trigger.h
 	baseq2rtxp/svgame/svg_utils.h
@@ -537,6 +544,7 @@ SET(HEADERS_BASEQ2RTXP_SVGAME
 	baseq2rtxp/svgame/player/svg_player_client.h
 	baseq2rtxp/svgame/player/svg_player_hud.h
 	baseq2rtxp/svgame/player/svg_player_move.h
+	baseq2rtxp/svgame/player/svg_player_move_bench.h
 	baseq2rtxp/svgame/player/svg_player_trail.h
 	baseq2rtxp/svgame/player/svg_player_usetargets.cpp
 	baseq2rtxp/svgame/player/svg_player_view.h
@@ -567,6 +575,7 @@ SET(SRC_CLIENT
 	client/cl_clientgame.cpp
 	client/cl_crc.cpp
 	client/cl_demo.cpp
+	client/cl_mvd.cpp
 	client/cl_download.cpp
 	client/cl_effects.cpp
 	client/cl_entities.cpp
@@ -596,7 +605,9 @@ SET(SRC_CLIENT
 	client/sound/al.c
 	client/sound/main.c
 	client/sound/mem.c
+	client/sound/mix.c
 	client/sound/ogg.c
+	client/sound/stream.c
 	client/sound/qal/fixed.c
 #	client/sound/qal/dynamic.cpp
 )
@@ -608,6 +619,7 @@ SET(SRC_CLIENT_HTTP
 SET(HEADERS_CLIENT
 	client/cl_client.h
 	client/ui/ui.h
+	client/sound/mix.h
 	client/sound/sound.h
 	client/sound/qal/dynamic.h
 	client/sound/qal/fixed.h
@@ -622,6 +634,9 @@ SET(HEADERS_CLIENT
 SET(SRC_SERVER
 	refresh/model_iqm.c
 
+	server/sv_addrmatch.cpp
+	server/sv_capture.cpp
+	server/sv_mvd.cpp
 	server/sv_commands.cpp
 	server/sv_entities.cpp
 	server/sv_init.cpp
@@ -638,6 +653,9 @@ SET(HEADERS_SERVER
 	#server/server.h
 
 	server/sv_server.h
+	server/sv_addrmatch.h
+	server/sv_capture.h
+	server/sv_mvd.h
 	server/sv_commands.h
 	server/sv_entities.h
 	server/sv_init.h
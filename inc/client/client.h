@@ -75,7 +75,8 @@ typedef struct {
     char map[ MAX_QPATH ];
     //! Client name that was recorded in the demo.
     char pov[ MAX_CLIENT_NAME ];
-    //qboolean mvd;
+    //! Recorded by the server, with every player as a possible point of view.
+    qboolean mvd;
 } demoInfo_t;
 
 /**
@@ -61,6 +61,9 @@ QEXTERN_C_OPEN
         bool wantread: 1;
         bool wantwrite: 1;
         bool wantexcept: 1;
+        // can* flags stay set until the owner sees EWOULDBLOCK,
+        // instead of being recomputed by every NET_Sleep
+        bool edgetriggered: 1;
     } ioentry_t; 
 QEXTERN_C_CLOSE
 
@@ -213,6 +216,8 @@ bool        NET_GetAddress(netsrc_t sock, netadr_t *adr);
 void        NET_GetPackets(netsrc_t sock, void (*packet_cb)(void));
 bool        NET_SendPacket(netsrc_t sock, const void *data,
                            size_t len, const netadr_t *to);
+void        NET_BeginSendBatch(void);
+void        NET_EndSendBatch(void);
 
 char        *NET_AdrToString(const netadr_t *a);
 bool        NET_StringToAdr(const char *s, netadr_t *a, int default_port);
@@ -236,6 +241,8 @@ QEXTERN_C_ENCLOSE( ioentry_t   *NET_AddFd(qsocket_t fd); );
 // <Q2RTXP>: WID: extern C for unix tty.c
 QEXTERN_C_ENCLOSE( void        NET_RemoveFd(qsocket_t fd); );
 int64_t     NET_Sleep(int64_t msec);
+// <Q2RTXP>: WID: extern C for async.c
+QEXTERN_C_ENCLOSE( void        NET_Wakeup(void); );
 
 extern cvar_t       *net_ip;
 extern cvar_t       *net_port;
@@ -207,6 +207,21 @@ inline static const bool VALIDATE_CLIENTNUM( int32_t x ) {
 
 // ==============================================================
 
+// Server recorded multi view demos (.mvd2). After the magic the file uses the
+// same framing as client demos: blocks prefixed by their little endian 32 bit
+// length, ending with a length of -1. Each block is a sequence of records.
+#define MVD_MAGIC   MakeLittleLong( 'M', 'V', 'D', '2' )
+
+typedef enum {
+    mvd_bad,
+    mvd_gamestate,      // svc_* messages up to the end of the block, parsed as is
+    mvd_unicast,        // [byte] client slot [short] length [length bytes] svc_* messages
+    mvd_multicast,      // [short] length [length bytes] svc_* messages for everyone
+    mvd_frame,          // [varint] framenum [short] count { [byte] slot [playerstate] } [packetentities]
+} mvd_record_t;
+
+// ==============================================================
+
 // WID: Moved to shared/shared.h
 // a SOLID_BOUNDS_BOX will never create this value
 //#define PACKED_BSP      255
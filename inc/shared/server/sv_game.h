@@ -30,7 +30,7 @@ typedef Vector3* cpp_vec3_t;
 // sv_game.h -- server game dll information visible to server
 //
 
-#define SVGAME_API_VERSION    1337
+#define SVGAME_API_VERSION    1338
 
 
 /**
@@ -427,6 +427,24 @@ typedef struct {
 
     //! Does nothing atm.
     void (*DebugGraph)(float value, int color);
+
+
+    /**
+    *
+    *   Later Additions:
+    *
+    *   Appended so the slots above keep their place in the table. Appending
+    *   still grows the struct, so every addition bumps SVGAME_API_VERSION.
+    *
+    **/
+    //! Like trace, but with players and monsters rewound to what the client of passent last saw, for hitscan weapons.
+    const cm_trace_t( *lagtrace )( const Vector3 *start, const Vector3 *mins, const Vector3 *maxs, const Vector3 *end, edict_ptr_t *passent, const cm_contents_t contentmask );
+    /**
+    *   @brief  Queues 'length' bytes of serialized savegame data to be compressed and written
+    *           to the OS path 'filename' on a background thread. The data is copied, and the
+    *           file is replaced atomically once it has been fully written out.
+    **/
+    void ( *WriteSaveFile )( const char *filename, const void *data, const size_t length );
 } svgame_import_t;
 
 /**
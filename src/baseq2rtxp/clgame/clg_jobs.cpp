@@ -0,0 +1,169 @@
+/********************************************************************
+*
+*
+*	ClientGame: Worker Jobs.
+*
+*
+********************************************************************/
+#include "clgame/clg_local.h"
+#include "clgame/clg_jobs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+//! Upper limit on the number of worker threads.
+static constexpr int32_t CLG_JOBS_MAX_THREADS = 16;
+
+//! Number of worker threads, 0 runs all jobs on the calling thread.
+static cvar_t *clg_entity_threads = nullptr;
+
+static struct {
+	//! The worker threads.
+	std::thread threads[ CLG_JOBS_MAX_THREADS ];
+	int32_t numThreads = 0;
+
+	//! Protects everything below, except for nextIndex.
+	std::mutex lock;
+	//! Signals the workers that a new batch, or quit, is up.
+	std::condition_variable wake;
+	//! Signals the calling thread that all workers are done with the batch.
+	std::condition_variable done;
+
+	//! Incremented for each batch.
+	uint64_t batch = 0;
+	//! Tells the workers to exit.
+	bool quit = false;
+	//! Number of workers that haven't finished the current batch yet.
+	int32_t activeWorkers = 0;
+
+	//! The current batch.
+	void ( *job )( const int32_t index, void *userData ) = nullptr;
+	void *userData = nullptr;
+	int32_t count = 0;
+	//! Next job index to be picked up.
+	std::atomic<int32_t> nextIndex = 0;
+} clg_jobs;
+
+/**
+*	@brief	Picks up and runs jobs of the current batch until there are none left.
+**/
+static void CLG_Jobs_RunBatch( void ) {
+	while ( 1 ) {
+		const int32_t index = clg_jobs.nextIndex.fetch_add( 1 );
+		if ( index >= clg_jobs.count ) {
+			break;
+		}
+		clg_jobs.job( index, clg_jobs.userData );
+	}
+}
+
+/**
+*	@brief	Worker thread, runs a share of each batch.
+**/
+static void CLG_Jobs_WorkerThread( uint64_t lastBatch ) {
+	std::unique_lock<std::mutex> lock( clg_jobs.lock );
+	while ( 1 ) {
+		clg_jobs.wake.wait( lock, [lastBatch]() { return clg_jobs.quit || clg_jobs.batch != lastBatch; } );
+		if ( clg_jobs.quit ) {
+			return;
+		}
+		lastBatch = clg_jobs.batch;
+
+		lock.unlock();
+		CLG_Jobs_RunBatch();
+		lock.lock();
+
+		if ( --clg_jobs.activeWorkers == 0 ) {
+			clg_jobs.done.notify_one();
+		}
+	}
+}
+
+/**
+*	@brief	Stops and joins all worker threads.
+**/
+void CLG_Jobs_Shutdown( void ) {
+	if ( !clg_jobs.numThreads ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( clg_jobs.lock );
+		clg_jobs.quit = true;
+	}
+	clg_jobs.wake.notify_all();
+
+	for ( int32_t i = 0; i < clg_jobs.numThreads; i++ ) {
+		clg_jobs.threads[ i ].join();
+	}
+	clg_jobs.numThreads = 0;
+	clg_jobs.quit = false;
+}
+
+/**
+*	@brief	(Re-)starts the worker threads if 'clg_entity_threads' changed.
+**/
+static void CLG_Jobs_CheckThreads( void ) {
+	const int32_t numThreads = std::clamp<int32_t>( clg_entity_threads->integer, 0, CLG_JOBS_MAX_THREADS );
+	if ( numThreads == clg_jobs.numThreads ) {
+		return;
+	}
+
+	CLG_Jobs_Shutdown();
+
+	// No batch is in flight here, so the workers can safely start from the current one.
+	for ( int32_t i = 0; i < numThreads; i++ ) {
+		clg_jobs.threads[ i ] = std::thread( CLG_Jobs_WorkerThread, clg_jobs.batch );
+	}
+	clg_jobs.numThreads = numThreads;
+}
+
+/**
+*	@brief	Registers the 'clg_entity_threads' cvar.
+**/
+void CLG_Jobs_Init( void ) {
+	clg_entity_threads = clgi.CVar_Get( "clg_entity_threads", "0", CVAR_ARCHIVE );
+}
+
+/**
+*	@return	The number of worker threads, not counting the calling thread.
+**/
+const int32_t CLG_Jobs_NumThreads( void ) {
+	return clg_jobs.numThreads;
+}
+
+/**
+*	@brief	Runs 'job' for each index in [0, count), spread over the worker threads and the
+*			calling thread, and waits for all of them to finish.
+**/
+void CLG_Jobs_ParallelFor( const int32_t count, void ( *job )( const int32_t index, void *userData ), void *userData ) {
+	CLG_Jobs_CheckThreads();
+
+	// Not worth waking anyone up for.
+	if ( !clg_jobs.numThreads || count <= 1 ) {
+		for ( int32_t i = 0; i < count; i++ ) {
+			job( i, userData );
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( clg_jobs.lock );
+		clg_jobs.job = job;
+		clg_jobs.userData = userData;
+		clg_jobs.count = count;
+		clg_jobs.nextIndex = 0;
+		clg_jobs.activeWorkers = clg_jobs.numThreads;
+		clg_jobs.batch++;
+	}
+	clg_jobs.wake.notify_all();
+
+	// Lend a hand.
+	CLG_Jobs_RunBatch();
+
+	std::unique_lock<std::mutex> lock( clg_jobs.lock );
+	clg_jobs.done.wait( lock, []() { return clg_jobs.activeWorkers == 0; } );
+}
@@ -0,0 +1,34 @@
+/********************************************************************
+*
+*
+*	ClientGame: Worker Jobs.
+*
+*	A small pool of worker threads that batches of independent jobs
+*	are spread over. The calling thread takes part in each batch and
+*	only returns once all jobs of it have been run.
+*
+*
+********************************************************************/
+#pragma once
+
+
+/**
+*	@brief	Registers the 'clg_entity_threads' cvar.
+**/
+void CLG_Jobs_Init( void );
+/**
+*	@brief	Stops and joins all worker threads.
+**/
+void CLG_Jobs_Shutdown( void );
+
+/**
+*	@return	The number of worker threads, not counting the calling thread.
+**/
+const int32_t CLG_Jobs_NumThreads( void );
+/**
+*	@brief	Runs 'job' for each index in [0, count), spread over the worker threads and the
+*			calling thread, and waits for all of them to finish.
+*	@note	Jobs must not call into anything that isn't thread-safe, clgi functions included,
+*			unless they are known to be pure lookups.
+**/
+void CLG_Jobs_ParallelFor( const int32_t count, void ( *job )( const int32_t index, void *userData ), void *userData );
@@ -86,12 +86,15 @@ extern cvar_t *maxentities;
 extern cvar_t *cl_showmiss;
 extern cvar_t *clg_debug_entity_events;
 extern cvar_t *clg_debug_pmove_changed_events;
+extern cvar_t *clg_entity_timings;
 
 extern cvar_t *clg_kickangles;
 extern cvar_t *clg_noskins;
 extern cvar_t *cl_predict;
+extern cvar_t *clg_predict_cache;
 extern cvar_t *cl_nolerp;
 extern cvar_t *clg_footsteps;
+extern cvar_t *clg_particles;
 
 // Cheesy workaround for various cvars initialized elsewhere in the client, but we need access.
 extern cvar_t *cvar_pt_particle_emissive; // from client FX_Init
@@ -989,10 +992,13 @@ typedef struct clg_explosion_s {
 static inline constexpr double PARTICLE_GRAVITY = 120.;
 static inline constexpr int32_t BLASTER_PARTICLE_COLOR = 0xe0;
 static inline constexpr double INSTANT_PARTICLE = -10000.0;
+//! Upper limit for 'clg_particles', the refresh still draws at most MAX_PARTICLES of them each frame.
+static inline constexpr int32_t CLG_MAX_PARTICLES = 65536;
 
+/**
+*	@brief	Spawn parameters of a particle, as filled in by the effects after CLG_AllocateParticle.
+**/
 typedef struct clg_particle_s {
-	struct clg_particle_s *next;
-
 	double   time;
 
 	vec3_t  org;
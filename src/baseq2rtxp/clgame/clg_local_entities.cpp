@@ -51,6 +51,153 @@ const clg_local_entity_class_t *local_entity_classes[] = {
 
 
 
+/**
+*
+*
+*	Local Entities - Cluster Buckets:
+*
+*
+**/
+/**
+*	Each linked local entity is in the bucket of every PVS cluster that it touches, so
+*	that CLG_AddLocalEntities only has to go through the entities of visible clusters.
+*	The buckets are doubly linked lists threaded through clg_cluster_links, one link for
+*	each of an entity's cluster slots, and a link is addressed as:
+*		'entity number * MAX_ENT_CLUSTERS + cluster slot'.
+*
+*	Entities that touch too many leafs to list their clusters are kept in a separate
+*	list which is tested by headnode, just like before.
+**/
+//! Marks the end of a bucket list.
+static constexpr int32_t CLUSTER_LINK_NONE = -1;
+
+typedef struct clg_cluster_link_s {
+	int32_t prev;
+	int32_t next;
+} clg_cluster_link_t;
+
+static struct {
+	//! First link in each cluster's bucket.
+	int32_t heads[ MAX_MAP_CLUSTERS ];
+	//! Index of each cluster in 'occupied', or -1 if its bucket is empty.
+	int32_t occupiedIndex[ MAX_MAP_CLUSTERS ];
+	//! Clusters with a non empty bucket.
+	int32_t occupied[ MAX_MAP_CLUSTERS ];
+	int32_t numOccupied;
+
+	//! The links of each entity's cluster slots.
+	clg_cluster_link_t links[ MAX_CLIENT_ENTITIES * MAX_ENT_CLUSTERS ];
+
+	//! Entities that are linked by headnode, and each entity's index in it(or -1).
+	int32_t headnodeEntities[ MAX_CLIENT_ENTITIES ];
+	int32_t headnodeIndex[ MAX_CLIENT_ENTITIES ];
+	int32_t numHeadnodeEntities;
+
+	//! Frame stamp of the last frame each entity was found visible in, to skip duplicates.
+	uint32_t visibleFrame[ MAX_CLIENT_ENTITIES ];
+	uint32_t frame;
+	//! Entities found visible this frame.
+	int32_t visibleEntities[ MAX_CLIENT_ENTITIES ];
+} clg_cluster_buckets;
+
+/**
+*	@brief	Empties all buckets.
+**/
+static void CLG_LocalEntity_ClearClusterBuckets( void ) {
+	for ( int32_t i = 0; i < MAX_MAP_CLUSTERS; i++ ) {
+		clg_cluster_buckets.heads[ i ] = CLUSTER_LINK_NONE;
+		clg_cluster_buckets.occupiedIndex[ i ] = -1;
+	}
+	clg_cluster_buckets.numOccupied = 0;
+
+	for ( int32_t i = 0; i < MAX_CLIENT_ENTITIES; i++ ) {
+		clg_cluster_buckets.headnodeIndex[ i ] = -1;
+	}
+	clg_cluster_buckets.numHeadnodeEntities = 0;
+}
+
+/**
+*	@brief	Adds the entity's cluster 'slot' to the bucket of 'cluster'.
+**/
+static void CLG_LocalEntity_AddToCluster( const int32_t entityNumber, const int32_t slot, const int32_t cluster ) {
+	const int32_t linkIndex = entityNumber * MAX_ENT_CLUSTERS + slot;
+	clg_cluster_link_t *link = &clg_cluster_buckets.links[ linkIndex ];
+
+	const int32_t head = clg_cluster_buckets.heads[ cluster ];
+	link->prev = CLUSTER_LINK_NONE;
+	link->next = head;
+	if ( head != CLUSTER_LINK_NONE ) {
+		clg_cluster_buckets.links[ head ].prev = linkIndex;
+	} else {
+		// First one in, the cluster is occupied now.
+		clg_cluster_buckets.occupiedIndex[ cluster ] = clg_cluster_buckets.numOccupied;
+		clg_cluster_buckets.occupied[ clg_cluster_buckets.numOccupied++ ] = cluster;
+	}
+	clg_cluster_buckets.heads[ cluster ] = linkIndex;
+}
+
+/**
+*	@brief	Removes the entity's cluster 'slot' from the bucket of 'cluster'.
+**/
+static void CLG_LocalEntity_RemoveFromCluster( const int32_t entityNumber, const int32_t slot, const int32_t cluster ) {
+	const int32_t linkIndex = entityNumber * MAX_ENT_CLUSTERS + slot;
+	const clg_cluster_link_t *link = &clg_cluster_buckets.links[ linkIndex ];
+
+	if ( link->prev != CLUSTER_LINK_NONE ) {
+		clg_cluster_buckets.links[ link->prev ].next = link->next;
+	} else {
+		clg_cluster_buckets.heads[ cluster ] = link->next;
+	}
+	if ( link->next != CLUSTER_LINK_NONE ) {
+		clg_cluster_buckets.links[ link->next ].prev = link->prev;
+	}
+
+	// Last one out, move the last occupied cluster into its place.
+	if ( clg_cluster_buckets.heads[ cluster ] == CLUSTER_LINK_NONE ) {
+		const int32_t index = clg_cluster_buckets.occupiedIndex[ cluster ];
+		const int32_t lastCluster = clg_cluster_buckets.occupied[ --clg_cluster_buckets.numOccupied ];
+		clg_cluster_buckets.occupied[ index ] = lastCluster;
+		clg_cluster_buckets.occupiedIndex[ lastCluster ] = index;
+		clg_cluster_buckets.occupiedIndex[ cluster ] = -1;
+	}
+}
+
+/**
+*	@brief	Puts the entity in the buckets of the given clusters, or the headnode list for -1 clusters.
+**/
+static void CLG_LocalEntity_AddToBuckets( const int32_t entityNumber, const int32_t numClusters, const int32_t *clusterNums ) {
+	if ( numClusters == -1 ) {
+		clg_cluster_buckets.headnodeIndex[ entityNumber ] = clg_cluster_buckets.numHeadnodeEntities;
+		clg_cluster_buckets.headnodeEntities[ clg_cluster_buckets.numHeadnodeEntities++ ] = entityNumber;
+		return;
+	}
+	for ( int32_t i = 0; i < numClusters; i++ ) {
+		CLG_LocalEntity_AddToCluster( entityNumber, i, clusterNums[ i ] );
+	}
+}
+
+/**
+*	@brief	Takes the entity out of the buckets of the given clusters, or the headnode list for -1 clusters.
+**/
+static void CLG_LocalEntity_RemoveFromBuckets( const int32_t entityNumber, const int32_t numClusters, const int32_t *clusterNums ) {
+	if ( numClusters == -1 ) {
+		const int32_t index = clg_cluster_buckets.headnodeIndex[ entityNumber ];
+		if ( index < 0 ) {
+			return;
+		}
+		const int32_t lastEntity = clg_cluster_buckets.headnodeEntities[ --clg_cluster_buckets.numHeadnodeEntities ];
+		clg_cluster_buckets.headnodeEntities[ index ] = lastEntity;
+		clg_cluster_buckets.headnodeIndex[ lastEntity ] = index;
+		clg_cluster_buckets.headnodeIndex[ entityNumber ] = -1;
+		return;
+	}
+	for ( int32_t i = 0; i < numClusters; i++ ) {
+		CLG_LocalEntity_RemoveFromCluster( entityNumber, i, clusterNums[ i ] );
+	}
+}
+
+
+
 /**
 *
 *
@@ -112,6 +259,9 @@ void CLG_LocalEntity_Free( clg_local_entity_t *lent ) {
 		return;
 	}
 
+	// Take it out of the cluster buckets.
+	CLG_LocalEntity_Unlink( lent );
+
 	// Free the entity class object if it had any set.
 	if ( lent->classLocals ) {
 		clgi.TagFree( lent->classLocals );
@@ -148,6 +298,9 @@ void CLG_LocalEntity_FreeAllClasses() {
 	// Zero out the local entities array and reset number of local entities.
 	memset( clg_local_entities, 0, sizeof( clg_local_entities ) );
 	clg_num_local_entities = 0;
+
+	// Start over with empty cluster buckets.
+	CLG_LocalEntity_ClearClusterBuckets();
 }
 
 
@@ -191,13 +344,20 @@ bool CLG_LocalEntity_RunThink( clg_local_entity_t *lent ) {
 }
 
 /**
-*	@brief	
+*	@brief	Links the entity to the PVS clusters and areas its bounding box touches, and updates
+*			the cluster buckets it is in if those changed.
 **/
 void CLG_LocalEntity_Link( clg_local_entity_t *lent ) {
 	if ( !lent ) {
 		return;
 	}
 
+	// Remember the clusters it is currently bucketed by, to only update those that changed.
+	const bool wasLinked = lent->islinked;
+	const int32_t oldNumClusters = lent->num_clusters;
+	int32_t oldClusterNums[ MAX_ENT_CLUSTERS ];
+	memcpy( oldClusterNums, lent->clusternums, sizeof( oldClusterNums ) );
+
 	// Link to PVS leafs.
 	lent->areanum = 0;
 	lent->areanum2 = 0;
@@ -274,17 +434,32 @@ void CLG_LocalEntity_Link( clg_local_entity_t *lent ) {
 		}
 	}
 
+	// Update the cluster buckets, if it moved to a different set of clusters.
+	const int32_t entityNumber = lent->id;
+	if ( wasLinked ) {
+		if ( lent->num_clusters == oldNumClusters
+			&& ( oldNumClusters == -1 || !memcmp( lent->clusternums, oldClusterNums, oldNumClusters * sizeof( oldClusterNums[ 0 ] ) ) ) ) {
+			return;
+		}
+		CLG_LocalEntity_RemoveFromBuckets( entityNumber, oldNumClusters, oldClusterNums );
+	}
+	CLG_LocalEntity_AddToBuckets( entityNumber, lent->num_clusters, lent->clusternums );
+
 	// Linked.
 	lent->islinked = true;
 }
 /**
-*	@brief	
+*	@brief	Unlinks the entity from the PVS, taking it out of its cluster buckets.
 **/
 void CLG_LocalEntity_Unlink( clg_local_entity_t *lent ) {
 	if ( !lent ) {
 		return;
 	}
 
+	if ( lent->islinked ) {
+		CLG_LocalEntity_RemoveFromBuckets( lent->id, lent->num_clusters, lent->clusternums );
+	}
+
 	lent->areanum = lent->areanum2 = lent->headnode = 0;
 	lent->islinked = false;
 }
@@ -561,13 +736,10 @@ void PF_PostSpawnEntities() {
 *
 **/
 /**
-*	@return	True if entity is inside the local client's PVS and should be processed to
-*			prepare a refresh entity.			
+*	@return	True if the entity's areas are connected to the local client's area. The PVS
+*			clusters are already taken care of by the cluster buckets.
 **/
-const bool CLG_LocalEntity_InLocalPVS( clg_local_entity_t *lent ) {
-	// Default to visible so all code below only has to check for it being invsiible(thus only sets it to false.)
-	bool isVisible = true;
-
+static const bool CLG_LocalEntity_InLocalAreas( const clg_local_entity_t *lent ) {
 	// Area Checks:
 	if ( clgi.client->localPVS.lastValidCluster >= 0 && !clgi.CM_AreasConnected( clgi.client->localPVS.leaf->area, lent->areanum ) ) {
 		// Doors can legally straddle two areas, so we may need to check another one
@@ -576,65 +748,58 @@ const bool CLG_LocalEntity_InLocalPVS( clg_local_entity_t *lent ) {
 			return false;
 		}
 	}
-
-	// If area checks succeeded and it is vissible, test the cluster or go by head node.
-	if ( isVisible ) {
-		// beams just check one point for PHS
-		//if ( ent->s.renderfx & RF_BEAM ) {
-		//	if ( !Q_IsBitSet( clientphs, ent->clusternums[ 0 ] ) )
-		//		ent_visible = false;
-		//} else {
-			//if ( cull_nonvisible_clientgame_entities ) {
-				int i = 0;
-				// Too many leafs for individual check, go by headnode:
-				if ( lent->num_clusters == -1 ) {
-					if ( !clgi.CM_HeadnodeVisible( clgi.CM_NodeForNumber( lent->headnode ), clgi.client->localPVS.pvs ) ) {
-						isVisible = false;
-					}
-				} else {
-					// Check the cluster's individual leafs.
-					for ( i = 0; i < lent->num_clusters; i++ ) {
-						if ( Q_IsBitSet( clgi.client->localPVS.pvs, lent->clusternums[ i ] ) ) {
-							// Possibly visible.
-							break;
-						}
-					}
-					// Not visible:
-					if ( i == lent->num_clusters ) {
-						isVisible = false;
-					}
-				}
-			//} //if ( cull_nonvisible_clientgame_entities ) {
-		//}
-	}
-
-	// Return the final result, visible or not.
-	return isVisible;
+	return true;
 }
 
 /**
 *	@brief	Add local client entities that are 'in-frame' to the view's refdef entities list.
 **/
 void CLG_AddLocalEntities( void ) {
-	// Iterate over all entities.
-	for ( int32_t i = 0; i < clg_num_local_entities; i++ ) {
+	const byte *pvs = clgi.client->localPVS.pvs;
+
+	// New frame stamp, an entity that is in several visible clusters is only gathered once.
+	const uint32_t frame = ++clg_cluster_buckets.frame;
+	int32_t numVisibleEntities = 0;
+
+	// Gather the entities of all occupied clusters that are in the PVS.
+	for ( int32_t i = 0; i < clg_cluster_buckets.numOccupied; i++ ) {
+		const int32_t cluster = clg_cluster_buckets.occupied[ i ];
+		if ( !Q_IsBitSet( pvs, cluster ) ) {
+			continue;
+		}
+		for ( int32_t link = clg_cluster_buckets.heads[ cluster ]; link != CLUSTER_LINK_NONE; link = clg_cluster_buckets.links[ link ].next ) {
+			const int32_t entityNumber = link / MAX_ENT_CLUSTERS;
+			if ( clg_cluster_buckets.visibleFrame[ entityNumber ] != frame ) {
+				clg_cluster_buckets.visibleFrame[ entityNumber ] = frame;
+				clg_cluster_buckets.visibleEntities[ numVisibleEntities++ ] = entityNumber;
+			}
+		}
+	}
+
+	// Too many leafs for individual checks, go by headnode.
+	for ( int32_t i = 0; i < clg_cluster_buckets.numHeadnodeEntities; i++ ) {
+		const int32_t entityNumber = clg_cluster_buckets.headnodeEntities[ i ];
+		if ( clgi.CM_HeadnodeVisible( clgi.CM_NodeForNumber( clg_local_entities[ entityNumber ].headnode ), pvs ) ) {
+			clg_cluster_buckets.visibleEntities[ numVisibleEntities++ ] = entityNumber;
+		}
+	}
+
+	// Keep adding them in entity order.
+	std::sort( clg_cluster_buckets.visibleEntities, clg_cluster_buckets.visibleEntities + numVisibleEntities );
+
+	for ( int32_t i = 0; i < numVisibleEntities; i++ ) {
 		// Get local entity pointer.
-		clg_local_entity_t *lent = &clg_local_entities[ i ];
+		clg_local_entity_t *lent = &clg_local_entities[ clg_cluster_buckets.visibleEntities[ i ] ];
 
 		// Skip iteration if entity is not in use, or not properly class allocated.
-		if ( !lent || !lent->inuse || !lent->classLocals || !lent->islinked ) {
+		if ( !lent->inuse || !lent->classLocals || !lent->islinked ) {
 			continue;
 		}
 
 		// Determine whether it is visible at all.
-		if ( CLG_LocalEntity_InLocalPVS( lent ) ) {
+		if ( CLG_LocalEntity_InLocalAreas( lent ) ) {
 			// Get its class locals.
 			CLG_LocalEntity_DispatchPrepareRefreshEntity( lent );
-			// Debug print it ain't visible.
-			//clgi.Print( PRINT_NOTICE, "%s: lent(#%d) PVS VISIBLE.\n", __func__, lent->id );
-		} else {
-			// Debug print it ain't visible.
-			//clgi.Print( PRINT_NOTICE, "%s: lent(#%d) is not PVS visible.\n", __func__, lent->id );
 		}
 	}
 }
@@ -79,11 +79,12 @@ void CLG_LocalEntity_ClearState();
 **/
 bool CLG_LocalEntity_RunThink( clg_local_entity_t *lent );
 /**
-*	@brief
+*	@brief	Links the entity to the PVS clusters and areas its bounding box touches, and updates
+*			the cluster buckets it is in if those changed.
 **/
 void CLG_LocalEntity_Link( clg_local_entity_t *lent );
 /**
-*	@brief
+*	@brief	Unlinks the entity from the PVS, taking it out of its cluster buckets.
 **/
 void CLG_LocalEntity_Unlink( clg_local_entity_t *lent );
 
@@ -12,6 +12,7 @@
 #include "clgame/clg_entities.h"
 #include "clgame/clg_frame.h"
 #include "clgame/clg_input.h"
+#include "clgame/clg_jobs.h"
 #include "clgame/clg_local_entities.h"
 #include "clgame/clg_packet_entities.h"
 #include "clgame/clg_parse.h"
@@ -76,12 +77,15 @@ cvar_t *maxentities = nullptr;
 cvar_t *cl_showmiss = nullptr;
 cvar_t *clg_debug_entity_events = nullptr;
 cvar_t *clg_debug_pmove_changed_events = nullptr;
+cvar_t *clg_entity_timings = nullptr;
 
 cvar_t *clg_kickangles = nullptr;
 cvar_t *clg_noskins = nullptr;
 cvar_t *cl_predict = nullptr;
+cvar_t *clg_predict_cache = nullptr;
 cvar_t *cl_nolerp = nullptr;
 cvar_t *clg_footsteps = nullptr;
+cvar_t *clg_particles = nullptr;
 
 // Cheesy workaround for various cvars initialized elsewhere in the client, but we need access.
 cvar_t *cvar_pt_particle_emissive = nullptr; // from client FX_Init
@@ -276,6 +280,9 @@ void PF_ClearState( void ) {
 	// Clear Local Entity States.
 	CLG_LocalEntity_ClearState();
 
+	// Don't reuse predicted command outcomes of the previous connection.
+	CLG_ClearPredictionCache();
+
 	// Clear out Client Entities array.
 	//memset( clg_entities, 0, globals.entity_size * sizeof( clg_entities[ 0 ] ) );
 	for ( int32_t i = 0; i < sizeof( clg_entities ); i++ ) {
@@ -492,6 +499,9 @@ void PF_PreShutdownGame( void ) {
 void PF_ShutdownGame( void ) {
 	clgi.Print( print_type_t::PRINT_ALL, "==== Shutdown ClientGame ====\n" );
 
+	// Stop the worker threads before anything they could be working on is released.
+	CLG_Jobs_Shutdown();
+
 	// Uncomment after we actually allocate anything using this.
 	clgi.FreeTags( TAG_CLGAME_LEVEL );
 	clgi.FreeTags( TAG_CLGAME );
@@ -529,6 +539,7 @@ void PF_InitGame( void ) {
 	//developer = clgi.CVar_Get( "developer", "0", CVAR_NOSET );
 	#endif
 	cl_predict = clgi.CVar_Get( "cl_predict", nullptr, 0 );
+	clg_predict_cache = clgi.CVar_Get( "clg_predict_cache", "1", 0 );
 	cl_running = clgi.CVar_Get( "cl_running", nullptr, 0 );
 	cl_paused = clgi.CVar_Get( "cl_paused", nullptr, 0 );
 	sv_running = clgi.CVar_Get( "cl_running", nullptr, 0 );
@@ -548,9 +559,11 @@ void PF_InitGame( void ) {
 	cl_showmiss = clgi.CVar_Get( "cl_showmiss", "0", 0 ); // Fetched from engine.
 	clg_debug_entity_events = clgi.CVar_Get( "clg_debug_entity_events", "1", 0 );
 	clg_debug_pmove_changed_events = clgi.CVar_Get( "clg_debug_pmove_changed_events", "1", 0 );
+	clg_entity_timings = clgi.CVar_Get( "clg_entity_timings", "0", 0 );
 
 	// Client effects.
 	clg_footsteps = clgi.CVar_Get( "clg_footsteps", "1", 0 );
+	clg_particles = clgi.CVar_Get( "clg_particles", "32768", CVAR_ARCHIVE );
 	clg_kickangles = clgi.CVar_Get( "clg_kickangles", "1", CVAR_CHEAT );
 	clg_noskins = clgi.CVar_Get( "clg_noskins", "0", 0 );
 	cl_nolerp = clgi.CVar_Get( "cl_nolerp", "0", 0 ); // Fetched from engine.
@@ -620,6 +633,11 @@ void PF_InitGame( void ) {
 	CLG_InitEffects();
 	CLG_TemporaryEntities_Init();
 
+	/**
+	*	Initialize the worker jobs, the threads are started on first use.
+	**/
+	CLG_Jobs_Init();
+
 	/**
 	*	Default EAX Environment:
 	**/
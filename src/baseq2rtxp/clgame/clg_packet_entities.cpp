@@ -14,12 +14,15 @@
 #include "clgame/clg_local.h"
 #include "clgame/clg_effects.h"
 #include "clgame/clg_entities.h"
+#include "clgame/clg_jobs.h"
 #include "clgame/clg_packet_entities.h"
 #include "clgame/clg_temp_entities.h"
 
 #include "sharedgame/sg_entity_types.h"
 #include "sharedgame/sg_entities.h"
 
+#include "clgame/packet_entities/clg_packet_et_player.h"
+
 
 // WID: TODO: Move to client where it determines old/new states?
 #if 1 
@@ -141,6 +144,97 @@ static void CLG_PacketEntity_DetermineMoveDirection( centity_t *packetEntity, en
 #endif
 
 
+/**
+*
+*
+*
+*   Pose Jobs:
+*
+*
+*
+**/
+/**
+*   @brief  A skeletal pose queued up by the serial pass of CLG_AddPacketEntities, for the
+*           job threads to process into the packet entity's own bone pose caches.
+**/
+typedef struct clg_pose_job_s {
+    centity_t *packetEntity;
+    const model_t *model;
+    entity_state_t *nextState;
+    bool isLocalClientEntity;
+} clg_pose_job_t;
+
+//! One for each packet entity, plus the predicted player entity.
+static clg_pose_job_t clg_pose_jobs[ MAX_PACKET_ENTITIES + 1 ];
+static int32_t clg_num_pose_jobs = 0;
+
+//! Accumulated 'clg_entity_timings' of the current reporting interval.
+static struct {
+    uint64_t lastReportTime;
+    int32_t numFrames;
+    int64_t numEntities;
+    int64_t numPoses;
+    double setupMsec;
+    double posesMsec;
+} clg_entity_timings_stats;
+
+/**
+*   @brief  Queues the packet entity's skeletal pose to be processed by the job threads, all of
+*           the queued poses are finished before CLG_AddPacketEntities returns.
+**/
+void CLG_PacketEntity_QueuePose( centity_t *packetEntity, const model_t *model, entity_state_t *nextState, const bool isLocalClientEntity ) {
+    if ( clg_num_pose_jobs >= (int32_t)q_countof( clg_pose_jobs ) ) {
+        return;
+    }
+    clg_pose_jobs[ clg_num_pose_jobs++ ] = {
+        .packetEntity = packetEntity,
+        .model = model,
+        .nextState = nextState,
+        .isLocalClientEntity = isLocalClientEntity
+    };
+}
+
+/**
+*   @brief  Job callback, processes the pose of the queued up job at 'index'.
+**/
+static void CLG_PacketEntity_PoseJob( const int32_t index, void *userData ) {
+    clg_pose_job_t *poseJob = &clg_pose_jobs[ index ];
+    CLG_ETPlayer_ProcessAnimations( poseJob->packetEntity, poseJob->model, poseJob->nextState, poseJob->isLocalClientEntity );
+}
+
+/**
+*   @brief  Accumulates the timings of this frame's CLG_AddPacketEntities, and prints out
+*           the averages once every second.
+**/
+static void CLG_PacketEntity_ReportTimings( const int32_t numEntities, const int32_t numPoses, const double setupMsec, const double posesMsec ) {
+    clg_entity_timings_stats.numFrames++;
+    clg_entity_timings_stats.numEntities += numEntities;
+    clg_entity_timings_stats.numPoses += numPoses;
+    clg_entity_timings_stats.setupMsec += setupMsec;
+    clg_entity_timings_stats.posesMsec += posesMsec;
+
+    const uint64_t realTime = clgi.GetRealTime();
+    if ( !clg_entity_timings_stats.lastReportTime ) {
+        clg_entity_timings_stats.lastReportTime = realTime;
+    }
+    if ( realTime - clg_entity_timings_stats.lastReportTime < 1000 ) {
+        return;
+    }
+
+    const double numFrames = clg_entity_timings_stats.numFrames;
+    clgi.Print( PRINT_ALL, "entities: %.1f poses: %.1f setup: %.3fms poses: %.3fms threads: %i\n",
+        clg_entity_timings_stats.numEntities / numFrames,
+        clg_entity_timings_stats.numPoses / numFrames,
+        clg_entity_timings_stats.setupMsec / numFrames,
+        clg_entity_timings_stats.posesMsec / numFrames,
+        CLG_Jobs_NumThreads() );
+
+    clg_entity_timings_stats = {};
+    clg_entity_timings_stats.lastReportTime = realTime;
+}
+
+
+
 /**
 *   @brief  Adds a packet entity according to its entity type.
 *   @param  packetEntity    The client game entity to add the packet entity data to.
@@ -204,6 +298,11 @@ static const bool AddPacketEntity( centity_t *packetEntity, entity_state_t *next
 *           has a matching ID.
 **/
 void CLG_AddPacketEntities( void ) {
+    // Start of the serial setup pass.
+    const auto setupStartTime = std::chrono::steady_clock::now();
+    // Nothing is queued up yet.
+    clg_num_pose_jobs = 0;
+
     // Base entity flags.
     int32_t base_entity_flags = 0;
 
@@ -266,4 +365,18 @@ void CLG_AddPacketEntities( void ) {
             continue;
         }
     }
+
+    /**
+    *   Process the queued up skeletal poses, spread over the job threads. The refresh entities
+    *   that were just added point right at the bone pose caches that are written to here.
+    **/
+    const auto posesStartTime = std::chrono::steady_clock::now();
+    CLG_Jobs_ParallelFor( clg_num_pose_jobs, CLG_PacketEntity_PoseJob, nullptr );
+    const auto posesEndTime = std::chrono::steady_clock::now();
+
+    if ( clg_entity_timings->integer ) {
+        CLG_PacketEntity_ReportTimings( clgi.client->frame.numEntities, clg_num_pose_jobs,
+            std::chrono::duration<double, std::milli>( posesStartTime - setupStartTime ).count(),
+            std::chrono::duration<double, std::milli>( posesEndTime - posesStartTime ).count() );
+    }
 }
\ No newline at end of file
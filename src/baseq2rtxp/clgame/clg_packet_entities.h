@@ -20,6 +20,11 @@
 *	@brief	Will add all packet entities to the current frame's view refdef
 **/
 void CLG_AddPacketEntities( void );
+/**
+*	@brief	Queues the packet entity's skeletal pose to be processed by the job threads, all of
+*			the queued poses are finished before CLG_AddPacketEntities returns.
+**/
+void CLG_PacketEntity_QueuePose( centity_t *packetEntity, const model_t *model, entity_state_t *nextState, const bool isLocalClientEntity );
 
 
 
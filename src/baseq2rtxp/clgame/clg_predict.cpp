@@ -49,6 +49,143 @@ static const cm_contents_t  CLG_PM_PointContents( const Vector3 &point ) {
 
 
 
+/**
+*
+*
+*
+*   PMove Replay Cache:
+*
+*
+*
+**/
+/**
+*   Between two server frames, CLG_PredictMovement replays the same acknowledged
+*   commands from the same starting player state every render frame, while only
+*   the pending command is new. The outcome of each command is cached here and
+*   restored instead of simulated again, for as long as the chain of commands
+*   starts off from the same server frame(and thus the same collision world), the
+*   same first command, and the same starting state. Each entry is also keyed on
+*   the bobCycle its command started off from, since CLG_PredictNextBobCycle moves
+*   it between commands by a fraction that differs every render frame.
+**/
+//! Predicted outcome of a single move command.
+typedef struct clg_predict_cache_entry_s {
+    //! Chain generation that this entry was simulated in.
+    uint64_t generation;
+    //! Command number, and the actual command and time that were simulated.
+    int64_t commandNumber;
+    usercmd_t cmd;
+    int64_t simulationTime;
+    //! The bobCycle the command started off from. CLG_PredictNextBobCycle adjusts it between
+    //! commands by the render frame's xerpFraction, so it differs from one replay to the next.
+    int32_t bobCycle;
+
+    //! The resulting player move state.
+    player_state_t playerState;
+    Vector3 mins, maxs;
+    ground_info_t ground;
+    liquid_info_t liquid;
+    qboolean step_clip;
+    double step_height;
+    qboolean jump_sound;
+    double impact_delta;
+} clg_predict_cache_entry_t;
+
+static struct {
+    //! Incremented whenever the chain is invalidated, entries of older generations are stale.
+    uint64_t generation;
+
+    //! The server frame, first command, and starting state that the current chain went off from.
+    int64_t frameNumber;
+    int64_t firstCommandNumber;
+    Vector3 deltaAngles;
+    ground_info_t ground;
+    liquid_info_t liquid;
+
+    //! One for each command in the circular move command buffer.
+    clg_predict_cache_entry_t entries[ CMD_BACKUP ];
+} clg_predict_replay;
+
+/**
+*   @brief  Invalidates all cached command outcomes, the next prediction replays all of them.
+**/
+void CLG_ClearPredictionCache( void ) {
+    clg_predict_replay.generation++;
+    clg_predict_replay.frameNumber = -1;
+}
+
+/**
+*   @return True if the cached chain went off from the same starting state, and its entries
+*           can be restored for as long as their commands match. Otherwise starts a new chain.
+**/
+static const bool CLG_PredictionCache_BeginChain( const int64_t firstCommandNumber, const pmove_t *pm ) {
+    if ( clg_predict_replay.frameNumber == clgi.client->frame.number
+        && clg_predict_replay.firstCommandNumber == firstCommandNumber
+        && clg_predict_replay.deltaAngles == pm->state->pmove.delta_angles
+        && !memcmp( &clg_predict_replay.ground, &pm->ground, sizeof( pm->ground ) )
+        && !memcmp( &clg_predict_replay.liquid, &pm->liquid, sizeof( pm->liquid ) ) ) {
+        return clg_predict_cache->integer != 0;
+    }
+
+    // New chain.
+    clg_predict_replay.generation++;
+    clg_predict_replay.frameNumber = clgi.client->frame.number;
+    clg_predict_replay.firstCommandNumber = firstCommandNumber;
+    clg_predict_replay.deltaAngles = pm->state->pmove.delta_angles;
+    clg_predict_replay.ground = pm->ground;
+    clg_predict_replay.liquid = pm->liquid;
+    return false;
+}
+
+/**
+*   @return True if the outcome of the command was cached in the current chain, and has been restored into 'pm'.
+**/
+static const bool CLG_PredictionCache_Restore( const int64_t commandNumber, pmove_t *pm ) {
+    const clg_predict_cache_entry_t *entry = &clg_predict_replay.entries[ commandNumber & CMD_MASK ];
+    if ( entry->generation != clg_predict_replay.generation
+        || entry->commandNumber != commandNumber
+        || entry->simulationTime != pm->simulationTime.Milliseconds()
+        || entry->bobCycle != pm->state->bobCycle
+        || memcmp( &entry->cmd, &pm->cmd, sizeof( pm->cmd ) ) ) {
+        return false;
+    }
+
+    *pm->state = entry->playerState;
+    pm->mins = entry->mins;
+    pm->maxs = entry->maxs;
+    pm->ground = entry->ground;
+    pm->liquid = entry->liquid;
+    pm->step_clip = entry->step_clip;
+    pm->step_height = entry->step_height;
+    pm->jump_sound = entry->jump_sound;
+    pm->impact_delta = entry->impact_delta;
+    return true;
+}
+
+/**
+*   @brief  Stores the outcome of the command that was just simulated, from 'bobCycle', into the current chain.
+**/
+static void CLG_PredictionCache_Store( const int64_t commandNumber, const int32_t bobCycle, const pmove_t *pm ) {
+    clg_predict_cache_entry_t *entry = &clg_predict_replay.entries[ commandNumber & CMD_MASK ];
+    entry->generation = clg_predict_replay.generation;
+    entry->commandNumber = commandNumber;
+    entry->cmd = pm->cmd;
+    entry->simulationTime = pm->simulationTime.Milliseconds();
+    entry->bobCycle = bobCycle;
+
+    entry->playerState = *pm->state;
+    entry->mins = pm->mins;
+    entry->maxs = pm->maxs;
+    entry->ground = pm->ground;
+    entry->liquid = pm->liquid;
+    entry->step_clip = pm->step_clip;
+    entry->step_height = pm->step_height;
+    entry->jump_sound = pm->jump_sound;
+    entry->impact_delta = pm->impact_delta;
+}
+
+
+
 /**
 *
 *
@@ -400,6 +537,8 @@ void CLG_CheckPredictionError( ) {
             game.predictedState.currentPs = clgi.client->frame.ps;
             //game.predictedState.currentPs.pmove = clgi.client->predictedFrame.ps.pmove;
             game.predictedState.error = {};
+            // Replay all commands from scratch.
+            CLG_ClearPredictionCache();
             game.predictedState.origin = clgi.client->frame.ps.pmove.origin; // Store the server returned origin for this command index.
 
             // Reset transition state.
@@ -511,6 +650,10 @@ void CLG_PredictMovement( int64_t acknowledgedCommandNumber, const int64_t curre
     // [NO-NEED]: This gets recalculated during PMove, based on the 'usercmd' and server 'delta angles'.
     //pm.state->viewangles = clgi.client->viewangles; 
 
+    // Determine whether the outcomes of the previous frame's replay can be reused. Once
+    // a command misses the cache, all that follow it have to be simulated again.
+    bool replayFromCache = CLG_PredictionCache_BeginChain( acknowledgedCommandNumber + 1, &pm );
+
     // Run previously stored and acknowledged frames up and including the last one.
     while ( ++acknowledgedCommandNumber <= currentCommandNumber ) {
         // Get the acknowledged move command from our circular buffer.
@@ -534,8 +677,13 @@ void CLG_PredictMovement( int64_t acknowledgedCommandNumber, const int64_t curre
             }
             #endif
 
-			// Move the simulation.
-            SG_PlayerMove( (pmove_s *)&pm, (pmoveParams_s *)&pmp );
+			// Move the simulation, unless its outcome is still cached.
+            if ( !replayFromCache || !CLG_PredictionCache_Restore( acknowledgedCommandNumber, &pm ) ) {
+                const int32_t bobCycle = pm.state->bobCycle;
+                SG_PlayerMove( (pmove_s *)&pm, (pmoveParams_s *)&pmp );
+                CLG_PredictionCache_Store( acknowledgedCommandNumber, bobCycle, &pm );
+                replayFromCache = false;
+            }
             #if 1
                 // Check and execute any player state related events.
                 CLG_CheckPlayerstateEvents( &predictedState->lastPs, &predictedState->currentPs );
@@ -35,6 +35,10 @@ void CLG_PredictMovement( int64_t acknowledgedCommandNumber, const int64_t curre
 *           the margin is too high, snap back to server provided player state.
 **/
 void CLG_CheckPredictionError();
+/**
+*   @brief  Invalidates all cached command outcomes, the next prediction replays all of them.
+**/
+void CLG_ClearPredictionCache( void );
 
 /**
 *   @brief  Checks for player state generated events(usually by PMove) and processed them for execution.
@@ -3,119 +3,263 @@
 *
 *	ClientGame: Particles for the client game module.
 *
+*	Effects allocate their particles as clg_particle_t spawn records,
+*	which are moved into a structure of arrays pool at the start of
+*	CLG_AddParticles. The pool is integrated in blocks of 8 particles,
+*	written straight into the refresh particle buffer, and compacted
+*	by moving the last particle into the slot of each one that faded
+*	out.
+*
 *
 ********************************************************************/
 #include "clgame/clg_local.h"
 #include "clgame/clg_effects.h"
 #include "clgame/effects/clg_fx_particles.h"
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define CLG_PARTICLES_SSE2 1
+#include <emmintrin.h>
+#else
+#define CLG_PARTICLES_SSE2 0
+#endif
+
+
+
+//! Number of particles integrated at once.
+static constexpr int32_t PARTICLE_BLOCK_SIZE = 8;
+//! Maximum number of particles that can be spawned in between two CLG_AddParticles calls.
+static constexpr int32_t MAX_PARTICLE_SPAWNS = MAX_PARTICLES;
+//! Particle spawn times are rebased once they're this far (in milliseconds) ahead of the time base,
+//! so that the float relative spawn times keep their millisecond precision.
+static constexpr int64_t PARTICLE_TIME_REBASE = 1 << 22;
+
+/**
+*   @brief  Structure of arrays holding all live particles, the arrays are padded up to
+*           a full block so the last block can be integrated without special casing.
+**/
+static struct {
+    alignas( 16 ) float orgX[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float orgY[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float orgZ[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float velX[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float velY[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float velZ[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float accelX[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float accelY[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float accelZ[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float alpha[ CLG_MAX_PARTICLES ];
+    alignas( 16 ) float alphavel[ CLG_MAX_PARTICLES ];
+    //! Spawn time in milliseconds, relative to timeBase.
+    alignas( 16 ) float time[ CLG_MAX_PARTICLES ];
+
+    int32_t color[ CLG_MAX_PARTICLES ];
+    color_t rgba[ CLG_MAX_PARTICLES ];
+    float brightness[ CLG_MAX_PARTICLES ];
 
+    //! Number of live particles.
+    int32_t count;
+    //! Client time that the spawn times are relative to.
+    int64_t timeBase;
+} particles;
 
-static clg_particle_t *active_particles, *free_particles;
+//! Particles allocated since the last CLG_AddParticles call.
+static clg_particle_t particle_spawns[ MAX_PARTICLE_SPAWNS ];
+static int32_t num_particle_spawns = 0;
 
-static clg_particle_t particles[ MAX_PARTICLES ];
+static_assert( CLG_MAX_PARTICLES % PARTICLE_BLOCK_SIZE == 0, "CLG_MAX_PARTICLES must be a multiple of PARTICLE_BLOCK_SIZE" );
 
 
 
 /**
-*   @brief  
+*   @brief
 **/
 void CLG_ClearParticles( void ) {
-    int32_t i = 0;
-
-    free_particles = &particles[ 0 ];
-    active_particles = nullptr;
-
-    for ( i = 0; i < MAX_PARTICLES - 1; i++ ) {
-        particles[ i ].next = &particles[ i + 1 ];
-    }
-    particles[ i ].next = nullptr;
+    particles.count = 0;
+    particles.timeBase = clgi.client->time;
+    num_particle_spawns = 0;
 }
 
 /**
-*   @brief
+*   @brief  Returns a particle spawn record for the caller to fill in, the particle is
+*           added to the pool by the next CLG_AddParticles call.
+*   @return (nullptr) if the pool, or spawn buffer, is full.
 **/
 clg_particle_t *CLG_AllocateParticle( void ) {
-    clg_particle_t *p;
-
-    if ( !free_particles ) {
+    const int32_t maxParticles = std::clamp<int32_t>( clg_particles->integer, PARTICLE_BLOCK_SIZE, CLG_MAX_PARTICLES );
+    if ( num_particle_spawns >= MAX_PARTICLE_SPAWNS || particles.count + num_particle_spawns >= maxParticles ) {
         return nullptr;
     }
-    p = free_particles;
-    free_particles = p->next;
-    p->next = active_particles;
-    active_particles = p;
-
-    return p;
+    return &particle_spawns[ num_particle_spawns++ ];
 }
 
-
-//extern int          r_numparticles;
-//extern particle_t   r_particles[ MAX_PARTICLES ];
+/**
+*   @brief  Writes a particle out to the refresh particle buffer.
+**/
+static inline void CLG_EmitParticle( particle_t *part, const float x, const float y, const float z, const float alpha, const int32_t color, const color_t rgba, const float brightness ) {
+    part->origin[ 0 ] = x;
+    part->origin[ 1 ] = y;
+    part->origin[ 2 ] = z;
+    part->rgba = rgba;
+    part->color = color;
+    part->brightness = brightness;
+    part->alpha = alpha;
+    part->radius = 0.f;
+}
 
 /**
-*   @brief
+*   @brief  Moves the particles spawned since the last frame into the pool. Instant particles
+*           only live for a single frame, so they are written out right away instead.
 **/
-void CLG_AddParticles( void ) {
-    clg_particle_t *p, *next;
-    float           alpha;
-    float           time = 0, time2;
-    int             color;
-    clg_particle_t *active, *tail;
-    particle_t *part;
-
-    active = NULL;
-    tail = NULL;
-
-    for ( p = active_particles; p; p = next ) {
-        next = p->next;
-
-        if ( p->alphavel != INSTANT_PARTICLE ) {
-            time = ( clgi.client->time - p->time ) * 0.001f;
-            alpha = p->alpha + time * p->alphavel;
-            if ( alpha <= 0 ) {
-                // faded out
-                p->next = free_particles;
-                free_particles = p;
+static void CLG_SpawnParticles( const int64_t currentTime ) {
+    for ( int32_t i = 0; i < num_particle_spawns; i++ ) {
+        const clg_particle_t *p = &particle_spawns[ i ];
+
+        if ( p->alphavel == INSTANT_PARTICLE ) {
+            if ( clgi.client->viewScene.r_numparticles >= MAX_PARTICLES ) {
                 continue;
             }
-        } else {
-            alpha = p->alpha;
+            const float time = ( currentTime - p->time ) * 0.001f;
+            const float time2 = time * time;
+            particle_t *part = &clgi.client->viewScene.r_particles[ clgi.client->viewScene.r_numparticles++ ];
+            CLG_EmitParticle( part,
+                p->org[ 0 ] + p->vel[ 0 ] * time + p->accel[ 0 ] * time2,
+                p->org[ 1 ] + p->vel[ 1 ] * time + p->accel[ 1 ] * time2,
+                p->org[ 2 ] + p->vel[ 2 ] * time + p->accel[ 2 ] * time2,
+                std::min( p->alpha, 1.f ), p->color, p->rgba, p->brightness );
+            continue;
         }
 
-        if ( clgi.client->viewScene.r_numparticles >= MAX_PARTICLES )
-            break;
-        part = &clgi.client->viewScene.r_particles[ clgi.client->viewScene.r_numparticles++ ];
+        const int32_t index = particles.count++;
+        particles.orgX[ index ] = p->org[ 0 ];
+        particles.orgY[ index ] = p->org[ 1 ];
+        particles.orgZ[ index ] = p->org[ 2 ];
+        particles.velX[ index ] = p->vel[ 0 ];
+        particles.velY[ index ] = p->vel[ 1 ];
+        particles.velZ[ index ] = p->vel[ 2 ];
+        particles.accelX[ index ] = p->accel[ 0 ];
+        particles.accelY[ index ] = p->accel[ 1 ];
+        particles.accelZ[ index ] = p->accel[ 2 ];
+        particles.alpha[ index ] = p->alpha;
+        particles.alphavel[ index ] = p->alphavel;
+        particles.time[ index ] = (float)( p->time - particles.timeBase );
+        particles.color[ index ] = p->color;
+        particles.rgba[ index ] = p->rgba;
+        particles.brightness[ index ] = p->brightness;
+    }
+    num_particle_spawns = 0;
+}
 
-        p->next = NULL;
-        if ( !tail )
-            active = tail = p;
-        else {
-            tail->next = p;
-            tail = p;
+/**
+*   @brief  Moves the last live particle into the slot of 'index'.
+**/
+static inline void CLG_RemoveParticle( const int32_t index ) {
+    const int32_t last = --particles.count;
+    particles.orgX[ index ] = particles.orgX[ last ];
+    particles.orgY[ index ] = particles.orgY[ last ];
+    particles.orgZ[ index ] = particles.orgZ[ last ];
+    particles.velX[ index ] = particles.velX[ last ];
+    particles.velY[ index ] = particles.velY[ last ];
+    particles.velZ[ index ] = particles.velZ[ last ];
+    particles.accelX[ index ] = particles.accelX[ last ];
+    particles.accelY[ index ] = particles.accelY[ last ];
+    particles.accelZ[ index ] = particles.accelZ[ last ];
+    particles.alpha[ index ] = particles.alpha[ last ];
+    particles.alphavel[ index ] = particles.alphavel[ last ];
+    particles.time[ index ] = particles.time[ last ];
+    particles.color[ index ] = particles.color[ last ];
+    particles.rgba[ index ] = particles.rgba[ last ];
+    particles.brightness[ index ] = particles.brightness[ last ];
+}
+
+/**
+*   @brief  Integrates the block of particles starting at 'first' for the time 'now',
+*           relative to the time base, outputting their positions and faded alpha.
+**/
+static inline void CLG_IntegrateParticleBlock( const int32_t first, const float now, float *x, float *y, float *z, float *alpha ) {
+    #if CLG_PARTICLES_SSE2
+    const __m128 vNow = _mm_set1_ps( now );
+    const __m128 vMsec = _mm_set1_ps( 0.001f );
+    const __m128 vOne = _mm_set1_ps( 1.f );
+    for ( int32_t lane = 0; lane < PARTICLE_BLOCK_SIZE; lane += 4 ) {
+        const int32_t i = first + lane;
+        const __m128 time = _mm_mul_ps( _mm_sub_ps( vNow, _mm_load_ps( &particles.time[ i ] ) ), vMsec );
+        const __m128 time2 = _mm_mul_ps( time, time );
+
+        _mm_storeu_ps( &x[ lane ], _mm_add_ps( _mm_add_ps( _mm_load_ps( &particles.orgX[ i ] ), _mm_mul_ps( _mm_load_ps( &particles.velX[ i ] ), time ) ), _mm_mul_ps( _mm_load_ps( &particles.accelX[ i ] ), time2 ) ) );
+        _mm_storeu_ps( &y[ lane ], _mm_add_ps( _mm_add_ps( _mm_load_ps( &particles.orgY[ i ] ), _mm_mul_ps( _mm_load_ps( &particles.velY[ i ] ), time ) ), _mm_mul_ps( _mm_load_ps( &particles.accelY[ i ] ), time2 ) ) );
+        _mm_storeu_ps( &z[ lane ], _mm_add_ps( _mm_add_ps( _mm_load_ps( &particles.orgZ[ i ] ), _mm_mul_ps( _mm_load_ps( &particles.velZ[ i ] ), time ) ), _mm_mul_ps( _mm_load_ps( &particles.accelZ[ i ] ), time2 ) ) );
+        // Not clamped from below, a faded out particle is recognized by its alpha <= 0.
+        _mm_storeu_ps( &alpha[ lane ], _mm_min_ps( _mm_add_ps( _mm_load_ps( &particles.alpha[ i ] ), _mm_mul_ps( _mm_load_ps( &particles.alphavel[ i ] ), time ) ), vOne ) );
+    }
+    #else
+    for ( int32_t lane = 0; lane < PARTICLE_BLOCK_SIZE; lane++ ) {
+        const int32_t i = first + lane;
+        const float time = ( now - particles.time[ i ] ) * 0.001f;
+        const float time2 = time * time;
+
+        x[ lane ] = particles.orgX[ i ] + particles.velX[ i ] * time + particles.accelX[ i ] * time2;
+        y[ lane ] = particles.orgY[ i ] + particles.velY[ i ] * time + particles.accelY[ i ] * time2;
+        z[ lane ] = particles.orgZ[ i ] + particles.velZ[ i ] * time + particles.accelZ[ i ] * time2;
+        // Not clamped from below, a faded out particle is recognized by its alpha <= 0.
+        alpha[ lane ] = std::min( particles.alpha[ i ] + particles.alphavel[ i ] * time, 1.f );
+    }
+    #endif
+}
+
+/**
+*   @brief  Spawns the particles allocated since the last frame, integrates all live ones
+*           into the refresh particle buffer, and removes those that faded out.
+**/
+void CLG_AddParticles( void ) {
+    const int64_t currentTime = clgi.client->time;
+
+    // Keep the relative spawn times small enough for float precision.
+    if ( currentTime - particles.timeBase >= PARTICLE_TIME_REBASE ) {
+        const float shift = (float)( currentTime - particles.timeBase );
+        for ( int32_t i = 0; i < particles.count; i++ ) {
+            particles.time[ i ] -= shift;
         }
+        particles.timeBase = currentTime;
+    }
 
-        if ( alpha > 1.0f )
-            alpha = 1;
-        color = p->color;
+    CLG_SpawnParticles( currentTime );
 
-        time2 = time * time;
+    const float now = (float)( currentTime - particles.timeBase );
+    const int32_t count = particles.count;
 
-        part->origin[ 0 ] = p->org[ 0 ] + p->vel[ 0 ] * time + p->accel[ 0 ] * time2;
-        part->origin[ 1 ] = p->org[ 1 ] + p->vel[ 1 ] * time + p->accel[ 1 ] * time2;
-        part->origin[ 2 ] = p->org[ 2 ] + p->vel[ 2 ] * time + p->accel[ 2 ] * time2;
+    // Slots of the particles that faded out, in increasing order.
+    static int32_t deadParticles[ CLG_MAX_PARTICLES ];
+    int32_t numDeadParticles = 0;
 
-        part->rgba = p->rgba;
-        part->color = color;
-        part->brightness = p->brightness;
-        part->alpha = alpha;
-        part->radius = 0.f;
+    particle_t *refreshParticles = clgi.client->viewScene.r_particles;
+    int32_t numRefreshParticles = clgi.client->viewScene.r_numparticles;
 
-        if ( p->alphavel == INSTANT_PARTICLE ) {
-            p->alphavel = 0.0f;
-            p->alpha = 0.0f;
+    for ( int32_t first = 0; first < count; first += PARTICLE_BLOCK_SIZE ) {
+        alignas( 16 ) float x[ PARTICLE_BLOCK_SIZE ], y[ PARTICLE_BLOCK_SIZE ], z[ PARTICLE_BLOCK_SIZE ], alpha[ PARTICLE_BLOCK_SIZE ];
+        CLG_IntegrateParticleBlock( first, now, x, y, z, alpha );
+
+        const int32_t numLanes = std::min( count - first, PARTICLE_BLOCK_SIZE );
+        for ( int32_t lane = 0; lane < numLanes; lane++ ) {
+            const int32_t i = first + lane;
+            if ( alpha[ lane ] <= 0 ) {
+                // faded out
+                deadParticles[ numDeadParticles++ ] = i;
+                continue;
+            }
+            // Keep it around, the refresh might have room for it next frame.
+            if ( numRefreshParticles >= MAX_PARTICLES ) {
+                continue;
+            }
+            CLG_EmitParticle( &refreshParticles[ numRefreshParticles++ ], x[ lane ], y[ lane ], z[ lane ], alpha[ lane ],
+                particles.color[ i ], particles.rgba[ i ], particles.brightness[ i ] );
         }
     }
 
-    active_particles = active;
-}
\ No newline at end of file
+    clgi.client->viewScene.r_numparticles = numRefreshParticles;
+
+    // Remove the faded out particles back to front, so the particle moved into a
+    // freed slot always is one that is still alive.
+    for ( int32_t i = numDeadParticles - 1; i >= 0; i-- ) {
+        CLG_RemoveParticle( deadParticles[ i ] );
+    }
+}
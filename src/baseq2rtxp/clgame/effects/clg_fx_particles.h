@@ -14,10 +14,13 @@
 **/
 void CLG_ClearParticles( void );
 /**
-*   @brief
+*   @brief  Returns a particle spawn record for the caller to fill in, the particle is
+*           added to the pool by the next CLG_AddParticles call.
+*   @return (nullptr) if the pool, or spawn buffer, is full.
 **/
 clg_particle_t *CLG_AllocateParticle( void );
 /**
-*	@brief
+*	@brief	Spawns the particles allocated since the last frame, integrates all live ones
+*			into the refresh particle buffer, and removes those that faded out.
 **/
 void CLG_AddParticles( void );
\ No newline at end of file
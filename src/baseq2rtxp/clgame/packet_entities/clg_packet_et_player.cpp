@@ -8,6 +8,7 @@
 #include "clgame/clg_local.h"
 #include "clgame/clg_effects.h"
 #include "clgame/clg_entities.h"
+#include "clgame/clg_packet_entities.h"
 #include "clgame/clg_precache.h"
 
 
@@ -379,41 +380,54 @@ void CLG_ETPlayer_ApplyBoneControllers( centity_t *packetEntity, const entity_st
 }
 
 /**
-*   @brief  Process the entity's active animations.
+*   @brief  Validates the model, and bone pose caches, that the entity's animations are processed with.
+*   @return The model, or (nullptr) if the animations can't be processed.
 **/
-void CLG_ETPlayer_ProcessAnimations( centity_t *packetEntity, entity_t *refreshEntity, entity_state_t *nextState, const bool isLocalClientEntity ) {
+static const model_t *CLG_ETPlayer_GetAnimationModel( centity_t *packetEntity, entity_t *refreshEntity ) {
     // Get model resource.
     const model_t *model = clgi.R_GetModelDataForHandle( refreshEntity->model );
 
     // Ensure it is valid.
     if ( !model ) {
         clgi.Print( PRINT_WARNING, "%s: Invalid model handle(#%i) for entity(#%i)\n", __func__, refreshEntity->model, packetEntity->current.number );
-        return;
+        return nullptr;
     }
     // Ensure it has SKM data.
     const skm_model_t *skmData = model->skmData;
     if ( !skmData ) {
         clgi.Print( PRINT_WARNING, "%s: No SKM data for model handle(#%i) for entity(#%i)\n", __func__, refreshEntity->model, packetEntity->current.number );
-        return;
+        return nullptr;
     }
     // Ensure it has SKM config.
     const skm_config_t *skmConfig = model->skmConfig;
     if ( !skmConfig ) {
         clgi.Print( PRINT_WARNING, "%s: No SKM config for model handle(#%i) for entity(#%i)\n", __func__, refreshEntity->model, packetEntity->current.number );
-        return;
+        return nullptr;
     }
     // Get the animation state mixer.
     sg_skm_animation_mixer_t *animationMixer = &packetEntity->animationMixer;
     if ( !animationMixer ) {
         clgi.Print( PRINT_WARNING, "%s: packetEntity(#%i)->animationMixer == (nullptr)\n", __func__, packetEntity->current.number );
-        return;
+        return nullptr;
     }
 
     // Wait till we got the cache.
     if ( !packetEntity->bonePoseCache[0] || !packetEntity->lastBonePoseCache[0] ) {
-        return;
+        return nullptr;
     }
 
+    return model;
+}
+
+/**
+*   @brief  Process the entity's active animations into its bone pose caches.
+*   @note   Only touches the entity's own state, and is run from the worker threads by
+*           CLG_AddPacketEntities. The model is expected to be validated by CLG_ETPlayer_GetAnimationModel.
+**/
+void CLG_ETPlayer_ProcessAnimations( centity_t *packetEntity, const model_t *model, entity_state_t *nextState, const bool isLocalClientEntity ) {
+    // Get the animation state mixer.
+    sg_skm_animation_mixer_t *animationMixer = &packetEntity->animationMixer;
+
     /**
     *   Time:
     **/
@@ -549,8 +563,7 @@ void CLG_ETPlayer_ProcessAnimations( centity_t *packetEntity, entity_t *refreshE
     /**
     *   Prepare the RefreshEntity by generating the local model space matrices for rendering.
     **/
-    // This will suffice.
-    refreshEntity->bonePoses = finalStatePose;
+    // This will suffice, CLG_ETPlayer_QueueAnimations already pointed the refresh entity at finalStatePose.
     #if 0
     // TODO: THIS NEEDS TO BE UNIQUE FOR EACH ET_PLAYER PACKETENTITY! OTHERWISE IT'LL OVERWRITE SAME MEMORY BEFORE IT IS RENDERED...
     // Local model space final representation matrices.
@@ -567,6 +580,21 @@ void CLG_ETPlayer_ProcessAnimations( centity_t *packetEntity, entity_t *refreshE
 
 
 
+/**
+*   @brief  Queues up the processing of the entity's animations, which CLG_AddPacketEntities
+*           runs for all players at once, and points the refresh entity at the resulting pose.
+**/
+static void CLG_ETPlayer_QueueAnimations( centity_t *packetEntity, entity_t *refreshEntity, entity_state_t *nextState, const bool isLocalClientEntity ) {
+    const model_t *model = CLG_ETPlayer_GetAnimationModel( packetEntity, refreshEntity );
+    if ( !model ) {
+        return;
+    }
+    CLG_PacketEntity_QueuePose( packetEntity, model, nextState, isLocalClientEntity );
+    refreshEntity->bonePoses = packetEntity->bonePoseCache[ SKM_BODY_LOWER ];
+}
+
+
+
 /**
 *
 * 
@@ -797,7 +825,7 @@ void CLG_PacketEntity_AddPlayer( centity_t *packetEntity, entity_t *refreshEntit
 
             }
             // Process the animations.
-            CLG_ETPlayer_ProcessAnimations( packetEntity, refreshEntity, nextState, true );
+            CLG_ETPlayer_QueueAnimations( packetEntity, refreshEntity, nextState, true );
         } else {
             // Determine the base animation to play.
             CLG_ETPlayer_DetermineBaseAnimations( packetEntity, refreshEntity, nextState );
@@ -806,7 +834,7 @@ void CLG_PacketEntity_AddPlayer( centity_t *packetEntity, entity_t *refreshEntit
             // Don't tilt the model - looks weird.
             refreshEntity->angles[ 0 ] = 0.f;
             // Process the animations.
-            CLG_ETPlayer_ProcessAnimations( packetEntity, refreshEntity, nextState, false );
+            CLG_ETPlayer_QueueAnimations( packetEntity, refreshEntity, nextState, false );
         }
 
         // Add model.
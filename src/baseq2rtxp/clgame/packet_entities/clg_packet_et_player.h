@@ -14,4 +14,9 @@
 /**
 *   @brief  Calculate desired yaw derived player state move direction, and recored time of change.
 **/
-const bool CLG_ETPlayer_CalculateDesiredYaw( centity_t *packetEntity, const player_state_t *playerState, const player_state_t *oldPlayerState, const QMTime &currentTime );
\ No newline at end of file
+const bool CLG_ETPlayer_CalculateDesiredYaw( centity_t *packetEntity, const player_state_t *playerState, const player_state_t *oldPlayerState, const QMTime &currentTime );
+/**
+*   @brief  Process the entity's active animations into its bone pose caches.
+*   @note   Thread-safe, it is run from the worker threads by CLG_AddPacketEntities.
+**/
+void CLG_ETPlayer_ProcessAnimations( centity_t *packetEntity, const model_t *model, entity_state_t *nextState, const bool isLocalClientEntity );
\ No newline at end of file
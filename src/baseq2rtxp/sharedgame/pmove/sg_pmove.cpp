@@ -68,6 +68,157 @@ static void PM_CrashLand( void );
 
 
 
+/**
+*
+*
+*
+*	PM Query Cache:
+*
+*
+*
+**/
+//! Number of trace results remembered during a single move.
+static constexpr int32_t PM_QUERY_CACHE_TRACES = 16;
+//! Number of point contents results remembered during a single move.
+static constexpr int32_t PM_QUERY_CACHE_POINTS = 8;
+
+/**
+*	@brief	A remembered trace, keyed by its exact arguments.
+**/
+struct pm_cached_trace_t {
+	Vector3 start, mins, maxs, end;
+	cm_contents_t contentMask;
+	//! True if the result came from pm->clip, (world only), rather than pm->trace.
+	bool worldOnly;
+	cm_trace_t result;
+};
+/**
+*	@brief	A remembered point contents result.
+**/
+struct pm_cached_contents_t {
+	Vector3 point;
+	cm_contents_t contents;
+};
+
+/**
+*	The world does not change while a single SG_PlayerMove runs, so a query with
+*	bit-identical arguments yields a bit-identical result. The ground, duck and
+*	liquid checks at the start and end of a move, (and every other one of them
+*	when the origin didn't change), are served from here instead of the BSP.
+**/
+static struct {
+	pm_cached_trace_t traces[ PM_QUERY_CACHE_TRACES ];
+	int32_t numTraces;
+	int32_t nextTrace;
+
+	pm_cached_contents_t points[ PM_QUERY_CACHE_POINTS ];
+	int32_t numPoints;
+	int32_t nextPoint;
+} pm_query_cache;
+
+//! Can be toggled by benchmarking code to compare against the uncached path.
+bool pm_query_cache_enabled = true;
+//! Query counters, accumulated until reset by whoever reads them.
+pm_query_stats_t pm_query_stats = {};
+
+/**
+*	@brief	Forgets all remembered queries, called at the start of each move.
+**/
+static inline void PM_QueryCache_Clear() {
+	pm_query_cache.numTraces = pm_query_cache.nextTrace = 0;
+	pm_query_cache.numPoints = pm_query_cache.nextPoint = 0;
+}
+
+/**
+*	@brief	Compares bit patterns rather than values, -0 and 0 are not the same query.
+**/
+static inline const bool PM_QueryCache_SameVector( const Vector3 &a, const Vector3 &b ) {
+	return std::memcmp( &a, &b, sizeof( Vector3 ) ) == 0;
+}
+
+/**
+*	@brief	Returns the remembered trace for these arguments, or nullptr.
+**/
+static const cm_trace_t *PM_QueryCache_FindTrace( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, const cm_contents_t contentMask, const bool worldOnly ) {
+	for ( int32_t i = 0; i < pm_query_cache.numTraces; i++ ) {
+		const pm_cached_trace_t &cached = pm_query_cache.traces[ i ];
+		if ( cached.contentMask == contentMask && cached.worldOnly == worldOnly
+			&& PM_QueryCache_SameVector( cached.start, start ) && PM_QueryCache_SameVector( cached.end, end )
+			&& PM_QueryCache_SameVector( cached.mins, mins ) && PM_QueryCache_SameVector( cached.maxs, maxs ) ) {
+			return &cached.result;
+		}
+	}
+	return nullptr;
+}
+
+/**
+*	@brief	Remembers a trace result, replacing the oldest one once full.
+**/
+static void PM_QueryCache_StoreTrace( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, const cm_contents_t contentMask, const bool worldOnly, const cm_trace_t &result ) {
+	pm_cached_trace_t &cached = pm_query_cache.traces[ pm_query_cache.nextTrace ];
+	cached.start = start;
+	cached.mins = mins;
+	cached.maxs = maxs;
+	cached.end = end;
+	cached.contentMask = contentMask;
+	cached.worldOnly = worldOnly;
+	cached.result = result;
+
+	pm_query_cache.nextTrace = ( pm_query_cache.nextTrace + 1 ) % PM_QUERY_CACHE_TRACES;
+	pm_query_cache.numTraces = std::min( pm_query_cache.numTraces + 1, PM_QUERY_CACHE_TRACES );
+}
+
+/**
+*	@brief	Performs, or reuses, a trace against the world(worldOnly), or all entities.
+**/
+static const cm_trace_t PM_QueryCache_Trace( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, const cm_contents_t contentMask, const bool worldOnly ) {
+	pm_query_stats.traces++;
+
+	if ( pm_query_cache_enabled ) {
+		const cm_trace_t *cached = PM_QueryCache_FindTrace( start, mins, maxs, end, contentMask, worldOnly );
+		if ( cached ) {
+			pm_query_stats.traceHits++;
+			return *cached;
+		}
+	}
+
+	const cm_trace_t result = ( worldOnly
+		? pm->clip( start, &mins, &maxs, end, contentMask )
+		: pm->trace( start, &mins, &maxs, end, pm->playerEdict, contentMask ) );
+
+	if ( pm_query_cache_enabled ) {
+		PM_QueryCache_StoreTrace( start, mins, maxs, end, contentMask, worldOnly, result );
+	}
+	return result;
+}
+
+/**
+*	@brief	Performs, or reuses, a point contents query.
+**/
+static const cm_contents_t PM_QueryCache_PointContents( const Vector3 &point ) {
+	pm_query_stats.pointContents++;
+
+	if ( pm_query_cache_enabled ) {
+		for ( int32_t i = 0; i < pm_query_cache.numPoints; i++ ) {
+			if ( PM_QueryCache_SameVector( pm_query_cache.points[ i ].point, point ) ) {
+				pm_query_stats.pointContentsHits++;
+				return pm_query_cache.points[ i ].contents;
+			}
+		}
+	}
+
+	const cm_contents_t contents = pm->pointcontents( point );
+
+	if ( pm_query_cache_enabled ) {
+		pm_query_cache.points[ pm_query_cache.nextPoint ] = { .point = point, .contents = contents };
+		pm_query_cache.nextPoint = ( pm_query_cache.nextPoint + 1 ) % PM_QUERY_CACHE_POINTS;
+		pm_query_cache.numPoints = std::min( pm_query_cache.numPoints + 1, PM_QUERY_CACHE_POINTS );
+	}
+	return contents;
+}
+
+
+
 /**
 *
 *
@@ -81,7 +232,7 @@ static void PM_CrashLand( void );
 *	@brief	Clips trace against world only.
 **/
 const cm_trace_t PM_Clip( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, const cm_contents_t contentMask ) {
-	return pm->clip( start, &mins, &maxs, end, contentMask );
+	return PM_QueryCache_Trace( start, mins, maxs, end, contentMask, true );
 }
 /**
 *	@brief	Determines the mask to use and returns a trace doing so. If spectating, it'll return clip instead.
@@ -105,14 +256,14 @@ const cm_trace_t PM_Trace( const Vector3 &start, const Vector3 &mins, const Vect
 		//	mask &= ~CONTENTS_PLAYER;
 	}
 
-	return pm->trace( start, &mins, &maxs, end, pm->playerEdict, contentMask );
+	return PM_QueryCache_Trace( start, mins, maxs, end, contentMask, false );
 }
 
 /**
 *	@brief	Returns the contents at a given point.
 **/
 const cm_contents_t PM_PointContents( const Vector3 &point ) {
-	return pm->pointcontents( point );
+	return PM_QueryCache_PointContents( point );
 }
 
 
@@ -489,13 +640,13 @@ static inline const bool PM_AboveLiquid() {
 	// Testing point.
 	const Vector3 below = pm->state->pmove.origin + Vector3{ 0, 0, -8 };
 	// We got solid below, not water:
-	bool solid_below = pm->trace( pm->state->pmove.origin, &pm->mins, &pm->maxs, below, pm->playerEdict, CM_CONTENTMASK_SOLID ).fraction < 1.0f;
+	bool solid_below = PM_QueryCache_Trace( pm->state->pmove.origin, pm->mins, pm->maxs, below, CM_CONTENTMASK_SOLID, false ).fraction < 1.0f;
 	if ( solid_below ) {
 		return false;
 	}
 
 	// We're above water:
-	bool water_below = pm->trace( pm->state->pmove.origin, &pm->mins, &pm->maxs, below, pm->playerEdict, CM_CONTENTMASK_LIQUID ).fraction < 1.0f;
+	bool water_below = PM_QueryCache_Trace( pm->state->pmove.origin, pm->mins, pm->maxs, below, CM_CONTENTMASK_LIQUID, false ).fraction < 1.0f;
 	if ( water_below ) {
 		return true;
 	}
@@ -2436,6 +2587,8 @@ void SG_PlayerMove_Frame() {
 void SG_PlayerMove( pmove_s *pmove, pmoveParams_s *params ) {
 	// Clear the player move locals.
 	pml = {};
+	// Nothing remembered from another player's, or an earlier, move is valid anymore.
+	PM_QueryCache_Clear();
 
 	// Store pointers.
 	pm = pmove;
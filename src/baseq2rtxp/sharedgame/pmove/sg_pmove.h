@@ -217,6 +217,21 @@ const cm_trace_t PM_Clip( const Vector3 &start, const Vector3 &mins, const Vecto
 const cm_trace_t PM_Trace( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, const cm_contents_t contentMask = CONTENTS_NONE );
 const cm_trace_t PM_TraceCorrectSolid( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, cm_contents_t contentMask = CONTENTS_NONE );
 
+/**
+*	@brief	Counters of the world queries issued by player movement, and how many of them
+*			were served from the per-move query cache instead of the collision model.
+**/
+typedef struct pm_query_stats_s {
+    uint64_t traces;
+    uint64_t traceHits;
+    uint64_t pointContents;
+    uint64_t pointContentsHits;
+} pm_query_stats_t;
+//! Accumulated query counters, reset by whoever reads them.
+extern pm_query_stats_t pm_query_stats;
+//! When false, every query goes to the collision model. (For benchmarking the cache itself.)
+extern bool pm_query_cache_enabled;
+
 /**
 *   @brief  Used for registering entity touching resulting traces.
 **/
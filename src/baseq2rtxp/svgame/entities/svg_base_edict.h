@@ -307,45 +307,33 @@ struct svg_base_edict_t : public sv_shared_edict_t<svg_base_edict_t, svg_client_
         return;
     }
     #endif
-    //! New Operator Overload.
+    //! New Operator Overload, places the edict in the slab of the given TypeInfo.
+    void *operator new( size_t size, EdictTypeInfo *typeInfo ) {
+        #if DEBUG_EDICT_ALLOCATORS
+        // Debug about the allocation.
+        gi.dprintf( "%s: Allocating %d bytes for '%s'.\n", __func__, size, typeInfo->classTypeName );
+        #endif
+        return typeInfo->slab.Allocate( size );
+    }
+    //! Matching Delete Operator Overload, only used when a constructor throws.
+    void operator delete( void *ptr, EdictTypeInfo *typeInfo ) {
+        svg_edict_slab_t::Free( ptr );
+    }
+    //! New Operator Overload, for edicts that are not allocated through their TypeInfo.
     void *operator new( size_t size ) {
-        // Prevent possible malloc from succeeding if size is 0.
-        if ( size == 0 ) {
-            size = 0;
-        }
-        // Allocate.
-        if ( void *ptr = gi.TagMalloc( size, TAG_SVGAME_EDICTS ) ) {//TagAllocator::Malloc( size, TagAllocator::_zoneTag );
-            // Debug about the allocation.
-            #if DEBUG_EDICT_ALLOCATORS
-            gi.dprintf( "%s: Allocating %d bytes.\n", __func__, size );
-            #endif
-            // Return the pointer.
-            return ptr;
-        }
         #if DEBUG_EDICT_ALLOCATORS
-        // Debug about the failure to allocate
-        gi.dprintf( "%s: Failed allocationg %d bytes\n", __func__, size );
+        // Debug about the allocation.
+        gi.dprintf( "%s: Allocating %d bytes.\n", __func__, size );
         #endif
-        // Throw an exception.
-        //throw std::bad_alloc( "Failed to allocate memory" );
-        return nullptr;
+        return svg_edict_slab_t::AllocateUnpooled( size );
     }
-    //! Delete Operator Overload.
+    //! Delete Operator Overload, hands the slot back to whichever slab it came from.
     void operator delete( void *ptr ) {
-        if ( ptr != nullptr ) {//TagAllocator::Free( ptr );
-            #if DEBUG_EDICT_ALLOCATORS
-            // Debug about deallocation.
-            gi.dprintf( "%s: Freeing %p\n", __func__, ptr );
-            #endif
-            // Deallocate.
-            gi.TagFree( ptr );
-            return;
-        }
-        ptr = nullptr;
         #if DEBUG_EDICT_ALLOCATORS
-        // Debug about the failure to allocate
-        gi.dprintf( "%s: (nullptr) %p\n", __func__, ptr );
+        // Debug about deallocation.
+        gi.dprintf( "%s: Freeing %p\n", __func__, ptr );
         #endif
+        svg_edict_slab_t::Free( ptr );
     }
 
 
@@ -49,6 +49,62 @@ using EdictAllocatorFncPtr = svg_base_edict_t* ( const cm_entity_t *entityDictio
 
 
 
+/**
+*
+*	EdictTypeInfo Slab:
+*
+*	Each EdictTypeInfo owns a slab of fixed size slots that its class instances are
+*	placed in. Slots are carved out of chunks that never move, so edict addresses
+*	stay stable for the lifetime of the level, and same class edicts sit next to
+*	each other in memory. Chunks are TAG_SVGAME_EDICTS memory and are released
+*	together with the edict pool.
+*
+**/
+struct svg_edict_slab_t {
+	//! Number of slots carved out of each chunk.
+	static constexpr int32_t SLOTS_PER_CHUNK = 32;
+
+	/**
+	*	@brief	Placed in front of every slab allocated edict, it is what lets operator
+	*			delete find its way back to the slab the object came from.
+	**/
+	struct alignas( 16 ) slot_header_t {
+		//! The slab owning this slot, (nullptr) for objects that were allocated outside of any slab.
+		svg_edict_slab_t *slab;
+		//! Next free slot, only valid while the slot sits in the free list.
+		slot_header_t *nextFree;
+	};
+
+	/**
+	*	@brief	Returns memory for an object of 'size' bytes, taken from the free list
+	*			or from a freshly allocated chunk.
+	**/
+	void *Allocate( const size_t size );
+	/**
+	*	@brief	Returns memory for an object of 'size' bytes that does not belong to any slab.
+	**/
+	static void *AllocateUnpooled( const size_t size );
+	/**
+	*	@brief	Gives the slot of an object allocated by Allocate or AllocateUnpooled back.
+	**/
+	static void Free( void *ptr );
+	/**
+	*	@brief	Forgets about all chunks, called after their TAG_SVGAME_EDICTS memory was freed.
+	**/
+	void Reset();
+
+	//! Size of the objects this slab hands out, set by the first allocation.
+	size_t objectSize = 0;
+	//! First free slot.
+	slot_header_t *freeList = nullptr;
+	//! Number of chunks allocated so far.
+	int32_t numChunks = 0;
+	//! Number of slots currently handed out.
+	int32_t numAllocated = 0;
+};
+
+
+
 /**
 * 
 *	EdictTypeInfo:
@@ -107,6 +163,9 @@ public:
 		head = this;
 		// Generate a hash of the worldSpawn classname.
 		worldSpawnClassNameHash = Q_HashCaseInsensitiveString( worldSpawnClassName );
+		// And of the C++ class type names.
+		hashedClassTypeName = Q_HashCaseInsensitiveString( classTypeName );
+		hashedSuperClassTypeName = Q_HashCaseInsensitiveString( superClassTypeName );
 
 		// This also gets properly set by TypeInfo initialization.
 		super = GetByClassTypeName( superClassTypeName );
@@ -115,6 +174,8 @@ public:
 	// This will be used to allocate instances of each entity class
 	// In theory, multiple map classnames can allocate one C++ class
 	EdictAllocatorFncPtr *allocateEdictInstanceCallback;
+	//! Storage for the instances of this class.
+	svg_edict_slab_t slab;
 
 	/**
 	*	@brief	Checks if the given type information corresponds to a class type.
@@ -224,7 +285,11 @@ public:
 		if ( nullptr == name ) {
 			return nullptr;
 		}
-		// Iterate over the linked list of EdictTypeInfo objects and set up their superclasses.
+		// Binary search the registry once it has been initialized.
+		if ( !registryByWorldSpawnClassName.empty() ) {
+			return FindInRegistry( registryByWorldSpawnClassName, &EdictTypeInfo::worldSpawnClassNameHash, &EdictTypeInfo::worldSpawnClassName, name );
+		}
+		// Iterate over the linked list of EdictTypeInfo objects.
 		EdictTypeInfo *current = head;
 		// Keep on going until we run into nullptr.
 		while ( current ) {
@@ -249,7 +314,12 @@ public:
 		if ( hashedName == 0 ) {
 			return nullptr;
 		}
-		// Iterate over the linked list of EdictTypeInfo objects and set up their superclasses.
+		// Binary search the registry once it has been initialized.
+		if ( !registryByWorldSpawnClassName.empty() ) {
+			auto it = LowerBoundInRegistry( registryByWorldSpawnClassName, &EdictTypeInfo::worldSpawnClassNameHash, hashedName );
+			return ( it != registryByWorldSpawnClassName.end() && ( *it )->worldSpawnClassNameHash == hashedName ? *it : nullptr );
+		}
+		// Iterate over the linked list of EdictTypeInfo objects.
 		EdictTypeInfo *current = head;
 		// Keep on going until we run into nullptr.
 		while ( current ) {
@@ -274,7 +344,11 @@ public:
 		if ( name == nullptr ) {
 			return nullptr;
 		}
-		// Iterate over the linked list of EdictTypeInfo objects and set up their superclasses.
+		// Binary search the registry once it has been initialized.
+		if ( !registryByClassTypeName.empty() ) {
+			return FindInRegistry( registryByClassTypeName, &EdictTypeInfo::hashedClassTypeName, &EdictTypeInfo::classTypeName, name );
+		}
+		// Iterate over the linked list of EdictTypeInfo objects.
 		EdictTypeInfo *current = head;
 		// Keep on going until we run into nullptr.
 		while ( current ) {
@@ -290,32 +364,52 @@ public:
 	}
 
 	/**
-	*	@brief	This is called during game initialisation in order to setup 
-	*			the superclasses for all EdictTypeInfo objects in the linked list.
+	*	@brief	This is called during game initialisation in order to build the sorted
+	*			lookup registries, and to setup the superclasses for all EdictTypeInfo 
+	*			objects in the linked list.
 	**/
 	static void InitializeTypeInfoRegistry() {
-		// Iterate over the linked list of EdictTypeInfo objects and set up their superclasses.
-		EdictTypeInfo *current = head;
-		// Keep on going until we run into nullptr.
-		while ( current != nullptr ) {
-			EdictTypeInfo *super = current;
-			while ( ( super = super->prev ) != nullptr ) {
-				if ( !strcmp( current->classTypeName, current->prev->superClassTypeName ) ) {
-					// Set the super pointer to the superclass type name.
-					current->super = GetByClassTypeName( current->superClassTypeName );
-					break;
-				}
-				
-			}
+		registryByWorldSpawnClassName.clear();
+		registryByClassTypeName.clear();
+		// Gather all EdictTypeInfo objects, in linked list order so that the stable sort
+		// below keeps the most recently registered one first, just like the list walk did.
+		for ( EdictTypeInfo *current = head; current != nullptr; current = current->prev ) {
+			registryByWorldSpawnClassName.push_back( current );
+			registryByClassTypeName.push_back( current );
+		}
+		// Sort them by their hashes.
+		std::stable_sort( registryByWorldSpawnClassName.begin(), registryByWorldSpawnClassName.end(), []( const EdictTypeInfo *a, const EdictTypeInfo *b ) {
+			return a->worldSpawnClassNameHash < b->worldSpawnClassNameHash;
+		} );
+		std::stable_sort( registryByClassTypeName.begin(), registryByClassTypeName.end(), []( const EdictTypeInfo *a, const EdictTypeInfo *b ) {
+			return a->hashedClassTypeName < b->hashedClassTypeName;
+		} );
+
+		// Now that lookups are cheap, set up the superclasses.
+		for ( EdictTypeInfo *current = head; current != nullptr; current = current->prev ) {
+			// Set the super pointer to the superclass type name, nullptr if it is not found.
+			current->super = GetByClassTypeName( current->superClassTypeName );
 			// Debug output.
 			gi.dprintf( "ID: %d ClassName: %s, SuperClass: %s, TypeFlags: %i\n", current->classTypeInfoID.GetID(), current->classTypeName, current->superClassTypeName, current->typeFlags );
-			// If the superclass type name is not found, set the super pointer to nullptr.
-			current = current->prev;
+		}
+	}
+
+	/**
+	*	@brief	Resets the slabs of all EdictTypeInfo objects, called by the edict pool
+	*			once it has released the memory of their chunks.
+	**/
+	static void ResetSlabs() {
+		for ( EdictTypeInfo *current = head; current != nullptr; current = current->prev ) {
+			current->slab.Reset();
 		}
 	}
 
 	//! The initial nullptr head EdictTypeInfo list entry.
 	inline static EdictTypeInfo *head = nullptr;
+	//! All EdictTypeInfo objects sorted by worldSpawnClassNameHash, built by InitializeTypeInfoRegistry.
+	inline static std::vector<EdictTypeInfo *> registryByWorldSpawnClassName;
+	//! All EdictTypeInfo objects sorted by hashedClassTypeName, built by InitializeTypeInfoRegistry.
+	inline static std::vector<EdictTypeInfo *> registryByClassTypeName;
 
 	// <Q2RTXP>: WID: TODO: maybe generate a CRC32 for each classname instead?
 	StaticEdictTypeInfoCounter classTypeInfoID;
@@ -341,6 +435,29 @@ public:
 	const char *superClassTypeName = nullptr;
 	//! A hashed version of superClassTypeName
 	uint32_t hashedSuperClassTypeName = 0;
+
+private:
+	/**
+	*	@return	The first entry of the registry whose hash is not less than 'hash'.
+	**/
+	static std::vector<EdictTypeInfo *>::const_iterator LowerBoundInRegistry( const std::vector<EdictTypeInfo *> &registry, uint32_t EdictTypeInfo:: *hashMember, const uint32_t hash ) {
+		return std::lower_bound( registry.begin(), registry.end(), hash, [hashMember]( const EdictTypeInfo *typeInfo, const uint32_t value ) {
+			return typeInfo->*hashMember < value;
+		} );
+	}
+	/**
+	*	@brief	Binary searches the registry for the run of entries with a matching hash,
+	*			and returns the first of them whose name actually matches.
+	**/
+	static EdictTypeInfo *FindInRegistry( const std::vector<EdictTypeInfo *> &registry, uint32_t EdictTypeInfo:: *hashMember, const char *EdictTypeInfo:: *nameMember, const char *name ) {
+		const uint32_t hash = Q_HashCaseInsensitiveString( name );
+		for ( auto it = LowerBoundInRegistry( registry, hashMember, hash ); it != registry.end() && ( *it )->*hashMember == hash; ++it ) {
+			if ( !strcmp( ( *it )->*nameMember, name ) ) {
+				return *it;
+			}
+		}
+		return nullptr;
+	}
 };
 
 
@@ -367,7 +484,7 @@ public:
 	using SelfType = className;		\
 	using Super = superClass;	\
 	static className* AllocateInstance( const cm_entity_t* cm_entity ) {	\
-		className *baseEdict = new className( cm_entity );	\
+		className *baseEdict = new ( &className::ClassInfo ) className( cm_entity );	\
 		baseEdict->classname = svg_level_qstring_t::from_char_str( worldSpawnClassName );	\
 		/*baseEdict->hashedClassname = baseEdict->GetTypeInfo()->hashedMapClass;*/ \
 		return baseEdict;	\
@@ -411,7 +528,7 @@ public:
 	using SelfType = className;		\
 	using Super = superClass;	\
 	static svg_base_edict_t* AllocateInstance( const cm_entity_t* cm_entity ) {	\
-		className *baseEdict = new className( cm_entity );	\
+		className *baseEdict = new ( &className::ClassInfo ) className( cm_entity );	\
 		baseEdict->classname = svg_level_qstring_t::from_char_str( worldSpawnClassName );	\
 		baseEdict->SetSpawnCallback( reinterpret_cast<svg_edict_callback_spawn_fptr>( spawnFunc ) );	\
 		return baseEdict;	\
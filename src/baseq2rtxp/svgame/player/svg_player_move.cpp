@@ -24,6 +24,7 @@
 #include "svgame/player/svg_player_client.h"
 #include "svgame/player/svg_player_events.h"
 #include "svgame/player/svg_player_move.h"
+#include "svgame/player/svg_player_move_bench.h"
 #include "svgame/player/svg_player_usetargets.h"
 
 #include "svgame/svg_gamemode.h"
@@ -58,6 +59,14 @@ static const cm_trace_t q_gameabi SV_PM_Clip( const Vector3 &start, const Vector
 static const cm_contents_t q_gameabi SV_PM_PointContents( const Vector3 &point ) {
     return gi.pointcontents( &point );
 }
+/**
+*   @brief  Assigns the server's trace, clip and pointcontents implementations to a player move.
+**/
+void SVG_Client_SetPMoveCallbacks( pmove_t *pm ) {
+    pm->trace = SV_PM_Trace;
+    pm->pointcontents = SV_PM_PointContents;
+    pm->clip = SV_PM_Clip;
+}
 
 
 
@@ -260,14 +269,20 @@ static void PMove_RunFrame( svg_player_edict_t *ent, svg_client_t *client, userc
     // Assign a pointer to the game module's matching player client entity.
     pm->playerEdict = reinterpret_cast<edict_ptr_t *>( ent );
     // Prepare PMove specific trace wrapper function pointers.
-    pm->trace = SV_PM_Trace;
-    pm->pointcontents = SV_PM_PointContents;
-    pm->clip = SV_PM_Clip;
+    SVG_Client_SetPMoveCallbacks( pm );
     // Let us not forget about the simulation time before the actual mode.
     pm->simulationTime = level.time;
 
+    // Capture the move's input for "sv pmovebench".
+    if ( svg_pmovebench_recording ) {
+        SVG_PMoveBench_BeginMove( ent, pm, pmp );
+    }
     // Move!
     SG_PlayerMove( (pmove_s *)pm, (pmoveParams_s *)pmp );
+    // And its output.
+    if ( svg_pmovebench_recording ) {
+        SVG_PMoveBench_EndMove( pm );
+    }
     // Backup the pmove result as the 'old' previous client player move.
     client->old_pmove = pm->state->pmove;
     // Backup the command angles given from last command.
@@ -329,6 +344,8 @@ static void PMove_PostFrame( svg_player_edict_t *ent, svg_client_t *client, pmov
                 ent->groundInfo.entityNumber = ENTITYNUM_NONE;
             }
         }
+        // Keep the pusher riders index in sync.
+        SVG_PushMove_UpdateRider( ent );
     #else
         // Store all player move liquid info into the entity 'monster move' (fake name here) properties.
         ent->liquidInfo.level = pm.liquid.level;
@@ -14,4 +14,8 @@
 *   @brief  This will be called once for each client frame, which will usually
 *           be a couple times for each server frame.
 **/
-void SVG_Client_Think( svg_base_edict_t *ent, usercmd_t *ucmd );
\ No newline at end of file
+void SVG_Client_Think( svg_base_edict_t *ent, usercmd_t *ucmd );
+/**
+*   @brief  Assigns the server's trace, clip and pointcontents implementations to a player move.
+**/
+void SVG_Client_SetPMoveCallbacks( struct pmove_s *pm );
\ No newline at end of file
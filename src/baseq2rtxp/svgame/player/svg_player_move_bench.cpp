@@ -0,0 +1,422 @@
+/********************************************************************
+*
+*
+*	ServerGame: Player Move Recording & Replay Benchmark.
+*
+*
+********************************************************************/
+#include "svgame/svg_local.h"
+
+#include "sharedgame/sg_shared.h"
+#include "sharedgame/pmove/sg_pmove.h"
+
+#include "svgame/player/svg_player_move.h"
+#include "svgame/player/svg_player_move_bench.h"
+
+#include <vector>
+
+
+
+//! "PMBN", identifies a player move recording.
+static constexpr uint32_t PMOVEBENCH_IDENT = ( 'N' << 24 ) + ( 'B' << 16 ) + ( 'M' << 8 ) + 'P';
+//! Bumped whenever the file layout changes.
+static constexpr uint32_t PMOVEBENCH_VERSION = 1;
+
+/**
+*	@brief	A single recorded move. Stored as is, so recordings only replay on builds
+*			with the same pmove_t/player_state_t layout, which the header's sampleSize checks.
+**/
+struct svg_pmovebench_sample_t {
+	//! Number of the player entity, passed as the trace skip entity on replay.
+	int32_t entityNumber = 0;
+	//! Movement parameters of the move.
+	pmoveParams_t params = {};
+
+	//! The move and player state as handed to SG_PlayerMove. (Pointers cleared.)
+	pmove_t in = {};
+	player_state_t inState = {};
+
+	//! The move and player state as SG_PlayerMove left them. (Pointers cleared.)
+	pmove_t out = {};
+	player_state_t outState = {};
+};
+
+/**
+*	@brief	Recording file header.
+**/
+struct svg_pmovebench_header_t {
+	uint32_t ident;
+	uint32_t version;
+	//! sizeof( svg_pmovebench_sample_t ) of the build that recorded it.
+	uint32_t sampleSize;
+	uint32_t numSamples;
+	//! Map the moves were recorded on.
+	char mapName[ MAX_QPATH ];
+};
+
+//! Clock used for timing the replay.
+using pmovebench_clock_t = std::chrono::steady_clock;
+
+/**
+*	Recorder State:
+**/
+//! True while recording.
+bool svg_pmovebench_recording = false;
+
+static struct {
+	//! Moves recorded since "sv pmovebench record".
+	std::vector<svg_pmovebench_sample_t> samples;
+	//! Index of the sample BeginMove started, -1 if none.
+	int64_t pending = -1;
+} pmovebench;
+
+
+
+/**
+*
+*
+*	Recording:
+*
+*
+**/
+/**
+*	@brief	Clears the pointers of a recorded move, they mean nothing outside of the move that was ran.
+**/
+static void PMoveBench_ClearPointers( pmove_t &pm ) {
+	pm.trace = nullptr;
+	pm.clip = nullptr;
+	pm.pointcontents = nullptr;
+	pm.state = nullptr;
+	pm.playerEdict = nullptr;
+}
+
+/**
+*	@brief	Discards any recording in progress.
+**/
+void SVG_PMoveBench_Shutdown( void ) {
+	svg_pmovebench_recording = false;
+	pmovebench.samples.clear();
+	pmovebench.samples.shrink_to_fit();
+	pmovebench.pending = -1;
+}
+
+/**
+*	@brief	Captures the input of the move that is about to be performed.
+**/
+void SVG_PMoveBench_BeginMove( const svg_base_edict_t *ent, const pmove_s *pm, const pmoveParams_s *pmp ) {
+	svg_pmovebench_sample_t &sample = pmovebench.samples.emplace_back();
+	sample.entityNumber = ent->s.number;
+	sample.params = *pmp;
+	sample.in = *pm;
+	sample.inState = *pm->state;
+	PMoveBench_ClearPointers( sample.in );
+
+	pmovebench.pending = (int64_t)pmovebench.samples.size() - 1;
+}
+
+/**
+*	@brief	Captures the output of the move started by the matching BeginMove call.
+**/
+void SVG_PMoveBench_EndMove( const pmove_s *pm ) {
+	// Recording may have been stopped while the move ran.
+	if ( pmovebench.pending < 0 || pmovebench.pending >= (int64_t)pmovebench.samples.size() ) {
+		return;
+	}
+
+	svg_pmovebench_sample_t &sample = pmovebench.samples[ pmovebench.pending ];
+	sample.out = *pm;
+	sample.outState = *pm->state;
+	PMoveBench_ClearPointers( sample.out );
+
+	pmovebench.pending = -1;
+}
+
+
+
+/**
+*
+*
+*	Recording Files:
+*
+*
+**/
+/**
+*	@brief	Builds the path of a recording in the game directory.
+**/
+static const bool PMoveBench_FilePath( char *path, const size_t size, const char *filename ) {
+	cvar_t *cvar_game = gi.cvar( "game", "", 0 );
+
+	size_t len = Q_snprintf( path, size, "%s/%s", ( *cvar_game->string ? cvar_game->string : GAMEVERSION ), filename );
+	if ( len >= size ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "File name too long\n" );
+		return false;
+	}
+	return true;
+}
+
+/**
+*	@brief	Stops recording and writes the recorded moves to a file in the game directory.
+**/
+static void PMoveBench_Stop( const char *filename ) {
+	if ( !svg_pmovebench_recording ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "Not recording.\n" );
+		return;
+	}
+	svg_pmovebench_recording = false;
+	pmovebench.pending = -1;
+
+	char path[ MAX_OSPATH ];
+	if ( !PMoveBench_FilePath( path, sizeof( path ), filename ) ) {
+		return;
+	}
+
+	FILE *f = fopen( path, "wb" );
+	if ( !f ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "Couldn't open %s\n", path );
+		return;
+	}
+
+	svg_pmovebench_header_t header = {
+		.ident = PMOVEBENCH_IDENT,
+		.version = PMOVEBENCH_VERSION,
+		.sampleSize = sizeof( svg_pmovebench_sample_t ),
+		.numSamples = (uint32_t)pmovebench.samples.size(),
+	};
+	Q_strlcpy( header.mapName, level.mapname, sizeof( header.mapName ) );
+
+	bool written = fwrite( &header, sizeof( header ), 1, f ) == 1;
+	if ( written && header.numSamples ) {
+		written = fwrite( pmovebench.samples.data(), sizeof( svg_pmovebench_sample_t ), header.numSamples, f ) == header.numSamples;
+	}
+	fclose( f );
+
+	if ( !written ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "Couldn't write %s\n", path );
+	} else {
+		gi.cprintf( nullptr, PRINT_HIGH, "Wrote %u player moves on %s to %s.\n", header.numSamples, header.mapName, path );
+	}
+
+	pmovebench.samples.clear();
+	pmovebench.samples.shrink_to_fit();
+}
+
+/**
+*	@brief	Reads a recording from the game directory.
+**/
+static const bool PMoveBench_Load( const char *filename, svg_pmovebench_header_t &header, std::vector<svg_pmovebench_sample_t> &samples ) {
+	char path[ MAX_OSPATH ];
+	if ( !PMoveBench_FilePath( path, sizeof( path ), filename ) ) {
+		return false;
+	}
+
+	FILE *f = fopen( path, "rb" );
+	if ( !f ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "Couldn't open %s\n", path );
+		return false;
+	}
+
+	bool valid = fread( &header, sizeof( header ), 1, f ) == 1;
+	if ( !valid || header.ident != PMOVEBENCH_IDENT || header.version != PMOVEBENCH_VERSION ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "%s is not a player move recording\n", path );
+		fclose( f );
+		return false;
+	}
+	if ( header.sampleSize != sizeof( svg_pmovebench_sample_t ) ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "%s was recorded by an incompatible build\n", path );
+		fclose( f );
+		return false;
+	}
+	header.mapName[ MAX_QPATH - 1 ] = '\0';
+
+	samples.resize( header.numSamples );
+	if ( header.numSamples ) {
+		valid = fread( samples.data(), sizeof( svg_pmovebench_sample_t ), header.numSamples, f ) == header.numSamples;
+	}
+	fclose( f );
+
+	if ( !valid ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "%s is truncated\n", path );
+		return false;
+	}
+	return true;
+}
+
+
+
+/**
+*
+*
+*	Replay:
+*
+*
+**/
+/**
+*	@brief	Bitwise comparison, a replayed move has to match, not merely come close.
+**/
+template<typename T>
+static inline const bool PMoveBench_Same( const T &a, const T &b ) {
+	return std::memcmp( &a, &b, sizeof( T ) ) == 0;
+}
+
+/**
+*	@brief	Returns true if the replayed move produced exactly what was recorded. Pointers are
+*			left out, (surfaces, materials), they differ between server sessions.
+**/
+static const bool PMoveBench_Matches( const svg_pmovebench_sample_t &sample, const pmove_t &pm, const player_state_t &state ) {
+	const pmove_t &out = sample.out;
+
+	if ( !PMoveBench_Same( state, sample.outState ) ) {
+		return false;
+	}
+	if ( !PMoveBench_Same( pm.mins, out.mins ) || !PMoveBench_Same( pm.maxs, out.maxs ) ) {
+		return false;
+	}
+	if ( pm.ground.entityNumber != out.ground.entityNumber || pm.ground.contents != out.ground.contents
+		|| !PMoveBench_Same( pm.ground.plane, out.ground.plane ) ) {
+		return false;
+	}
+	if ( !PMoveBench_Same( pm.liquid, out.liquid ) ) {
+		return false;
+	}
+	if ( pm.step_clip != out.step_clip || pm.jump_sound != out.jump_sound
+		|| !PMoveBench_Same( pm.step_height, out.step_height ) || !PMoveBench_Same( pm.impact_delta, out.impact_delta ) ) {
+		return false;
+	}
+
+	if ( pm.touchTraces.count != out.touchTraces.count ) {
+		return false;
+	}
+	for ( uint32_t i = 0; i < pm.touchTraces.count; i++ ) {
+		const cm_trace_t &a = pm.touchTraces.traces[ i ];
+		const cm_trace_t &b = out.touchTraces.traces[ i ];
+		if ( a.entityNumber != b.entityNumber || a.allsolid != b.allsolid || a.startsolid != b.startsolid || a.contents != b.contents
+			|| !PMoveBench_Same( a.fraction, b.fraction ) || !PMoveBench_Same( a.endpos, b.endpos ) || !PMoveBench_Same( a.plane, b.plane ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+*	@brief	Results of a single replay pass.
+**/
+struct svg_pmovebench_pass_t {
+	//! Total time spent in SG_PlayerMove, in microseconds.
+	uint64_t usec = 0;
+	//! Moves of the first iteration that didn't match the recording.
+	uint64_t mismatches = 0;
+	//! Index of the first mismatching move, -1 if none.
+	int64_t firstMismatch = -1;
+	//! World queries issued.
+	pm_query_stats_t queries = {};
+};
+
+/**
+*	@brief	Runs all samples 'iterations' times through SG_PlayerMove, validating the first iteration.
+**/
+static const svg_pmovebench_pass_t PMoveBench_RunPass( const std::vector<svg_pmovebench_sample_t> &samples, const int32_t iterations, const bool queryCache ) {
+	svg_pmovebench_pass_t pass = {};
+
+	pm_query_cache_enabled = queryCache;
+	pm_query_stats = {};
+
+	for ( int32_t iteration = 0; iteration < iterations; iteration++ ) {
+		for ( size_t i = 0; i < samples.size(); i++ ) {
+			const svg_pmovebench_sample_t &sample = samples[ i ];
+
+			// Restore the move exactly as it was handed to SG_PlayerMove.
+			pmoveParams_t pmp = sample.params;
+			player_state_t state = sample.inState;
+			pmove_t pm = sample.in;
+			pm.state = &state;
+			pm.playerEdict = reinterpret_cast<edict_ptr_t *>( g_edict_pool.EdictForNumber( sample.entityNumber ) );
+			SVG_Client_SetPMoveCallbacks( &pm );
+
+			const pmovebench_clock_t::time_point start = pmovebench_clock_t::now();
+			SG_PlayerMove( (pmove_s *)&pm, (pmoveParams_s *)&pmp );
+			pass.usec += std::chrono::duration_cast<std::chrono::microseconds>( pmovebench_clock_t::now() - start ).count();
+
+			if ( iteration == 0 && !PMoveBench_Matches( sample, pm, state ) ) {
+				if ( pass.firstMismatch < 0 ) {
+					pass.firstMismatch = (int64_t)i;
+				}
+				pass.mismatches++;
+			}
+		}
+	}
+
+	pass.queries = pm_query_stats;
+	pm_query_cache_enabled = true;
+	return pass;
+}
+
+/**
+*	@brief	Prints the results of a replay pass.
+**/
+static void PMoveBench_PrintPass( const char *name, const svg_pmovebench_pass_t &pass, const uint64_t moves ) {
+	gi.cprintf( nullptr, PRINT_HIGH, "%-8s %10" PRIu64 " us %8.3f us/move, %9" PRIu64 " traces (%" PRIu64 " reused), %9" PRIu64 " contents (%" PRIu64 " reused), ",
+		name, pass.usec, moves ? (double)pass.usec / moves : 0.0,
+		pass.queries.traces, pass.queries.traceHits, pass.queries.pointContents, pass.queries.pointContentsHits );
+	if ( pass.mismatches ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "%" PRIu64 " MISMATCHES (first at move %" PRId64 ")\n", pass.mismatches, pass.firstMismatch );
+	} else {
+		gi.cprintf( nullptr, PRINT_HIGH, "bit-exact\n" );
+	}
+}
+
+/**
+*	@brief	Replays a recording against the loaded map, with and without the player move query cache.
+**/
+static void PMoveBench_Replay( const char *filename, const int32_t iterations ) {
+	if ( svg_pmovebench_recording ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "Stop recording first.\n" );
+		return;
+	}
+
+	svg_pmovebench_header_t header = {};
+	std::vector<svg_pmovebench_sample_t> samples;
+	if ( !PMoveBench_Load( filename, header, samples ) ) {
+		return;
+	}
+	if ( Q_stricmp( header.mapName, level.mapname ) ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "WARNING: recorded on %s, but %s is loaded, expect mismatches.\n", header.mapName, level.mapname );
+	}
+
+	const uint64_t moves = (uint64_t)samples.size() * iterations;
+	gi.cprintf( nullptr, PRINT_HIGH, "Replaying %u player moves %d times:\n", header.numSamples, iterations );
+	PMoveBench_PrintPass( "cached", PMoveBench_RunPass( samples, iterations, true ), moves );
+	PMoveBench_PrintPass( "uncached", PMoveBench_RunPass( samples, iterations, false ), moves );
+}
+
+
+
+/**
+*
+*
+*	"sv pmovebench" Command:
+*
+*
+**/
+/**
+*	@brief	Handles "sv pmovebench [record|stop <filename>|replay <filename> [iterations]]".
+**/
+void SVG_PMoveBench_Command_f( void ) {
+	const char *subcmd = gi.argc() > 2 ? gi.argv( 2 ) : "";
+
+	if ( !Q_stricmp( subcmd, "record" ) ) {
+		if ( svg_pmovebench_recording ) {
+			gi.cprintf( nullptr, PRINT_HIGH, "Already recording, %d moves so far.\n", (int)pmovebench.samples.size() );
+			return;
+		}
+		pmovebench.samples.clear();
+		pmovebench.pending = -1;
+		svg_pmovebench_recording = true;
+		gi.cprintf( nullptr, PRINT_HIGH, "Recording player moves on %s.\n", level.mapname );
+	} else if ( !Q_stricmp( subcmd, "stop" ) ) {
+		PMoveBench_Stop( gi.argc() > 3 ? gi.argv( 3 ) : "pmove.rec" );
+	} else if ( !Q_stricmp( subcmd, "replay" ) ) {
+		PMoveBench_Replay( gi.argc() > 3 ? gi.argv( 3 ) : "pmove.rec", gi.argc() > 4 ? std::max( 1, atoi( gi.argv( 4 ) ) ) : 1 );
+	} else {
+		gi.cprintf( nullptr, PRINT_HIGH, "Usage: sv pmovebench [record|stop <filename>|replay <filename> [iterations]]\n" );
+	}
+}
@@ -0,0 +1,37 @@
+/********************************************************************
+*
+*
+*	ServerGame: Player Move Recording & Replay Benchmark.
+*
+*	"sv pmovebench record" captures the input and output of every
+*	SG_PlayerMove the server runs. "sv pmovebench replay <file>" then
+*	runs the recorded moves again against the loaded map, timing them
+*	and checking each result bit-for-bit against the recording.
+*
+*
+********************************************************************/
+#pragma once
+
+
+
+//! True while recording. PMove_RunFrame tests this first so the disabled path stays a single branch.
+extern bool svg_pmovebench_recording;
+
+/**
+*	@brief	Discards any recording in progress.
+**/
+void SVG_PMoveBench_Shutdown( void );
+
+/**
+*	@brief	Captures the input of the move that is about to be performed.
+**/
+void SVG_PMoveBench_BeginMove( const svg_base_edict_t *ent, const struct pmove_s *pm, const struct pmoveParams_s *pmp );
+/**
+*	@brief	Captures the output of the move started by the matching BeginMove call.
+**/
+void SVG_PMoveBench_EndMove( const struct pmove_s *pm );
+
+/**
+*	@brief	Handles "sv pmovebench [record|stop <filename>|replay <filename> [iterations]]".
+**/
+void SVG_PMoveBench_Command_f( void );
@@ -15,26 +15,130 @@
 #include "svgame/svg_save.h"
 #include "svgame/svg_game_items.h"
 
+//! Size of the chunks the file is read in, the buffer doubles whenever it runs out.
+static constexpr size_t SAVE_READ_BUFFER_SIZE = 0x40000;
+
 /**
-*   @brief Creates a game read context with the specified file and version.
-*   @param f The gzFile object representing the file to read from.
-*   @param version The version of the game data being read.
-*   @return A game_read_context_t object initialized with the provided file and version.
+*   @brief Creates a game read context holding the entire, decompressed, contents of the file.
+*   @param filename The name of the file to read from.
+*   @return A game_read_context_t object initialized with the file contents.
 **/
-game_read_context_t game_read_context_t::make_read_context( gzFile f ) {
+game_read_context_t game_read_context_t::make_read_context( const char *filename ) {
     game_read_context_t ctx;
-    ctx.f = f;
+    if ( !try_make_read_context( filename, &ctx ) ) {
+        gi.error( "Couldn't open %s", filename );
+    }
     return ctx;
 }
 
+/**
+*   @brief  Same as make_read_context, but returns false when the file can't be opened.
+*   @param  outCtx Receives the file contents when true is returned.
+**/
+const bool game_read_context_t::try_make_read_context( const char *filename, game_read_context_t *outCtx ) {
+    game_read_context_t &ctx = *outCtx;
+    ctx.data = nullptr;
+    ctx.size = ctx.offset = 0;
+
+    gzFile f = gzopen( filename, "rb" );
+    if ( !f ) {
+        return false;
+    }
+    gzbuffer( f, 65536 );
+
+    // Read it all in, growing the buffer as we go.
+    size_t allocated = SAVE_READ_BUFFER_SIZE;
+    ctx.data = static_cast<byte *>( gi.TagMalloc( allocated, TAG_SVGAME ) );
+    while ( 1 ) {
+        if ( ctx.size == allocated ) {
+            allocated *= 2;
+            if ( allocated > UINT32_MAX ) {
+                gzclose( f );
+                ctx.close();
+                gi.error( "%s: %s is too large", __func__, filename );
+            }
+            ctx.data = static_cast<byte *>( gi.TagReMalloc( ctx.data, allocated ) );
+        }
+        const int ret = gzread( f, ctx.data + ctx.size, allocated - ctx.size );
+        if ( ret < 0 ) {
+            gzclose( f );
+            ctx.close();
+            gi.error( "%s: couldn't read %s", __func__, filename );
+        }
+        if ( ret == 0 ) {
+            break;
+        }
+        ctx.size += ret;
+    }
+    gzclose( f );
+
+    return true;
+}
+
+/**
+*   @brief  Creates a game read context over an in-memory buffer.
+*   @param  data A TAG_SVGAME buffer, which is freed by close.
+**/
+game_read_context_t game_read_context_t::make_read_context( byte *data, const size_t size ) {
+    game_read_context_t ctx;
+    ctx.data = data;
+    ctx.size = size;
+    ctx.offset = 0;
+    return ctx;
+}
+
+/**
+*   @brief  Releases the file contents.
+**/
+void game_read_context_t::close( void ) {
+    if ( data ) {
+        gi.TagFree( data );
+    }
+    data = nullptr;
+    size = offset = 0;
+}
+
 /**
 *   @brief  Read data from the file.
 **/
 void game_read_context_t::read_data( void *buf, size_t len ) {
-    if ( gzread( f, buf, len ) != len ) {
-        gzclose( f );
+    if ( len > size - offset ) {
+        close();
+        gi.error( "%s: couldn't read %zu bytes", __func__, len );
+    }
+    memcpy( buf, data + offset, len );
+    offset += len;
+}
+
+/**
+*   @return The current read offset.
+**/
+const size_t game_read_context_t::tell( void ) const {
+    return offset;
+}
+
+/**
+*   @brief  Moves the read offset to 'newOffset'.
+**/
+void game_read_context_t::seek( const size_t newOffset ) {
+    if ( newOffset > size ) {
+        close();
+        gi.error( "%s: bad offset %zu", __func__, newOffset );
+    }
+    offset = newOffset;
+}
+
+/**
+*   @brief  Returns a pointer to the next 'len' bytes, and skips over them.
+**/
+const byte *game_read_context_t::read_raw( size_t len ) {
+    if ( len > size - offset ) {
+        close();
         gi.error( "%s: couldn't read %zu bytes", __func__, len );
     }
+    const byte *raw = data + offset;
+    offset += len;
+    return raw;
 }
 
 /**
@@ -114,7 +218,7 @@ char *game_read_context_t::read_string() {
     }
 
     if ( len < 0 || len >= 65536 ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad length", __func__ );
     }
 
@@ -139,7 +243,7 @@ const svg_level_qstring_t game_read_context_t::read_level_qstring() {
     }
 
     if ( len < 0 || len >= UINT16_MAX ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -164,7 +268,7 @@ const svg_game_qstring_t game_read_context_t::read_game_qstring() {
     }
 
     if ( len < 0 || len >= UINT16_MAX ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -190,7 +294,7 @@ sg_qtag_memory_t<T, TAG_SVGAME_LEVEL> *game_read_context_t::read_level_qtag_memo
     }
 
     if ( len < 0 || len >= UINT32_MAX ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -211,7 +315,7 @@ sg_qtag_memory_t<T, TAG_SVGAME> *game_read_context_t::read_game_qtag_memory( sg_
     }
 
     if ( len < 0 || len >= UINT32_MAX ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -228,7 +332,7 @@ void game_read_context_t::read_zstring( char *s, size_t size ) {
 
     len = read_int32();
     if ( len < 0 || len >= size ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad length(%d) >= size(%d)", __func__, len, size );
     }
 
@@ -265,7 +369,7 @@ void *game_read_context_t::read_index( size_t size, void *start, int max_index )
     }
 
     if ( index < 0 || index > max_index ) {
-        gzclose( f );
+        close();
         gi.error( "%s: bad index", __func__ );
     }
 
@@ -301,7 +405,7 @@ void *game_read_context_t::read_pointer( svg_save_funcptr_type_t type ) {
         }
         return nullptr;
     } else {
-        gzclose( f );
+        close();
         gi.error( "%s: failed finding \"%s\" in the saveAble list.", __func__, name );
         return nullptr;
     }
@@ -20,14 +20,32 @@
 *
 **/
 //! A read context for the game save/load system.
+//! The whole file is read, and decompressed, into memory up front and decoded from there.
 struct game_read_context_t {
 private:
-	//! File handle.
-	gzFile f;
+	//! Decompressed file contents.
+	byte *data;
+	//! Size of the file contents.
+	size_t size;
+	//! Current read offset.
+	size_t offset;
 
 public:
-	//! Create a new read context.
-	static game_read_context_t make_read_context( gzFile f );
+	//! Create a new read context, holding the entire contents of 'filename'.
+	static game_read_context_t make_read_context( const char *filename );
+	//! Same as above, but returns false instead of erroring out when 'filename' doesn't exist.
+	static const bool try_make_read_context( const char *filename, game_read_context_t *ctx );
+	//! Create a new read context over 'data', taking ownership of the TAG_SVGAME buffer.
+	static game_read_context_t make_read_context( byte *data, const size_t size );
+	//! Release the file contents.
+	void close( void );
+
+	//! Current read offset.
+	const size_t tell( void ) const;
+	//! Move the read offset to 'newOffset'.
+	void seek( const size_t newOffset );
+	//! Return a pointer to the next 'len' bytes and skip over them.
+	const byte *read_raw( size_t len );
 
 	//!
 	//! 
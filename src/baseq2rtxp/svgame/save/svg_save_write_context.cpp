@@ -17,17 +17,85 @@
 
 
 
+//! Initial size of the serialization buffer, it doubles whenever it runs out.
+static constexpr size_t SAVE_WRITE_BUFFER_SIZE = 0x40000;
+
 /**
 *   @brief  Used for svg_base_edict_t and derived members.
-*   @param  f The gzFile object representing the file to write to.
-*   @return A game_write_context_t object initialized with the provided file.
+*   @return A game_write_context_t object with an empty in-memory buffer.
 **/
-game_write_context_t game_write_context_t::make_write_context( gzFile f ) {
+game_write_context_t game_write_context_t::make_write_context( void ) {
     game_write_context_t ctx;
-    ctx.f = f;
+    ctx.data = static_cast<byte *>( gi.TagMalloc( SAVE_WRITE_BUFFER_SIZE, TAG_SVGAME ) );
+    ctx.size = 0;
+    ctx.allocated = SAVE_WRITE_BUFFER_SIZE;
     return ctx;
 }
 
+/**
+*   @brief  Queues the serialized data to be compressed and written to 'filename' by the
+*           server's background save writer, and releases the buffer.
+**/
+void game_write_context_t::commit( const char *filename ) {
+    gi.WriteSaveFile( filename, data, size );
+    release();
+}
+
+/**
+*   @brief  Releases the buffer without writing anything.
+**/
+void game_write_context_t::release( void ) {
+    gi.TagFree( data );
+    data = nullptr;
+    size = allocated = 0;
+}
+
+/**
+*   @brief  Hands the buffer over to the caller, leaving the context empty.
+**/
+byte *game_write_context_t::detach( size_t *length ) {
+    byte *detached = data;
+    *length = size;
+    data = nullptr;
+    size = allocated = 0;
+    return detached;
+}
+
+/**
+*   @return The number of bytes written so far.
+**/
+const size_t game_write_context_t::tell( void ) const {
+    return size;
+}
+
+/**
+*   @return Pointer to the serialized data, valid until the next write.
+**/
+const byte *game_write_context_t::get_data( void ) const {
+    return data;
+}
+
+/**
+*   @brief  Discards everything written past 'length'.
+**/
+void game_write_context_t::truncate( const size_t length ) {
+    if ( length < size ) {
+        size = length;
+    }
+}
+
+/**
+*   @brief  Overwrites an int32 previously written at 'offset', used for length prefixes.
+**/
+void game_write_context_t::patch_int32( const size_t offset, int32_t v ) {
+    if ( offset + sizeof( v ) > size ) {
+        release();
+        gi.error( "%s: bad offset %zu", __func__, offset );
+    }
+    v = LittleLong( v );
+    memcpy( data + offset, &v, sizeof( v ) );
+}
+
 
 /**
 *
@@ -39,10 +107,21 @@ game_write_context_t game_write_context_t::make_write_context( gzFile f ) {
 *
 **/
 void game_write_context_t::write_data( const void *buf, size_t len ) {
-    if ( gzwrite( f, buf, len ) != len ) {
-        gzclose( f );
-        gi.error( "%s: couldn't write %zu bytes", __func__, len );
+    // Grow the buffer if needed.
+    if ( size + len > allocated ) {
+        size_t newSize = allocated;
+        while ( size + len > newSize ) {
+            newSize *= 2;
+        }
+        if ( newSize > UINT32_MAX ) {
+            release();
+            gi.error( "%s: couldn't write %zu bytes", __func__, len );
+        }
+        data = static_cast<byte *>( gi.TagReMalloc( data, newSize ) );
+        allocated = newSize;
     }
+    memcpy( data + size, buf, len );
+    size += len;
 }
 
 void game_write_context_t::write_int16( int16_t v ) {
@@ -80,7 +159,7 @@ void game_write_context_t::write_string( const char *s ) {
 
     len = strlen( s );
     if ( len >= 65536 ) {
-        gzclose( f );
+        release();
         gi.error( "%s: bad length", __func__ );
     }
     write_int32( len );
@@ -95,7 +174,7 @@ void game_write_context_t::write_level_qstring( svg_level_qstring_t *qstr ) {
 
     const size_t len = qstr->size();
     if ( len >= UINT16_MAX ) {
-        gzclose( f );
+        release();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -112,7 +191,7 @@ void game_write_context_t::write_game_qstring( svg_game_qstring_t *qstr ) {
 
     const size_t len = qstr->count;
     if ( len >= UINT16_MAX ) {
-        gzclose( f );
+        release();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -146,7 +225,7 @@ void game_write_context_t::write_level_qtag_memory( sg_qtag_memory_t<T, TAG_SVGA
 
     const size_t len = qstr->length();
     if ( len >= UINT32_MAX ) {
-        gzclose( f );
+        release();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -179,7 +258,7 @@ void game_write_context_t::write_game_qtag_memory( sg_qtag_memory_t<T, TAG_SVGAM
 
     const size_t len = qstr->length();
     if ( len >= UINT32_MAX ) {
-        gzclose( f );
+        release();
         gi.error( "%s: bad length(%d)", __func__, len );
     }
 
@@ -218,11 +297,11 @@ void game_write_context_t::write_index( const void *p, size_t size, const void *
 
     diff = (uintptr_t)p - (uintptr_t)start;
     if ( diff > max_index * size ) {
-        gzclose( f );
+        release();
         gi.error( "%s: pointer out of range: %p", __func__, p );
     }
     if ( diff % size ) {
-        gzclose( f );
+        release();
         gi.error( "%s: misaligned pointer: %p", __func__, p );
     }
     write_int32( (int32_t)( diff / size ) );
@@ -248,7 +327,7 @@ void game_write_context_t::write_pointer( void *p, svg_save_funcptr_type_t type,
         return;
     }
 
-    gzclose( f );
+    release();
     #if USE_DEBUG
     gi.error( "%s: unknown pointer for '%s': %p", __func__, saveField->name, p );
     #else
@@ -13,14 +13,35 @@
 
 
 //! A write context for the game save/load system.
+//! Everything is serialized into an in-memory buffer, which commit then hands over to
+//! the server's background save writer for compression and the actual disk write.
 struct game_write_context_t {
 private:
-	//! File handle.
-	gzFile f;
+	//! Serialized data.
+	byte *data;
+	//! Number of bytes written so far.
+	size_t size;
+	//! Number of bytes allocated for data.
+	size_t allocated;
 
 public:
 	//! Create a new write context.
-	static game_write_context_t make_write_context( gzFile f );
+	static game_write_context_t make_write_context( void );
+	//! Queue the serialized data to be written to 'filename', and release the buffer.
+	void commit( const char *filename );
+	//! Release the buffer without writing anything.
+	void release( void );
+	//! Hand the buffer over to the caller, who is responsible for TagFree-ing it.
+	byte *detach( size_t *length );
+
+	//! Number of bytes written so far.
+	const size_t tell( void ) const;
+	//! Pointer to the serialized data, valid until the next write.
+	const byte *get_data( void ) const;
+	//! Discard everything written past 'length'.
+	void truncate( const size_t length );
+	//! Overwrite an int32 previously written at 'offset'.
+	void patch_int32( const size_t offset, int32_t v );
 
 	//! Write a buffer of data to the file.
 	void write_data( const void *buf, size_t len );
@@ -7,6 +7,8 @@
 ********************************************************************/
 #include "svgame/svg_local.h"
 #include "svgame/svg_signalio.h"
+#include "svgame/svg_entity_profiler.h"
+#include "svgame/player/svg_player_move_bench.h"
 
 /**
 *   @brief  
@@ -285,6 +287,10 @@ void SVG_ServerCommand(void) {
         ServerCommand_ListIP_f();
     else if ( Q_stricmp( cmd, "writeip" ) == 0 )
         ServerCommand_WriteIP_f();
+    else if ( Q_stricmp( cmd, "entprof" ) == 0 )
+        SVG_EntityProfiler_Command_f();
+    else if ( Q_stricmp( cmd, "pmovebench" ) == 0 )
+        SVG_PMoveBench_Command_f();
     else
         gi.cprintf( NULL, PRINT_HIGH, "Unknown server command \"%s\"\n", cmd );
 }
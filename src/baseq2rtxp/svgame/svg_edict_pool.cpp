@@ -18,6 +18,97 @@
 
 
 
+/**
+*
+*
+*
+*	EdictTypeInfo Slab Implementation:
+*
+*
+*
+**/
+//! Rounds sizes up to the slot header alignment so every object in a chunk stays aligned.
+#define SLAB_ALIGN( x ) ( ( ( x ) + alignof( svg_edict_slab_t::slot_header_t ) - 1 ) & ~( alignof( svg_edict_slab_t::slot_header_t ) - 1 ) )
+
+/**
+*	@brief	Returns memory for an object of 'size' bytes, taken from the free list
+*			or from a freshly allocated chunk.
+**/
+void *svg_edict_slab_t::Allocate( const size_t size ) {
+	// The first allocation determines the slot size.
+	if ( objectSize == 0 ) {
+		objectSize = SLAB_ALIGN( size );
+	}
+	// A derived class that didn't declare its own TypeInfo ends up here with a larger size.
+	if ( size > objectSize ) {
+		return AllocateUnpooled( size );
+	}
+
+	// Carve out a new chunk if we ran out of free slots.
+	if ( freeList == nullptr ) {
+		const size_t slotSize = sizeof( slot_header_t ) + objectSize;
+		byte *chunk = static_cast<byte *>( gi.TagMalloc( slotSize * SLOTS_PER_CHUNK, TAG_SVGAME_EDICTS ) );
+		// Link the slots in reverse, so they are handed out in address order.
+		for ( int32_t i = SLOTS_PER_CHUNK - 1; i >= 0; i-- ) {
+			slot_header_t *header = reinterpret_cast<slot_header_t *>( chunk + i * slotSize );
+			header->slab = this;
+			header->nextFree = freeList;
+			freeList = header;
+		}
+		numChunks++;
+	}
+
+	// Pop the first free slot.
+	slot_header_t *header = freeList;
+	freeList = header->nextFree;
+	header->nextFree = nullptr;
+	numAllocated++;
+
+	return header + 1;
+}
+
+/**
+*	@brief	Returns memory for an object of 'size' bytes that does not belong to any slab.
+**/
+void *svg_edict_slab_t::AllocateUnpooled( const size_t size ) {
+	slot_header_t *header = static_cast<slot_header_t *>( gi.TagMalloc( sizeof( slot_header_t ) + SLAB_ALIGN( size ), TAG_SVGAME_EDICTS ) );
+	header->slab = nullptr;
+	header->nextFree = nullptr;
+	return header + 1;
+}
+
+/**
+*	@brief	Gives the slot of an object allocated by Allocate or AllocateUnpooled back.
+**/
+void svg_edict_slab_t::Free( void *ptr ) {
+	if ( ptr == nullptr ) {
+		return;
+	}
+
+	slot_header_t *header = static_cast<slot_header_t *>( ptr ) - 1;
+	svg_edict_slab_t *slab = header->slab;
+	// Not part of any slab, give it back to the zone.
+	if ( slab == nullptr ) {
+		gi.TagFree( header );
+		return;
+	}
+	// Push it onto the free list of its slab.
+	header->nextFree = slab->freeList;
+	slab->freeList = header;
+	slab->numAllocated--;
+}
+
+/**
+*	@brief	Forgets about all chunks, called after their TAG_SVGAME_EDICTS memory was freed.
+**/
+void svg_edict_slab_t::Reset() {
+	freeList = nullptr;
+	numChunks = 0;
+	numAllocated = 0;
+}
+
+
+
 /**
 *
 *
@@ -175,8 +266,8 @@ svg_base_edict_t *svg_edict_pool_t::EmplaceNextFreeEdict( svg_base_edict_t *ent
 			ent->inUse = true;
 			// Free the old entity.
 			SVG_FreeEdict( entity );
-			// Initialize the new one.
-			edicts[ num_edicts ] = ent;
+			// Initialize the new one, in the slot it was freed from.
+			edicts[ i ] = ent;
 			// Return its ptr.
 			return /*static_cast<EdictType *>*/( edicts[ i ] );
 		}
@@ -193,16 +284,18 @@ svg_base_edict_t *svg_edict_pool_t::EmplaceNextFreeEdict( svg_base_edict_t *ent
 		// If we have a freed entity, use it.
 		if ( freedEntity ) {
 			//_InitEdict<EdictType>( entity, i );
+			// Take over the freed entity's slot, 'i' is past the end here.
+			const int32_t freedNumber = freedEntity->s.number;
 			// Restore the actual number.
-			ent->s.number = i;
+			ent->s.number = freedNumber;
 			// Make sure it is set to 'inUse'.
 			ent->inUse = true;
 			// Free the old entity.
 			SVG_FreeEdict( freedEntity );
 			// Initialize the new one.
-			edicts[ i ] = ent;
+			edicts[ freedNumber ] = ent;
 			// Return its ptr.
-			return /*static_cast<EdictType *>*/( edicts[ i ] );
+			return /*static_cast<EdictType *>*/( edicts[ freedNumber ] );
 		}
 		// If we don't have any free edicts, error out.
 		gi.error( "SVG_AllocateEdict: no free edicts" );
@@ -269,6 +362,8 @@ svg_base_edict_t **SVG_EdictPool_Release( svg_edict_pool_t *edictPool ) {
 		gi.FreeTags( TAG_SVGAME_EDICTS );
 		// Free up all SVGAME_LEVEL tag memory.
 		gi.FreeTags( TAG_SVGAME_LEVEL );
+		// Which includes the chunks of all TypeInfo slabs.
+		EdictTypeInfo::ResetSlabs();
 	}
 
 	return edictPool->edicts;
@@ -293,17 +388,21 @@ svg_base_edict_t **SVG_EdictPool_Allocate( svg_edict_pool_t *edictPool, const in
 	} else {
 		edictPool->edicts = (svg_base_edict_t **)gi.TagReMalloc( edictPool->edicts, numReservedEntities * sizeof( svg_base_edict_t * ) );//new svg_base_edict_t*[ numReservedEntities ];// 
 	}
+	// Look up the type infos for the edicts to be spawned once, rather than for each slot.
+	EdictTypeInfo *baseTypeInfo = EdictTypeInfo::GetInfoByWorldSpawnClassName( "svg_base_edict_t" );
+	EdictTypeInfo *worldSpawnTypeInfo = EdictTypeInfo::GetInfoByWorldSpawnClassName( "worldspawn" );
+	EdictTypeInfo *playerTypeInfo = EdictTypeInfo::GetInfoByWorldSpawnClassName( "player" );
 	// Initialize objects.
 	for ( int32_t i = 0; i < numReservedEntities; i++ ) {
 		// Determine the type info for the edict to be spawned.
-		EdictTypeInfo *typeInfo = EdictTypeInfo::GetInfoByWorldSpawnClassName( "svg_base_edict_t" );
+		EdictTypeInfo *typeInfo = baseTypeInfo;
 		// If edict number == 0, it is the worldspawn entity.
 		if ( i == 0 ) {
-			typeInfo = EdictTypeInfo::GetInfoByWorldSpawnClassName( "worldspawn" );
+			typeInfo = worldSpawnTypeInfo;
 			edictPool->num_edicts++;
 		// And if edict number is within the range of maxclients, it is a player entity.
 		} else if ( i >= 1 && i < game.maxclients + 1 ) {
-			typeInfo = EdictTypeInfo::GetInfoByWorldSpawnClassName( "player" );
+			typeInfo = playerTypeInfo;
 			edictPool->num_edicts++;
 		// Otherwise, it is a generic entity.
 		} else {
@@ -10,6 +10,16 @@
 
 
 
+/**
+*   @note   Edicts live in per-TypeInfo slabs, but there is deliberately no structure-of-arrays
+*           mirror of their hot fields. SV_Push gathers its candidates from gi.BoxEdicts and the
+*           pusher riders index, and touch queries run on the server's area nodes, so no frame
+*           scan walks all edicts for movetype, nextthink, svFlags or bounds. SVG_RunFrame does
+*           walk every slot, but runs each entity it finds in use, touching the edict regardless.
+*           A mirror would only save the pointer load of free slots, while every place that
+*           writes one of those fields would have to keep it in sync.
+**/
+
 /**
 *   @brief  Interface to be implemented by the ServerGame which is a
 *           Memory Pool for game allocated EDICTS.
@@ -0,0 +1,359 @@
+/********************************************************************
+*
+*
+*	ServerGame: Per-Entity-Class Think/Physics Cost Accounting.
+*
+*
+********************************************************************/
+#include "svgame/svg_local.h"
+#include "svgame/svg_entity_profiler.h"
+
+#include <string>
+#include <unordered_map>
+
+
+
+/**
+*	@brief	Counters gathered for a classname, either for a single frame or accumulated.
+**/
+struct svg_entprof_counters_t {
+	//! Number of SVG_RunEntity calls.
+	uint64_t calls = 0;
+	//! Total time spent, in microseconds.
+	uint64_t totalUsec = 0;
+	//! Most expensive single call, in microseconds.
+	uint64_t maxUsec = 0;
+	//! Number of gi.trace calls issued.
+	uint64_t traces = 0;
+	//! Number of gi.linkentity calls issued.
+	uint64_t links = 0;
+};
+
+/**
+*	@brief	Per classname accounting.
+**/
+struct svg_entprof_class_t {
+	//! Counters of the frame that is currently running.
+	svg_entprof_counters_t frame = {};
+	//! Counters of the last completed frame.
+	svg_entprof_counters_t lastFrame = {};
+	//! Counters accumulated since the last reset.
+	svg_entprof_counters_t total = {};
+	//! Most expensive frame for this class, in microseconds.
+	uint64_t peakFrameUsec = 0;
+	//! Number of frames in which this class was ran at least once.
+	uint64_t framesActive = 0;
+};
+
+//! Clock used for timing, microsecond resolution is all we need.
+using entprof_clock_t = std::chrono::steady_clock;
+
+/**
+*	Profiler State:
+**/
+//! True while 'sv_entprof' is enabled.
+bool svg_entprof_enabled = false;
+//! The cvar toggling the profiler.
+static cvar_t *sv_entprof = nullptr;
+
+static struct {
+	//! Classname to accounting map.
+	std::unordered_map<std::string, svg_entprof_class_t> classes;
+
+	//! Class of the entity currently being ran, nullptr when outside of SVG_RunEntity.
+	svg_entprof_class_t *current = nullptr;
+	//! Start time of the entity currently being ran.
+	entprof_clock_t::time_point entityStart;
+	//! Start time of the current frame.
+	entprof_clock_t::time_point frameStart;
+
+	//! Number of profiled frames since the last reset.
+	uint64_t frames = 0;
+	//! Total SVG_RunFrame time since the last reset, in microseconds.
+	uint64_t frameUsecTotal = 0;
+	//! Most expensive SVG_RunFrame since the last reset, in microseconds.
+	uint64_t frameUsecMax = 0;
+	//! Traces issued outside of SVG_RunEntity, (clients, gamemode, lua) since the last reset.
+	uint64_t unattributedTraces = 0;
+	//! Links issued outside of SVG_RunEntity since the last reset.
+	uint64_t unattributedLinks = 0;
+
+	//! The original import functions, restored when the profiler is disabled.
+	decltype( svgame_import_t::trace ) trace = nullptr;
+	decltype( svgame_import_t::linkentity ) linkentity = nullptr;
+} entprof;
+
+
+
+/**
+*
+*
+*	Counting import wrappers, only installed in 'gi' while the profiler is enabled.
+*
+*
+**/
+static const cm_trace_t EntProf_Trace( const Vector3 *start, const Vector3 *mins, const Vector3 *maxs, const Vector3 *end, edict_ptr_t *passent, const cm_contents_t contentmask ) {
+	if ( entprof.current ) {
+		entprof.current->frame.traces++;
+	} else {
+		entprof.unattributedTraces++;
+	}
+	return entprof.trace( start, mins, maxs, end, passent, contentmask );
+}
+static void EntProf_LinkEntity( edict_ptr_t *ent ) {
+	if ( entprof.current ) {
+		entprof.current->frame.links++;
+	} else {
+		entprof.unattributedLinks++;
+	}
+	entprof.linkentity( ent );
+}
+
+/**
+*	@brief	Installs, or removes, the counting wrappers.
+**/
+static void EntProf_SetEnabled( const bool enabled ) {
+	if ( enabled == svg_entprof_enabled ) {
+		return;
+	}
+
+	if ( enabled ) {
+		entprof.trace = gi.trace;
+		entprof.linkentity = gi.linkentity;
+		gi.trace = EntProf_Trace;
+		gi.linkentity = EntProf_LinkEntity;
+	} else {
+		gi.trace = entprof.trace;
+		gi.linkentity = entprof.linkentity;
+		entprof.current = nullptr;
+	}
+	svg_entprof_enabled = enabled;
+}
+
+/**
+*	@brief	Clears all accumulated statistics.
+**/
+static void EntProf_Reset( void ) {
+	entprof.classes.clear();
+	entprof.current = nullptr;
+	entprof.frames = 0;
+	entprof.frameUsecTotal = 0;
+	entprof.frameUsecMax = 0;
+	entprof.unattributedTraces = 0;
+	entprof.unattributedLinks = 0;
+}
+
+static void cvar_sv_entprof_changed( cvar_t *self ) {
+	EntProf_SetEnabled( self->integer != 0 );
+}
+
+static inline const uint64_t EntProf_Microseconds( const entprof_clock_t::time_point &start, const entprof_clock_t::time_point &end ) {
+	return std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+}
+
+/**
+*	@brief	Returns the classes sorted by their total accumulated time, most expensive first.
+**/
+static std::vector<std::pair<const std::string *, const svg_entprof_class_t *>> EntProf_SortedClasses( void ) {
+	std::vector<std::pair<const std::string *, const svg_entprof_class_t *>> sorted;
+	sorted.reserve( entprof.classes.size() );
+	for ( const auto &it : entprof.classes ) {
+		sorted.emplace_back( &it.first, &it.second );
+	}
+	std::sort( sorted.begin(), sorted.end(), []( const auto &a, const auto &b ) {
+		return a.second->total.totalUsec > b.second->total.totalUsec;
+	} );
+	return sorted;
+}
+
+
+
+/**
+*
+*
+*	Profiler API:
+*
+*
+**/
+/**
+*	@brief	Registers the 'sv_entprof' cvar.
+**/
+void SVG_EntityProfiler_Init( void ) {
+	sv_entprof = gi.cvar( "sv_entprof", "0", 0 );
+	sv_entprof->changed = cvar_sv_entprof_changed;
+	EntProf_SetEnabled( sv_entprof->integer != 0 );
+}
+
+/**
+*	@brief	Restores the original gi.trace/gi.linkentity and releases all accumulated statistics.
+**/
+void SVG_EntityProfiler_Shutdown( void ) {
+	if ( sv_entprof ) {
+		sv_entprof->changed = nullptr;
+		sv_entprof = nullptr;
+	}
+	EntProf_SetEnabled( false );
+	EntProf_Reset();
+}
+
+/**
+*	@brief	Resets the per-frame counters, called at the start of SVG_RunFrame.
+**/
+void SVG_EntityProfiler_BeginFrame( void ) {
+	if ( !svg_entprof_enabled ) {
+		return;
+	}
+
+	for ( auto &it : entprof.classes ) {
+		it.second.frame = {};
+	}
+	entprof.current = nullptr;
+	entprof.frameStart = entprof_clock_t::now();
+}
+
+/**
+*	@brief	Folds the per-frame counters into the running totals, called at the end of SVG_RunFrame.
+**/
+void SVG_EntityProfiler_EndFrame( void ) {
+	if ( !svg_entprof_enabled ) {
+		return;
+	}
+
+	const uint64_t frameUsec = EntProf_Microseconds( entprof.frameStart, entprof_clock_t::now() );
+	entprof.frames++;
+	entprof.frameUsecTotal += frameUsec;
+	entprof.frameUsecMax = std::max( entprof.frameUsecMax, frameUsec );
+
+	for ( auto &it : entprof.classes ) {
+		svg_entprof_class_t &cls = it.second;
+		cls.lastFrame = cls.frame;
+		if ( !cls.frame.calls ) {
+			continue;
+		}
+
+		cls.total.calls += cls.frame.calls;
+		cls.total.totalUsec += cls.frame.totalUsec;
+		cls.total.maxUsec = std::max( cls.total.maxUsec, cls.frame.maxUsec );
+		cls.total.traces += cls.frame.traces;
+		cls.total.links += cls.frame.links;
+		cls.peakFrameUsec = std::max( cls.peakFrameUsec, cls.frame.totalUsec );
+		cls.framesActive++;
+	}
+}
+
+/**
+*	@brief	Starts accounting for the entity that is about to be ran.
+**/
+void SVG_EntityProfiler_BeginEntity( svg_base_edict_t *ent ) {
+	const char *classname = ( ent->classname.ptr ? ent->classname.ptr : "(noclass)" );
+	entprof.current = &entprof.classes[ classname ];
+	entprof.entityStart = entprof_clock_t::now();
+}
+
+/**
+*	@brief	Stops accounting for the entity that was ran by the matching BeginEntity call.
+**/
+void SVG_EntityProfiler_EndEntity( void ) {
+	// Cvar may have been toggled, or the stats reset, while the entity was running.
+	if ( !entprof.current ) {
+		return;
+	}
+
+	const uint64_t usec = EntProf_Microseconds( entprof.entityStart, entprof_clock_t::now() );
+	svg_entprof_counters_t &frame = entprof.current->frame;
+	frame.calls++;
+	frame.totalUsec += usec;
+	frame.maxUsec = std::max( frame.maxUsec, usec );
+	entprof.current = nullptr;
+}
+
+
+
+/**
+*
+*
+*	"sv entprof" Command:
+*
+*
+**/
+/**
+*	@brief	Prints the 'count' most expensive classes.
+**/
+static void EntProf_Print( const int32_t count ) {
+	if ( !entprof.frames ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "No entity profile data, set sv_entprof 1 first.\n" );
+		return;
+	}
+
+	gi.cprintf( nullptr, PRINT_HIGH, "Entity profile over %" PRIu64 " frames (avg %.1f us/frame, max %" PRIu64 " us/frame):\n",
+		entprof.frames, (double)entprof.frameUsecTotal / entprof.frames, entprof.frameUsecMax );
+	gi.cprintf( nullptr, PRINT_HIGH, "%-32s %9s %10s %8s %8s %9s %10s %9s\n",
+		"classname", "calls", "total us", "avg us", "max us", "peak/frm", "traces", "links" );
+
+	const auto sorted = EntProf_SortedClasses();
+	int32_t printed = 0;
+	for ( const auto &it : sorted ) {
+		if ( printed++ >= count ) {
+			break;
+		}
+		const svg_entprof_counters_t &total = it.second->total;
+		gi.cprintf( nullptr, PRINT_HIGH, "%-32.32s %9" PRIu64 " %10" PRIu64 " %8.2f %8" PRIu64 " %9" PRIu64 " %10" PRIu64 " %9" PRIu64 "\n",
+			it.first->c_str(), total.calls, total.totalUsec, total.calls ? (double)total.totalUsec / total.calls : 0.0,
+			total.maxUsec, it.second->peakFrameUsec, total.traces, total.links );
+	}
+
+	gi.cprintf( nullptr, PRINT_HIGH, "Unattributed (clients, gamemode, lua): %" PRIu64 " traces, %" PRIu64 " links\n",
+		entprof.unattributedTraces, entprof.unattributedLinks );
+}
+
+/**
+*	@brief	Writes all accumulated statistics to a CSV file in the game directory.
+**/
+static void EntProf_Dump( const char *filename ) {
+	char path[ MAX_OSPATH ];
+	cvar_t *cvar_game = gi.cvar( "game", "", 0 );
+
+	size_t len = Q_snprintf( path, sizeof( path ), "%s/%s", ( *cvar_game->string ? cvar_game->string : GAMEVERSION ), filename );
+	if ( len >= sizeof( path ) ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "File name too long\n" );
+		return;
+	}
+
+	FILE *f = fopen( path, "wb" );
+	if ( !f ) {
+		gi.cprintf( nullptr, PRINT_HIGH, "Couldn't open %s\n", path );
+		return;
+	}
+
+	fprintf( f, "classname,calls,total_us,avg_us,max_us,peak_frame_us,frames_active,traces,links,last_frame_calls,last_frame_us,last_frame_traces,last_frame_links\n" );
+	for ( const auto &it : EntProf_SortedClasses() ) {
+		const svg_entprof_class_t &cls = *it.second;
+		fprintf( f, "%s,%" PRIu64 ",%" PRIu64 ",%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+			it.first->c_str(), cls.total.calls, cls.total.totalUsec, cls.total.calls ? (double)cls.total.totalUsec / cls.total.calls : 0.0,
+			cls.total.maxUsec, cls.peakFrameUsec, cls.framesActive, cls.total.traces, cls.total.links,
+			cls.lastFrame.calls, cls.lastFrame.totalUsec, cls.lastFrame.traces, cls.lastFrame.links );
+	}
+	fclose( f );
+
+	gi.cprintf( nullptr, PRINT_HIGH, "Wrote %d entity classes over %" PRIu64 " frames to %s.\n", (int)entprof.classes.size(), entprof.frames, path );
+}
+
+/**
+*	@brief	Handles "sv entprof [reset|top <count>|dump <filename>]".
+**/
+void SVG_EntityProfiler_Command_f( void ) {
+	const char *subcmd = gi.argc() > 2 ? gi.argv( 2 ) : "";
+
+	if ( !*subcmd ) {
+		EntProf_Print( 20 );
+	} else if ( !Q_stricmp( subcmd, "top" ) ) {
+		EntProf_Print( gi.argc() > 3 ? std::max( 1, atoi( gi.argv( 3 ) ) ) : 20 );
+	} else if ( !Q_stricmp( subcmd, "reset" ) ) {
+		EntProf_Reset();
+		gi.cprintf( nullptr, PRINT_HIGH, "Entity profile reset.\n" );
+	} else if ( !Q_stricmp( subcmd, "dump" ) ) {
+		EntProf_Dump( gi.argc() > 3 ? gi.argv( 3 ) : "entprof.csv" );
+	} else {
+		gi.cprintf( nullptr, PRINT_HIGH, "Usage: sv entprof [reset|top <count>|dump <filename>]\n" );
+	}
+}
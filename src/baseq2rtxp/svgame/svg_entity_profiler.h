@@ -0,0 +1,69 @@
+/********************************************************************
+*
+*
+*	ServerGame: Per-Entity-Class Think/Physics Cost Accounting.
+*
+*	When 'sv_entprof' is enabled, every SVG_RunEntity call is timed and
+*	attributed to the entity's classname, together with the number of
+*	gi.trace and gi.linkentity calls it issued. Use "sv entprof" to
+*	inspect the results, or "sv entprof dump" to write them to CSV.
+*
+*
+********************************************************************/
+#pragma once
+
+
+
+//! True while 'sv_entprof' is enabled. All hooks test this first so the disabled path stays a single branch.
+extern bool svg_entprof_enabled;
+
+/**
+*	@brief	Registers the 'sv_entprof' cvar.
+**/
+void SVG_EntityProfiler_Init( void );
+/**
+*	@brief	Restores the original gi.trace/gi.linkentity and releases all accumulated statistics.
+**/
+void SVG_EntityProfiler_Shutdown( void );
+
+/**
+*	@brief	Resets the per-frame counters, called at the start of SVG_RunFrame.
+**/
+void SVG_EntityProfiler_BeginFrame( void );
+/**
+*	@brief	Folds the per-frame counters into the running totals, called at the end of SVG_RunFrame.
+**/
+void SVG_EntityProfiler_EndFrame( void );
+
+/**
+*	@brief	Starts accounting for the entity that is about to be ran.
+**/
+void SVG_EntityProfiler_BeginEntity( svg_base_edict_t *ent );
+/**
+*	@brief	Stops accounting for the entity that was ran by the matching BeginEntity call.
+**/
+void SVG_EntityProfiler_EndEntity( void );
+
+/**
+*	@brief	Handles "sv entprof [reset|top <count>|dump <filename>]".
+**/
+void SVG_EntityProfiler_Command_f( void );
+
+/**
+*	@brief	Scoped accounting of a single SVG_RunEntity call.
+**/
+struct svg_entprof_scope_t {
+	//! Whether this scope actually began accounting, the cvar may toggle mid-entity.
+	const bool active;
+
+	svg_entprof_scope_t( svg_base_edict_t *ent ) : active( svg_entprof_enabled ) {
+		if ( active ) {
+			SVG_EntityProfiler_BeginEntity( ent );
+		}
+	}
+	~svg_entprof_scope_t() {
+		if ( active ) {
+			SVG_EntityProfiler_EndEntity();
+		}
+	}
+};
@@ -361,6 +361,11 @@ void SVG_AddGravity( svg_base_edict_t *ent );
 *   @brief  Run the entity's think function.
 **/
 void SVG_RunEntity( svg_base_edict_t *ent );
+/**
+*   @brief  Reconciles the pusher riders index with the entity's current ground entity.
+*           Needs calling after code that changes groundInfo outside of SVG_RunEntity.
+**/
+void SVG_PushMove_UpdateRider( svg_base_edict_t *ent );
 
 
 
@@ -411,6 +416,7 @@ extern cvar_t *flood_persecond;
 extern cvar_t *flood_waitdelay;
 
 extern cvar_t *g_select_empty;
+extern cvar_t *g_savedeltas;
 
 // Moved to CLGame.
 //extern cvar_t *gun_x;
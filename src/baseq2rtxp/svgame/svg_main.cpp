@@ -20,6 +20,9 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "svgame/svg_combat.h"
 #include "svgame/svg_commands_server.h"
 #include "svgame/svg_edict_pool.h"
+#include "svgame/svg_entity_profiler.h"
+#include "svgame/player/svg_player_move_bench.h"
+#include "svgame/svg_scratch.h"
 #include "svgame/svg_clients.h"
 #include "svgame/svg_utils.h"
 
@@ -117,6 +120,7 @@ cvar_t *flood_persecond = nullptr;
 cvar_t *flood_waitdelay = nullptr;
 
 cvar_t *g_select_empty = nullptr;
+cvar_t *g_savedeltas = nullptr;
 
 //
 // Func Declarations:
@@ -396,6 +400,9 @@ void SVG_InitGame( void ) {
 
     g_select_empty = gi.cvar( "g_select_empty", "0", CVAR_ARCHIVE );
 
+    // number of delta level saves before a full level file is written again
+    g_savedeltas = gi.cvar( "g_savedeltas", "8", 0 );
+
     // flood control
     flood_msgs = gi.cvar( "flood_msgs", "4", 0 );
     flood_persecond = gi.cvar( "flood_persecond", "4", 0 );
@@ -407,6 +414,12 @@ void SVG_InitGame( void ) {
     // obtain server features
     sv_features = gi.cvar( "sv_features", NULL, 0 );
 
+    // per-entity-class think/physics cost accounting
+    SVG_EntityProfiler_Init();
+
+    // frame scoped scratch memory for entity queries
+    SVG_Scratch_Init();
+
     // flare gun switch: 
     //   0 = no flare gun
     //   1 = spawn with the flare gun
@@ -470,6 +483,15 @@ void SVG_ShutdownGame( void ) {
     // Shutdown the Lua VM.
     SVG_Lua_Shutdown();
 
+    // Restore the profiler's wrapped imports and release its statistics.
+    SVG_EntityProfiler_Shutdown();
+
+    // Discard any player move recording in progress.
+    SVG_PMoveBench_Shutdown();
+
+    // Release the scratch arena.
+    SVG_Scratch_Shutdown();
+
     // Free game mode object.
     // game.mode->Shutdown();
     delete game.mode;
@@ -646,6 +668,12 @@ void SVG_RunFrame(void) {
     // Reseed the mersennery twister.
     mt_rand.seed( level.frameNumber );
 
+    // Reset the entity profiler's per-frame counters.
+    SVG_EntityProfiler_BeginFrame();
+
+    // Rewind the scratch arena, nothing may hold on to it across frames.
+    SVG_Scratch_BeginFrame();
+
     // Choose a client for monsters to target this frame.
     // WID: TODO: Monster Reimplement.
     //AI_SetSightClient();
@@ -754,4 +782,7 @@ void SVG_RunFrame(void) {
     EndClientServerFrames();
     // WID: LUA: CallBack.
     SVG_Lua_CallBack_EndServerFrame();
+
+    // Accumulate this frame's entity profile.
+    SVG_EntityProfiler_EndFrame();
 }
\ No newline at end of file
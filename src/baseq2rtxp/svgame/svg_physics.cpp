@@ -19,6 +19,8 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #include "svgame/svg_local.h"
 #include "svgame/svg_utils.h"
+#include "svgame/svg_entity_profiler.h"
+#include "svgame/svg_scratch.h"
 
 /*
 
@@ -452,6 +454,120 @@ pushed_t    pushed[MAX_EDICTS], *pushed_p;
 
 svg_base_edict_t *obstacle;
 
+/**
+*   Pusher Riders Index:
+*
+*   For each entity number, a linked list of the entities that had it as their ground entity
+*   when they were last reconciled, so SV_Push can find its riders without scanning all edicts.
+*   Entries are reconciled after each entity has ran, after player movement and whenever the
+*   push code itself changes an entity's ground. Lookups always validate against the current
+*   groundInfo, so stale entries are harmless.
+**/
+//! Ground entity number each entity is indexed under, 0 if not indexed (the world never pushes).
+static int32_t riderGround[ MAX_EDICTS ];
+//! Per ground entity number, the first rider's number + 1, 0 if none.
+static int32_t riderHead[ MAX_EDICTS ];
+//! Per rider, the next/previous rider's number + 1 on the same ground entity.
+static int32_t riderNext[ MAX_EDICTS ];
+static int32_t riderPrev[ MAX_EDICTS ];
+
+/**
+*   @brief  Reconciles the riders index with the entity's current ground entity.
+**/
+void SVG_PushMove_UpdateRider( svg_base_edict_t *ent ) {
+    const int32_t number = ent->s.number;
+    if ( number <= 0 || number >= MAX_EDICTS ) {
+        return;
+    }
+
+    int32_t ground = ( ent->inUse ? ent->groundInfo.entityNumber : ENTITYNUM_NONE );
+    if ( ground <= 0 || ground >= MAX_EDICTS ) {
+        ground = 0;
+    }
+    if ( riderGround[ number ] == ground ) {
+        return;
+    }
+
+    // Unlink from the previous ground entity.
+    if ( riderGround[ number ] ) {
+        if ( riderPrev[ number ] ) {
+            riderNext[ riderPrev[ number ] - 1 ] = riderNext[ number ];
+        } else {
+            riderHead[ riderGround[ number ] ] = riderNext[ number ];
+        }
+        if ( riderNext[ number ] ) {
+            riderPrev[ riderNext[ number ] - 1 ] = riderPrev[ number ];
+        }
+    }
+
+    // Link to the new one.
+    riderGround[ number ] = ground;
+    riderPrev[ number ] = riderNext[ number ] = 0;
+    if ( ground ) {
+        riderNext[ number ] = riderHead[ ground ];
+        if ( riderHead[ ground ] ) {
+            riderPrev[ riderHead[ ground ] - 1 ] = number + 1;
+        }
+        riderHead[ ground ] = number + 1;
+    }
+}
+
+//! Area query results and the merged, sorted candidate entity numbers for SV_Push.
+static svg_base_edict_t *pushAreaEdicts[ MAX_EDICTS ];
+static int32_t pushCandidates[ MAX_EDICTS ];
+//! Stamp per entity number to merge the candidate sources without duplicates.
+static uint32_t pushCandidateStamps[ MAX_EDICTS ];
+static uint32_t pushCandidateStamp;
+
+/**
+*   @brief  Adds all entities that are linked in the area index, and of which the bounds
+*           overlap the pusher's swept bounds, to the candidate list.
+**/
+static void SV_PushAreaCandidates( const Vector3 &sweptMins, const Vector3 &sweptMaxs, const int32_t areaType, int32_t &numCandidates ) {
+    const int32_t num = gi.BoxEdicts( &sweptMins, &sweptMaxs, pushAreaEdicts, MAX_EDICTS, areaType );
+    for ( int32_t i = 0; i < num; i++ ) {
+        const int32_t number = pushAreaEdicts[ i ]->s.number;
+        if ( number <= 0 || number >= MAX_EDICTS || pushCandidateStamps[ number ] == pushCandidateStamp ) {
+            continue;
+        }
+        pushCandidateStamps[ number ] = pushCandidateStamp;
+        pushCandidates[ numCandidates++ ] = number;
+    }
+}
+
+/**
+*   @brief  Gathers the entities SV_Push has to consider: everything overlapping the pusher's
+*           swept bounds, plus the entities riding it, sorted by entity number so they are
+*           processed in the same order as a full edict scan would.
+**/
+static const int32_t SV_PushCandidates( svg_base_edict_t *pusher, const Vector3 &sweptMins, const Vector3 &sweptMaxs ) {
+    int32_t numCandidates = 0;
+
+    if ( ++pushCandidateStamp == 0 ) {
+        std::fill( std::begin( pushCandidateStamps ), std::end( pushCandidateStamps ), 0 );
+        pushCandidateStamp = 1;
+    }
+
+    SV_PushAreaCandidates( sweptMins, sweptMaxs, AREA_SOLID, numCandidates );
+    SV_PushAreaCandidates( sweptMins, sweptMaxs, AREA_TRIGGERS, numCandidates );
+
+    // Riders are moved regardless of whether they still overlap.
+    const int32_t pusherNumber = pusher->s.number;
+    if ( pusherNumber > 0 && pusherNumber < MAX_EDICTS ) {
+        for ( int32_t rider = riderHead[ pusherNumber ]; rider; rider = riderNext[ rider - 1 ] ) {
+            const int32_t number = rider - 1;
+            if ( pushCandidateStamps[ number ] == pushCandidateStamp ) {
+                continue;
+            }
+            pushCandidateStamps[ number ] = pushCandidateStamp;
+            pushCandidates[ numCandidates++ ] = number;
+        }
+    }
+
+    std::sort( pushCandidates, pushCandidates + numCandidates );
+    return numCandidates;
+}
+
 const float SnapToEights( const float x ) {
     // WID: Float-movement.
     //x *= 8.0f;
@@ -473,9 +589,10 @@ otherwise riders would continue to slide.
 */
 bool SV_Push(svg_base_edict_t *pusher, vec3_t move, vec3_t amove)
 {
-    int         i, e;
+    int         i;
     svg_base_edict_t     *check, *block;
     vec3_t      mins, maxs;
+    Vector3     sweptMins, sweptMaxs;
     pushed_t    *p;
     vec3_t      org, org2, move2, forward, right, up;
 
@@ -492,6 +609,8 @@ bool SV_Push(svg_base_edict_t *pusher, vec3_t move, vec3_t amove)
     for (i = 0; i < 3; i++) {
         mins[i] = pusher->absMin[i] + move[i];
         maxs[i] = pusher->absMax[i] + move[i];
+        sweptMins[i] = std::min( pusher->absMin[i], mins[i] );
+        sweptMaxs[i] = std::max( pusher->absMax[i], maxs[i] );
     }
 
 // we need this for pushing things later
@@ -513,10 +632,12 @@ bool SV_Push(svg_base_edict_t *pusher, vec3_t move, vec3_t amove)
     VectorAdd(pusher->s.angles, amove, pusher->s.angles);
     gi.linkentity(pusher);
 
-// see if any solid entities are inside the final position
-    check = g_edict_pool.EdictForNumber( 1 );
-    for (e = 1; e < globals.edictPool->num_edicts; e++, check = g_edict_pool.EdictForNumber( e ) ) {
-        if (!check->inUse)
+// see if any solid entities are inside the final position, only
+// entities near the pusher or riding it can be, so query those
+    const int32_t numCandidates = SV_PushCandidates( pusher, sweptMins, sweptMaxs );
+    for ( int32_t c = 0; c < numCandidates; c++ ) {
+        check = g_edict_pool.EdictForNumber( pushCandidates[ c ] );
+        if (!check || !check->inUse)
             continue;
         if (check->movetype == MOVETYPE_PUSH
             || check->movetype == MOVETYPE_STOP
@@ -576,6 +697,7 @@ bool SV_Push(svg_base_edict_t *pusher, vec3_t move, vec3_t amove)
             // may have pushed them off an edge
             if ( check->groundInfo.entityNumber != pusher->s.number ) {
                 check->groundInfo.entityNumber = ENTITYNUM_NONE;
+                SVG_PushMove_UpdateRider( check );
             }
 
             block = SV_TestEntityPosition(check);
@@ -618,9 +740,16 @@ bool SV_Push(svg_base_edict_t *pusher, vec3_t move, vec3_t amove)
     }
 
 //FIXME: is there a better way to handle this?
-    // see if anything we moved has touched a trigger
-    for (i = (pushed_p - pushed) - 1; i >= 0; i--)
-        SVG_Util_TouchTriggers(pushed[i].ent);
+    // see if anything we moved has touched a trigger, in one pass
+    // over all of them, last pushed first
+    {
+        svg_scratch_scope_t scratchScope;
+        const int32_t numPushed = pushed_p - pushed;
+        svg_base_edict_t **movers = SVG_Scratch_AllocArray<svg_base_edict_t *>( numPushed );
+        for (i = 0; i < numPushed; i++)
+            movers[i] = pushed[numPushed - 1 - i].ent;
+        SVG_Util_TouchTriggersBatch(movers, numPushed);
+    }
 
     return true;
 }
@@ -1321,6 +1450,9 @@ SVG_RunEntity
 */
 void SVG_RunEntity(svg_base_edict_t *ent)
 {
+    // Attribute this call's cost to the entity's classname when 'sv_entprof' is enabled.
+    svg_entprof_scope_t entprofScope( ent );
+
     Vector3	previousOrigin;
     bool	isMoveStepper = false;
 
@@ -1373,4 +1505,7 @@ void SVG_RunEntity(svg_base_edict_t *ent)
     if ( ent->HasPostThinkCallback() ) {
         ent->DispatchPostThinkCallback();
     }
+
+    // Keep the pusher riders index in sync with whatever ground entity it ended up on.
+    SVG_PushMove_UpdateRider( ent );
 }
@@ -59,17 +59,8 @@ void SVG_WriteGame( const char *filename, const bool isAutoSave ) {
         SVG_Player_SaveClientData();
     }
 
-    gzFile f = gzopen( filename, "wb" );
-    if ( !f ) {
-        gi.error( "Couldn't open %s", filename );
-    }
-
     // Create a savegame write context.
-    game_write_context_t ctx = game_write_context_t::make_write_context( f );
-
-    //f = gzopen(filename, "wb");
-    //if (!f)
-    //    gi.error("Couldn't open %s", filename);
+    game_write_context_t ctx = game_write_context_t::make_write_context();
 
     ctx.write_int32( SAVE_MAGIC1 );
     ctx.write_int32( SAVE_VERSION );
@@ -83,10 +74,8 @@ void SVG_WriteGame( const char *filename, const bool isAutoSave ) {
 		ctx.write_fields( svg_client_t::saveDescriptorFields, &game.clients[ i ] );
     }
 
-    // Possibly throw an error if the file couldn't be written.
-    if ( gzclose( f ) ) {
-        gi.error( "Couldn't write %s", filename );
-    }
+    // Hand it over to the server for compressing and writing it out in the background.
+    ctx.commit( filename );
 }
 
 /**
@@ -97,7 +86,6 @@ void SVG_WriteGame( const char *filename, const bool isAutoSave ) {
 *                   It also checks the version of the save file and ensures that the game state is valid.
 **/
 void SVG_ReadGame( const char *filename ) {
-    gzFile	f;
     int     i;
 
     gi.FreeTags(TAG_SVGAME);
@@ -107,27 +95,20 @@ void SVG_ReadGame( const char *filename ) {
     game.moveWithEntities = static_cast<svg_game_locals_t::game_locals_movewith_t *>( gi.TagMalloc( sizeof( svg_game_locals_t::game_locals_movewith_t ) * MAX_EDICTS, TAG_SVGAME ) );
     memset( game.moveWithEntities, 0, sizeof( svg_game_locals_t::game_locals_movewith_t ) * MAX_EDICTS );
 
-	// Open the file.
-    f = gzopen(filename, "rb");
-    if ( !f ) {
-        gi.error( "Couldn't open %s", filename );
-    }
-	// Set the buffer size to 64k.
-    gzbuffer(f, 65536);
-    // Create a savegame read context.
-    game_read_context_t ctx = game_read_context_t::make_read_context( f );
+    // Create a savegame read context, reading in the entire file.
+    game_read_context_t ctx = game_read_context_t::make_read_context( filename );
 
 	// Read the magic number.
     i = ctx.read_int32();
     if (i != SAVE_MAGIC1) {
-        gzclose(f);
+        ctx.close();
         gi.error("Not a Q2RTXPerimental save game");
     }
 	// Read the version number.
     i = ctx.read_int32();
     if ((i != SAVE_VERSION)  && (i != 2)) {
         // Version 2 was written by Q2RTX 1.5.0, and the savegame code was crafted such to allow reading it
-        gzclose(f);
+        ctx.close();
         gi.error("Savegame from different version (got %d, expected %d)", i, SAVE_VERSION);
     }
 
@@ -136,11 +117,11 @@ void SVG_ReadGame( const char *filename ) {
 
     // should agree with server's version
     if (game.maxclients != (int)maxclients->value) {
-        gzclose(f);
+        ctx.close();
         gi.error("Savegame has bad maxclients");
     }
     if (game.maxentities <= game.maxclients || game.maxentities > MAX_EDICTS) {
-        gzclose(f);
+        ctx.close();
         gi.error("Savegame has bad maxentities");
     }
 
@@ -163,7 +144,7 @@ void SVG_ReadGame( const char *filename ) {
         ctx.read_fields( svg_client_t::saveDescriptorFields, &game.clients[ i ] );
     }
 
-    gzclose(f);
+    ctx.close();
 }
 
 
@@ -179,57 +160,301 @@ void SVG_ReadGame( const char *filename ) {
 *
 *
 ***/
+/**
+*   Level files are written as a chain of snapshots: a base file holding every entity,
+*   followed by '<level>.<n>.sav' deltas which only hold the entities whose serialized
+*   state changed (or that were freed) since the previous write. After 'g_savedeltas'
+*   deltas the chain is compacted by writing out a new base.
+*
+*   Each entity record is stored length prefixed so the chain can be merged back into
+*   a plain level image without walking any field descriptors:
+*
+*   int32 SAVE_MAGIC3, int32 SAVE_VERSION, int32 generation, int32 sequence,
+*   { int32 entnum, int32 classname length (-1 if freed), int32 fields length, data }...,
+*   int32 -1, int32 level fields length, level fields.
+**/
+//! Upper limit on the number of deltas in a chain, regardless of g_savedeltas.
+static constexpr int32_t LEVEL_SNAPSHOT_MAX_DELTAS = 64;
+
+//! What is on disk for the current level's snapshot chain.
+static struct {
+    //! True if the state below matches the files on disk for 'filename'.
+    bool valid;
+    //! The base level file of the chain.
+    char filename[ MAX_OSPATH ];
+    //! Identifies the base file, deltas carrying another generation are stale.
+    uint32_t generation;
+    //! Number of deltas written on top of the base.
+    int32_t sequence;
+    //! Whether the entity is stored in the chain.
+    bool present[ MAX_EDICTS ];
+    //! Hash of the entity's serialized classname and fields, as stored in the chain.
+    uint64_t hashes[ MAX_EDICTS ];
+} level_snapshot;
+
+//! Merged state of a single entity while loading a snapshot chain.
+struct level_snapshot_entry_t {
+    const byte *classname;
+    int32_t classnameLength;
+    const byte *fields;
+    int32_t fieldsLength;
+};
+
+/**
+*   @brief  64 bit FNV-1a hash of 'data', continuing from 'hash'.
+**/
+static const uint64_t level_snapshot_hash( const byte *data, const size_t length, uint64_t hash = 0xcbf29ce484222325ULL ) {
+    for ( size_t i = 0; i < length; i++ ) {
+        hash = ( hash ^ data[ i ] ) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+*   @brief  Generates the generation identifier of a new base file.
+**/
+static const uint32_t level_snapshot_generation( void ) {
+    static uint32_t counter = 0;
+    return (uint32_t)time( nullptr ) * 2654435761U + ++counter;
+}
+
+/**
+*   @brief  Builds the filename of the delta 'sequence' of the base level file 'filename'.
+**/
+static void level_snapshot_delta_filename( char *buffer, const size_t bufferSize, const char *filename, const int32_t sequence ) {
+    size_t length = strlen( filename );
+    if ( length > 4 && !Q_stricmp( filename + length - 4, ".sav" ) ) {
+        length -= 4;
+    }
+    Q_snprintf( buffer, bufferSize, "%.*s.%d.sav", (int)length, filename, sequence );
+}
+
+/**
+*   @brief  Forgets about the level snapshot chain, so that the next SVG_WriteLevel
+*           writes out a full level file again. Called when a new level is spawned.
+**/
+void SVG_ResetLevelSnapshot( void ) {
+    level_snapshot.valid = false;
+}
+
+/**
+*   @brief  Applies the entity records of a snapshot file to 'entries'.
+*   @return False if the file isn't part of the chain 'generation'.
+**/
+static const bool level_snapshot_apply( game_read_context_t *ctx, level_snapshot_entry_t *entries,
+    const int32_t sequence, uint32_t *generation, const byte **levelFields, int32_t *levelFieldsLength ) {
+    if ( ctx->read_int32() != SAVE_MAGIC3 ) {
+        return false;
+    }
+    const int32_t version = ctx->read_int32();
+    if ( version != SAVE_VERSION ) {
+        ctx->close();
+        gi.error( "Savegame from different version (got %d, expected %d)", version, SAVE_VERSION );
+    }
+    const uint32_t fileGeneration = (uint32_t)ctx->read_int32();
+    const int32_t fileSequence = ctx->read_int32();
+    if ( fileSequence != sequence || ( sequence && fileGeneration != *generation ) ) {
+        return false;
+    }
+    *generation = fileGeneration;
+
+    while ( 1 ) {
+        const int32_t entnum = ctx->read_int32();
+        if ( entnum == -1 ) {
+            break;
+        }
+        if ( entnum < 0 || entnum >= game.maxentities ) {
+            ctx->close();
+            gi.error( "%s: bad entity number", __func__ );
+        }
+        const int32_t classnameLength = ctx->read_int32();
+        const int32_t fieldsLength = ctx->read_int32();
+        level_snapshot_entry_t *entry = &entries[ entnum ];
+        // Freed since the previous snapshot.
+        if ( classnameLength < 0 ) {
+            *entry = {};
+            continue;
+        }
+        if ( fieldsLength < 0 ) {
+            ctx->close();
+            gi.error( "%s: bad entity record", __func__ );
+        }
+        entry->classnameLength = classnameLength;
+        entry->classname = ctx->read_raw( classnameLength );
+        entry->fieldsLength = fieldsLength;
+        entry->fields = ctx->read_raw( fieldsLength );
+    }
+
+    *levelFieldsLength = ctx->read_int32();
+    if ( *levelFieldsLength < 0 ) {
+        ctx->close();
+        gi.error( "%s: bad level record", __func__ );
+    }
+    *levelFields = ctx->read_raw( *levelFieldsLength );
+    return true;
+}
+
+/**
+*   @brief  Loads the level file 'filename' together with its deltas, and merges them
+*           into a plain level image for SVG_ReadLevel to restore from. Rebuilds the
+*           snapshot state so that the next write continues the chain.
+*
+*           Level files written before snapshot chains existed are returned as is.
+**/
+static game_read_context_t level_snapshot_load( const char *filename ) {
+    // Forget about the previous chain, if loading fails we start over with a full write.
+    level_snapshot.valid = false;
+
+    game_read_context_t files[ 1 + LEVEL_SNAPSHOT_MAX_DELTAS ];
+    files[ 0 ] = game_read_context_t::make_read_context( filename );
+    if ( files[ 0 ].read_int32() != SAVE_MAGIC3 ) {
+        files[ 0 ].seek( 0 );
+        return files[ 0 ];
+    }
+    files[ 0 ].seek( 0 );
+
+    level_snapshot_entry_t *entries = static_cast<level_snapshot_entry_t *>( gi.TagMallocz( sizeof( *entries ) * MAX_EDICTS, TAG_SVGAME ) );
+    const byte *levelFields = nullptr;
+    int32_t levelFieldsLength = 0;
+    uint32_t generation = 0;
+    int32_t numFiles = 0;
+
+    // Apply the base, followed by the deltas, up until the first missing or stale one.
+    char deltaFilename[ MAX_OSPATH ];
+    while ( numFiles < 1 + LEVEL_SNAPSHOT_MAX_DELTAS ) {
+        if ( numFiles > 0 ) {
+            level_snapshot_delta_filename( deltaFilename, sizeof( deltaFilename ), filename, numFiles );
+            if ( !game_read_context_t::try_make_read_context( deltaFilename, &files[ numFiles ] ) ) {
+                break;
+            }
+        }
+        if ( !level_snapshot_apply( &files[ numFiles ], entries, numFiles, &generation, &levelFields, &levelFieldsLength ) ) {
+            if ( numFiles == 0 ) {
+                files[ 0 ].close();
+                gi.error( "%s: bad level file", __func__ );
+            }
+            files[ numFiles ].close();
+            break;
+        }
+        numFiles++;
+    }
+
+    // Rebuild the image in the layout SVG_ReadLevel expects: classnames first, then fields.
+    game_write_context_t image = game_write_context_t::make_write_context();
+    image.write_int32( SAVE_MAGIC2 );
+    image.write_int32( SAVE_VERSION );
+    for ( int32_t i = 0; i < MAX_EDICTS; i++ ) {
+        if ( entries[ i ].classname ) {
+            image.write_int32( i );
+            image.write_data( entries[ i ].classname, entries[ i ].classnameLength );
+        }
+    }
+    image.write_int32( -1 );
+    for ( int32_t i = 0; i < MAX_EDICTS; i++ ) {
+        level_snapshot.present[ i ] = ( entries[ i ].classname != nullptr );
+        if ( !level_snapshot.present[ i ] ) {
+            continue;
+        }
+        image.write_int32( i );
+        image.write_data( entries[ i ].fields, entries[ i ].fieldsLength );
+        // Hashed the same way as SVG_WriteLevel does, over the classname directly followed by the fields.
+        level_snapshot.hashes[ i ] = level_snapshot_hash( entries[ i ].fields, entries[ i ].fieldsLength,
+            level_snapshot_hash( entries[ i ].classname, entries[ i ].classnameLength ) );
+    }
+    image.write_int32( -1 );
+    image.write_data( levelFields, levelFieldsLength );
+
+    for ( int32_t i = 0; i < numFiles; i++ ) {
+        files[ i ].close();
+    }
+    gi.TagFree( entries );
+
+    // Continue the chain from here on.
+    Q_strlcpy( level_snapshot.filename, filename, sizeof( level_snapshot.filename ) );
+    level_snapshot.generation = generation;
+    level_snapshot.sequence = numFiles - 1;
+    level_snapshot.valid = true;
+
+    size_t imageSize = 0;
+    byte *imageData = image.detach( &imageSize );
+    return game_read_context_t::make_read_context( imageData, imageSize );
+}
+
 /**
 *   @brief  Writes the state of the current level to a file.
+*
+*           Unless a full write is due, only the entities whose serialized state differs
+*           from what the snapshot chain already holds are written, as a delta file.
 **/
 void SVG_WriteLevel(const char *filename)
 {
-    gzFile f = gzopen(filename, "wb");
-    if ( !f ) {
-        gi.error( "Couldn't open %s", filename );
+    // Determine whether to start a new chain with a full level file, or write a delta on top of it.
+    const int32_t maxDeltas = std::clamp<int32_t>( g_savedeltas->integer, 0, LEVEL_SNAPSHOT_MAX_DELTAS );
+    const bool writeBase = !level_snapshot.valid
+        || strcmp( level_snapshot.filename, filename )
+        || level_snapshot.sequence >= maxDeltas;
+    // Invalidate until the write went through.
+    level_snapshot.valid = false;
+    if ( writeBase ) {
+        Q_strlcpy( level_snapshot.filename, filename, sizeof( level_snapshot.filename ) );
+        level_snapshot.generation = level_snapshot_generation();
+        level_snapshot.sequence = 0;
+        memset( level_snapshot.present, 0, sizeof( level_snapshot.present ) );
+    } else {
+        level_snapshot.sequence++;
     }
 
     // Create a savegame write context.
-    game_write_context_t ctx = game_write_context_t::make_write_context( f );
+    game_write_context_t ctx = game_write_context_t::make_write_context();
 
-    ctx.write_int32( SAVE_MAGIC2 );
+    ctx.write_int32( SAVE_MAGIC3 );
     ctx.write_int32( SAVE_VERSION );
+    ctx.write_int32( (int32_t)level_snapshot.generation );
+    ctx.write_int32( level_snapshot.sequence );
 
-	// First write out all the entity indices and their classnames.
-	// We do so for being able to allocate the entities first.
-    // 
-    // This helps restoring actual entity pointers to the entities of the saved game.
-    // Write out all the entities.
+    // Write out an indice, classname, and the actual entity properties of each entity.
+    // The classnames are gathered in front by the loader, for being able to allocate 
+    // the entities first. This helps restoring actual entity pointers to the entities of the saved game.
+    bool inUse[ MAX_EDICTS ] = {};
     for ( int32_t i = 0; i < globals.edictPool->num_edicts; i++ ) {
         svg_base_edict_t *ent = g_edict_pool.EdictForNumber( i );
-        //ent = &g_edicts[i];
         if ( !ent || !ent->inUse ) {
             continue;
         }
-        // Entity number.
+        inUse[ i ] = true;
+
+        // Entity number, followed by the classname and fields lengths which are filled in after.
+        const size_t recordStart = ctx.tell();
         ctx.write_int32( i );
+        ctx.write_int32( 0 );
+        ctx.write_int32( 0 );
         // Entity classname.
+        const size_t classnameStart = ctx.tell();
         ctx.write_level_qstring( &ent->classname );
         // Rest of entity fields.
-        //ent->Save( &ctx );
-        //write_fields(f, entityfields, ent);
-    }
-    // End of level data.
-    ctx.write_int32( -1 );
-    // Now write out an indice + the actual entity properties.
-    for ( int32_t i = 0; i < globals.edictPool->num_edicts; i++) {
-        svg_base_edict_t *ent = g_edict_pool.EdictForNumber( i );
-        //ent = &g_edicts[i];
-        if ( !ent || !ent->inUse ) {
+        const size_t fieldsStart = ctx.tell();
+        ent->Save( &ctx );
+        const size_t recordEnd = ctx.tell();
+
+        // Drop the record again if the chain already holds this exact state.
+        const uint64_t hash = level_snapshot_hash( ctx.get_data() + classnameStart, recordEnd - classnameStart );
+        if ( level_snapshot.present[ i ] && level_snapshot.hashes[ i ] == hash ) {
+            ctx.truncate( recordStart );
             continue;
         }
-        // Entity number.
-        ctx.write_int32( i );
-        // Entity classname.
-        //ctx.write_level_qstring( &ent->classname );
-        // Rest of entity fields.
-        ent->Save( &ctx );
-        //write_fields(f, entityfields, ent);
+        ctx.patch_int32( recordStart + 4, (int32_t)( fieldsStart - classnameStart ) );
+        ctx.patch_int32( recordStart + 8, (int32_t)( recordEnd - fieldsStart ) );
+        level_snapshot.present[ i ] = true;
+        level_snapshot.hashes[ i ] = hash;
+    }
+    // Entities that were freed since the previous write.
+    for ( int32_t i = 0; i < MAX_EDICTS; i++ ) {
+        if ( level_snapshot.present[ i ] && !inUse[ i ] ) {
+            ctx.write_int32( i );
+            ctx.write_int32( -1 );
+            ctx.write_int32( 0 );
+            level_snapshot.present[ i ] = false;
+        }
     }
 
     // End of level data.
@@ -238,13 +463,21 @@ void SVG_WriteLevel(const char *filename)
     // Write out svg_level_locals_t. We do this after writing out the entities.
 	// This is so that while loading the level, we initialize entities first
     // which in turn, the levelfields can optionally be pointing at.
+    const size_t levelStart = ctx.tell();
+    ctx.write_int32( 0 );
 	ctx.write_fields( svg_level_locals_t::saveDescriptorFields, &level );
-
-	// Possibly throw an error if the file couldn't be written.
-    if ( gzclose( f ) ) {
-        gi.error( "Couldn't write %s", filename );
+    ctx.patch_int32( levelStart, (int32_t)( ctx.tell() - levelStart - 4 ) );
+
+    // Hand it over to the server for compressing and writing it out in the background.
+    if ( writeBase ) {
+        ctx.commit( filename );
+    } else {
+        char deltaFilename[ MAX_OSPATH ];
+        level_snapshot_delta_filename( deltaFilename, sizeof( deltaFilename ), filename, level_snapshot.sequence );
+        ctx.commit( deltaFilename );
     }
-} 
+    level_snapshot.valid = true;
+}
 
 /**
 *   @brief  SpawnEntities will allready have been called on the
@@ -276,14 +509,8 @@ void SVG_ReadLevel(const char *filename)
     // Store cm_entity_t pointer.
     level.cm_entities = cm_entities;
 
-    gzFile f = gzopen(filename, "rb");
-    if ( !f ) {
-        gi.error( "Couldn't open %s", filename );
-    }
-    gzbuffer(f, 65536);
-
-    // Create read context.
-    game_read_context_t ctx = game_read_context_t::make_read_context( f );
+    // Create read context, reading in the entire level file merged with its deltas.
+    game_read_context_t ctx = level_snapshot_load( filename );
 
     // Wipe all the entities back to 'baseline'.
     for ( int32_t i = 0; i < game.maxentities; i++ ) {
@@ -351,14 +578,14 @@ void SVG_ReadLevel(const char *filename)
 
     int32_t i = ctx.read_int32();
     if (i != SAVE_MAGIC2) {
-        gzclose(f);
+        ctx.close();
         gi.error("Not a Q2RTXPerimental save game");
     }
 
     i = ctx.read_int32();
     if ((i != SAVE_VERSION) && (i != 2)) {
         // Version 2 was written by Q2RTX 1.5.0, and the savegame code was crafted such to allow reading it
-        gzclose(f);
+        ctx.close();
         gi.error("Savegame from different version (got %d, expected %d)", i, SAVE_VERSION);
     }
 
@@ -369,7 +596,7 @@ void SVG_ReadLevel(const char *filename)
         if ( entnum == -1 )
             break;
         if ( entnum < 0 || entnum >= game.maxentities ) {
-            gzclose( f );
+            ctx.close();
             gi.error( "%s: bad entity number", __func__ );
         }
         if ( entnum >= g_edict_pool.num_edicts ) {
@@ -414,7 +641,7 @@ void SVG_ReadLevel(const char *filename)
         if ( entnum == -1 )
             break;
         if ( entnum < 0 || entnum >= game.maxentities ) {
-            gzclose( f );
+            ctx.close();
             gi.error( "%s: bad entity number", __func__ );
         }
         if ( entnum >= g_edict_pool.num_edicts ) {
@@ -470,7 +697,7 @@ void SVG_ReadLevel(const char *filename)
     //read_fields( &ctx, levelfields, &level );
 	ctx.read_fields( svg_level_locals_t::saveDescriptorFields, &level );
 
-    gzclose(f);
+    ctx.close();
 
     // Set client fields on player entities.
     for ( int32_t i = 0; i < game.maxclients; i++ ) {
@@ -15,6 +15,8 @@
 static constexpr int32_t SAVE_MAGIC1	= MakeLittleLong('G','S','V','1');
 //! The magic number for the level save file.
 static constexpr int32_t SAVE_MAGIC2	= MakeLittleLong('L','S','V','1');
+//! The magic number for the level snapshot files, a base level file or a delta on top of it.
+static constexpr int32_t SAVE_MAGIC3	= MakeLittleLong('L','S','V','D');
 // WID: We got our own version number obviously.
 static constexpr int32_t SAVE_VERSION	= 1337;
 
@@ -88,4 +90,10 @@ void SVG_WriteLevel( const char *filename );
 *
 *   No clients are connected yet.
 **/
-void SVG_ReadLevel( const char *filename );
\ No newline at end of file
+void SVG_ReadLevel( const char *filename );
+
+/**
+*   @brief  Forgets about the level snapshot chain, so that the next SVG_WriteLevel
+*           writes out a full level file again. Called when a new level is spawned.
+**/
+void SVG_ResetLevelSnapshot( void );
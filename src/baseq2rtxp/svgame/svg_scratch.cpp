@@ -0,0 +1,72 @@
+/********************************************************************
+*
+*
+*	ServerGame: Frame Scoped Scratch Arena.
+*
+*
+********************************************************************/
+#include "svgame/svg_local.h"
+#include "svgame/svg_scratch.h"
+
+
+
+//! Size of the arena, enough for a few dozen nested full entity lists.
+static constexpr size_t SCRATCH_ARENA_SIZE = 4 * 1024 * 1024;
+
+//! Backing memory. Static rather than TAG_SVGAME, since SVG_ReadGame frees that tag.
+alignas( 64 ) static byte scratchBase[ SCRATCH_ARENA_SIZE ];
+//! Offset of the first free byte.
+static size_t scratchTop = 0;
+
+
+
+/**
+*	@brief	Resets the arena for a new game.
+**/
+void SVG_Scratch_Init( void ) {
+	scratchTop = 0;
+}
+
+/**
+*	@brief	Drops anything still allocated from the arena.
+**/
+void SVG_Scratch_Shutdown( void ) {
+	scratchTop = 0;
+}
+
+/**
+*	@brief	Rewinds the arena, called at the start of SVG_RunFrame.
+**/
+void SVG_Scratch_BeginFrame( void ) {
+	scratchTop = 0;
+}
+
+/**
+*	@return	Uninitialized memory for 'size' bytes aligned to 'alignment', valid until
+*			released by the enclosing scope or the next frame. Errors out on overflow.
+**/
+void *SVG_Scratch_Alloc( const size_t size, const size_t alignment ) {
+	const size_t offset = ( scratchTop + alignment - 1 ) & ~( alignment - 1 );
+	if ( offset > SCRATCH_ARENA_SIZE || size > SCRATCH_ARENA_SIZE - offset ) {
+		gi.error( "%s: overflow allocating %zu bytes (%zu in use)", __func__, size, scratchTop );
+	}
+
+	scratchTop = offset + size;
+	return scratchBase + offset;
+}
+
+/**
+*	@return	The current allocation offset, to rewind to with SVG_Scratch_Release.
+**/
+const size_t SVG_Scratch_Mark( void ) {
+	return scratchTop;
+}
+
+/**
+*	@brief	Releases everything allocated since 'mark' was taken.
+**/
+void SVG_Scratch_Release( const size_t mark ) {
+	if ( mark < scratchTop ) {
+		scratchTop = mark;
+	}
+}
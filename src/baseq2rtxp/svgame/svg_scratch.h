@@ -0,0 +1,76 @@
+/********************************************************************
+*
+*
+*	ServerGame: Frame Scoped Scratch Arena.
+*
+*	A bump allocator for short lived query buffers, such as the entity
+*	lists filled in by gi.BoxEdicts. Memory is never cleared, callers
+*	only read back what they wrote. Nested users (e.g. a touch callback
+*	that queries again) each get their own block. Use svg_scratch_scope_t
+*	to hand a block back once done, the arena is also rewound as a whole
+*	at the start of every SVG_RunFrame.
+*
+*
+********************************************************************/
+#pragma once
+
+
+
+/**
+*	@brief	Resets the arena for a new game.
+**/
+void SVG_Scratch_Init( void );
+/**
+*	@brief	Drops anything still allocated from the arena.
+**/
+void SVG_Scratch_Shutdown( void );
+/**
+*	@brief	Rewinds the arena, called at the start of SVG_RunFrame.
+**/
+void SVG_Scratch_BeginFrame( void );
+
+/**
+*	@return	Uninitialized memory for 'size' bytes aligned to 'alignment', valid until
+*			released by the enclosing scope or the next frame. Errors out on overflow.
+**/
+void *SVG_Scratch_Alloc( const size_t size, const size_t alignment );
+/**
+*	@return	The current allocation offset, to rewind to with SVG_Scratch_Release.
+**/
+const size_t SVG_Scratch_Mark( void );
+/**
+*	@brief	Releases everything allocated since 'mark' was taken.
+**/
+void SVG_Scratch_Release( const size_t mark );
+
+/**
+*	@return	Uninitialized storage for 'count' elements of T.
+**/
+template<typename T>
+static inline T *SVG_Scratch_AllocArray( const size_t count ) {
+	return static_cast<T *>( SVG_Scratch_Alloc( sizeof( T ) * count, alignof( T ) ) );
+}
+
+/**
+*	@return	Storage for an entity list that can hold every entity currently in use,
+*			which is as many as any area query can return.
+**/
+static inline svg_base_edict_t **SVG_Scratch_AllocEdictList( int32_t *maxCount ) {
+	*maxCount = globals.edictPool->num_edicts;
+	return SVG_Scratch_AllocArray<svg_base_edict_t *>( *maxCount );
+}
+
+/**
+*	@brief	Releases all scratch memory allocated within its lifetime.
+**/
+struct svg_scratch_scope_t {
+	const size_t mark;
+
+	svg_scratch_scope_t() : mark( SVG_Scratch_Mark() ) {}
+	~svg_scratch_scope_t() {
+		SVG_Scratch_Release( mark );
+	}
+
+	svg_scratch_scope_t( const svg_scratch_scope_t & ) = delete;
+	svg_scratch_scope_t &operator=( const svg_scratch_scope_t & ) = delete;
+};
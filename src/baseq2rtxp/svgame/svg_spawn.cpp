@@ -412,6 +412,9 @@ void SVG_SpawnEntities( const char *mapname, const char *spawnpoint, const cm_en
     // Give it a chance to prepare any CVars that it needs to set up.
     game.mode->PrepareCVars();
 
+    // A new level, any level file written from here on starts a new snapshot chain.
+    SVG_ResetLevelSnapshot();
+
     // Output the game mode type, and the maximum clients allowed for this session.
     gi.dprintf( "[GameMode(#%d): %s][maxclients=%d]\n",
         requestedGameModeType, SG_GetGameModeName( requestedGameModeType ), maxclients->integer );
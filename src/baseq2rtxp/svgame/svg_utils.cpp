@@ -19,6 +19,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #include "svgame/svg_local.h"
 #include "svgame/svg_utils.h"
+#include "svgame/svg_scratch.h"
 
 #include "svgame/svg_lua.h"
 #include "svgame/lua/svg_lua_gamelib.hpp"
@@ -297,14 +298,12 @@ svg_base_edict_t *SVG_Util_CreateTempEventEntity( const Vector3 &origin, const s
 *
 **/
 /**
-*   @brief  
+*   @brief  Dispatches the touch callbacks of all triggers 'ent' is in, using 'touchedEdicts'
+*           (room for 'maxCount' entities) as the query buffer.
 **/
-void SVG_Util_TouchTriggers(svg_base_edict_t *ent) {
+static void SVG_Util_TouchTriggers( svg_base_edict_t *ent, svg_base_edict_t **touchedEdicts, const int32_t maxCount ) {
     svg_base_edict_t *hit;
 
-    static svg_base_edict_t *touchedEdicts[ MAX_EDICTS ] = {};
-	std::fill( std::begin( touchedEdicts ), std::end( touchedEdicts ), nullptr );
-
     // dead things don't activate triggers!
     if ( ( ent->client || ( ent->svFlags & SVF_MONSTER ) ) && ( ent->health <= 0 ) ) {
         return;
@@ -312,7 +311,7 @@ void SVG_Util_TouchTriggers(svg_base_edict_t *ent) {
 
 	const Vector3 absMin = ent->absMin;
     const Vector3 absMax = ent->absMax;
-    const int32_t num = gi.BoxEdicts( &absMin, &absMax, touchedEdicts, MAX_EDICTS, AREA_TRIGGERS );
+    const int32_t num = gi.BoxEdicts( &absMin, &absMax, touchedEdicts, maxCount, AREA_TRIGGERS );
 
     // be careful, it is possible to have an entity in this
     // list removed before we get to it (killtriggered)
@@ -336,6 +335,33 @@ void SVG_Util_TouchTriggers(svg_base_edict_t *ent) {
         }
     }
 }
+/**
+*   @brief  Dispatches the touch callbacks of all triggers 'ent' is in.
+**/
+void SVG_Util_TouchTriggers( svg_base_edict_t *ent ) {
+    // Only the entries returned by the query are ever read, so no need to clear it.
+    svg_scratch_scope_t scratchScope;
+    int32_t maxCount = 0;
+    svg_base_edict_t **touchedEdicts = SVG_Scratch_AllocEdictList( &maxCount );
+
+    SVG_Util_TouchTriggers( ent, touchedEdicts, maxCount );
+}
+/**
+*   @brief  Same as calling SVG_Util_TouchTriggers for each of the 'count' entities in order,
+*           sharing a single query buffer between them.
+**/
+void SVG_Util_TouchTriggersBatch( svg_base_edict_t **ents, const int32_t count ) {
+    svg_scratch_scope_t scratchScope;
+    int32_t maxCount = 0;
+    svg_base_edict_t **touchedEdicts = SVG_Scratch_AllocEdictList( &maxCount );
+
+    for ( int32_t i = 0; i < count; i++ ) {
+        // A previous touch may have freed it.
+        if ( ents[ i ] && ents[ i ]->inUse ) {
+            SVG_Util_TouchTriggers( ents[ i ], touchedEdicts, maxCount );
+        }
+    }
+}
 
 /**
 *   @brief  Call after linking a new trigger in during gameplay
@@ -344,12 +370,13 @@ void SVG_Util_TouchTriggers(svg_base_edict_t *ent) {
 void SVG_Util_TouchSolids(svg_base_edict_t *ent) {
     svg_base_edict_t *hit = nullptr;
 
-    static svg_base_edict_t *touchedEdicts[ MAX_EDICTS ] = {};
-    std::fill( std::begin( touchedEdicts ), std::end( touchedEdicts ), nullptr );
+    svg_scratch_scope_t scratchScope;
+    int32_t maxCount = 0;
+    svg_base_edict_t **touchedEdicts = SVG_Scratch_AllocEdictList( &maxCount );
 
     const Vector3 absMin = ent->absMin;
     const Vector3 absMax = ent->absMax;
-    const int32_t num = gi.BoxEdicts( &absMin, &absMax, touchedEdicts, MAX_EDICTS, AREA_SOLID );
+    const int32_t num = gi.BoxEdicts( &absMin, &absMax, touchedEdicts, maxCount, AREA_SOLID );
 
     // be careful, it is possible to have an entity in this
     // list removed before we get to it (killtriggered)
@@ -382,8 +409,10 @@ void SVG_Util_TouchProjectiles( svg_base_edict_t *ent, const Vector3 &previous_o
         svg_base_edict_t *projectile;
         int32_t spawn_count;
     };
-    // a bit ugly, but we'll store projectiles we are ignoring here.
-    static std::vector<skipped_projectile> skipped;
+    // store projectiles we are ignoring here, each one is skipped at most once.
+    svg_scratch_scope_t scratchScope;
+    int32_t numSkipped = 0;
+    skipped_projectile *skipped = SVG_Scratch_AllocArray<skipped_projectile>( globals.edictPool->num_edicts );
 
     while ( true ) {
         svg_trace_t tr = SVG_Trace( previous_origin, ent->mins, ent->maxs, ent->s.origin, ent, ( ent->clipMask | CONTENTS_PROJECTILE ) );
@@ -398,7 +427,7 @@ void SVG_Util_TouchProjectiles( svg_base_edict_t *ent, const Vector3 &previous_o
         // always skip this projectile since certain conditions may cause the projectile
         // to not disappear immediately
         tr.ent->svFlags &= ~SVF_PROJECTILE;
-        skipped.push_back( { tr.ent, tr.ent->spawn_count } );
+        skipped[ numSkipped++ ] = { tr.ent, tr.ent->spawn_count };
 
         // Q2RE: if we're both players and it's coop, allow the projectile to "pass" through
         // However, we got no methods like them, but we do have an optional check for no friendly fire.
@@ -411,13 +440,12 @@ void SVG_Util_TouchProjectiles( svg_base_edict_t *ent, const Vector3 &previous_o
         SVG_Impact( ent, &tr );
     }
 
-    for ( auto &skip : skipped ) {
+    for ( int32_t i = 0; i < numSkipped; i++ ) {
+        skipped_projectile &skip = skipped[ i ];
         if ( skip.projectile->inUse && skip.projectile->spawn_count == skip.spawn_count ) {
             skip.projectile->svFlags |= SVF_PROJECTILE;
         }
     }
-
-    skipped.clear();
 }
 /*
 =================
@@ -514,12 +542,13 @@ const bool SVG_Util_KillBox( svg_base_edict_t *ent, const bool bspClipping, sg_m
     //// [Paril-KEX] don't gib other players in coop if we're not colliding
     //if ( from_spawning && ent->client && coop->integer && !G_ShouldPlayersCollide( false ) )
     //    mask &= ~CONTENTS_PLAYER;
-    static svg_base_edict_t *touchedEdicts[ MAX_EDICTS ];
-    std::fill( std::begin( touchedEdicts ), std::end( touchedEdicts ), nullptr );
+    svg_scratch_scope_t scratchScope;
+    int32_t maxCount = 0;
+    svg_base_edict_t **touchedEdicts = SVG_Scratch_AllocEdictList( &maxCount );
 
     const Vector3 absMin = ent->absMin;
     const Vector3 absMax = ent->absMax;
-    int32_t num = gi.BoxEdicts( &absMin, &absMax, touchedEdicts, MAX_EDICTS, AREA_SOLID );
+    int32_t num = gi.BoxEdicts( &absMin, &absMax, touchedEdicts, maxCount, AREA_SOLID );
     
     for ( int32_t i = 0; i < num; i++ ) {
         #if 0
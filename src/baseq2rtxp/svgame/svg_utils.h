@@ -90,6 +90,17 @@ static inline const svg_trace_t SVG_Trace( const Vector3 &start, const Vector3 &
 	return gi.trace( _start, _mins, _maxs, _end, passEdict, contentMask );
 }
 /**
+*	@brief	Wrapper for gi.lagtrace that accepts Vector3 args. Use for hitscan shots fired
+*			by clients, so they hit what the shooter was aiming at on their screen.
+**/
+static inline const svg_trace_t SVG_LagTrace( const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, svg_base_edict_t *passEdict, const cm_contents_t contentMask ) {
+	const Vector3 *_mins = ( ( &mins != &qm_vector3_null || mins != qm_vector3_null || mins != vec3_origin ) ? &mins : nullptr );
+	const Vector3 *_maxs = ( ( &maxs != &qm_vector3_null || maxs != qm_vector3_null || maxs != vec3_origin ) ? &maxs : nullptr );
+	const Vector3 *_start = ( ( &start != &qm_vector3_null || start != qm_vector3_null || start != vec3_origin ) ? &start : nullptr );
+	const Vector3 *_end = ( ( &end != &qm_vector3_null || end != qm_vector3_null || end != vec3_origin ) ? &end : nullptr );
+	return gi.lagtrace( _start, _mins, _maxs, _end, passEdict, contentMask );
+}
+/**
 *	@brief	Wrapper for gi.clipthat accepts Vector3 args.
 **/
 static inline const svg_trace_t SVG_Clip( svg_base_edict_t *clipEdict, const Vector3 &start, const Vector3 &mins, const Vector3 &maxs, const Vector3 &end, const cm_contents_t contentMask ) {
@@ -134,10 +145,15 @@ void SVG_Util_ProjectSource( const vec3_t point, const vec3_t distance, const ve
 *
 **/
 /**
-*   @brief
+*   @brief  Dispatches the touch callbacks of all triggers 'ent' is in.
 **/
 void SVG_Util_TouchTriggers( svg_base_edict_t *ent );
 /**
+*   @brief  Same as calling SVG_Util_TouchTriggers for each of the 'count' entities in order,
+*           sharing a single query buffer between them.
+**/
+void SVG_Util_TouchTriggersBatch( svg_base_edict_t **ents, const int32_t count );
+/**
 *   @brief  Scan for projectiles between our movement positions
 *           to see if we need to collide against them.
 **/
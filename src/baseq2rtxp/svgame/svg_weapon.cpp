@@ -294,8 +294,8 @@ static void fire_lead(svg_base_edict_t *self, const Vector3 &start, const Vector
             content_mask = static_cast<cm_contents_t>( content_mask & ~CM_CONTENTMASK_LIQUID ); // content_mask &= ~CM_CONTENTMASK_LIQUID
         }
 
-		// Trace the bullet.
-        tr = SVG_Trace(start, qm_vector3_null, qm_vector3_null, &end.x, self, content_mask);
+		// Trace the bullet, against players and monsters where the shooter saw them.
+        tr = SVG_LagTrace(start, qm_vector3_null, qm_vector3_null, &end.x, self, content_mask);
 
         // See if we hit water.
         if ( tr.contents & CM_CONTENTMASK_LIQUID ) {
@@ -344,7 +344,7 @@ static void fire_lead(svg_base_edict_t *self, const Vector3 &start, const Vector
             }
 
             // re-trace ignoring water this time
-            tr = SVG_Trace( &water_start.x, qm_vector3_null, qm_vector3_null, &end.x, self, CM_CONTENTMASK_SHOT );
+            tr = SVG_LagTrace( &water_start.x, qm_vector3_null, qm_vector3_null, &end.x, self, CM_CONTENTMASK_SHOT );
         }
     }
 
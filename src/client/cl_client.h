@@ -292,15 +292,17 @@ typedef struct client_static_s {
 		uint64_t	frames_dropped;     // number of svc_frames that didn't fit
 		uint64_t	others_dropped;     // number of misc svc_* messages that didn't fit
 		uint64_t	frames_read;        // number of frames read from demo file
-		uint64_t	last_snapshot;      // number of demo frame the last snapshot was saved
+		int64_t		last_snapshot;      // number of demo frame the last snapshot was saved
         int64_t     file_size;
         int64_t     file_offset;
         float       file_progress;
         sizebuf_t   buffer;
-        list_t      snapshots;
+        struct demosnap_s   **snapshots;    // sorted by frame number
+        int         numsnapshots;
         qboolean    paused;
         qboolean    seeking;
         qboolean    eof;
+        qboolean    mvd;                // playing back a server recorded multi view demo
     } demo;
     //! Time Demo:
     struct {
@@ -621,6 +623,14 @@ void CL_FirstDemoFrame(void);
 void CL_Stop_f(void);
 demoInfo_t *CL_GetDemoInfo(const char *path, demoInfo_t *info);
 
+//
+// mvd.cpp
+//
+void CL_MVD_Init(void);
+void CL_MVD_Begin(void);
+void CL_MVD_End(void);
+void CL_MVD_TranscodeMessage(void);
+
 
 
 //
@@ -22,6 +22,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #include "cl_client.h"
 #include "common/collisionmodel.h"
+#include "common/intreadwrite.h"
 
 #define CS_BITMAP_LONGS         (CS_BITMAP_BYTES / 4)
 
@@ -607,23 +608,20 @@ static int read_first_message(qhandle_t f)
     }
 
     // determine demo type
-    //if (ul == MVD_MAGIC) {
-    //    read = FS_Read(&us, 2, f);
-    //    if (read != 2) {
-    //        return read < 0 ? read : Q_ERR_UNEXPECTED_EOF;
-    //    }
-    //    if (!us) {
-    //        return Q_ERR_UNEXPECTED_EOF;
-    //    }
-    //    msglen = LittleShort(us);
-    //    type = 1;
-    //} else {
-        if (ul == (uint32_t)-1) {
-            return Q_ERR_UNEXPECTED_EOF;
+    if (ul == MVD_MAGIC) {
+        // multi view demos use the same framing after the magic
+        read = FS_Read(&ul, 4, f);
+        if (read != 4) {
+            return read < 0 ? read : Q_ERR_UNEXPECTED_EOF;
         }
-        msglen = LittleLong(ul);
+        type = 1;
+    } else {
         type = 0;
-    //}
+    }
+    if (ul == (uint32_t)-1) {
+        return Q_ERR_UNEXPECTED_EOF;
+    }
+    msglen = LittleLong(ul);
 
     // if (msglen < 64 || msglen > sizeof(msg_read_buffer)) {
     if (msglen > sizeof(msg_read_buffer)) {
@@ -731,6 +729,10 @@ static int parse_next_message(int wait)
         return -1;
     }
 
+    if (cls.demo.mvd) {
+        CL_MVD_TranscodeMessage();
+    }
+
     CL_ParseServerMessage();
 
     // if recording demo, write the message out
@@ -744,6 +746,21 @@ static int parse_next_message(int wait)
     return 0;
 }
 
+// keyframe index of the demo being played, see load_demo_index
+static char demo_index_path[MAX_OSPATH];
+
+static void set_index_path(const char *name)
+{
+    size_t len = Q_strlcpy(demo_index_path, name, sizeof(demo_index_path));
+
+    // shared by the plain and compressed version of a demo
+    if (len > 3 && !Q_stricmp(demo_index_path + len - 3, ".gz"))
+        demo_index_path[len - 3] = 0;
+
+    if (Q_strlcat(demo_index_path, ".idx", sizeof(demo_index_path)) >= sizeof(demo_index_path))
+        demo_index_path[0] = 0;
+}
+
 /*
 ====================
 CL_PlayDemo_f
@@ -773,19 +790,15 @@ static void CL_PlayDemo_f(void)
         return;
     }
 
-    if (type == 1) {
-        Com_Printf("MVD support was not compiled in.\n");
-        FS_CloseFile(f);
-        return;
-    }
-
     // if running a local server, kill it and reissue
     SV_Shutdown("Server was killed.\n", ERR_DISCONNECT);
 
     CL_Disconnect(ERR_RECONNECT);
 
     cls.demo.playback = f;
+    cls.demo.mvd = (type == 1);
     cls.state = ca_connected;
+    set_index_path(name);
     Q_strlcpy(cls.servername, COM_SkipPath(name), sizeof(cls.servername));
     cls.serverAddress.type = NA_LOOPBACK;
 
@@ -793,6 +806,10 @@ static void CL_PlayDemo_f(void)
     SCR_UpdateScreen();
 
     // parse the first message just read
+    if (cls.demo.mvd) {
+        CL_MVD_Begin();
+        CL_MVD_TranscodeMessage();
+    }
     CL_ParseServerMessage();
 
     // read and parse messages util `precache' command
@@ -805,18 +822,25 @@ static void CL_PlayDemo_f(void)
 static void CL_Demo_c(genctx_t *ctx, int argnum)
 {
     if (argnum == 1) {
-        FS_File_g("demos", "*.dm2;*.dm2.gz", FS_SEARCH_SAVEPATH | FS_SEARCH_BYFILTER, ctx);
+        FS_File_g("demos", "*.dm2;*.dm2.gz;*.mvd2;*.mvd2.gz", FS_SEARCH_SAVEPATH | FS_SEARCH_BYFILTER, ctx);
     }
 }
 
-typedef struct {
-    list_t entry;
+typedef struct demosnap_s {
     int framenum;
     int64_t filepos;
     size_t msglen;
     byte data[1];
 } demosnap_t;
 
+static void add_snapshot(demosnap_t *snap)
+{
+    if (!(cls.demo.numsnapshots & 63)) {
+        cls.demo.snapshots = static_cast<demosnap_t **>( Z_Realloc(cls.demo.snapshots, sizeof(demosnap_t *) * (cls.demo.numsnapshots + 64)) );
+    }
+    cls.demo.snapshots[cls.demo.numsnapshots++] = snap;
+}
+
 /*
 ====================
 CL_EmitDemoSnapshot
@@ -837,7 +861,11 @@ void CL_EmitDemoSnapshot(void)
     if (cl_demosnaps->integer <= 0)
         return;
 
-    if (cls.demo.frames_read < cls.demo.last_snapshot + cl_demosnaps->integer * BASE_FRAMETIME)
+    // the multi view decoder state can't be rewound
+    if (cls.demo.mvd)
+        return;
+
+    if ((int64_t)cls.demo.frames_read < cls.demo.last_snapshot + cl_demosnaps->integer * BASE_FRAMETIME)
         return;
 
     if (!cl.frame.valid)
@@ -891,7 +919,7 @@ void CL_EmitDemoSnapshot(void)
     snap->filepos = pos;
     snap->msglen = msg_write.cursize;
     memcpy(snap->data, msg_write.data, msg_write.cursize);
-    List_Append(&cls.demo.snapshots, &snap->entry);
+    add_snapshot(snap);
 
     Com_DPrintf("[%d] snaplen %zu\n", cls.demo.frames_read, msg_write.cursize);
 
@@ -900,22 +928,149 @@ void CL_EmitDemoSnapshot(void)
     cls.demo.last_snapshot = cls.demo.frames_read;
 }
 
-static demosnap_t *find_snapshot(int framenum)
+// returns the last snapshot at or before framenum, or the first one
+static demosnap_t *find_snapshot(int64_t framenum)
 {
-    demosnap_t *snap, *prev;
+    int lo = 0, hi = cls.demo.numsnapshots;
 
-    if (LIST_EMPTY(&cls.demo.snapshots))
+    if (!cls.demo.numsnapshots)
         return NULL;
 
-    prev = LIST_FIRST(demosnap_t, &cls.demo.snapshots, entry);
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cls.demo.snapshots[mid]->framenum > framenum)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return cls.demo.snapshots[lo ? lo - 1 : 0];
+}
+
+/*
+=======================================================================
+
+DEMO INDEX
+
+Snapshots saved to a file next to the demo, so seeking doesn't have to
+parse the whole demo up to the destination first. Loaded when playback
+starts, written by the demo_index command.
+
+=======================================================================
+*/
+
+#define DEMO_INDEX_MAGIC    MakeLittleLong('D','I','D','X')
+#define DEMO_INDEX_VERSION  1
+
+/*
+====================
+load_demo_index
+
+Loads snapshots from the index of the demo being played, if it has one
+that was made for this very file.
+====================
+*/
+static void load_demo_index(void)
+{
+    byte header[24];
+    demosnap_t *snap;
+    qhandle_t f;
+    uint32_t i, count, msglen;
+    int64_t len;
+
+    if (!demo_index_path[0] || cls.demo.numsnapshots)
+        return;
+
+    FS_OpenFile(demo_index_path, &f, FS_MODE_READ | FS_FLAG_GZIP);
+    if (!f)
+        return;
+
+    len = FS_Length(cls.demo.playback);
+    if (FS_Read(header, 24, f) != 24 || RL32(header) != DEMO_INDEX_MAGIC ||
+        RL32(header + 4) != DEMO_INDEX_VERSION || RL32(header + 8) != PROTOCOL_VERSION_Q2RTXPERIMENTAL ||
+        (int64_t)RL64(header + 12) != len) {
+        Com_DPrintf("Ignoring stale demo index %s\n", demo_index_path);
+        FS_CloseFile(f);
+        return;
+    }
+
+    count = RL32(header + 20);
+    for (i = 0; i < count; i++) {
+        if (FS_Read(header, 16, f) != 16)
+            break;
+        msglen = RL32(header + 12);
+        if (msglen > MAX_MSGLEN)
+            break;
 
-    LIST_FOR_EACH(demosnap_t, snap, &cls.demo.snapshots, entry) {
-        if (snap->framenum > framenum)
+        snap = static_cast<demosnap_t *>( Z_Malloc(sizeof(*snap) + msglen - 1) );
+        snap->framenum = RL32(header);
+        snap->filepos = RL64(header + 4);
+        snap->msglen = msglen;
+        if (FS_Read(snap->data, msglen, f) != msglen ||
+            (cls.demo.numsnapshots && snap->framenum <= cls.demo.snapshots[cls.demo.numsnapshots - 1]->framenum)) {
+            Z_Free(snap);
             break;
-        prev = snap;
+        }
+        add_snapshot(snap);
+    }
+
+    FS_CloseFile(f);
+
+    if (i < count) {
+        Com_WPrintf("Demo index %s is damaged, ignoring it.\n", demo_index_path);
+        for (i = 0; i < cls.demo.numsnapshots; i++)
+            Z_Free(cls.demo.snapshots[i]);
+        cls.demo.numsnapshots = 0;
+        return;
     }
 
-    return prev;
+    if (cls.demo.numsnapshots) {
+        // playback saves snapshots again past the indexed ones only
+        cls.demo.last_snapshot = cls.demo.snapshots[cls.demo.numsnapshots - 1]->framenum;
+        Com_DPrintf("Loaded %d snapshots from %s\n", cls.demo.numsnapshots, demo_index_path);
+    }
+}
+
+static bool write_demo_index(void)
+{
+    byte header[24];
+    demosnap_t *snap;
+    qhandle_t f;
+    int i, ret;
+
+    ret = FS_OpenFile(demo_index_path, &f, FS_MODE_WRITE | FS_FLAG_GZIP);
+    if (!f) {
+        Com_EPrintf("Couldn't open %s: %s\n", demo_index_path, Q_ErrorString(ret));
+        return false;
+    }
+
+    WL32(header, DEMO_INDEX_MAGIC);
+    WL32(header + 4, DEMO_INDEX_VERSION);
+    WL32(header + 8, PROTOCOL_VERSION_Q2RTXPERIMENTAL);
+    WL64(header + 12, FS_Length(cls.demo.playback));
+    WL32(header + 20, cls.demo.numsnapshots);
+    ret = FS_Write(header, 24, f);
+
+    for (i = 0; i < cls.demo.numsnapshots && ret >= 0; i++) {
+        snap = cls.demo.snapshots[i];
+        WL32(header, snap->framenum);
+        WL64(header + 4, snap->filepos);
+        WL32(header + 12, snap->msglen);
+        ret = FS_Write(header, 16, f);
+        if (ret >= 0)
+            ret = FS_Write(snap->data, snap->msglen, f);
+    }
+
+    if (ret >= 0)
+        ret = FS_CloseFile(f);
+    else
+        FS_CloseFile(f);
+
+    if (ret < 0) {
+        Com_EPrintf("Couldn't write %s: %s\n", demo_index_path, Q_ErrorString(ret));
+        return false;
+    }
+    return true;
 }
 
 /*
@@ -956,54 +1111,29 @@ void CL_FirstDemoFrame(void)
 
     // force initial snapshot
     cls.demo.last_snapshot = INT_MIN;
+
+    // or start with the saved ones
+    load_demo_index();
 }
 
-static void CL_Seek_f(void)
+/*
+====================
+seek_demo
+
+Moves playback to demo frame 'dest', starting from the closest snapshot
+if that saves parsing. Stays at the last frame instead of finishing the
+demo if 'stopAtEnd' is set. Returns false if the demo was finished.
+====================
+*/
+static bool seek_demo(int64_t dest, bool stopAtEnd)
 {
     demosnap_t *snap;
-    int i, j, ret, index, frames, dest, prev;
+    int i, j, ret, index;
+    int64_t frames, prev;
     const char *from; // WID: C++20: Added const.
     char *to;
 
-    if ( Cmd_Argc() < 2 ) {
-        Com_Printf( "Usage: %s [+-]<timespec>\n", Cmd_Argv( 0 ) );
-        return;
-    }
-
-    if ( !cls.demo.playback ) {
-        Com_Printf( "Not playing a demo.\n" );
-        return;
-    }
-
-    to = Cmd_Argv( 1 );
-
-    if ( *to == '-' || *to == '+' ) {
-        // relative to current frame
-        if ( !Com_ParseTimespec( to + 1, &frames ) ) {
-            Com_Printf( "Invalid relative timespec.\n" );
-            return;
-        }
-        if ( *to == '-' )
-            frames = -frames;
-        dest = cls.demo.frames_read + frames;
-    } else {
-        // relative to first frame
-        if ( !Com_ParseTimespec( to, &dest ) ) {
-            Com_Printf( "Invalid absolute timespec.\n" );
-            return;
-        }
-        frames = dest - cls.demo.frames_read;
-    }
-
-    if ( !frames ) {
-        // already there
-        return;
-    }
-
-    if ( frames > 0 && cls.demo.eof && cl_demowait->integer ) {
-        // already at end
-        return;
-    }
+    frames = dest - (int64_t)cls.demo.frames_read;
 
     // disable effects processing
     cls.demo.seeking = true;
@@ -1017,59 +1147,63 @@ static void CL_Seek_f(void)
     // save previous server frame number
     prev = cl.frame.number;
 
-    Com_DPrintf( "[%d] seeking to %d\n", cls.demo.frames_read, dest );
-
-    // seek to the previous most recent snapshot
-    if ( frames < 0 || cls.demo.last_snapshot > cls.demo.frames_read ) {
-        snap = find_snapshot( dest );
+    Com_DPrintf( "[%d] seeking to %" PRId64 "\n", cls.demo.frames_read, dest );
 
-        if ( snap ) {
-            Com_DPrintf( "found snap at %d\n", snap->framenum );
-            ret = FS_Seek( cls.demo.playback, snap->filepos, SEEK_SET );
-            if ( ret < 0 ) {
-                Com_EPrintf( "Couldn't seek demo: %s\n", Q_ErrorString( ret ) );
-                goto done;
-            }
+    // seek to the previous most recent snapshot, when going backward
+    // or when it is ahead of the current position
+    snap = find_snapshot( dest );
+    if ( snap && frames > 0 && ( snap->framenum <= (int64_t)cls.demo.frames_read || snap->framenum > dest ) ) {
+        snap = NULL;
+    }
+    if ( snap ) {
+        Com_DPrintf( "found snap at %d\n", snap->framenum );
+        ret = FS_Seek( cls.demo.playback, snap->filepos, SEEK_SET );
+        if ( ret < 0 ) {
+            Com_EPrintf( "Couldn't seek demo: %s\n", Q_ErrorString( ret ) );
+            goto done;
+        }
 
-            // clear end-of-file flag
-            cls.demo.eof = false;
+        // clear end-of-file flag
+        cls.demo.eof = false;
 
-            // reset configstrings
-            for ( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
-                from = cl.baseconfigstrings[ i ];
-                to = cl.configstrings[ i ];
+        // reset configstrings
+        for ( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+            from = cl.baseconfigstrings[ i ];
+            to = cl.configstrings[ i ];
 
-                if ( !strcmp( from, to ) )
-                    continue;
+            if ( !strcmp( from, to ) )
+                continue;
 
-                Q_SetBit( cl.dcs, i );
-                strcpy( to, from );
-            }
+            Q_SetBit( cl.dcs, i );
+            strcpy( to, from );
+        }
 
-            SZ_Init( &msg_read, snap->data, snap->msglen );
-            msg_read.cursize = snap->msglen;
+        SZ_Init( &msg_read, snap->data, snap->msglen );
+        msg_read.cursize = snap->msglen;
 
-            CL_SeekDemoMessage();
-            cls.demo.frames_read = snap->framenum;
-            Com_DPrintf( "[%d] after snap parse %d\n", cls.demo.frames_read, cl.frame.number );
-        } else if ( frames < 0 ) {
-            Com_Printf( "Couldn't seek backwards without snapshots!\n" );
-            goto done;
-        }
+        CL_SeekDemoMessage();
+        cls.demo.frames_read = snap->framenum;
+        Com_DPrintf( "[%d] after snap parse %d\n", cls.demo.frames_read, cl.frame.number );
+    } else if ( frames < 0 ) {
+        Com_Printf( "Couldn't seek backwards without snapshots!\n" );
+        goto done;
     }
 
     // skip forward to destination frame
-    while ( cls.demo.frames_read < dest ) {
+    while ( (int64_t)cls.demo.frames_read < dest ) {
         ret = read_next_message( cls.demo.playback );
-        if ( ret == 0 && cl_demowait->integer ) {
+        if ( ret == 0 && stopAtEnd ) {
             cls.demo.eof = true;
             break;
         }
         if ( ret <= 0 ) {
             finish_demo( ret );
-            return;
+            return false;
         }
 
+        if ( cls.demo.mvd ) {
+            CL_MVD_TranscodeMessage();
+        }
         CL_SeekDemoMessage();
         CL_EmitDemoSnapshot();
     }
@@ -1115,6 +1249,99 @@ static void CL_Seek_f(void)
 
 done:
     cls.demo.seeking = false;
+    return true;
+}
+
+static void CL_Seek_f(void)
+{
+    int frames, dest;
+    char *to;
+
+    if ( Cmd_Argc() < 2 ) {
+        Com_Printf( "Usage: %s [+-]<timespec>\n", Cmd_Argv( 0 ) );
+        return;
+    }
+
+    if ( !cls.demo.playback ) {
+        Com_Printf( "Not playing a demo.\n" );
+        return;
+    }
+
+    to = Cmd_Argv( 1 );
+
+    if ( *to == '-' || *to == '+' ) {
+        // relative to current frame
+        if ( !Com_ParseTimespec( to + 1, &frames ) ) {
+            Com_Printf( "Invalid relative timespec.\n" );
+            return;
+        }
+        if ( *to == '-' )
+            frames = -frames;
+        dest = cls.demo.frames_read + frames;
+    } else {
+        // relative to first frame
+        if ( !Com_ParseTimespec( to, &dest ) ) {
+            Com_Printf( "Invalid absolute timespec.\n" );
+            return;
+        }
+        frames = dest - cls.demo.frames_read;
+    }
+
+    if ( !frames ) {
+        // already there
+        return;
+    }
+
+    if ( frames > 0 && cls.demo.eof && cl_demowait->integer ) {
+        // already at end
+        return;
+    }
+
+    seek_demo( dest, cl_demowait->integer );
+}
+
+/*
+====================
+CL_DemoIndex_f
+
+Runs through the rest of the demo saving snapshots, writes them all to
+the index file and goes back to where playback was.
+====================
+*/
+static void CL_DemoIndex_f(void)
+{
+    int64_t start;
+
+    if ( !cls.demo.playback || cls.state != ca_active ) {
+        Com_Printf( "Not playing a demo.\n" );
+        return;
+    }
+
+    if ( cls.demo.mvd ) {
+        Com_Printf( "Multi view demos can't be indexed.\n" );
+        return;
+    }
+
+    if ( cl_demosnaps->integer <= 0 || !cls.demo.file_size ) {
+        Com_Printf( "Demo snapshots are disabled, set cl_demosnaps.\n" );
+        return;
+    }
+
+    if ( !demo_index_path[ 0 ] ) {
+        Com_Printf( "Demo path is too long to index.\n" );
+        return;
+    }
+
+    start = cls.demo.frames_read;
+    if ( !cls.demo.eof && !seek_demo( INT64_MAX, true ) ) {
+        return;
+    }
+
+    if ( write_demo_index() ) {
+        Com_Printf( "Wrote %d snapshots to %s.\n", cls.demo.numsnapshots, demo_index_path );
+    }
+
+    seek_demo( start, true );
 }
 
 static void parse_info_string(demoInfo_t *info, int clientNum, int index, const char *string)
@@ -1156,6 +1383,9 @@ demoInfo_t *CL_GetDemoInfo(const char *path, demoInfo_t *info)
         goto fail;
     }
 
+    if (type == 1 && MSG_ReadUint8() != mvd_gamestate) {
+        goto fail;
+    }
     if (MSG_ReadUint8() != svc_serverdata) {
         goto fail;
     }
@@ -1164,6 +1394,11 @@ demoInfo_t *CL_GetDemoInfo(const char *path, demoInfo_t *info)
     }
     MSG_ReadInt32();
     MSG_ReadUint8();
+    if (type == 1) {
+        // recorded by the server, which writes the gamemode as well
+        MSG_ReadUint8();
+        info->mvd = true;
+    }
     MSG_ReadString(NULL, 0);
     clientNum = MSG_ReadInt16();
     MSG_ReadString(NULL, 0);
@@ -1200,8 +1435,8 @@ fail:
 
 void CL_CleanupDemos(void)
 {
-    demosnap_t *snap, *next;
     size_t total;
+    int i;
 
     if (cls.demo.recording) {
         CL_Stop_f();
@@ -1210,6 +1445,10 @@ void CL_CleanupDemos(void)
     if (cls.demo.playback) {
         FS_CloseFile(cls.demo.playback);
 
+        if (cls.demo.mvd) {
+            CL_MVD_End();
+        }
+
         if (com_timedemo->integer && cls.demo.time_frames) {
             unsigned msec = Sys_Milliseconds();
 
@@ -1238,17 +1477,16 @@ void CL_CleanupDemos(void)
     }
 
     total = 0;
-    LIST_FOR_EACH_SAFE(demosnap_t, snap, next, &cls.demo.snapshots, entry) {
-        total += snap->msglen;
-        Z_Free(snap);
+    for (i = 0; i < cls.demo.numsnapshots; i++) {
+        total += cls.demo.snapshots[i]->msglen;
+        Z_Free(cls.demo.snapshots[i]);
     }
+    Z_Free(cls.demo.snapshots);
 
     if (total)
         Com_DPrintf("Freed %zu bytes of snaps\n", total);
 
     memset(&cls.demo, 0, sizeof(cls.demo));
-
-    List_Init(&cls.demo.snapshots);
 }
 
 /*
@@ -1297,6 +1535,7 @@ static const cmdreg_t c_demo[] = {
     { "stop", CL_Stop_f },
     { "suspend", CL_Suspend_f },
     { "seek", CL_Seek_f },
+    { "demo_index", CL_DemoIndex_f },
 
     { NULL }
 };
@@ -1311,9 +1550,9 @@ void CL_InitDemos(void)
     cl_demosnaps = Cvar_Get("cl_demosnaps", std::to_string(BASE_FRAMERATE).c_str(), 0 );
     cl_demomsglen = Cvar_Get("cl_demomsglen", va("%d", MAX_PACKETLEN_WRITABLE_DEFAULT), 0);
     cl_demowait = Cvar_Get("cl_demowait", "0", 0);
+    CL_MVD_Init();
 
     Cmd_Register(c_demo);
-    List_Init(&cls.demo.snapshots);
 }
 
 
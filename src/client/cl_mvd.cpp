@@ -0,0 +1,362 @@
+//
+// cl_mvd.cpp - multi view demo playback
+//
+// Server recorded demos (see server/sv_mvd.cpp) hold every entity and the
+// player state of every player. Each block read from the file is turned
+// into a regular demo message for one point of view before it is parsed,
+// so the rest of the client doesn't know the difference: gamestate and
+// multicast records pass through, unicasts pass for the point of view
+// only, and frame records are decoded and emitted as svc_frame deltas.
+//
+
+#include "cl_client.h"
+#include "common/collisionmodel.h"
+
+static cvar_t   *cl_mvdpov;
+
+static struct {
+    // decoded state of the last frame record, entities that aren't
+    // part of it have a number of 0
+    entity_state_t  *entities;
+    player_state_t  players[MAX_CLIENTS];
+    bool            present[MAX_CLIENTS];
+
+    // state of the last emitted svc_frame, as the client has it
+    entity_state_t  *emitted;
+    player_state_t  emittedPs;
+    int             pov;
+    int64_t         lastFrame;
+
+    // portal states that came with the first frame record
+    byte            portalBits[MAX_MAP_PORTAL_BYTES];
+    int             numPortalBits;
+} cl_mvd;
+
+/*
+====================
+CL_MVD_Begin
+
+Resets the decoder, called when a multi view demo starts playing.
+====================
+*/
+void CL_MVD_Begin(void)
+{
+    if (!cl_mvd.entities) {
+        cl_mvd.entities = static_cast<entity_state_t *>( Z_Malloc( sizeof( entity_state_t ) * MAX_PACKET_ENTITIES ) );
+        cl_mvd.emitted = static_cast<entity_state_t *>( Z_Malloc( sizeof( entity_state_t ) * MAX_PACKET_ENTITIES ) );
+    }
+    memset(cl_mvd.entities, 0, sizeof(entity_state_t) * MAX_PACKET_ENTITIES);
+    memset(cl_mvd.emitted, 0, sizeof(entity_state_t) * MAX_PACKET_ENTITIES);
+    memset(cl_mvd.present, 0, sizeof(cl_mvd.present));
+    cl_mvd.pov = -1;
+    cl_mvd.lastFrame = -1;
+    cl_mvd.numPortalBits = -1;
+}
+
+/*
+====================
+CL_MVD_End
+
+Frees the decoder state.
+====================
+*/
+void CL_MVD_End(void)
+{
+    Z_Freep((void **)&cl_mvd.entities);
+    Z_Freep((void **)&cl_mvd.emitted);
+}
+
+/*
+====================
+parse_frame_record
+
+Applies a frame record to the decoded state.
+====================
+*/
+static int64_t parse_frame_record(void)
+{
+    int64_t framenum = MSG_ReadIntBase128();
+    int i, count, slot, number;
+    bool present[MAX_CLIENTS] = {};
+    bool remove;
+    uint64_t bits;
+    entity_state_t old;
+    byte *data;
+
+    count = MSG_ReadUint8();
+    if (count) {
+        data = MSG_ReadData(count);
+        if (!data || count > MAX_MAP_PORTAL_BYTES) {
+            Com_Error(ERR_DROP, "%s: bad portalbits", __func__);
+        }
+        memcpy(cl_mvd.portalBits, data, count);
+        cl_mvd.numPortalBits = count;
+    }
+
+    count = MSG_ReadUint16();
+    for (i = 0; i < count; i++) {
+        slot = MSG_ReadUint8();
+        if (slot < 0 || slot >= MAX_CLIENTS) {
+            Com_Error(ERR_DROP, "%s: bad player slot: %d", __func__, slot);
+        }
+        bits = MSG_ReadUintBase128();
+        MSG_ParseDeltaPlayerstate(cl_mvd.present[slot] ? &cl_mvd.players[slot] : NULL, &cl_mvd.players[slot], bits);
+        present[slot] = true;
+    }
+    memcpy(cl_mvd.present, present, sizeof(cl_mvd.present));
+
+    const int32_t tempEntityOffset = clge->GetTempEventEntityTypeOffset();
+
+    while (1) {
+        number = MSG_ReadEntityNumber(&remove, &bits);
+        if (number < 0 || number >= MAX_PACKET_ENTITIES) {
+            Com_Error(ERR_DROP, "%s: bad number: %d", __func__, number);
+        }
+        if (msg_read.readcount > msg_read.cursize) {
+            Com_Error(ERR_DROP, "%s: read past end of message", __func__);
+        }
+        if (!number) {
+            break;
+        }
+
+        entity_state_t *state = &cl_mvd.entities[number];
+        if (remove) {
+            state->number = 0;
+            continue;
+        }
+
+        // new entities are deltas from their baseline
+        old = state->number ? *state : cl.baselines[number];
+        MSG_ParseDeltaEntity(&old, state, number, bits, cl.esFlags, tempEntityOffset);
+
+        // shuffle previous origin to old, like CL_ParseDeltaEntity
+        if (!(bits & U_OLDORIGIN) && !(state->renderfx & RF_BEAM) && state->entityType != ET_BEAM) {
+            VectorCopy(old.origin, state->old_origin);
+        }
+    }
+
+    return framenum;
+}
+
+/*
+====================
+choose_pov
+
+Follows cl_mvdpov if that player is in game, otherwise sticks with the
+current point of view, or falls back to the first player in game.
+====================
+*/
+static int choose_pov(void)
+{
+    int i, pov = cl_mvdpov->integer;
+
+    if (pov >= 0 && pov < MAX_CLIENTS && cl_mvd.present[pov])
+        return pov;
+    if (cl_mvd.pov >= 0 && cl_mvd.present[cl_mvd.pov])
+        return cl_mvd.pov;
+    if (cl_mvd.pov < 0 && cl.clientNumber >= 0 && cl.clientNumber < MAX_CLIENTS && cl_mvd.present[cl.clientNumber])
+        return cl.clientNumber;
+
+    for (i = 0; i < MAX_CLIENTS; i++) {
+        if (cl_mvd.present[i])
+            return i;
+    }
+    return -1;
+}
+
+/*
+====================
+emit_pov_entities
+
+Writes a delta of the decoded entities, as seen from the point of view,
+against what the last emitted frame had. Entities that don't fit keep
+their old state and are caught up on the next frame.
+====================
+*/
+static void emit_pov_entities(const player_state_t *ps)
+{
+    const int32_t tempEntityOffset = clge->GetTempEventEntityTypeOffset();
+    const int clientEntity = cl_mvd.pov + 1;
+    int i;
+
+    for (i = 1; i < MAX_PACKET_ENTITIES; i++) {
+        entity_state_t *oldent = &cl_mvd.emitted[i];
+        entity_state_t newent = cl_mvd.entities[i];
+
+        if (!newent.number && !oldent->number)
+            continue;
+
+        if (msg_write.cursize + MAX_PACKETENTITY_BYTES > msg_write.maxsize - 16)
+            continue;
+
+        if (!newent.number) {
+            MSG_WriteDeltaEntity(oldent, NULL, MSG_ES_FORCE, tempEntityOffset);
+            oldent->number = 0;
+            continue;
+        }
+
+        // same adjustments SV_BuildClientFrame makes for its client
+        if (i == clientEntity) {
+            encoded_skinnum_t skinnum = static_cast<encoded_skinnum_t>( newent.skinnum );
+            if (skinnum.clientNumber != ps->clientNumber) {
+                skinnum.clientNumber = ps->clientNumber;
+                newent.skinnum = skinnum.skinnum;
+            }
+        } else if (i == ps->clientNumber + 1) {
+            // hide the model of the player being chased
+            newent.modelindex = 0;
+        }
+        if (newent.ownerNumber == clientEntity) {
+            newent.solid = SOLID_NOT;
+        }
+
+        if (oldent->number) {
+            MSG_WriteDeltaEntity(oldent, &newent, i <= cl.maxclients ? MSG_ES_NEWENTITY : MSG_ES_NONE, tempEntityOffset);
+        } else {
+            MSG_WriteDeltaEntity(&cl.baselines[i], &newent, static_cast<msgEsFlags_t>( MSG_ES_FORCE | MSG_ES_NEWENTITY ), tempEntityOffset);
+        }
+        *oldent = newent;
+    }
+
+    MSG_WriteInt16(0);
+}
+
+/*
+====================
+emit_pov_frame
+
+Writes the decoded frame as a svc_frame for the point of view. Switching
+to another player starts over with an uncompressed frame.
+====================
+*/
+static void emit_pov_frame(int64_t framenum)
+{
+    byte areabits[MAX_MAP_AREA_BYTES];
+    byte portalBits[MAX_MAP_PORTAL_BYTES];
+    int pov, areabytes, numPortalBits;
+    bool nodelta;
+
+    pov = choose_pov();
+    if (pov < 0) {
+        // nobody to watch
+        return;
+    }
+
+    nodelta = (pov != cl_mvd.pov || cl_mvd.lastFrame < 0);
+    if (pov != cl_mvd.pov) {
+        if (cl_mvd.pov >= 0)
+            Com_Printf("Watching player %d.\n", pov);
+        cl_mvd.pov = pov;
+        cl.clientNumber = pov;
+    }
+    if (nodelta) {
+        memset(cl_mvd.emitted, 0, sizeof(entity_state_t) * MAX_PACKET_ENTITIES);
+    }
+
+    // frame 0 can't be used, see CL_EmitDemoFrame
+    framenum++;
+
+    const player_state_t *ps = &cl_mvd.players[pov];
+    Vector3 viewOrigin = ps->pmove.origin + ps->viewoffset;
+    viewOrigin.z += ps->pmove.viewheight;
+
+    MSG_WriteUint8(svc_frame);
+    MSG_WriteIntBase128(framenum);
+    MSG_WriteIntBase128(nodelta ? -1 : cl_mvd.lastFrame);
+    MSG_WriteUint8(0);
+
+    areabytes = CM_WriteAreaBits(&cl.collisionModel, areabits, CM_PointLeaf(&cl.collisionModel, &viewOrigin.x)->area);
+    if (!areabytes) {
+        areabits[0] = 255;
+        areabytes = 1;
+    }
+    MSG_WriteUint8(areabytes);
+    MSG_WriteData(areabits, areabytes);
+
+    if (nodelta) {
+        // the recorded portal states go out once, after that the client
+        // has them along with the svc_set_portalbit updates
+        if (cl_mvd.numPortalBits >= 0) {
+            numPortalBits = cl_mvd.numPortalBits;
+            memcpy(portalBits, cl_mvd.portalBits, numPortalBits);
+            cl_mvd.numPortalBits = -1;
+        } else {
+            numPortalBits = CM_WritePortalBits(&cl.collisionModel, portalBits);
+        }
+        MSG_WriteUint8(svc_portalbits);
+        MSG_WriteUint8(numPortalBits);
+        MSG_WriteData(portalBits, numPortalBits);
+    }
+
+    MSG_WriteUint8(svc_playerinfo);
+    MSG_WriteDeltaPlayerstate(nodelta ? NULL : &cl_mvd.emittedPs, ps);
+    cl_mvd.emittedPs = *ps;
+
+    MSG_WriteUint8(svc_packetentities);
+    emit_pov_entities(ps);
+
+    cl_mvd.lastFrame = framenum;
+}
+
+/*
+====================
+CL_MVD_TranscodeMessage
+
+Turns the multi view demo block in msg_read into a regular demo message
+for the current point of view, in place.
+====================
+*/
+void CL_MVD_TranscodeMessage(void)
+{
+    int type, slot, len;
+    byte *data;
+
+    SZ_Clear(&msg_write);
+
+    while (msg_read.readcount < msg_read.cursize) {
+        type = MSG_ReadUint8();
+        switch (type) {
+        case mvd_gamestate:
+            // plain messages up to the end of the block
+            MSG_WriteData(msg_read.data + msg_read.readcount, msg_read.cursize - msg_read.readcount);
+            msg_read.readcount = msg_read.cursize;
+            break;
+        case mvd_unicast:
+        case mvd_multicast:
+            slot = type == mvd_unicast ? MSG_ReadUint8() : -1;
+            len = MSG_ReadUint16();
+            data = MSG_ReadData(len);
+            if (!data) {
+                Com_Error(ERR_DROP, "%s: read past end of message", __func__);
+            }
+            if (slot == -1 || slot == cl_mvd.pov) {
+                MSG_WriteData(data, len);
+            }
+            break;
+        case mvd_frame:
+            emit_pov_frame(parse_frame_record());
+            break;
+        default:
+            Com_Error(ERR_DROP, "%s: bad record type: %d", __func__, type);
+        }
+    }
+
+    if (msg_write.overflowed) {
+        Com_Error(ERR_DROP, "%s: message overflowed", __func__);
+    }
+
+    SZ_Init(&msg_read, msg_read_buffer, sizeof(msg_read_buffer));
+    memcpy(msg_read.data, msg_write.data, msg_write.cursize);
+    msg_read.cursize = msg_write.cursize;
+    SZ_Clear(&msg_write);
+}
+
+/*
+====================
+CL_MVD_Init
+====================
+*/
+void CL_MVD_Init(void)
+{
+    cl_mvdpov = Cvar_Get("cl_mvdpov", "-1", 0);
+}
@@ -311,6 +311,9 @@ static sfxcache_t *AL_UploadSfx(sfx_t *s)
     sc->channels = s_info.channels;
     sc->size = size;
     sc->bufnum = buffer;
+#if USE_SNDDMA
+    sc->stream = NULL;
+#endif
 
     return sc;
 
@@ -435,92 +438,82 @@ static void AL_StopAllSounds(void)
     }
 }
 
-static channel_t *AL_FindLoopingSound(int entnum, sfx_t *sfx)
-{
-    int         i;
-    channel_t   *ch;
-
-    for (i = 0, ch = s_channels; i < s_numchannels; i++, ch++) {
-        if (!ch->autosound)
-            continue;
-        if (entnum && ch->entnum != entnum)
-            continue;
-        if (ch->sfx != sfx)
-            continue;
-        return ch;
-    }
-
-    return NULL;
-}
-
 static void AL_AddLoopSounds(void)
 {
-    int         i;
-    int         sounds[MAX_EDICTS];
-    channel_t   *ch, *ch2;
-    sfx_t       *sfx;
-    sfxcache_t  *sc;
-    int         num;
-    entity_state_t  *ent;
-    vec3_t      origin;
-    float       dist;
+    static channel_t    *loopchannels[MAX_EDICTS];
+    int             indexed[MAX_CHANNELS];
+    int             i, j, k, numindexed;
+    channel_t       *ch, *ch2;
+    sfxcache_t      *sc;
+    loopsound_t     *ls;
+    loopemitter_t   *le;
 
     if (cls.state != ca_active || sv_paused->integer || !s_ambient->integer)
         return;
 
-    S_BuildSoundList(sounds);
+    S_BuildLoopSounds();
 
-    for (i = 0; i < cl.frame.numEntities; i++) {
-        if (!sounds[i])
-            continue;
+    for (i = 0, ls = s_loopsounds; i < s_numloopsounds; i++, ls++) {
+        if (!ls->count)
+            continue;       // bad sound effect, or completely attenuated
 
-        sfx = S_SfxForHandle(cl.sound_precache[sounds[i]]);
-        if (!sfx)
-            continue;       // bad sound effect
-        sc = sfx->cache;
-        if (!sc)
-            continue;
+        sc = ls->sfx->cache;
 
-        num = (cl.frame.firstEntity + i) & PARSE_ENTITIES_MASK;
-        ent = &cl.entityStates[num];
+        // index the playing channels of this sound by entity once, instead
+        // of scanning all channels for every emitter
+        ch2 = NULL;
+        numindexed = 0;
+        for (k = 0, ch = s_channels; k < s_numchannels; k++, ch++) {
+            if (!ch->autosound || ch->sfx != ls->sfx)
+                continue;
+            if (ch->entnum >= 0 && ch->entnum < MAX_EDICTS) {
+                loopchannels[ch->entnum] = ch;
+                indexed[numindexed++] = ch->entnum;
+            }
+            if (!ch2)
+                ch2 = ch;
+        }
+
+        for (j = ls->first; j != -1; j = le->next) {
+            le = &s_loopemitters[j];
+
+            // S_PickChannel may have taken over an indexed channel
+            ch = loopchannels[le->entnum];
+            if (ch && ch->autosound && ch->sfx == ls->sfx && ch->entnum == le->entnum) {
+                ch->autoframe = s_framecount;
+                ch->end = s_paintedtime + sc->length;
+                continue;
+            }
+
+            // allocate a channel
+            ch = S_PickChannel(0, 0);
+            if (!ch)
+                continue;
 
-        ch = AL_FindLoopingSound(ent->number, sfx);
-        if (ch) {
+            // attempt to synchronize with existing sounds of the same type
+            if (ch2 && ch2 != ch && ch2->autosound && ch2->sfx == ls->sfx) {
+                ALfloat offset = 0;
+                qalGetSourcef(ch2->srcnum, AL_SAMPLE_OFFSET, &offset);
+                qalSourcef(s_srcnums[ch - s_channels], AL_SAMPLE_OFFSET, offset);
+            }
+
+            ch->autosound = true;   // remove next frame
             ch->autoframe = s_framecount;
+            ch->sfx = ls->sfx;
+            ch->entnum = le->entnum;
+            ch->master_vol = 1.0f;
+            ch->dist_mult = SOUND_LOOPATTENUATE;
             ch->end = s_paintedtime + sc->length;
-            continue;
-        }
 
-        // check attenuation before playing the sound
-        CL_GetEntitySoundOrigin(ent->number, origin);
-        VectorSubtract(origin, cl.listener_spatialize.origin, origin);
-        dist = VectorNormalize(origin);
-        dist = (dist - SOUND_FULLVOLUME) * SOUND_LOOPATTENUATE;
-        if(dist >= 1.f)
-            continue; // completely attenuated
-        
-        // allocate a channel
-        ch = S_PickChannel(0, 0);
-        if (!ch)
-            continue;
+            AL_PlayChannel(ch);
 
-        // attempt to synchronize with existing sounds of the same type
-        ch2 = AL_FindLoopingSound(0, sfx);
-        if (ch2) {
-            ALfloat offset = 0;
-            qalGetSourcef(ch2->srcnum, AL_SAMPLE_OFFSET, &offset);
-            qalSourcef(s_srcnums[ch - s_channels], AL_SAMPLE_OFFSET, offset);
+            if (!ch2)
+                ch2 = ch;
         }
 
-        ch->autosound = true;   // remove next frame
-        ch->autoframe = s_framecount;
-        ch->sfx = sfx;
-        ch->entnum = ent->number;
-        ch->master_vol = 1.0f;
-        ch->dist_mult = SOUND_LOOPATTENUATE;
-        ch->end = s_paintedtime + sc->length;
-
-        AL_PlayChannel(ch);
+        // reset the entries set above
+        for (k = 0; k < numindexed; k++)
+            loopchannels[indexed[k]] = NULL;
     }
 }
 
@@ -31,6 +31,10 @@ cvar_t      *s_khz;
 static cvar_t       *s_testsound;
 static cvar_t       *s_swapstereo;
 static cvar_t       *s_mixahead;
+static cvar_t       *s_mixsimd;
+
+// paint/transfer/filter kernels selected by s_mixsimd
+static const mix_kernels_t *s_mix;
 
 static float    snd_vol;
 
@@ -68,6 +72,7 @@ static sfxcache_t *DMA_UploadSfx(sfx_t *sfx)
     sc->width = s_info.width;
     sc->channels = s_info.channels;
     sc->size = size;
+    sc->stream = NULL;
 
 // resample / decimate to the current source rate
     if (stepscale == 1) // fast special case
@@ -94,7 +99,7 @@ static const qboolean DMA_SetEAXEFfectProperties( const sfx_eax_properties_t *ea
 static void DMA_PageInSfx(sfx_t *sfx)
 {
     sfxcache_t *sc = sfx->cache;
-    if (sc)
+    if (sc && !sc->stream)
         Com_PageInMemory(sc->data, sc->size);
 }
 
@@ -188,11 +193,9 @@ static void TransferStereo16(samplepair_t *samp, int endtime)
 
         // write a linear blast of samples
         int16_t *out = (int16_t *)dma.buffer + (lpos << 1);
-        for (int i = 0; i < count; i++, samp++, out += 2) {
-            out[0] = clip16(samp->left);
-            out[1] = clip16(samp->right);
-        }
+        s_mix->transfer_stereo16(samp, count, out);
 
+        samp += count;
         ltime += count;
     }
 }
@@ -259,12 +262,7 @@ UNDERWATER FILTER
 ===============================================================================
 */
 
-typedef struct {
-    float z1, z2;
-} hist_t;
-
-static hist_t hist[2];
-static float a1, a2, b0, b1, b2;
+static mix_filter_t underwater;
 
 // Implements "high shelf" biquad filter. This is what OpenAL Soft uses for
 // AL_FILTER_LOWPASS.
@@ -286,7 +284,7 @@ static void s_underwater_gain_hf_changed(float hfGain)
     float cos_w0 = cos(w0);
     float alpha = sin_w0 / 2.0f * M_SQRT2;
     float sqrtgain_alpha_2 = 2.0f * sqrtf(gain) * alpha;
-    float a0;
+    float a0, a1, a2, b0, b1, b2;
 
     b0 = gain * ((gain+1.0f) + (gain-1.0f) * cos_w0 + sqrtgain_alpha_2);
     b1 = gain * ((gain-1.0f) + (gain+1.0f) * cos_w0) * -2.0f;
@@ -296,30 +294,16 @@ static void s_underwater_gain_hf_changed(float hfGain)
     a1 = ((gain-1.0f) - (gain+1.0f) * cos_w0) * 2.0f;
     a2 =  (gain+1.0f) - (gain-1.0f) * cos_w0 - sqrtgain_alpha_2;
 
-    a1 /= a0; a2 /= a0; b0 /= a0; b1 /= a0; b2 /= a0;
-}
-
-static void filter_ch(hist_t *hist, float *samp, int count)
-{
-    float z1 = hist->z1;
-    float z2 = hist->z2;
-
-    for (int i = 0; i < count; i++, samp += 2) {
-        float input = *samp;
-        float output = input * b0 + z1;
-        z1 = input * b1 - output * a1 + z2;
-        z2 = input * b2 - output * a2;
-        *samp = output;
-    }
-
-    hist->z1 = z1;
-    hist->z2 = z2;
+    underwater.a1 = a1 / a0;
+    underwater.a2 = a2 / a0;
+    underwater.b0 = b0 / a0;
+    underwater.b1 = b1 / a0;
+    underwater.b2 = b2 / a0;
 }
 
 static void underwater_filter(samplepair_t *samp, int count)
 {
-    filter_ch(&hist[0], &samp->left, count);
-    filter_ch(&hist[1], &samp->right, count);
+    s_mix->filter_stereo(&underwater, samp, count);
 }
 
 /*
@@ -330,92 +314,43 @@ CHANNEL MIXING
 ===============================================================================
 */
 
-typedef void (*paintfunc_t)(channel_t *, sfxcache_t *, int, samplepair_t *);
-
-#define PAINTFUNC(name) \
-    static void name(channel_t *ch, sfxcache_t *sc, int count, samplepair_t *samp)
-
-PAINTFUNC(PaintMono8)
-{
-    float leftvol = ch->leftvol * snd_vol * 256;
-    float rightvol = ch->rightvol * snd_vol * 256;
-    uint8_t *sfx = sc->data + ch->pos;
-
-    for (int i = 0; i < count; i++, samp++, sfx++) {
-        samp->left += (*sfx - 128) * leftvol;
-        samp->right += (*sfx - 128) * rightvol;
-    }
-}
-
-PAINTFUNC(PaintStereoDmix8)
-{
-    float leftvol = ch->leftvol * snd_vol * (256 * M_SQRT1_2);
-    float rightvol = ch->rightvol * snd_vol * (256 * M_SQRT1_2);
-    uint8_t *sfx = sc->data + ch->pos * 2;
-
-    for (int i = 0; i < count; i++, samp++, sfx += 2) {
-        int sum = (sfx[0] - 128) + (sfx[1] - 128);
-        samp->left += sum * leftvol;
-        samp->right += sum * rightvol;
-    }
-}
-
-PAINTFUNC(PaintStereoFull8)
-{
-    float vol = ch->leftvol * snd_vol * 256;
-    uint8_t *sfx = sc->data + ch->pos * 2;
-
-    for (int i = 0; i < count; i++, samp++, sfx += 2) {
-        samp->left += (sfx[0] - 128) * vol;
-        samp->right += (sfx[1] - 128) * vol;
-    }
-}
-
-PAINTFUNC(PaintMono16)
-{
-    float leftvol = ch->leftvol * snd_vol;
-    float rightvol = ch->rightvol * snd_vol;
-    int16_t *sfx = (int16_t *)sc->data + ch->pos;
-
-    for (int i = 0; i < count; i++, samp++, sfx++) {
-        samp->left += *sfx * leftvol;
-        samp->right += *sfx * rightvol;
-    }
-}
+// volume scale of each paint kernel, 8 bit samples are scaled up to 16 bit
+// range and stereo downmixes are attenuated by 1/sqrt(2)
+static const double paintscale[MIX_PAINT_NUM] = {
+    [MIX_PAINT_MONO8]           = 256,
+    [MIX_PAINT_STEREO_DMIX8]    = 256 * M_SQRT1_2,
+    [MIX_PAINT_STEREO_FULL8]    = 256,
+    [MIX_PAINT_MONO16]          = 1,
+    [MIX_PAINT_STEREO_DMIX16]   = M_SQRT1_2,
+    [MIX_PAINT_STEREO_FULL16]   = 1,
+};
 
-PAINTFUNC(PaintStereoDmix16)
+static void PaintChannel(channel_t *ch, sfxcache_t *sc, int count, samplepair_t *samp)
 {
-    float leftvol = ch->leftvol * snd_vol * M_SQRT1_2;
-    float rightvol = ch->rightvol * snd_vol * M_SQRT1_2;
-    int16_t *sfx = (int16_t *)sc->data + ch->pos * 2;
-
-    for (int i = 0; i < count; i++, samp++, sfx += 2) {
-        int sum = sfx[0] + sfx[1];
-        samp->left += sum * leftvol;
-        samp->right += sum * rightvol;
+    int func = (sc->width - 1) * 3 + (sc->channels - 1) * (S_IsFullVolume(ch) + 1);
+    float leftvol = ch->leftvol * snd_vol * paintscale[func];
+    float rightvol = ch->rightvol * snd_vol * paintscale[func];
+    const byte *data;
+
+    if (sc->stream) {
+        // painted a decoded chunk at a time, chunks not decoded yet are skipped
+        int64_t pos = ch->pos;
+        while (count > 0) {
+            int n = count;
+            data = S_StreamData(sc->stream, pos, &n);
+            if (data)
+                s_mix->paint[func](data, n, leftvol, rightvol, samp);
+            pos += n;
+            samp += n;
+            count -= n;
+        }
+        return;
     }
-}
 
-PAINTFUNC(PaintStereoFull16)
-{
-    float vol = ch->leftvol * snd_vol;
-    int16_t *sfx = (int16_t *)sc->data + ch->pos * 2;
-
-    for (int i = 0; i < count; i++, samp++, sfx += 2) {
-        samp->left += sfx[0] * vol;
-        samp->right += sfx[1] * vol;
-    }
+    data = sc->data + ch->pos * sc->width * sc->channels;
+    s_mix->paint[func](data, count, leftvol, rightvol, samp);
 }
 
-static const paintfunc_t paintfuncs[] = {
-    PaintMono8,
-    PaintStereoDmix8,
-    PaintStereoFull8,
-    PaintMono16,
-    PaintStereoDmix16,
-    PaintStereoFull16,
-};
-
 static void PaintChannels(int endtime)
 {
     samplepair_t paintbuffer[PAINTBUFFER_SIZE];
@@ -455,8 +390,10 @@ static void PaintChannels(int endtime)
                 if (!ch->sfx || (!ch->leftvol && !ch->rightvol))
                     break;
 
-                sfxcache_t *sc = S_LoadSound(ch->sfx);
-                if (!sc)
+                // playing sounds are never evicted, so this only
+                // needs to load sounds that failed to load before
+                sfxcache_t *sc = ch->sfx->cache;
+                if (!sc && !(sc = S_LoadSound(ch->sfx)))
                     break;
 
                 Q_assert(sc->width == 1 || sc->width == 2);
@@ -466,8 +403,7 @@ static void PaintChannels(int endtime)
                 int64_t count = min(end, ch->end) - ltime;
 
                 if (count > 0) {
-                    int func = (sc->width - 1) * 3 + (sc->channels - 1) * (S_IsFullVolume(ch) + 1);
-                    paintfuncs[func](ch, sc, count, &paintbuffer[ltime - s_paintedtime]);
+                    PaintChannel(ch, sc, count, &paintbuffer[ltime - s_paintedtime]);
                     ch->pos += count;
                     ltime += count;
                 }
@@ -516,6 +452,16 @@ static void s_volume_changed(cvar_t *self)
     snd_vol = S_GetLinearVolume(Cvar_ClampValue(self, 0, 1));
 }
 
+static void s_mixsimd_changed(cvar_t *self)
+{
+    mix_impl_t impl = Mix_BestImpl(Cvar_ClampInteger(self, MIX_IMPL_SCALAR, MIX_NUM_IMPLS - 1));
+
+    s_mix = Mix_GetKernels(impl);
+
+    if (impl != self->integer)
+        Com_DPrintf("s_mixsimd: %d is not supported, using %s\n", self->integer, s_mix->name);
+}
+
 
 /*
 ===============================================================================
@@ -565,6 +511,10 @@ static bool DMA_Init(void)
     s_mixahead = Cvar_Get("s_mixahead", "0.1", CVAR_ARCHIVE);
     s_testsound = Cvar_Get("s_testsound", "0", 0);
     s_swapstereo = Cvar_Get("s_swapstereo", "0", 0);
+    s_mixsimd = Cvar_Get("s_mixsimd", "2", 0);
+    s_streamsize = Cvar_Get("s_streamsize", "2048", 0);
+    s_mixsimd->changed = s_mixsimd_changed;
+    s_mixsimd_changed(s_mixsimd);
     cvar_t *s_driver = Cvar_Get("s_driver", "", CVAR_SOUND);
 
     for (i = 0; s_drivers[i]; i++) {
@@ -609,6 +559,7 @@ static void DMA_Shutdown(void)
     s_numchannels = 0;
 
     s_volume->changed = NULL;
+    s_mixsimd->changed = NULL;
 }
 
 static void DMA_Activate(void)
@@ -662,21 +613,10 @@ SpatializeOrigin
 Used for spatializing channels and autosounds
 =================
 */
-static void SpatializeOrigin(const vec3_t origin, float master_vol, float dist_mult, float *left_vol, float *right_vol)
+static void SpatializeDirection(const vec3_t source_vec, vec_t dist, float master_vol, float *left_vol, float *right_vol)
 {
     vec_t       dot;
-    vec_t       dist;
     vec_t       lscale, rscale, scale;
-    vec3_t      source_vec;
-
-// calculate stereo seperation and distance attenuation
-    VectorSubtract(origin, cl.listener_spatialize.origin, source_vec);
-
-    dist = VectorNormalize(source_vec);
-    dist -= SOUND_FULLVOLUME;
-    if (dist < 0)
-        dist = 0;           // close enough to be at full volume
-    dist *= dist_mult;      // different attenuation levels
 
     if (dma.channels == 1) {
         rscale = 1.0f;
@@ -699,6 +639,23 @@ static void SpatializeOrigin(const vec3_t origin, float master_vol, float dist_m
         *left_vol = 0;
 }
 
+static void SpatializeOrigin(const vec3_t origin, float master_vol, float dist_mult, float *left_vol, float *right_vol)
+{
+    vec_t       dist;
+    vec3_t      source_vec;
+
+// calculate stereo seperation and distance attenuation
+    VectorSubtract(origin, cl.listener_spatialize.origin, source_vec);
+
+    dist = VectorNormalize(source_vec);
+    dist -= SOUND_FULLVOLUME;
+    if (dist < 0)
+        dist = 0;           // close enough to be at full volume
+    dist *= dist_mult;      // different attenuation levels
+
+    SpatializeDirection(source_vec, dist, master_vol, left_vol, right_vol);
+}
+
 /*
 =================
 DMA_Spatialize
@@ -736,50 +693,27 @@ as the entities are sent to the client
 */
 static void AddLoopSounds(void)
 {
-    int         i, j;
-    int         sounds[MAX_EDICTS];
-    float       left, right, left_total, right_total;
-    channel_t   *ch;
-    sfx_t       *sfx;
-    sfxcache_t  *sc;
-    int         num;
-    entity_state_t  *ent;
-    vec3_t      origin;
+    int             i, j;
+    float           left, right, left_total, right_total;
+    channel_t       *ch;
+    sfxcache_t      *sc;
+    loopsound_t     *ls;
+    loopemitter_t   *le;
 
     if (cls.state != ca_active || !s_active || sv_paused->integer || !s_ambient->integer)
         return;
 
-    S_BuildSoundList(sounds);
+    S_BuildLoopSounds();
 
-    for (i = 0; i < cl.frame.numEntities; i++) {
-        if (!sounds[i])
-            continue;
-
-        sfx = S_SfxForHandle(cl.sound_precache[sounds[i]]);
-        if (!sfx)
-            continue;       // bad sound effect
-        sc = sfx->cache;
-        if (!sc)
-            continue;
-
-        num = (cl.frame.firstEntity + i) & PARSE_ENTITIES_MASK;
-        ent = &cl.entityStates[num];
+    for (i = 0, ls = s_loopsounds; i < s_numloopsounds; i++, ls++) {
+        if (!ls->count)
+            continue;       // bad sound effect, or all emitters culled
 
         // find the total contribution of all sounds of this type
-        CL_GetEntitySoundOrigin(ent->number, origin);
-        SpatializeOrigin(origin, 1.0f, SOUND_LOOPATTENUATE,
-                         &left_total, &right_total);
-        for (j = i + 1; j < cl.frame.numEntities; j++) {
-            if (sounds[j] != sounds[i])
-                continue;
-            sounds[j] = 0;  // don't check this again later
-
-            num = (cl.frame.firstEntity + j) & PARSE_ENTITIES_MASK;
-            ent = &cl.entityStates[num];
-
-            CL_GetEntitySoundOrigin(ent->number, origin);
-            SpatializeOrigin(origin, 1.0f, SOUND_LOOPATTENUATE,
-                             &left, &right);
+        left_total = right_total = 0;
+        for (j = ls->first; j != -1; j = le->next) {
+            le = &s_loopemitters[j];
+            SpatializeDirection(le->dir, le->dist, 1.0f, &left, &right);
             left_total += left;
             right_total += right;
         }
@@ -792,12 +726,13 @@ static void AddLoopSounds(void)
         if (!ch)
             return;
 
+        sc = ls->sfx->cache;
         ch->leftvol = min(left_total, 1.0f);
         ch->rightvol = min(right_total, 1.0f);
         ch->master_vol = 1.0f;
         ch->dist_mult = SOUND_LOOPATTENUATE;    // for S_IsFullVolume()
         ch->autosound = true;   // remove next frame
-        ch->sfx = sfx;
+        ch->sfx = ls->sfx;
         ch->pos = s_paintedtime % sc->length;
         ch->end = s_paintedtime + sc->length - ch->pos;
     }
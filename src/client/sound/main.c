@@ -64,6 +64,15 @@ cvar_t      *s_underwater;
 
 static cvar_t   *s_enable;
 static cvar_t   *s_auto_focus;
+static cvar_t   *s_cachesize;
+
+// loaded sounds, most recently used first
+static LIST_DECL(s_cachelru);
+static size_t   s_cachebytes;
+static unsigned s_cacheframe;
+static unsigned s_cachehits;
+static unsigned s_cachemisses;
+static unsigned s_cacheevictions;
 
 
 
@@ -164,6 +173,10 @@ static void S_SoundList_f(void)
     sfx_t   *sfx;
     sfxcache_t  *sc;
     size_t  total;
+#if USE_SNDDMA
+    int     streams = 0;
+    unsigned underruns = 0;
+#endif
 
     total = count = 0;
     for (sfx = known_sfx, i = 0; i < num_sfx; i++, sfx++) {
@@ -172,6 +185,13 @@ static void S_SoundList_f(void)
         sc = sfx->cache;
         if (sc) {
             total += sc->size;
+#if USE_SNDDMA
+            if (sc->stream) {
+                streams++;
+                underruns += S_StreamUnderruns(sc->stream);
+                Com_Printf("S");
+            } else
+#endif
             if (sc->loopstart >= 0)
                 Com_Printf("L");
             else
@@ -188,6 +208,18 @@ static void S_SoundList_f(void)
     }
     Com_Printf("Total sounds: %d (out of %d slots)\n", count, num_sfx);
     Com_Printf("Total resident: %zu\n", total);
+    if (s_cachesize->integer > 0)
+        Com_Printf("Cache budget: %d MB\n", s_cachesize->integer);
+    else
+        Com_Printf("Cache budget: unlimited\n");
+    Com_Printf("Cache lookups: %u hits, %u misses (%.1f%% hit rate), %u evictions\n",
+               s_cachehits, s_cachemisses,
+               s_cachehits + s_cachemisses ? s_cachehits * 100.0 / (s_cachehits + s_cachemisses) : 0.0,
+               s_cacheevictions);
+#if USE_SNDDMA
+    if (streams)
+        Com_Printf("Streams: %d, %u underruns\n", streams, underruns);
+#endif
 }
 
 static const cmdreg_t c_sound[] = {
@@ -224,6 +256,7 @@ void S_Init(void)
 
     s_volume = Cvar_Get("s_volume", "0.7", CVAR_ARCHIVE);
     s_ambient = Cvar_Get("s_ambient", "1", 0);
+    s_cachesize = Cvar_Get("s_cachesize", "64", 0);
 #if USE_DEBUG
     s_show = Cvar_Get("s_show", "0", 0);
 #endif
@@ -281,12 +314,25 @@ fail:
 // Shutdown sound engine
 // =======================================================================
 
-static void S_FreeSound(sfx_t *sfx)
+static void S_UnloadSound(sfx_t *sfx)
 {
     if (s_api.delete_sfx)
         s_api.delete_sfx(sfx);
-    if (sfx->cache)
+    if (sfx->cache) {
+#if USE_SNDDMA
+        if (sfx->cache->stream)
+            S_FreeStream(sfx->cache->stream);
+#endif
+        s_cachebytes -= sfx->cache->size;
+        List_Remove(&sfx->cache_entry);
         Z_Free(sfx->cache);
+        sfx->cache = NULL;
+    }
+}
+
+static void S_FreeSound(sfx_t *sfx)
+{
+    S_UnloadSound(sfx);
     if (sfx->truename)
         Z_Free(sfx->truename);
     memset(sfx, 0, sizeof(*sfx));
@@ -305,6 +351,9 @@ void S_FreeAllSounds(void)
     }
 
     num_sfx = 0;
+
+    s_cachebytes = 0;
+    s_cachehits = s_cachemisses = s_cacheevictions = 0;
 }
 
 //void S_FreeAllEAX( void ) {
@@ -380,6 +429,77 @@ sfx_t *S_SfxForHandle(qhandle_t hSfx)
     return &known_sfx[hSfx - 1];
 }
 
+// =======================================================================
+// Sample cache
+// =======================================================================
+
+static size_t S_CacheBudget(void)
+{
+    return s_cachesize->integer > 0 ? (size_t)s_cachesize->integer << 20 : SIZE_MAX;
+}
+
+// sounds used this update, playing on a channel or waiting to be
+// played can't be evicted, the backends are still referencing them
+static bool S_SoundInUse(sfx_t *sfx)
+{
+    playsound_t *ps;
+    int         i;
+
+    if (sfx->cache_frame == s_cacheframe)
+        return true;
+
+    for (i = 0; i < s_numchannels; i++)
+        if (s_channels[i].sfx == sfx)
+            return true;
+
+    LIST_FOR_EACH(playsound_t, ps, &s_pendingplays, entry)
+        if (ps->sfx == sfx)
+            return true;
+
+    return false;
+}
+
+static void S_EvictSounds(void)
+{
+    sfx_t   *sfx, *prev;
+    size_t  budget = S_CacheBudget();
+
+    // walk from the least recently used end, the budget is a soft limit
+    // when everything left is in use
+    for (sfx = LIST_LAST(sfx_t, &s_cachelru, cache_entry);
+         s_cachebytes > budget && !LIST_TERM(sfx, &s_cachelru, cache_entry); sfx = prev) {
+        prev = LIST_PREV(sfx_t, sfx, cache_entry);
+        if (S_SoundInUse(sfx))
+            continue;
+        S_UnloadSound(sfx);
+        s_cacheevictions++;
+    }
+}
+
+/**
+*   @brief  Marks a cached sound as the most recently used one.
+**/
+void S_TouchSound(sfx_t *sfx)
+{
+    s_cachehits++;
+    sfx->cache_frame = s_cacheframe;
+    List_Remove(&sfx->cache_entry);
+    List_Insert(&s_cachelru, &sfx->cache_entry);
+}
+
+/**
+*   @brief  Adds a freshly loaded sound to the cache, evicting the least
+*           recently used ones if that takes it over s_cachesize.
+**/
+void S_CacheSound(sfx_t *sfx)
+{
+    s_cachemisses++;
+    sfx->cache_frame = s_cacheframe;
+    s_cachebytes += sfx->cache->size;
+    List_Insert(&s_cachelru, &sfx->cache_entry);
+    S_EvictSounds();
+}
+
 static sfx_t *S_AllocSfx(void)
 {
     sfx_t   *sfx;
@@ -643,8 +763,9 @@ void S_EndRegistration(void)
             s_api.page_in_sfx(sfx);
     }
 
-    // load everything in
-    for (i = 0, sfx = known_sfx; i < num_sfx; i++, sfx++) {
+    // load everything in that fits the cache budget, the rest
+    // is loaded on first use
+    for (i = 0, sfx = known_sfx; i < num_sfx && s_cachebytes < S_CacheBudget(); i++, sfx++) {
         if (!sfx->name[0])
             continue;
         S_LoadSound(sfx);
@@ -765,7 +886,10 @@ void S_IssuePlaysound(playsound_t *ps)
         return;
     }
 
-    sc = S_LoadSound(ps->sfx);
+    // already loaded by S_StartSound, and pending sounds aren't evicted
+    sc = ps->sfx->cache;
+    if (!sc)
+        sc = S_LoadSound(ps->sfx);
     if (!sc) {
         Com_Printf("S_IssuePlaysound: couldn't load %s\n", ps->sfx->name);
         S_FreePlaysound(ps);
@@ -930,29 +1054,100 @@ void S_RawSamples(int samples, int rate, int width, int channels, const byte *da
 // =======================================================================
 // Update sound buffer
 // =======================================================================
+loopemitter_t   s_loopemitters[MAX_EDICTS];
+int             s_numloopemitters;
+loopsound_t     s_loopsounds[MAX_SOUNDS];
+int             s_numloopsounds;
+
+// sound index -> s_loopsounds index + 1, only the used entries are reset
+static int      s_loopsoundmap[MAX_SOUNDS];
+
+// emitters further away than this are completely attenuated
+#define LOOPSOUND_CULL_DIST     (SOUND_FULLVOLUME + 1.0f / SOUND_LOOPATTENUATE)
+
 /**
-*   @brief  Iterates all packet entities and builds a sound list
-*           according to s_ambient cvar value. When s_ambient is 2,
-*           only entities with models will have sounds, when 3,
-*           only the listener entity will have sounds.
-*           Otherwise, all entities will have their sound member processed.
+*   @brief  Iterates all packet entities and buckets their looping sounds
+*           by sound index in a single pass. When s_ambient is 2, only
+*           entities with models will have sounds, when 3, only the listener
+*           entity will have sounds. Otherwise, all entities will have their
+*           sound member processed.
+*
+*           Emitters that are completely attenuated are culled before being
+*           spatialized, the remaining ones have their direction and distance
+*           computed once here so the backends don't need to.
 **/
-void S_BuildSoundList(int *sounds)
+void S_BuildLoopSounds(void)
 {
-    int         i;
-    int         num;
+    int             i, num, index;
     entity_state_t  *ent;
+    loopsound_t     *ls;
+    loopemitter_t   *le;
+    vec3_t          origin, dir;
+    float           dist;
+
+    s_numloopsounds = 0;
+    s_numloopemitters = 0;
 
     for (i = 0; i < cl.frame.numEntities; i++) {
         num = (cl.frame.firstEntity + i) & PARSE_ENTITIES_MASK;
         ent = &cl.entityStates[num];
-        if (s_ambient->integer == 2 && !ent->modelindex) {
-            sounds[i] = 0;
-        } else if (s_ambient->integer == 3 && ent->number != cl.listener_spatialize.entnum) {
-            sounds[i] = 0;
+        if (ent->sound <= 0 || ent->sound >= MAX_SOUNDS)
+            continue;
+        if (s_ambient->integer == 2 && !ent->modelindex)
+            continue;
+        if (s_ambient->integer == 3 && ent->number != cl.listener_spatialize.entnum)
+            continue;
+
+        // find or allocate the bucket, resolving the sfx only once
+        index = s_loopsoundmap[ent->sound];
+        if (index) {
+            ls = &s_loopsounds[index - 1];
         } else {
-            sounds[i] = ent->sound;
+            ls = &s_loopsounds[s_numloopsounds++];
+            s_loopsoundmap[ent->sound] = s_numloopsounds;
+            ls->sfx = S_SfxForHandle(cl.sound_precache[ent->sound]);
+            if (ls->sfx && !S_LoadSound(ls->sfx))
+                ls->sfx = NULL;
+            ls->first = ls->last = -1;
+            ls->count = 0;
         }
+        if (!ls->sfx)
+            continue;       // bad sound effect
+
+        // cull completely attenuated emitters before spatializing
+        CL_GetEntitySoundOrigin(ent->number, origin);
+        VectorSubtract(origin, cl.listener_spatialize.origin, dir);
+        if (DotProduct(dir, dir) >= LOOPSOUND_CULL_DIST * LOOPSOUND_CULL_DIST)
+            continue;
+
+        dist = VectorNormalize(dir);
+        dist -= SOUND_FULLVOLUME;
+        if (dist < 0)
+            dist = 0;       // close enough to be at full volume
+        dist *= SOUND_LOOPATTENUATE;
+        if (dist >= 1.0f)
+            continue;
+
+        // append to the bucket
+        le = &s_loopemitters[s_numloopemitters];
+        le->entnum = ent->number;
+        VectorCopy(dir, le->dir);
+        le->dist = dist;
+        le->next = -1;
+        if (ls->last == -1)
+            ls->first = s_numloopemitters;
+        else
+            s_loopemitters[ls->last].next = s_numloopemitters;
+        ls->last = s_numloopemitters++;
+        ls->count++;
+    }
+
+    // reset only the map entries used this update
+    for (i = 0; i < cl.frame.numEntities; i++) {
+        num = (cl.frame.firstEntity + i) & PARSE_ENTITIES_MASK;
+        ent = &cl.entityStates[num];
+        if (ent->sound > 0 && ent->sound < MAX_SOUNDS)
+            s_loopsoundmap[ent->sound] = 0;
     }
 }
 
@@ -1000,6 +1195,9 @@ void S_Update(void)
         cl.listener_spatialize.entnum = cl.frame.ps.clientNumber + 1;
     }
 
+    // sounds used from here on are protected from eviction until the next update
+    s_cacheframe++;
+
     OGG_Update();
 
     s_api.update();
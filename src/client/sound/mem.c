@@ -197,8 +197,10 @@ sfxcache_t *S_LoadSound(sfx_t *s)
 
 // see if still in memory
     sc = s->cache;
-    if (sc)
+    if (sc) {
+        S_TouchSound(s);
         return sc;
+    }
 
 // don't retry after error
     if (s->error)
@@ -222,6 +224,15 @@ sfxcache_t *S_LoadSound(sfx_t *s)
     SZ_Init(&sz, data, len);
     sz.cursize = len;
 
+#if USE_SNDDMA
+    // large compressed sounds are decoded on demand instead
+    if ((len >= 4 && RL32(data) == MakeLittleLong('O','g','g','S')) || !COM_CompareExtension(name, ".ogg")) {
+        sc = S_OpenStream(s, data, len);
+        if (sc)
+            goto done;
+    }
+#endif
+
     if (!GetWavinfo(&sz)) {
         s->error = Q_ERR_INVALID_FORMAT;
         goto fail;
@@ -242,6 +253,12 @@ sfxcache_t *S_LoadSound(sfx_t *s)
     if (s_info.format != FORMAT_PCM)
         FS_FreeTempMem(s_info.data);
 
+#if USE_SNDDMA
+done:
+#endif
+    if (sc)
+        S_CacheSound(s);
+
 fail:
     FS_FreeFile(data);
     return sc;
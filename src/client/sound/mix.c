@@ -0,0 +1,603 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// mix.c -- scalar, SSE2 and AVX2 software mixer kernels
+//
+// All implementations perform the exact same float operations in the same
+// order as the scalar reference (no FMA, truncating conversion), so they
+// produce bit identical output.
+
+#include <string.h>
+
+#include "mix.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MIX_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define MIX_X86 0
+#endif
+
+#if MIX_X86 && (defined(__GNUC__) || defined(__clang__))
+#define MIX_TARGET_SSE2 __attribute__((target("sse2")))
+#define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MIX_TARGET_SSE2
+#define MIX_TARGET_AVX2
+#endif
+
+// clip integer to [-0x8000, 0x7FFF] range (stolen from FFmpeg)
+static inline int mix_clip16(int v)
+{
+    return ((v + 0x8000U) & ~0xFFFF) ? (v >> 31) ^ 0x7FFF : v;
+}
+
+/*
+===============================================================================
+
+SCALAR
+
+===============================================================================
+*/
+
+static void Scalar_PaintMono8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    for (int i = 0; i < count; i++, samp++, sfx++) {
+        samp->left += (*sfx - 128) * leftvol;
+        samp->right += (*sfx - 128) * rightvol;
+    }
+}
+
+static void Scalar_PaintStereoDmix8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    for (int i = 0; i < count; i++, samp++, sfx += 2) {
+        int sum = (sfx[0] - 128) + (sfx[1] - 128);
+        samp->left += sum * leftvol;
+        samp->right += sum * rightvol;
+    }
+}
+
+static void Scalar_PaintStereoFull8(const uint8_t *sfx, int count, float vol, float unused, samplepair_t *samp)
+{
+    for (int i = 0; i < count; i++, samp++, sfx += 2) {
+        samp->left += (sfx[0] - 128) * vol;
+        samp->right += (sfx[1] - 128) * vol;
+    }
+}
+
+static void Scalar_PaintMono16(const uint8_t *data, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const int16_t *sfx = (const int16_t *)data;
+
+    for (int i = 0; i < count; i++, samp++, sfx++) {
+        samp->left += *sfx * leftvol;
+        samp->right += *sfx * rightvol;
+    }
+}
+
+static void Scalar_PaintStereoDmix16(const uint8_t *data, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const int16_t *sfx = (const int16_t *)data;
+
+    for (int i = 0; i < count; i++, samp++, sfx += 2) {
+        int sum = sfx[0] + sfx[1];
+        samp->left += sum * leftvol;
+        samp->right += sum * rightvol;
+    }
+}
+
+static void Scalar_PaintStereoFull16(const uint8_t *data, int count, float vol, float unused, samplepair_t *samp)
+{
+    const int16_t *sfx = (const int16_t *)data;
+
+    for (int i = 0; i < count; i++, samp++, sfx += 2) {
+        samp->left += sfx[0] * vol;
+        samp->right += sfx[1] * vol;
+    }
+}
+
+static void Scalar_TransferStereo16(const samplepair_t *samp, int count, int16_t *out)
+{
+    for (int i = 0; i < count; i++, samp++, out += 2) {
+        out[0] = mix_clip16(samp->left);
+        out[1] = mix_clip16(samp->right);
+    }
+}
+
+static void Scalar_FilterChannel(const mix_filter_t *f, float *z1p, float *z2p, float *samp, int count)
+{
+    float z1 = *z1p;
+    float z2 = *z2p;
+
+    for (int i = 0; i < count; i++, samp += 2) {
+        float input = *samp;
+        float output = input * f->b0 + z1;
+        z1 = input * f->b1 - output * f->a1 + z2;
+        z2 = input * f->b2 - output * f->a2;
+        *samp = output;
+    }
+
+    *z1p = z1;
+    *z2p = z2;
+}
+
+static void Scalar_FilterStereo(mix_filter_t *f, samplepair_t *samp, int count)
+{
+    Scalar_FilterChannel(f, &f->z1[0], &f->z2[0], &samp->left, count);
+    Scalar_FilterChannel(f, &f->z1[1], &f->z2[1], &samp->right, count);
+}
+
+static const mix_kernels_t mix_scalar = {
+    .name = "scalar",
+    .paint = {
+        Scalar_PaintMono8,
+        Scalar_PaintStereoDmix8,
+        Scalar_PaintStereoFull8,
+        Scalar_PaintMono16,
+        Scalar_PaintStereoDmix16,
+        Scalar_PaintStereoFull16,
+    },
+    .transfer_stereo16 = Scalar_TransferStereo16,
+    .filter_stereo = Scalar_FilterStereo,
+};
+
+#if MIX_X86
+
+/*
+===============================================================================
+
+SSE2 (4 samples per iteration)
+
+===============================================================================
+*/
+
+// adds 4 mono samples to 4 stereo pairs, scaled by (l, r, l, r)
+MIX_TARGET_SSE2
+static inline void SSE2_AddMono4(__m128 s, __m128 vol, samplepair_t *samp)
+{
+    float *out = (float *)samp;
+    _mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), _mm_mul_ps(_mm_unpacklo_ps(s, s), vol)));
+    _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(_mm_unpackhi_ps(s, s), vol)));
+}
+
+// adds 4 interleaved stereo pairs (as two vectors of 2 pairs), scaled by 'vol'
+MIX_TARGET_SSE2
+static inline void SSE2_AddStereo4(__m128 lo, __m128 hi, __m128 vol, samplepair_t *samp)
+{
+    float *out = (float *)samp;
+    _mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), _mm_mul_ps(lo, vol)));
+    _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(hi, vol)));
+}
+
+// sign extends the low and high 4 int16 of 'x' into two int32 vectors
+#define SSE2_EXTEND_LO16(x) _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)
+#define SSE2_EXTEND_HI16(x) _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)
+
+MIX_TARGET_SSE2
+static void SSE2_PaintMono8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m128 vol = _mm_setr_ps(leftvol, rightvol, leftvol, rightvol);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(128);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, sfx += 4, samp += 4) {
+        int32_t raw;
+        memcpy(&raw, sfx, sizeof(raw));
+        __m128i x = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero), zero);
+        SSE2_AddMono4(_mm_cvtepi32_ps(_mm_sub_epi32(x, bias)), vol, samp);
+    }
+
+    Scalar_PaintMono8(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_SSE2
+static void SSE2_PaintStereoDmix8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m128 vol = _mm_setr_ps(leftvol, rightvol, leftvol, rightvol);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i ones = _mm_set1_epi16(1);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, sfx += 8, samp += 4) {
+        __m128i x = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)sfx), zero), bias);
+        SSE2_AddMono4(_mm_cvtepi32_ps(_mm_madd_epi16(x, ones)), vol, samp);
+    }
+
+    Scalar_PaintStereoDmix8(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_SSE2
+static void SSE2_PaintStereoFull8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m128 vol = _mm_set1_ps(leftvol);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, sfx += 8, samp += 4) {
+        __m128i x = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)sfx), zero), bias);
+        SSE2_AddStereo4(_mm_cvtepi32_ps(SSE2_EXTEND_LO16(x)), _mm_cvtepi32_ps(SSE2_EXTEND_HI16(x)), vol, samp);
+    }
+
+    Scalar_PaintStereoFull8(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_SSE2
+static void SSE2_PaintMono16(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m128 vol = _mm_setr_ps(leftvol, rightvol, leftvol, rightvol);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, sfx += 8, samp += 4) {
+        __m128i x = _mm_loadl_epi64((const __m128i *)sfx);
+        SSE2_AddMono4(_mm_cvtepi32_ps(SSE2_EXTEND_LO16(x)), vol, samp);
+    }
+
+    Scalar_PaintMono16(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_SSE2
+static void SSE2_PaintStereoDmix16(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m128 vol = _mm_setr_ps(leftvol, rightvol, leftvol, rightvol);
+    const __m128i ones = _mm_set1_epi16(1);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, sfx += 16, samp += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)sfx);
+        SSE2_AddMono4(_mm_cvtepi32_ps(_mm_madd_epi16(x, ones)), vol, samp);
+    }
+
+    Scalar_PaintStereoDmix16(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_SSE2
+static void SSE2_PaintStereoFull16(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m128 vol = _mm_set1_ps(leftvol);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, sfx += 16, samp += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)sfx);
+        SSE2_AddStereo4(_mm_cvtepi32_ps(SSE2_EXTEND_LO16(x)), _mm_cvtepi32_ps(SSE2_EXTEND_HI16(x)), vol, samp);
+    }
+
+    Scalar_PaintStereoFull16(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_SSE2
+static void SSE2_TransferStereo16(const samplepair_t *samp, int count, int16_t *out)
+{
+    const float *in = (const float *)samp;
+    int i;
+
+    // truncate like the scalar float -> int conversion, then saturate to 16 bits
+    for (i = 0; i + 4 <= count; i += 4, in += 8, out += 8) {
+        __m128i a = _mm_cvttps_epi32(_mm_loadu_ps(in + 0));
+        __m128i b = _mm_cvttps_epi32(_mm_loadu_ps(in + 4));
+        _mm_storeu_si128((__m128i *)out, _mm_packs_epi32(a, b));
+    }
+
+    Scalar_TransferStereo16((const samplepair_t *)in, count - i, out);
+}
+
+// both channels share the coefficients, so they run side by side in two lanes
+MIX_TARGET_SSE2
+static void SSE2_FilterStereo(mix_filter_t *f, samplepair_t *samp, int count)
+{
+    const __m128 b0 = _mm_set1_ps(f->b0);
+    const __m128 b1 = _mm_set1_ps(f->b1);
+    const __m128 b2 = _mm_set1_ps(f->b2);
+    const __m128 a1 = _mm_set1_ps(f->a1);
+    const __m128 a2 = _mm_set1_ps(f->a2);
+    __m128 z1 = _mm_setr_ps(f->z1[0], f->z1[1], 0, 0);
+    __m128 z2 = _mm_setr_ps(f->z2[0], f->z2[1], 0, 0);
+    __m128 input = _mm_setzero_ps();
+
+    for (int i = 0; i < count; i++, samp++) {
+        input = _mm_loadl_pi(input, (const __m64 *)samp);
+        __m128 output = _mm_add_ps(_mm_mul_ps(input, b0), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(input, b1), _mm_mul_ps(output, a1)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(input, b2), _mm_mul_ps(output, a2));
+        _mm_storel_pi((__m64 *)samp, output);
+    }
+
+    float tmp[4];
+    _mm_storeu_ps(tmp, z1);
+    f->z1[0] = tmp[0];
+    f->z1[1] = tmp[1];
+    _mm_storeu_ps(tmp, z2);
+    f->z2[0] = tmp[0];
+    f->z2[1] = tmp[1];
+}
+
+static const mix_kernels_t mix_sse2 = {
+    .name = "SSE2",
+    .paint = {
+        SSE2_PaintMono8,
+        SSE2_PaintStereoDmix8,
+        SSE2_PaintStereoFull8,
+        SSE2_PaintMono16,
+        SSE2_PaintStereoDmix16,
+        SSE2_PaintStereoFull16,
+    },
+    .transfer_stereo16 = SSE2_TransferStereo16,
+    .filter_stereo = SSE2_FilterStereo,
+};
+
+/*
+===============================================================================
+
+AVX2 (8 samples per iteration)
+
+===============================================================================
+*/
+
+// adds 8 mono samples to 8 stereo pairs, scaled by (l, r, l, r, ...)
+MIX_TARGET_AVX2
+static inline void AVX2_AddMono8(__m256 s, __m256 vol, samplepair_t *samp)
+{
+    float *out = (float *)samp;
+    // unpack works per 128 bit lane: lo = s0 s0 s1 s1 | s4 s4 s5 s5, hi = s2 s2 s3 s3 | s6 s6 s7 s7
+    __m256 lo = _mm256_unpacklo_ps(s, s);
+    __m256 hi = _mm256_unpackhi_ps(s, s);
+    __m256 first = _mm256_permute2f128_ps(lo, hi, 0x20);
+    __m256 second = _mm256_permute2f128_ps(lo, hi, 0x31);
+    _mm256_storeu_ps(out + 0, _mm256_add_ps(_mm256_loadu_ps(out + 0), _mm256_mul_ps(first, vol)));
+    _mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_mul_ps(second, vol)));
+}
+
+// adds 8 interleaved stereo pairs (as two vectors of 4 pairs), scaled by 'vol'
+MIX_TARGET_AVX2
+static inline void AVX2_AddStereo8(__m256 first, __m256 second, __m256 vol, samplepair_t *samp)
+{
+    float *out = (float *)samp;
+    _mm256_storeu_ps(out + 0, _mm256_add_ps(_mm256_loadu_ps(out + 0), _mm256_mul_ps(first, vol)));
+    _mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_mul_ps(second, vol)));
+}
+
+MIX_TARGET_AVX2
+static void AVX2_PaintMono8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m256 vol = _mm256_setr_ps(leftvol, rightvol, leftvol, rightvol, leftvol, rightvol, leftvol, rightvol);
+    const __m256i bias = _mm256_set1_epi32(128);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, sfx += 8, samp += 8) {
+        __m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)sfx));
+        AVX2_AddMono8(_mm256_cvtepi32_ps(_mm256_sub_epi32(x, bias)), vol, samp);
+    }
+
+    SSE2_PaintMono8(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_AVX2
+static void AVX2_PaintStereoDmix8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m256 vol = _mm256_setr_ps(leftvol, rightvol, leftvol, rightvol, leftvol, rightvol, leftvol, rightvol);
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i ones = _mm256_set1_epi16(1);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, sfx += 16, samp += 8) {
+        __m256i x = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)sfx)), bias);
+        AVX2_AddMono8(_mm256_cvtepi32_ps(_mm256_madd_epi16(x, ones)), vol, samp);
+    }
+
+    SSE2_PaintStereoDmix8(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_AVX2
+static void AVX2_PaintStereoFull8(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m256 vol = _mm256_set1_ps(leftvol);
+    const __m256i bias = _mm256_set1_epi32(128);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, sfx += 16, samp += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)sfx);
+        __m256i first = _mm256_sub_epi32(_mm256_cvtepu8_epi32(x), bias);
+        __m256i second = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(x, 8)), bias);
+        AVX2_AddStereo8(_mm256_cvtepi32_ps(first), _mm256_cvtepi32_ps(second), vol, samp);
+    }
+
+    SSE2_PaintStereoFull8(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_AVX2
+static void AVX2_PaintMono16(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m256 vol = _mm256_setr_ps(leftvol, rightvol, leftvol, rightvol, leftvol, rightvol, leftvol, rightvol);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, sfx += 16, samp += 8) {
+        __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)sfx));
+        AVX2_AddMono8(_mm256_cvtepi32_ps(x), vol, samp);
+    }
+
+    SSE2_PaintMono16(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_AVX2
+static void AVX2_PaintStereoDmix16(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m256 vol = _mm256_setr_ps(leftvol, rightvol, leftvol, rightvol, leftvol, rightvol, leftvol, rightvol);
+    const __m256i ones = _mm256_set1_epi16(1);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, sfx += 32, samp += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)sfx);
+        AVX2_AddMono8(_mm256_cvtepi32_ps(_mm256_madd_epi16(x, ones)), vol, samp);
+    }
+
+    SSE2_PaintStereoDmix16(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_AVX2
+static void AVX2_PaintStereoFull16(const uint8_t *sfx, int count, float leftvol, float rightvol, samplepair_t *samp)
+{
+    const __m256 vol = _mm256_set1_ps(leftvol);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, sfx += 32, samp += 8) {
+        __m256i first = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)sfx));
+        __m256i second = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(sfx + 16)));
+        AVX2_AddStereo8(_mm256_cvtepi32_ps(first), _mm256_cvtepi32_ps(second), vol, samp);
+    }
+
+    SSE2_PaintStereoFull16(sfx, count - i, leftvol, rightvol, samp);
+}
+
+MIX_TARGET_AVX2
+static void AVX2_TransferStereo16(const samplepair_t *samp, int count, int16_t *out)
+{
+    const float *in = (const float *)samp;
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, in += 16, out += 16) {
+        __m256i a = _mm256_cvttps_epi32(_mm256_loadu_ps(in + 0));
+        __m256i b = _mm256_cvttps_epi32(_mm256_loadu_ps(in + 8));
+        // packs works per 128 bit lane, restore the sample order afterwards
+        __m256i packed = _mm256_packs_epi32(a, b);
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    SSE2_TransferStereo16((const samplepair_t *)in, count - i, out);
+}
+
+static const mix_kernels_t mix_avx2 = {
+    .name = "AVX2",
+    .paint = {
+        AVX2_PaintMono8,
+        AVX2_PaintStereoDmix8,
+        AVX2_PaintStereoFull8,
+        AVX2_PaintMono16,
+        AVX2_PaintStereoDmix16,
+        AVX2_PaintStereoFull16,
+    },
+    .transfer_stereo16 = AVX2_TransferStereo16,
+    // the filter is serial per channel, two lanes is all it can use
+    .filter_stereo = SSE2_FilterStereo,
+};
+
+/*
+===============================================================================
+
+CPU FEATURE DETECTION
+
+===============================================================================
+*/
+
+#ifdef _MSC_VER
+static bool Mix_CPUHasSSE2(void)
+{
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[3] >> 26) & 1;
+}
+
+static bool Mix_CPUHasAVX2(void)
+{
+    int regs[4];
+
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+
+    // OS must save the YMM registers
+    __cpuid(regs, 1);
+    if (!((regs[2] >> 27) & 1) || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+}
+#else
+static bool Mix_CPUHasSSE2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static bool Mix_CPUHasAVX2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#endif // MIX_X86
+
+/*
+===============================================================================
+
+KERNEL SELECTION
+
+===============================================================================
+*/
+
+bool Mix_ImplSupported(mix_impl_t impl)
+{
+    switch (impl) {
+    case MIX_IMPL_SCALAR:
+        return true;
+#if MIX_X86
+    case MIX_IMPL_SSE2:
+        return Mix_CPUHasSSE2();
+    case MIX_IMPL_AVX2:
+        return Mix_CPUHasSSE2() && Mix_CPUHasAVX2();
+#endif
+    default:
+        return false;
+    }
+}
+
+mix_impl_t Mix_BestImpl(mix_impl_t max_impl)
+{
+    int impl = max_impl;
+
+    if (impl >= MIX_NUM_IMPLS)
+        impl = MIX_NUM_IMPLS - 1;
+
+    while (impl > MIX_IMPL_SCALAR && !Mix_ImplSupported(impl))
+        impl--;
+
+    return impl > MIX_IMPL_SCALAR ? impl : MIX_IMPL_SCALAR;
+}
+
+const mix_kernels_t *Mix_GetKernels(mix_impl_t impl)
+{
+    if (!Mix_ImplSupported(impl))
+        return NULL;
+
+    switch (impl) {
+#if MIX_X86
+    case MIX_IMPL_SSE2:
+        return &mix_sse2;
+    case MIX_IMPL_AVX2:
+        return &mix_avx2;
+#endif
+    default:
+        return &mix_scalar;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// mix.h -- software mixer kernels used by the DMA sound backend
+//
+// These are self contained (no client state) so that they can also be
+// linked into the headless mixer benchmark tool.
+
+#ifndef MIX_H
+#define MIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+*   @brief  A single stereo sample in the paint buffer.
+**/
+typedef struct {
+    float   left;
+    float   right;
+} samplepair_t;
+
+/**
+*   @brief  Paint kernels, indexed the same way PaintChannels selects them:
+*           (width - 1) * 3 + (channels - 1) * (fullvolume + 1)
+**/
+typedef enum {
+    MIX_PAINT_MONO8,
+    MIX_PAINT_STEREO_DMIX8,
+    MIX_PAINT_STEREO_FULL8,
+    MIX_PAINT_MONO16,
+    MIX_PAINT_STEREO_DMIX16,
+    MIX_PAINT_STEREO_FULL16,
+
+    MIX_PAINT_NUM
+} mix_paint_t;
+
+/**
+*   @brief  Available kernel implementations, ordered from slowest to fastest.
+**/
+typedef enum {
+    MIX_IMPL_SCALAR,
+    MIX_IMPL_SSE2,
+    MIX_IMPL_AVX2,
+
+    MIX_NUM_IMPLS
+} mix_impl_t;
+
+/**
+*   @brief  "High shelf" biquad filter state, shared coefficients with a
+*           separate history for the left and right channel.
+**/
+typedef struct {
+    float   a1, a2, b0, b1, b2;
+    float   z1[2];
+    float   z2[2];
+} mix_filter_t;
+
+/**
+*   @brief  Adds 'count' samples of 'data' into 'samp' scaled by the given volumes.
+*           Volumes are pre-scaled by the caller (8 bit and downmix factors included).
+*           The "full" stereo kernels only use 'leftvol'.
+**/
+typedef void (*mix_paintfunc_t)(const uint8_t *data, int count, float leftvol, float rightvol, samplepair_t *samp);
+
+typedef struct {
+    const char      *name;
+    //! Channel painting into the float paint buffer.
+    mix_paintfunc_t paint[MIX_PAINT_NUM];
+    //! Clips and converts 'count' stereo pairs into interleaved 16 bit output.
+    void            (*transfer_stereo16)(const samplepair_t *samp, int count, int16_t *out);
+    //! Runs the filter over both channels of 'count' stereo pairs in place.
+    void            (*filter_stereo)(mix_filter_t *filter, samplepair_t *samp, int count);
+} mix_kernels_t;
+
+/**
+*   @return True if the CPU (and OS) support the given implementation.
+**/
+bool Mix_ImplSupported(mix_impl_t impl);
+/**
+*   @return The fastest supported implementation not exceeding 'max_impl'.
+**/
+mix_impl_t Mix_BestImpl(mix_impl_t max_impl);
+/**
+*   @return The kernels for 'impl', or NULL if it is not supported.
+**/
+const mix_kernels_t *Mix_GetKernels(mix_impl_t impl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MIX_H
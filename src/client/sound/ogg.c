@@ -540,6 +540,66 @@ fail:
 	return false;
 }
 
+#if USE_SNDDMA
+/*
+ * Opens an in-memory Ogg/Vorbis file for incremental decoding and fills
+ * in s_info, without decoding any samples. The data must stay valid until
+ * the stream is closed.
+ */
+void *OGG_OpenStream(const byte *data, int len)
+{
+	int ret;
+	stb_vorbis *vf = stb_vorbis_open_memory(data, len, &ret, NULL);
+	if (!vf) {
+		Com_DPrintf("%s does not appear to be an Ogg bitstream (error %d)\n", s_info.name, ret);
+		return NULL;
+	}
+
+	unsigned int samples = stb_vorbis_stream_length_in_samples(vf);
+	if (vf->channels < 1 || vf->channels > 2 || vf->sample_rate < 8000 || vf->sample_rate > 48000 || samples < 1) {
+		stb_vorbis_close(vf);
+		return NULL;
+	}
+
+	s_info.channels = vf->channels;
+	s_info.rate = vf->sample_rate;
+	s_info.width = 2;
+	s_info.loopstart = -1;
+	s_info.samples = samples;
+	s_info.data = NULL;
+	return vf;
+}
+
+/*
+ * Decodes up to 'samples' interleaved 16 bit samples starting at 'offset'.
+ * Only touches the decoder state, so it may run on a worker thread as long
+ * as a single stream isn't read from concurrently.
+ */
+int OGG_ReadStream(void *handle, int offset, int16_t *out, int samples)
+{
+	stb_vorbis *vf = handle;
+	int total = 0;
+
+	if (stb_vorbis_get_sample_offset(vf) != offset && !stb_vorbis_seek(vf, offset))
+		return 0;
+
+	while (total < samples) {
+		int ret = stb_vorbis_get_samples_short_interleaved(vf, vf->channels, out + total * vf->channels, (samples - total) * vf->channels);
+		if (ret == 0)
+			break;
+
+		total += ret;
+	}
+
+	return total;
+}
+
+void OGG_CloseStream(void *handle)
+{
+	stb_vorbis_close(handle);
+}
+#endif
+
 /*
  * List Ogg Vorbis files and print current playback state.
  */
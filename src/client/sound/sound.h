@@ -23,19 +23,16 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #if USE_SNDDMA
 #include "client/sound/dma.h"
+#include "mix.h"
 #endif
 
 // =======================================================================
 // EAX Reverb Effects( OpenAL only ), stub functions for DMA.
 // =======================================================================
 
-/**
-*   @brief
-**/
-typedef struct {
-    float   left;
-    float   right;
-} samplepair_t;
+#if USE_SNDDMA
+typedef struct sfxstream_s sfxstream_t;
+#endif
 
 /**
 *   @brief
@@ -50,6 +47,7 @@ typedef struct sfxcache_s {
     unsigned    bufnum;
 #endif
 #if USE_SNDDMA
+    sfxstream_t *stream;        // decoded on demand, data is unused
     byte        data[1];        // variable sized
 #endif
 } sfxcache_t;
@@ -63,6 +61,8 @@ typedef struct sfx_s {
     sfxcache_t  *cache;
     char        *truename;
     int         error;
+    list_t      cache_entry;    // in the sample cache LRU while cache is set
+    unsigned    cache_frame;    // last update the cache was used on
 } sfx_t;
 
 #define PS_FIRST(list)      LIST_FIRST(playsound_t, list, entry)
@@ -185,6 +185,30 @@ extern sndapi_t     s_api;
 extern channel_t    s_channels[MAX_CHANNELS];
 extern int          s_numchannels;
 
+/**
+*   Looping Sounds:
+**/
+//! An audible looping sound emitter, spatialized once per update by S_BuildLoopSounds.
+typedef struct {
+    int     entnum;
+    vec3_t  dir;        // normalized listener -> emitter direction
+    float   dist;       // attenuated distance, [0, 1)
+    int     next;       // next emitter playing the same sound, -1 if last
+} loopemitter_t;
+
+//! All audible emitters of a single sound, in first seen entity order.
+typedef struct {
+    sfx_t   *sfx;       // NULL if the sound failed to load
+    int     first;      // first emitter in s_loopemitters, -1 if none
+    int     last;       // last emitter, for appending
+    int     count;      // 0 if all emitters were culled
+} loopsound_t;
+
+extern loopemitter_t    s_loopemitters[MAX_EDICTS];
+extern int              s_numloopemitters;
+extern loopsound_t      s_loopsounds[MAX_SOUNDS];
+extern int              s_numloopsounds;
+
 /**
 *   Sound Painting:
 **/
@@ -198,6 +222,9 @@ extern wavinfo_t    s_info;
 **/
 extern cvar_t       *s_volume;
 extern cvar_t       *s_ambient;
+#if USE_SNDDMA
+extern cvar_t       *s_streamsize;
+#endif
 #if USE_DEBUG
 extern cvar_t       *s_show;
 #endif
@@ -228,12 +255,29 @@ static inline const bool S_IsUnderWater( void ) {
 **/
 sfx_t *S_SfxForHandle(qhandle_t hSfx);
 sfxcache_t *S_LoadSound(sfx_t *s);
+void S_TouchSound(sfx_t *s);
+void S_CacheSound(sfx_t *s);
 channel_t *S_PickChannel(int entnum, int entchannel);
 void S_IssuePlaysound(playsound_t *ps);
-void S_BuildSoundList(int *sounds);
+void S_BuildLoopSounds(void);
 void S_SetupSpatialListener( const vec3_t viewOrigin, const vec3_t vForward, const vec3_t vRight, const vec3_t vUp );
 
+#if USE_SNDDMA
+/**
+*   Streamed Sounds( DMA only ):
+**/
+sfxcache_t *S_OpenStream(sfx_t *s, const byte *data, int len);
+void S_FreeStream(sfxstream_t *stream);
+const byte *S_StreamData(sfxstream_t *stream, int64_t pos, int *count);
+unsigned S_StreamUnderruns(const sfxstream_t *stream);
+#endif
+
 // EAX Reverb Funcs:
 const qboolean S_SetEAXEnvironmentProperties( const sfx_eax_properties_t *properties );
 
 bool OGG_Load(sizebuf_t *sz);
+#if USE_SNDDMA
+void *OGG_OpenStream(const byte *data, int len);
+int OGG_ReadStream(void *handle, int offset, int16_t *out, int samples);
+void OGG_CloseStream(void *handle);
+#endif
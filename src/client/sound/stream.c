@@ -0,0 +1,300 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// stream.c -- streamed sound effects for the DMA backend
+//
+// Ogg/Vorbis sounds that would decode to more than s_streamsize kilobytes
+// are kept compressed in memory and decoded in fixed size chunks on the
+// async work thread, into a small ring of chunks consumed by the mixer.
+// Only the first chunk is decoded at load time.
+
+#include "sound.h"
+#include "common/async.h"
+#include "system/system.h"
+
+// output (resampled) sample frames per chunk, ~370 ms at 44.1 kHz
+#define STREAM_CHUNK_SAMPLES    16384
+// chunks kept decoded per stream, the one playing plus read-ahead
+#define STREAM_NUM_CHUNKS       4
+
+typedef struct {
+    int         chunk;          // chunk index held by this slot, -1 if empty
+    byte        *data;
+} streamslot_t;
+
+struct sfxstream_s {
+    void        *decoder;
+    byte        *source;        // compressed file contents, read by the decoder
+    int         srcsamples;     // length in source sample frames
+    int         fracstep;       // source frames per output frame, 8.8 fixed point
+    int         framesize;      // bytes per output sample frame
+    int64_t     length;         // length in output sample frames
+    int         numchunks;
+
+    streamslot_t    slots[STREAM_NUM_CHUNKS];
+
+    // at most one chunk is decoded by the worker at a time, into
+    // a spare buffer that is swapped with the slot once done
+    bool        pending;
+    int         jobchunk;
+    byte        *jobdata;
+    int16_t     *jobsrc;
+    int         jobsrcsize;     // in source sample frames
+
+    unsigned    underruns;
+};
+
+cvar_t  *s_streamsize;
+
+/*
+===============================================================================
+
+CHUNK DECODING
+
+===============================================================================
+*/
+
+static int StreamSourceFrame(const sfxstream_t *st, int64_t pos)
+{
+    return (int)((pos * st->fracstep) >> 8);
+}
+
+// Runs on the async work thread, only touches the decoder and job buffers.
+static void Stream_WorkCb(void *arg)
+{
+    sfxstream_t *st = arg;
+    int64_t first = (int64_t)st->jobchunk * STREAM_CHUNK_SAMPLES;
+    int count = min(st->length - first, STREAM_CHUNK_SAMPLES);
+    int channels = st->framesize / 2;
+    int src_first = StreamSourceFrame(st, first);
+    int src_count = min(StreamSourceFrame(st, first + count - 1) + 1, st->srcsamples) - src_first;
+    int i, j, decoded;
+
+    decoded = OGG_ReadStream(st->decoder, src_first, st->jobsrc, min(src_count, st->jobsrcsize));
+    if (decoded < st->jobsrcsize)
+        memset(st->jobsrc + decoded * channels, 0, (st->jobsrcsize - decoded) * st->framesize);
+
+// resample / decimate to the current output rate, same as DMA_UploadSfx
+    if (st->fracstep == 256) {
+        memcpy(st->jobdata, st->jobsrc, count * st->framesize);
+    } else if (channels == 2) {
+        for (i = 0; i < count; i++) {
+            j = StreamSourceFrame(st, first + i) - src_first;
+            ((uint32_t *)st->jobdata)[i] = ((uint32_t *)st->jobsrc)[j];
+        }
+    } else {
+        for (i = 0; i < count; i++) {
+            j = StreamSourceFrame(st, first + i) - src_first;
+            ((int16_t *)st->jobdata)[i] = st->jobsrc[j];
+        }
+    }
+}
+
+// Runs on the main thread from Com_CompleteAsyncWork.
+static void Stream_DoneCb(void *arg)
+{
+    sfxstream_t *st = arg;
+    streamslot_t *slot = &st->slots[st->jobchunk % STREAM_NUM_CHUNKS];
+    byte *data = slot->data;
+
+    slot->data = st->jobdata;
+    slot->chunk = st->jobchunk;
+    st->jobdata = data;
+    st->pending = false;
+}
+
+static void Stream_QueueChunk(sfxstream_t *st, int chunk)
+{
+    asyncwork_t work = {
+        .work_cb = Stream_WorkCb,
+        .done_cb = Stream_DoneCb,
+        .cb_arg = st,
+    };
+
+    st->jobchunk = chunk;
+    st->pending = true;
+    Com_QueueAsyncWork(&work);
+}
+
+/*
+===============================================================================
+
+READ AHEAD
+
+===============================================================================
+*/
+
+// chunks from 'from' up to 'to', wrapping around since sounds can loop
+static int StreamDistance(const sfxstream_t *st, int from, int to)
+{
+    return (to - from + st->numchunks) % st->numchunks;
+}
+
+// Makes sure the chunk being played and the ones after it are decoded,
+// without throwing out a chunk that will be needed sooner.
+static void Stream_Prefetch(sfxstream_t *st, int chunk)
+{
+    int i, next, held;
+
+    if (st->pending)
+        return;
+
+    for (i = 0; i < min(STREAM_NUM_CHUNKS, st->numchunks); i++) {
+        next = (chunk + i) % st->numchunks;
+        held = st->slots[next % STREAM_NUM_CHUNKS].chunk;
+        if (held == next)
+            continue;
+        if (held != -1 && StreamDistance(st, chunk, held) < i)
+            break;
+
+        Stream_QueueChunk(st, next);
+        break;
+    }
+}
+
+/**
+*   @brief  Returns the decoded samples at output position 'pos', with 'count'
+*           clamped to the contiguous run available from the returned pointer.
+*           Returns NULL (and still clamps 'count') if the chunk isn't decoded
+*           yet, in which case the caller should skip over it.
+**/
+const byte *S_StreamData(sfxstream_t *st, int64_t pos, int *count)
+{
+    int chunk = pos / STREAM_CHUNK_SAMPLES;
+    int offset = pos - (int64_t)chunk * STREAM_CHUNK_SAMPLES;
+    streamslot_t *slot = &st->slots[chunk % STREAM_NUM_CHUNKS];
+
+    *count = min(*count, STREAM_CHUNK_SAMPLES - offset);
+
+    Stream_Prefetch(st, chunk);
+
+    if (slot->chunk != chunk) {
+        st->underruns++;
+        return NULL;
+    }
+
+    return slot->data + offset * st->framesize;
+}
+
+unsigned S_StreamUnderruns(const sfxstream_t *st)
+{
+    return st->underruns;
+}
+
+/*
+===============================================================================
+
+OPENING / CLOSING
+
+===============================================================================
+*/
+
+/**
+*   @brief  Sets up 'sfx' as a streamed sound if it is an Ogg/Vorbis file that
+*           decodes to more than s_streamsize kilobytes. Returns NULL if the
+*           sound should be loaded the regular way.
+**/
+sfxcache_t *S_OpenStream(sfx_t *sfx, const byte *data, int len)
+{
+    sfxstream_t *st;
+    sfxcache_t  *sc;
+    void        *decoder;
+    float       stepscale;
+    int64_t     length;
+    int         i, bufsize;
+
+    if (s_started != SS_DMA || s_streamsize->integer <= 0)
+        return NULL;
+
+    decoder = OGG_OpenStream(data, len);
+    if (!decoder)
+        return NULL;
+
+    stepscale = (float)s_info.rate / dma.speed;
+    length = s_info.samples / stepscale;
+    if ((int64_t)s_info.samples * s_info.width * s_info.channels <= s_streamsize->integer * 1024LL || !length) {
+        OGG_CloseStream(decoder);
+        return NULL;
+    }
+
+    // the decoder reads from the file data, keep a copy of it
+    st = S_Malloc(sizeof(*st));
+    memset(st, 0, sizeof(*st));
+    st->source = S_Malloc(len);
+    memcpy(st->source, data, len);
+    OGG_CloseStream(decoder);
+    st->decoder = OGG_OpenStream(st->source, len);
+    if (!st->decoder) {
+        Z_Free(st->source);
+        Z_Free(st);
+        return NULL;
+    }
+
+    st->srcsamples = s_info.samples;
+    st->fracstep = stepscale * 256;
+    st->framesize = s_info.width * s_info.channels;
+    st->length = length;
+    st->numchunks = (length + STREAM_CHUNK_SAMPLES - 1) / STREAM_CHUNK_SAMPLES;
+
+    bufsize = STREAM_CHUNK_SAMPLES * st->framesize;
+    for (i = 0; i < STREAM_NUM_CHUNKS; i++) {
+        st->slots[i].chunk = -1;
+        st->slots[i].data = S_Malloc(bufsize);
+    }
+    st->jobdata = S_Malloc(bufsize);
+    st->jobsrcsize = (STREAM_CHUNK_SAMPLES * st->fracstep >> 8) + 2;
+    st->jobsrc = S_Malloc(st->jobsrcsize * st->framesize);
+
+    // decode the start right away so the first play doesn't underrun
+    st->jobchunk = 0;
+    Stream_WorkCb(st);
+    Stream_DoneCb(st);
+
+    sc = sfx->cache = S_Malloc(sizeof(*sc));
+    memset(sc, 0, sizeof(*sc));
+    sc->length = length;
+    sc->loopstart = -1;
+    sc->width = s_info.width;
+    sc->channels = s_info.channels;
+    sc->size = len + (STREAM_NUM_CHUNKS + 1) * bufsize + st->jobsrcsize * st->framesize;
+    sc->stream = st;
+
+    return sc;
+}
+
+/**
+*   @brief  Frees the stream, waiting for a chunk still being decoded first.
+**/
+void S_FreeStream(sfxstream_t *st)
+{
+    int i;
+
+    while (st->pending) {
+        Com_CompleteAsyncWork();
+        if (st->pending)
+            Sys_Sleep(1);
+    }
+
+    OGG_CloseStream(st->decoder);
+    for (i = 0; i < STREAM_NUM_CHUNKS; i++)
+        Z_Free(st->slots[i].data);
+    Z_Free(st->jobdata);
+    Z_Free(st->jobsrc);
+    Z_Free(st->source);
+    Z_Free(st);
+}
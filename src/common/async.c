@@ -19,6 +19,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "shared/shared.h"
 #include "common/async.h"
 #include "common/zone.h"
+#include "common/net/net.h"
 #include "system/pthread.h"
 
 static bool work_initialized;
@@ -55,6 +56,9 @@ static void *work_func(void *arg)
         pthread_mutex_lock(&work_lock);
 
         append_work(&done_head, work);
+
+        // don't let the main thread sleep through the completion
+        NET_Wakeup();
     }
     pthread_mutex_unlock(&work_lock);
 
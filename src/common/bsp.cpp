@@ -1458,6 +1458,360 @@ static void FixLeafContents( bsp_t *bsp ) {
 }
 #endif 
 
+/*
+===============================================================================
+
+                    BSP CACHE
+
+Fully loaded maps are kept in `cache/maps/<name>.bspc`: the bsp_t, its hunk
+with every pointer turned into an offset, the list of places to fix up and
+the PVS matrix. Loading one takes a single read and relocation pass instead
+of parsing the lumps and building the PVS matrix again. The cache is keyed
+by the checksum of the .bsp and of the cache format, anything that doesn't
+match is ignored and written again once the map is parsed.
+
+The engine build is identified by BSP_CACHE_VERSION and the sizes of the
+cached structures, not by when bsp.cpp was compiled, so the client and the
+dedicated server share their caches. Bump BSP_CACHE_VERSION whenever the
+lump loaders change what ends up in the hunk.
+
+===============================================================================
+*/
+
+#define BSP_CACHE_IDENT     MakeLittleLong('B','S','P','C')
+#define BSP_CACHE_VERSION   2
+
+// encoded pointers: 0 is NULL, the rest is offset into the hunk plus one
+#define BSP_CACHE_NULLTEXINFO   UINTPTR_MAX
+
+typedef struct {
+    uint32_t    ident;
+    uint32_t    version;
+    uint32_t    build;      // checksum of the cached structure layouts
+    uint32_t    filelen;    // of the .bsp
+    uint32_t    checksum;   // of the .bsp
+    uint32_t    hunksize;
+    uint32_t    numrelocs;
+    uint32_t    pvssize;    // 0 if the PVS matrix isn't included
+} dbspcache_t;
+
+typedef struct {
+    const bsp_t *bsp;
+    byte        *data;      // copy of the hunk being encoded
+    uint32_t    *relocs;
+    uint32_t    numrelocs;
+    bool        error;
+} bspcache_writer_t;
+
+static cvar_t   *map_cache;
+
+static uint32_t BSP_CacheBuild( void ) {
+    const uint32_t sizes[] = {
+        (uint32_t)sizeof( void * ), (uint32_t)offsetof( bsp_t, name ),
+        (uint32_t)sizeof( mbrushside_t ), (uint32_t)sizeof( mtexinfo_t ), (uint32_t)sizeof( cm_plane_t ),
+        (uint32_t)sizeof( mnode_t ), (uint32_t)sizeof( mleaf_t ), (uint32_t)sizeof( mmodel_t ),
+        (uint32_t)sizeof( mbrush_t ), (uint32_t)sizeof( marea_t ), (uint32_t)sizeof( mareaportal_t ),
+        (uint32_t)sizeof( mface_t ), (uint32_t)sizeof( mvertex_t ), (uint32_t)sizeof( medge_t ),
+        (uint32_t)sizeof( msurfedge_t ), (uint32_t)sizeof( mbasis_t ),
+    };
+
+    return Com_BlockChecksum( sizes, sizeof( sizes ) );
+}
+
+// Converts `maps/<name>.bsp` into `cache/maps/<name>.bspc`
+static bool BSP_GetCacheFileName( const char *map_path, char cache_path[ MAX_OSPATH ] ) {
+    size_t path_len = strlen( map_path );
+    if ( path_len < 5 || Q_stricmp( map_path + path_len - 4, ".bsp" ) )
+        return false;
+
+    return Q_snprintf( cache_path, MAX_OSPATH, "cache/%sc", map_path ) < MAX_OSPATH;
+}
+
+static uintptr_t BSP_EncodePointer( bspcache_writer_t *w, const void *ptr ) {
+    const byte *base = static_cast<const byte *>( w->bsp->hunk.base );
+    const byte *p = static_cast<const byte *>( ptr );
+
+    if ( !p )
+        return 0;
+    if ( p == (const byte *)&nulltexinfo )
+        return BSP_CACHE_NULLTEXINFO;
+    if ( p >= base && p < base + w->bsp->hunk.cursize )
+        return (uintptr_t)( p - base ) + 1;
+
+    // points to something that won't be there next time
+    w->error = true;
+    return 0;
+}
+
+// records a pointer stored in the hunk
+static void BSP_CachePointer( bspcache_writer_t *w, const void *slot ) {
+    const byte *base = static_cast<const byte *>( w->bsp->hunk.base );
+    const size_t ofs = static_cast<const byte *>( slot ) - base;
+    const uintptr_t enc = BSP_EncodePointer( w, *(void *const *)slot );
+
+    if ( !enc )
+        return;
+
+    memcpy( w->data + ofs, &enc, sizeof( enc ) );
+    if ( !( w->numrelocs & 4095 ) )
+        w->relocs = static_cast<uint32_t *>( Z_Realloc( w->relocs, sizeof( w->relocs[ 0 ] ) * ( w->numrelocs + 4096 ) ) );
+    w->relocs[ w->numrelocs++ ] = ofs;
+}
+
+static void BSP_CacheHunkPointers( bspcache_writer_t *w ) {
+    const bsp_t *bsp = w->bsp;
+    int i;
+
+    for ( i = 0; i < bsp->numtexinfo; i++ ) {
+        #if USE_REF
+        BSP_CachePointer( w, &bsp->texinfo[ i ].next );
+        #endif
+        if ( bsp->texinfo[ i ].c.material )
+            w->error = true;
+    }
+    for ( i = 0; i < bsp->numbrushsides; i++ ) {
+        BSP_CachePointer( w, &bsp->brushsides[ i ].plane );
+        BSP_CachePointer( w, &bsp->brushsides[ i ].texinfo );
+    }
+    for ( i = 0; i < bsp->numbrushes; i++ ) {
+        BSP_CachePointer( w, &bsp->brushes[ i ].firstbrushside );
+    }
+    for ( i = 0; i < bsp->numleafbrushes; i++ ) {
+        BSP_CachePointer( w, &bsp->leafbrushes[ i ] );
+    }
+    for ( i = 0; i < bsp->numnodes; i++ ) {
+        BSP_CachePointer( w, &bsp->nodes[ i ].plane );
+        BSP_CachePointer( w, &bsp->nodes[ i ].parent );
+        BSP_CachePointer( w, &bsp->nodes[ i ].children[ 0 ] );
+        BSP_CachePointer( w, &bsp->nodes[ i ].children[ 1 ] );
+        #if USE_REF
+        BSP_CachePointer( w, &bsp->nodes[ i ].firstface );
+        #endif
+    }
+    for ( i = 0; i < bsp->numleafs; i++ ) {
+        BSP_CachePointer( w, &bsp->leafs[ i ].plane );
+        BSP_CachePointer( w, &bsp->leafs[ i ].parent );
+        BSP_CachePointer( w, &bsp->leafs[ i ].firstleafbrush );
+        #if USE_REF
+        BSP_CachePointer( w, &bsp->leafs[ i ].firstleafface );
+        #endif
+    }
+    for ( i = 0; i < bsp->nummodels; i++ ) {
+        BSP_CachePointer( w, &bsp->models[ i ].headnode );
+        BSP_CachePointer( w, &bsp->models[ i ].firstface );
+    }
+    for ( i = 0; i < bsp->numareas; i++ ) {
+        BSP_CachePointer( w, &bsp->areas[ i ].firstareaportal );
+    }
+
+    #if USE_REF
+    for ( i = 0; i < bsp->numfaces; i++ ) {
+        const mface_t *face = &bsp->faces[ i ];
+        BSP_CachePointer( w, &face->firstsurfedge );
+        BSP_CachePointer( w, &face->plane );
+        BSP_CachePointer( w, &face->lightmap );
+        BSP_CachePointer( w, &face->texinfo );
+        if ( face->entity || face->next )
+            w->error = true;
+    }
+    for ( i = 0; i < bsp->numleaffaces; i++ ) {
+        BSP_CachePointer( w, &bsp->leaffaces[ i ] );
+    }
+    for ( i = 0; i < bsp->numedges; i++ ) {
+        BSP_CachePointer( w, &bsp->edges[ i ].v[ 0 ] );
+        BSP_CachePointer( w, &bsp->edges[ i ].v[ 1 ] );
+    }
+    for ( i = 0; i < bsp->numsurfedges; i++ ) {
+        BSP_CachePointer( w, &bsp->surfedges[ i ].edge );
+    }
+    #endif
+}
+
+// applies 'func' to every bsp_t member that points into the hunk
+#if USE_REF
+#define BSP_CACHE_REF_MEMBERS(func) \
+    func( faces ) func( leaffaces ) func( lightmap ) func( vertices ) \
+    func( edges ) func( surfedges ) func( basisvectors ) func( bases )
+#else
+#define BSP_CACHE_REF_MEMBERS(func)
+#endif
+#define BSP_CACHE_MEMBERS(func) \
+    func( brushsides ) func( texinfo ) func( planes ) func( nodes ) func( leafs ) \
+    func( leafbrushes ) func( models ) func( brushes ) func( vis ) func( entitystring ) \
+    func( areas ) func( areaportals ) BSP_CACHE_REF_MEMBERS( func )
+
+static void BSP_WriteCache( const bsp_t *bsp, const char *cache_path, uint32_t filelen ) {
+    bspcache_writer_t w = { bsp };
+    dbspcache_t header;
+    uint32_t ident;
+    bsp_t copy;
+    qhandle_t f;
+    int64_t ret;
+
+    w.data = static_cast<byte *>( Z_Malloc( bsp->hunk.cursize ) );
+    memcpy( w.data, bsp->hunk.base, bsp->hunk.cursize );
+
+    BSP_CacheHunkPointers( &w );
+
+    memcpy( &copy, bsp, offsetof( bsp_t, name ) );
+    #define ENCODE( member ) \
+        *(uintptr_t *)&copy.member = BSP_EncodePointer( &w, bsp->member );
+    BSP_CACHE_MEMBERS( ENCODE )
+    #undef ENCODE
+    copy.pvs_matrix = copy.pvs2_matrix = NULL;
+    memset( &copy.entry, 0, sizeof( copy.entry ) );
+    memset( &copy.hunk, 0, sizeof( copy.hunk ) );
+
+    if ( w.error || bsp->hunk.cursize > UINT32_MAX ) {
+        Com_DPrintf( "%s: %s has external pointers, not caching\n", __func__, bsp->name );
+        goto done;
+    }
+
+    ret = FS_OpenFile( cache_path, &f, FS_MODE_WRITE );
+    if ( !f ) {
+        Com_DPrintf( "Couldn't write %s: %s\n", cache_path, Q_ErrorString( ret ) );
+        goto done;
+    }
+
+    header.ident = BSP_CACHE_IDENT;
+    header.version = BSP_CACHE_VERSION;
+    header.build = BSP_CacheBuild();
+    header.filelen = filelen;
+    header.checksum = bsp->checksum;
+    header.hunksize = bsp->hunk.cursize;
+    header.numrelocs = w.numrelocs;
+    header.pvssize = ( bsp->pvs_matrix && !bsp->pvs_patched ) ? bsp->visrowsize * bsp->vis->numclusters : 0;
+
+    // the header goes in last, so a partially written file is never used
+    ident = header.ident;
+    header.ident = 0;
+    ret = FS_Write( &header, sizeof( header ), f );
+    if ( ret >= 0 )
+        ret = FS_Write( &copy, offsetof( bsp_t, name ), f );
+    if ( ret >= 0 )
+        ret = FS_Write( w.data, header.hunksize, f );
+    if ( ret >= 0 )
+        ret = FS_Write( w.relocs, sizeof( w.relocs[ 0 ] ) * w.numrelocs, f );
+    if ( ret >= 0 && header.pvssize )
+        ret = FS_Write( bsp->pvs_matrix, header.pvssize, f );
+    if ( ret >= 0 )
+        ret = FS_Seek( f, 0, SEEK_SET );
+    if ( ret >= 0 ) {
+        header.ident = ident;
+        ret = FS_Write( &header, sizeof( header ), f );
+    }
+    if ( ret >= 0 )
+        ret = FS_CloseFile( f );
+    else
+        FS_CloseFile( f );
+
+    if ( ret < 0 ) {
+        Com_WPrintf( "Couldn't write %s: %s\n", cache_path, Q_ErrorString( ret ) );
+    }
+
+done:
+    Z_Free( w.relocs );
+    Z_Free( w.data );
+}
+
+static bool BSP_DecodePointer( const bsp_t *bsp, void **slot ) {
+    const uintptr_t enc = *(uintptr_t *)slot;
+
+    if ( !enc ) {
+        *slot = NULL;
+    } else if ( enc == BSP_CACHE_NULLTEXINFO ) {
+        *slot = &nulltexinfo;
+    } else if ( enc - 1 < bsp->hunk.cursize ) {
+        *slot = (byte *)bsp->hunk.base + enc - 1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bsp_t *BSP_LoadCache( const char *name, const char *cache_path, uint32_t filelen, uint32_t checksum ) {
+    dbspcache_t header;
+    uint32_t *relocs = NULL;
+    bsp_t *bsp = NULL;
+    qhandle_t f;
+    size_t len;
+    uint32_t i;
+    bool ok = false;
+
+    FS_OpenFile( cache_path, &f, FS_MODE_READ );
+    if ( !f )
+        return NULL;
+
+    if ( FS_Read( &header, sizeof( header ), f ) != sizeof( header ) ||
+         header.ident != BSP_CACHE_IDENT || header.version != BSP_CACHE_VERSION ||
+         header.build != BSP_CacheBuild() || header.filelen != filelen || header.checksum != checksum ) {
+        Com_DPrintf( "%s is stale\n", cache_path );
+        goto fail;
+    }
+
+    len = strlen( name );
+    bsp = static_cast<bsp_t *>( Z_Mallocz( sizeof( *bsp ) + len ) );
+    if ( FS_Read( bsp, offsetof( bsp_t, name ), f ) != offsetof( bsp_t, name ) )
+        goto fail;
+    memcpy( bsp->name, name, len + 1 );
+    bsp->refcount = 1;
+    memset( &bsp->hunk, 0, sizeof( bsp->hunk ) );
+    bsp->pvs_matrix = bsp->pvs2_matrix = NULL;
+    bsp->pvs_patched = false;
+
+    Hunk_Begin( &bsp->hunk, header.hunksize );
+    Hunk_Alloc( &bsp->hunk, header.hunksize );
+    bsp->hunk.cursize = header.hunksize;
+    if ( FS_Read( bsp->hunk.base, header.hunksize, f ) != header.hunksize )
+        goto fail;
+
+    // fix up the pointers in one pass
+    relocs = static_cast<uint32_t *>( Z_Malloc( sizeof( relocs[ 0 ] ) * header.numrelocs + 1 ) );
+    if ( FS_Read( relocs, sizeof( relocs[ 0 ] ) * header.numrelocs, f ) != sizeof( relocs[ 0 ] ) * header.numrelocs )
+        goto fail;
+    for ( i = 0; i < header.numrelocs; i++ ) {
+        if ( relocs[ i ] > header.hunksize - sizeof( void * ) || relocs[ i ] & ( sizeof( void * ) - 1 ) )
+            goto fail;
+        if ( !BSP_DecodePointer( bsp, (void **)( (byte *)bsp->hunk.base + relocs[ i ] ) ) )
+            goto fail;
+    }
+
+    #define DECODE( member ) \
+        if ( !BSP_DecodePointer( bsp, (void **)&bsp->member ) ) goto fail;
+    BSP_CACHE_MEMBERS( DECODE )
+    #undef DECODE
+
+    Hunk_End( &bsp->hunk );
+
+    if ( BSP_LoadPatchedPVS( bsp ) ) {
+        bsp->pvs_patched = true;
+    } else if ( bsp->vis && header.pvssize == bsp->visrowsize * bsp->vis->numclusters ) {
+        bsp->pvs_matrix = static_cast<byte *>( Z_Malloc( header.pvssize ) );
+        if ( FS_Read( bsp->pvs_matrix, header.pvssize, f ) != header.pvssize ) {
+            Z_Freep( (void **)&bsp->pvs_matrix );
+            goto fail;
+        }
+    } else {
+        BSP_BuildPvsMatrix( bsp );
+    }
+
+    ok = true;
+
+fail:
+    Z_Free( relocs );
+    FS_CloseFile( f );
+
+    if ( !ok && bsp ) {
+        Com_WPrintf( "%s is damaged, reloading %s\n", cache_path, name );
+        Z_Free( bsp->pvs2_matrix );
+        if ( bsp->hunk.base )
+            Hunk_Free( &bsp->hunk );
+        Z_Free( bsp );
+        bsp = NULL;
+    }
+    return bsp;
+}
+
 /*
 ==================
 BSP_Load
@@ -1476,6 +1830,9 @@ int BSP_Load( const char *name, bsp_t **bsp_p ) {
     uint32_t        lump_count[ q_countof( bsp_lumps ) ];
     size_t          memsize;
     bool            extended = false;
+    uint32_t        checksum;
+    char            cache_path[ MAX_OSPATH ];
+    bool            cache;
 
     #if USE_REF
     lump_t ext[ q_countof( bspx_lumps ) ] = { 0 };
@@ -1526,6 +1883,18 @@ int BSP_Load( const char *name, bsp_t **bsp_p ) {
         goto fail2;
     }
 
+    // calculate the checksum
+    checksum = Com_BlockChecksum( buf, filelen );
+
+    // use the precompiled version if it is still good
+    cache = map_cache->integer && BSP_GetCacheFileName( name, cache_path );
+    if ( cache && ( bsp = BSP_LoadCache( name, cache_path, filelen, checksum ) ) != NULL ) {
+        List_Append( &bsp_cache, &bsp->entry );
+        FS_FreeFile( buf );
+        *bsp_p = bsp;
+        return Q_ERR_SUCCESS;
+    }
+
     // byte swap and validate all lumps
     memsize = 0;
     maxpos = 0;
@@ -1567,8 +1936,7 @@ int BSP_Load( const char *name, bsp_t **bsp_p ) {
 
     Hunk_Begin( &bsp->hunk, memsize );
 
-    // calculate the checksum
-    bsp->checksum = Com_BlockChecksum( buf, filelen );
+    bsp->checksum = checksum;
 
     // load all lumps
     for ( i = 0; i < q_countof( bsp_lumps ); i++ ) {
@@ -1613,6 +1981,10 @@ int BSP_Load( const char *name, bsp_t **bsp_p ) {
     FixLeafContents( bsp );
     #endif
 
+    if ( cache ) {
+        BSP_WriteCache( bsp, cache_path, filelen );
+    }
+
     *bsp_p = bsp;
     return Q_ERR_SUCCESS;
 
@@ -1882,6 +2254,8 @@ void BSP_Init( void ) {
     // WID: Not needed anymore.
     //map_visibility_patch = Cvar_Get("map_visibility_patch", "1", 0);
 
+    map_cache = Cvar_Get( "map_cache", "1", 0 );
+
     Cmd_AddCommand( "bsplist", BSP_List_f );
 
     List_Init( &bsp_cache );
@@ -53,6 +53,13 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <errno.h>
 #ifdef __linux__
 #include <linux/types.h>
+// recvmmsg/sendmmsg
+#ifdef MSG_WAITFORONE
+#define USE_UDP_BATCH   1
+#endif
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define USE_EPOLL       1
 #if USE_ICMP
 #include <linux/errqueue.h>
 #else
@@ -106,6 +113,9 @@ static cvar_t   *net_enable_ipv6;
 #if USE_ICMP
 static cvar_t   *net_ignore_icmp;
 #endif
+#if USE_UDP_BATCH
+static cvar_t   *net_batch;
+#endif
 
 QEXTERN_C_ENCLOSE( static netflag_t net_active; );
 static int          net_error;
@@ -141,6 +151,13 @@ static uint64_t     net_bytes_sent;
 static uint64_t     net_packets_rcvd;
 static uint64_t     net_packets_sent;
 
+#if USE_UDP_BATCH
+static uint64_t     net_batch_recv_calls;
+static uint64_t     net_batch_recv_packets;
+static uint64_t     net_batch_send_calls;
+static uint64_t     net_batch_send_packets;
+#endif
+
 //=============================================================================
 
 static size_t NET_NetadrToSockadr(const netadr_t *a, struct sockaddr_storage *s)
@@ -512,6 +529,12 @@ static void NET_Stats_f(void)
 #else
     Com_Printf("Total errors: %" PRIu64 "/%" PRIu64 " (send/recv)\n",
                net_send_errors, net_recv_errors);
+#endif
+#if USE_UDP_BATCH
+    Com_Printf("Batched recv: %" PRIu64 " packets in %" PRIu64 " calls\n",
+               net_batch_recv_packets, net_batch_recv_calls);
+    Com_Printf("Batched send: %" PRIu64 " packets in %" PRIu64 " calls\n",
+               net_batch_send_packets, net_batch_send_calls);
 #endif
     Com_Printf("Current upload rate: %zu bytes/sec\n", net_rate_up);
     Com_Printf("Current download rate: %zu bytes/sec\n", net_rate_dn);
@@ -677,6 +700,10 @@ void NET_RemoveFd(qsocket_t fd)
     ioentry_t *e = os_get_io(fd);
     int i;
 
+#if USE_EPOLL
+    os_poll_remove(fd);
+#endif
+
     memset(e, 0, sizeof(*e));
 
     for (i = io_numfds - 1; i >= 0; i--) {
@@ -689,13 +716,27 @@ void NET_RemoveFd(qsocket_t fd)
     io_numfds = i + 1;
 }
 
+/*
+=============
+NET_Wakeup
+
+Interrupts NET_Sleep, may be called from any thread.
+=============
+*/
+void NET_Wakeup(void)
+{
+#if USE_EPOLL
+    os_poll_wakeup();
+#endif
+}
+
 /*
 =============
 NET_Sleep
 
-Sleeps msec or until some file descriptor is ready. Implementation is not
-terribly efficient, but that's fine for a small number of descriptors we
-typically have.
+Sleeps msec or until some file descriptor is ready. Uses epoll where
+available, otherwise select(), which is not terribly efficient, but
+that's fine for a small number of descriptors we typically have.
 =============
 */
 int64_t NET_Sleep(int64_t msec)
@@ -706,6 +747,15 @@ int64_t NET_Sleep(int64_t msec)
     qsocket_t fd;
     int64_t i, ret;
 
+#if USE_EPOLL
+    if (io_epfd != -1) {
+        ret = os_poll(msec);
+        if (ret == -1)
+            Com_EPrintf("%s: %s\n", __func__, NET_ErrorString());
+        return ret;
+    }
+#endif
+
     if (!io_numfds) {
         // don't bother with select()
         Sys_Sleep(msec);
@@ -757,10 +807,116 @@ int64_t NET_Sleep(int64_t msec)
 
 //=============================================================================
 
+#if USE_UDP_BATCH
+
+// max datagrams moved per recvmmsg/sendmmsg call
+#define NET_BATCH_SIZE  32
+
+typedef struct {
+    struct mmsghdr          hdrs[NET_BATCH_SIZE];
+    struct iovec            iovs[NET_BATCH_SIZE];
+    struct sockaddr_storage addrs[NET_BATCH_SIZE];
+    qsocket_t               socks[NET_BATCH_SIZE];  // send only
+    netadr_t                to[NET_BATCH_SIZE];     // send only
+    byte                    data[NET_BATCH_SIZE][MAX_PACKETLEN];
+} netbatch_t;
+
+static netbatch_t   net_recv_batch;
+static netbatch_t   net_send_batch;
+static int          net_send_queued;
+static bool         net_send_batching;
+
+static void NET_SetupBatchMsg(netbatch_t *b, int i, size_t len, socklen_t addrlen)
+{
+    struct mmsghdr *h = &b->hdrs[i];
+
+    b->iovs[i].iov_base = b->data[i];
+    b->iovs[i].iov_len = len;
+
+    memset(h, 0, sizeof(*h));
+    h->msg_hdr.msg_name = &b->addrs[i];
+    h->msg_hdr.msg_namelen = addrlen;
+    h->msg_hdr.msg_iov = &b->iovs[i];
+    h->msg_hdr.msg_iovlen = 1;
+}
+
+#endif // USE_UDP_BATCH
+
+// hands the packet in msg_read_buffer to the callback
+static void NET_DispatchUdpPacket(int len, void (*packet_cb)(void))
+{
+    NET_LogPacket(&net_from, "UDP recv", msg_read_buffer, len);
+
+    net_rate_rcvd += len;
+    net_bytes_rcvd += len;
+    net_packets_rcvd++;
+
+    SZ_Init(&msg_read, msg_read_buffer, sizeof(msg_read_buffer));
+    msg_read.cursize = len;
+
+    (*packet_cb)();
+}
+
+// returns false once there is nothing left to read
+static bool NET_GetUdpPacket(qsocket_t sock, ioentry_t *e, void (*packet_cb)(void))
+{
+    int ret = os_udp_recv(sock, msg_read_buffer, MAX_PACKETLEN, &net_from);
+
+    if (ret == NET_AGAIN) {
+        e->canread = false;
+        return false;
+    }
+
+    if (ret == NET_ERROR) {
+        Com_DPrintf("%s: %s from %s\n", __func__,
+                    NET_ErrorString(), NET_AdrToString(&net_from));
+        net_recv_errors++;
+        return false;
+    }
+
+    NET_DispatchUdpPacket(ret, packet_cb);
+    return true;
+}
+
+#if USE_UDP_BATCH
+
+// same as NET_GetUdpPacket, but reads up to NET_BATCH_SIZE packets per syscall
+static bool NET_GetUdpPacketBatch(qsocket_t sock, ioentry_t *e, void (*packet_cb)(void))
+{
+    netbatch_t *b = &net_recv_batch;
+    int i, count, len;
+
+    for (i = 0; i < NET_BATCH_SIZE; i++)
+        NET_SetupBatchMsg(b, i, MAX_PACKETLEN, sizeof(b->addrs[i]));
+
+    count = os_udp_recv_batch(sock, b->hdrs, NET_BATCH_SIZE);
+    if (count == NET_AGAIN) {
+        e->canread = false;
+        return false;
+    }
+
+    // let the single packet path retry and process the error queue
+    if (count == NET_ERROR)
+        return NET_GetUdpPacket(sock, e, packet_cb);
+
+    net_batch_recv_calls++;
+    net_batch_recv_packets += count;
+
+    for (i = 0; i < count; i++) {
+        NET_SockadrToNetadr(&b->addrs[i], &net_from);
+        len = b->hdrs[i].msg_len;
+        memcpy(msg_read_buffer, b->data[i], len);
+        NET_DispatchUdpPacket(len, packet_cb);
+    }
+
+    return true;
+}
+
+#endif // USE_UDP_BATCH
+
 static void NET_GetUdpPackets(qsocket_t sock, void (*packet_cb)(void))
 {
     ioentry_t *e;
-    int ret;
 
     if (sock == -1)
         return;
@@ -769,31 +925,16 @@ static void NET_GetUdpPackets(qsocket_t sock, void (*packet_cb)(void))
     if (!e->canread)
         return;
 
-    while (1) {
-        ret = os_udp_recv(sock, msg_read_buffer, MAX_PACKETLEN, &net_from);
-        if (ret == NET_AGAIN) {
-            e->canread = false;
-            break;
-        }
-
-        if (ret == NET_ERROR) {
-            Com_DPrintf("%s: %s from %s\n", __func__,
-                        NET_ErrorString(), NET_AdrToString(&net_from));
-            net_recv_errors++;
-            break;
-        }
-
-        NET_LogPacket(&net_from, "UDP recv", msg_read_buffer, ret);
-
-        net_rate_rcvd += ret;
-        net_bytes_rcvd += ret;
-        net_packets_rcvd++;
-
-        SZ_Init(&msg_read, msg_read_buffer, sizeof(msg_read_buffer));
-        msg_read.cursize = ret;
-
-        (*packet_cb)();
+#if USE_UDP_BATCH
+    if (net_batch->integer) {
+        while (NET_GetUdpPacketBatch(sock, e, packet_cb))
+            ;
+        return;
     }
+#endif
+
+    while (NET_GetUdpPacket(sock, e, packet_cb))
+        ;
 }
 
 /*
@@ -821,6 +962,48 @@ void NET_GetPackets(netsrc_t sock, void (*packet_cb)(void))
     NET_GetUdpPackets(udp6_sockets[sock], packet_cb);
 }
 
+// accounts for 'ret' bytes of a 'len' byte packet sent to 'to'
+static void NET_SentUdpPacket(const netadr_t *to, const void *data,
+                              size_t len, int ret)
+{
+    if (ret < len)
+        Com_WPrintf("%s: short send to %s\n", __func__,
+                    NET_AdrToString(to));
+
+#if USE_DEBUG
+    if (net_log_enable->integer)
+        NET_LogPacket(to, "UDP send", static_cast<const byte*>( data ), ret); // WID: C++20: Added cast.
+#endif
+
+    net_rate_sent += ret;
+    net_bytes_sent += ret;
+    net_packets_sent++;
+}
+
+static bool NET_SendUdpPacket(qsocket_t s, const void *data,
+                              size_t len, const netadr_t *to)
+{
+    int ret = os_udp_send(s, data, len, to);
+
+    if (ret == NET_AGAIN)
+        return false;
+
+    if (ret == NET_ERROR) {
+        Com_DPrintf("%s: %s to %s\n", __func__,
+                    NET_ErrorString(), NET_AdrToString(to));
+        net_send_errors++;
+        return false;
+    }
+
+    NET_SentUdpPacket(to, data, len, ret);
+    return true;
+}
+
+#if USE_UDP_BATCH
+static void NET_QueueUdpPacket(qsocket_t s, const void *data,
+                               size_t len, const netadr_t *to);
+#endif
+
 /*
 =============
 NET_SendPacket
@@ -830,7 +1013,6 @@ NET_SendPacket
 bool NET_SendPacket(netsrc_t sock, const void *data,
                     size_t len, const netadr_t *to)
 {
-    int ret;
     qsocket_t s;
 
     if (len == 0)
@@ -863,31 +1045,97 @@ bool NET_SendPacket(netsrc_t sock, const void *data,
     if (s == -1)
         return false;
 
-    ret = os_udp_send(s, data, len, to);
-    if (ret == NET_AGAIN)
-        return false;
+#if USE_UDP_BATCH
+    if (net_send_batching) {
+        NET_QueueUdpPacket(s, data, len, to);
+        return true;
+    }
+#endif
 
-    if (ret == NET_ERROR) {
-        Com_DPrintf("%s: %s to %s\n", __func__,
-                    NET_ErrorString(), NET_AdrToString(to));
-        net_send_errors++;
-        return false;
+    return NET_SendUdpPacket(s, data, len, to);
+}
+
+#if USE_UDP_BATCH
+
+// sends everything queued since NET_BeginSendBatch
+static void NET_FlushUdpPackets(void)
+{
+    netbatch_t *b = &net_send_batch;
+    int i, j, n, ret;
+
+    for (i = 0; i < net_send_queued; ) {
+        // sendmmsg takes a single socket, send each run of packets for the same one
+        for (n = i + 1; n < net_send_queued && b->socks[n] == b->socks[i]; n++)
+            ;
+
+        ret = os_udp_send_batch(b->socks[i], &b->hdrs[i], n - i);
+        if (ret > 0) {
+            net_batch_send_calls++;
+            net_batch_send_packets += ret;
+            for (j = i; j < i + ret; j++)
+                NET_SentUdpPacket(&b->to[j], b->data[j], b->iovs[j].iov_len, b->hdrs[j].msg_len);
+            i += ret;
+            continue;
+        }
+
+        // socket buffer is full, drop the run like single sends would
+        if (ret == NET_AGAIN) {
+            i = n;
+            continue;
+        }
+
+        // let the single packet path retry and account for the error
+        NET_SendUdpPacket(b->socks[i], b->data[i], b->iovs[i].iov_len, &b->to[i]);
+        i++;
     }
 
-    if (ret < len)
-        Com_WPrintf("%s: short send to %s\n", __func__,
-                    NET_AdrToString(to));
+    net_send_queued = 0;
+}
 
-#if USE_DEBUG
-    if (net_log_enable->integer)
-        NET_LogPacket(to, "UDP send", static_cast<const byte*>( data ), ret); // WID: C++20: Added cast.
-#endif
+static void NET_QueueUdpPacket(qsocket_t s, const void *data,
+                               size_t len, const netadr_t *to)
+{
+    netbatch_t *b = &net_send_batch;
+    int i;
 
-    net_rate_sent += ret;
-    net_bytes_sent += ret;
-    net_packets_sent++;
+    if (net_send_queued == NET_BATCH_SIZE)
+        NET_FlushUdpPackets();
 
-    return true;
+    i = net_send_queued++;
+    memcpy(b->data[i], data, len);
+    b->socks[i] = s;
+    b->to[i] = *to;
+    NET_SetupBatchMsg(b, i, len, NET_NetadrToSockadr(to, &b->addrs[i]));
+}
+
+#endif // USE_UDP_BATCH
+
+/*
+=============
+NET_BeginSendBatch
+
+Queues UDP packets sent until NET_EndSendBatch, to be sent with as few
+syscalls as possible. Has no effect on platforms without sendmmsg.
+=============
+*/
+void NET_BeginSendBatch(void)
+{
+#if USE_UDP_BATCH
+    net_send_batching = net_batch->integer;
+#endif
+}
+
+/*
+=============
+NET_EndSendBatch
+=============
+*/
+void NET_EndSendBatch(void)
+{
+#if USE_UDP_BATCH
+    NET_FlushUdpPackets();
+    net_send_batching = false;
+#endif
 }
 
 //=============================================================================
@@ -1119,6 +1367,7 @@ static void NET_OpenServer(void)
         udp_sockets[NS_SERVER] = s;
         e = NET_AddFd(s);
         e->wantread = true;
+        e->edgetriggered = true;
         return;
     }
 
@@ -1155,6 +1404,7 @@ static void NET_OpenServer6(void)
     udp6_sockets[NS_SERVER] = s;
     e = NET_AddFd(s);
     e->wantread = true;
+    e->edgetriggered = true;
 }
 
 #if USE_CLIENT
@@ -1191,6 +1441,7 @@ static void NET_OpenClient(void)
     udp_sockets[NS_CLIENT] = s;
     e = NET_AddFd(s);
     e->wantread = true;
+    e->edgetriggered = true;
 }
 
 static void NET_OpenClient6(void)
@@ -1211,6 +1462,7 @@ static void NET_OpenClient6(void)
     udp6_sockets[NS_CLIENT] = s;
     e = NET_AddFd(s);
     e->wantread = true;
+    e->edgetriggered = true;
 }
 #endif
 
@@ -1873,6 +2125,10 @@ void NET_Init(void)
     net_ignore_icmp = Cvar_Get("net_ignore_icmp", "0", 0);
 #endif
 
+#if USE_UDP_BATCH
+    net_batch = Cvar_Get("net_batch", "1", 0);
+#endif
+
 #if USE_DEBUG
     net_log_enable_changed(net_log_enable);
 #endif
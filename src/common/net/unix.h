@@ -163,6 +163,44 @@ static int os_udp_send(qsocket_t sock, const void *data,
     return NET_ERROR;
 }
 
+#if USE_UDP_BATCH
+
+// receives up to 'count' datagrams with a single syscall
+static int os_udp_recv_batch(qsocket_t sock, struct mmsghdr *msgs, int count)
+{
+    int ret = recvmmsg(sock, msgs, count, 0, NULL);
+
+    if (ret >= 0)
+        return ret;
+
+    net_error = errno;
+
+    // wouldblock is silent
+    if (net_error == EWOULDBLOCK)
+        return NET_AGAIN;
+
+    return NET_ERROR;
+}
+
+// sends up to 'count' datagrams with a single syscall
+static int os_udp_send_batch(qsocket_t sock, struct mmsghdr *msgs, int count)
+{
+    int ret = sendmmsg(sock, msgs, count, 0);
+
+    if (ret >= 0)
+        return ret;
+
+    net_error = errno;
+
+    // wouldblock is silent
+    if (net_error == EWOULDBLOCK)
+        return NET_AGAIN;
+
+    return NET_ERROR;
+}
+
+#endif // USE_UDP_BATCH
+
 static neterr_t os_get_error(void)
 {
     net_error = errno;
@@ -357,11 +395,214 @@ static int os_select(int nfds, fd_set *rfds, fd_set *wfds,
     return ret;
 }
 
+#if USE_EPOLL
+
+// epoll instance, -1 if unavailable and select() is used instead
+static int          io_epfd = -1;
+// eventfd used by NET_Wakeup
+static int          io_wakefd = -1;
+// events each descriptor is registered for, 0 if not registered
+static uint32_t     io_events[FD_SETSIZE];
+// descriptors epoll refuses (regular files), these are always ready
+static bool         io_alwaysready[FD_SETSIZE];
+// level triggered descriptors reported ready by the last poll
+static qsocket_t    io_levelready[FD_SETSIZE];
+static int          io_numlevelready;
+
+static uint32_t os_poll_events(const ioentry_t *e)
+{
+    uint32_t events = 0;
+
+    if (e->wantread)
+        events |= EPOLLIN;
+    if (e->wantwrite)
+        events |= EPOLLOUT;
+    if (e->wantexcept)
+        events |= EPOLLPRI;
+
+    // edge triggered entries keep can* set until they see EWOULDBLOCK
+    if (events && e->edgetriggered)
+        events |= EPOLLET;
+
+    return events;
+}
+
+// registers new descriptors and follows changes to what they wait for
+static void os_poll_update(qsocket_t fd, ioentry_t *e)
+{
+    struct epoll_event ev;
+    uint32_t events = e->inuse ? os_poll_events(e) : 0;
+    int op;
+
+    if (events == io_events[fd] || io_alwaysready[fd])
+        return;
+
+    if (!io_events[fd])
+        op = EPOLL_CTL_ADD;
+    else if (!events)
+        op = EPOLL_CTL_DEL;
+    else
+        op = EPOLL_CTL_MOD;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(io_epfd, op, fd, &ev) == -1) {
+        if (errno == EPERM) {
+            io_alwaysready[fd] = true;
+        } else {
+            Com_DPrintf("%s: fd %d: %s\n", __func__, fd, strerror(errno));
+        }
+    }
+
+    io_events[fd] = events;
+}
+
+static void os_poll_remove(qsocket_t fd)
+{
+    if (io_epfd == -1 || fd < 0 || fd >= FD_SETSIZE)
+        return;
+
+    // closing the descriptor would remove it too, but it may have been dup()ed
+    if (io_events[fd] && !io_alwaysready[fd])
+        epoll_ctl(io_epfd, EPOLL_CTL_DEL, fd, NULL);
+
+    io_events[fd] = 0;
+    io_alwaysready[fd] = false;
+}
+
+static void os_poll_ready(qsocket_t fd, ioentry_t *e, uint32_t events)
+{
+    uint32_t error = events & (EPOLLERR | EPOLLHUP);
+
+    if (e->wantread && (events & (EPOLLIN | error)))
+        e->canread = true;
+    if (e->wantwrite && (events & (EPOLLOUT | error)))
+        e->canwrite = true;
+    if (e->wantexcept && (events & (EPOLLPRI | error)))
+        e->canexcept = true;
+
+    if (!e->edgetriggered)
+        io_levelready[io_numlevelready++] = fd;
+}
+
+static int os_poll(int64_t msec)
+{
+    struct epoll_event events[64];
+    ioentry_t *e;
+    uint64_t value;
+    int i, fd, ret, always = 0;
+
+    // level triggered readiness only lasts until the next poll, like with select()
+    for (i = 0; i < io_numlevelready; i++) {
+        e = &io_entries[io_levelready[i]];
+        e->canread = false;
+        e->canwrite = false;
+        e->canexcept = false;
+    }
+    io_numlevelready = 0;
+
+    for (fd = 0; fd < io_numfds; fd++) {
+        e = &io_entries[fd];
+        os_poll_update(fd, e);
+        if (io_alwaysready[fd] && e->inuse && os_poll_events(e)) {
+            os_poll_ready(fd, e, EPOLLIN | EPOLLOUT | EPOLLPRI);
+            always++;
+        }
+    }
+
+    if (always)
+        msec = 0;
+
+    ret = epoll_wait(io_epfd, events, q_countof(events), std::min(msec, (int64_t)INT_MAX));
+    if (ret == -1) {
+        net_error = errno;
+        if (net_error == EINTR)
+            return always;
+        return ret;
+    }
+
+    for (i = 0; i < ret; i++) {
+        fd = events[i].data.fd;
+        if (fd == io_wakefd) {
+            // drain the counter, a wakeup only needs to interrupt the wait
+            while (read(io_wakefd, &value, sizeof(value)) > 0)
+                ;
+            continue;
+        }
+
+        e = &io_entries[fd];
+        if (e->inuse)
+            os_poll_ready(fd, e, events[i].events);
+    }
+
+    return ret + always;
+}
+
+static void os_poll_wakeup(void)
+{
+    uint64_t value = 1;
+    ssize_t ret;
+
+    // fails only if the counter would overflow, the poll wakes up anyway then
+    if (io_wakefd != -1) {
+        ret = write(io_wakefd, &value, sizeof(value));
+        (void)ret;
+    }
+}
+
+static void os_poll_init(void)
+{
+    struct epoll_event ev;
+
+    io_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (io_epfd == -1) {
+        Com_DPrintf("%s: epoll_create1: %s, using select()\n", __func__, strerror(errno));
+        return;
+    }
+
+    io_wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (io_wakefd != -1) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = io_wakefd;
+        if (epoll_ctl(io_epfd, EPOLL_CTL_ADD, io_wakefd, &ev) == -1) {
+            close(io_wakefd);
+            io_wakefd = -1;
+        }
+    }
+}
+
+static void os_poll_shutdown(void)
+{
+    if (io_wakefd != -1) {
+        close(io_wakefd);
+        io_wakefd = -1;
+    }
+    if (io_epfd != -1) {
+        close(io_epfd);
+        io_epfd = -1;
+    }
+
+    memset(io_events, 0, sizeof(io_events));
+    memset(io_alwaysready, 0, sizeof(io_alwaysready));
+    io_numlevelready = 0;
+}
+
+#endif // USE_EPOLL
+
 static void os_net_init(void)
 {
+#if USE_EPOLL
+    os_poll_init();
+#endif
 }
 
 static void os_net_shutdown(void)
 {
+#if USE_EPOLL
+    os_poll_shutdown();
+#endif
 }
 
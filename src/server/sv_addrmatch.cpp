@@ -0,0 +1,267 @@
+/********************************************************************
+*
+*
+*	Server: Address/Mask Lists.
+*
+*	Ban and blackhole lists are matched against every connectionless
+*	packet, so besides the insertion ordered list used for listing and
+*	deleting by id, each list keeps a path compressed binary trie per
+*	address family. A lookup walks at most one node per prefix length
+*	instead of testing every entry.
+*
+*
+********************************************************************/
+#include "server/sv_server.h"
+#include "server/sv_addrmatch.h"
+
+
+
+/**
+*
+*
+*	Trie:
+*
+*
+**/
+/**
+*	@return	The bit at 'index', counting from the most significant bit of the first byte.
+**/
+static inline int addrtrie_bit( const netadrip_t *ip, const int index ) {
+	return ( ip->u8[ index >> 3 ] >> ( 7 - ( index & 7 ) ) ) & 1;
+}
+
+/**
+*	@return	The number of leading bits, up to 'limit', that 'a' and 'b' have in common.
+**/
+static int addrtrie_common_bits( const netadrip_t *a, const netadrip_t *b, const int limit ) {
+	int bits = 0;
+	while ( bits < limit ) {
+		const uint8_t diff = a->u8[ bits >> 3 ] ^ b->u8[ bits >> 3 ];
+		if ( diff ) {
+			// Count the equal leading bits of the first differing byte.
+			for ( int mask = 0x80; !( diff & mask ); mask >>= 1 ) {
+				bits++;
+			}
+			break;
+		}
+		bits += 8;
+	}
+	return std::min( bits, limit );
+}
+
+/**
+*	@return	The prefix length of a mask made by make_mask.
+**/
+static int addrtrie_mask_bits( const netadr_t *mask ) {
+	const int size = ( mask->type == NA_IP6 ? 128 : 32 );
+	int bits = 0;
+	while ( bits < size && addrtrie_bit( &mask->ip, bits ) ) {
+		bits++;
+	}
+	return bits;
+}
+
+/**
+*	@return	The address with the bits outside of the mask cleared, only this part is significant.
+**/
+static netadrip_t addrtrie_masked( const netadr_t *address, const netadr_t *mask ) {
+	netadrip_t prefix = {};
+	for ( int i = 0; i < 16; i++ ) {
+		prefix.u8[ i ] = address->ip.u8[ i ] & mask->ip.u8[ i ];
+	}
+	return prefix;
+}
+
+/**
+*	@return	The trie root for the address family, or nullptr for non IP addresses.
+**/
+static addrtrie_t **addrtrie_root( addrlist_t *list, const netadrtype_t type ) {
+	if ( type == NA_IP ) {
+		return &list->ipv4;
+	} else if ( type == NA_IP6 ) {
+		return &list->ipv6;
+	}
+	return nullptr;
+}
+
+static addrtrie_t *addrtrie_alloc( const netadrip_t *prefix, const int bits, addrmatch_t *match ) {
+	addrtrie_t *node = static_cast<addrtrie_t *>( Z_Mallocz( sizeof( *node ) ) );
+	node->prefix = *prefix;
+	node->bits = bits;
+	node->match = match;
+	return node;
+}
+
+static void addrtrie_free( addrtrie_t *node ) {
+	if ( node ) {
+		addrtrie_free( node->child[ 0 ] );
+		addrtrie_free( node->child[ 1 ] );
+		Z_Free( node );
+	}
+}
+
+/**
+*	@brief	Inserts the entry, if another entry has the exact same prefix
+*			the oldest one is kept as the one that matches.
+**/
+static void addrtrie_insert( addrlist_t *list, addrmatch_t *match ) {
+	addrtrie_t **link = addrtrie_root( list, match->addr.type );
+	if ( !link ) {
+		return;
+	}
+
+	const netadrip_t prefix = addrtrie_masked( &match->addr, &match->mask );
+	const int bits = addrtrie_mask_bits( &match->mask );
+
+	while ( *link ) {
+		addrtrie_t *node = *link;
+		const int common = addrtrie_common_bits( &node->prefix, &prefix, std::min( node->bits, bits ) );
+
+		if ( common < node->bits ) {
+			if ( common == bits ) {
+				// The new prefix is an ancestor of this node.
+				addrtrie_t *parent = addrtrie_alloc( &prefix, bits, match );
+				parent->child[ addrtrie_bit( &node->prefix, bits ) ] = node;
+				*link = parent;
+			} else {
+				// The prefixes diverge, split at the common part.
+				addrtrie_t *split = addrtrie_alloc( &prefix, common, nullptr );
+				split->child[ addrtrie_bit( &node->prefix, common ) ] = node;
+				split->child[ addrtrie_bit( &prefix, common ) ] = addrtrie_alloc( &prefix, bits, match );
+				*link = split;
+			}
+			return;
+		}
+
+		if ( node->bits == bits ) {
+			if ( !node->match || match->sequence < node->match->sequence ) {
+				node->match = match;
+			}
+			return;
+		}
+
+		link = &node->child[ addrtrie_bit( &prefix, node->bits ) ];
+	}
+
+	*link = addrtrie_alloc( &prefix, bits, match );
+}
+
+/**
+*	@brief	Rebuilds both tries from the entry list, used after removals which are rare.
+**/
+static void addrtrie_rebuild( addrlist_t *list ) {
+	addrtrie_free( list->ipv4 );
+	addrtrie_free( list->ipv6 );
+	list->ipv4 = list->ipv6 = nullptr;
+
+	addrmatch_t *match;
+	LIST_FOR_EACH( addrmatch_t, match, &list->entries, entry ) {
+		addrtrie_insert( list, match );
+	}
+}
+
+
+
+/**
+*
+*
+*	Address Lists:
+*
+*
+**/
+/**
+*	@brief	Returns the oldest entry of the list whose address/mask covers 'address',
+*			bumping its hit counter. Costs a single trie walk of at most the address
+*			length in bits.
+**/
+addrmatch_t *SV_MatchAddress( addrlist_t *list, netadr_t *address ) {
+	addrtrie_t **root = addrtrie_root( list, address->type );
+	if ( !root ) {
+		return nullptr;
+	}
+
+	addrmatch_t *best = nullptr;
+	const int size = ( address->type == NA_IP6 ? 128 : 32 );
+	for ( addrtrie_t *node = *root; node; ) {
+		if ( addrtrie_common_bits( &node->prefix, &address->ip, node->bits ) < node->bits ) {
+			break;
+		}
+		// Every entry on the path covers the address, the oldest one wins like
+		// it did when the list was scanned in order.
+		if ( node->match && ( !best || node->match->sequence < best->sequence ) ) {
+			best = node->match;
+		}
+		if ( node->bits >= size ) {
+			break;
+		}
+		node = node->child[ addrtrie_bit( &address->ip, node->bits ) ];
+	}
+
+	if ( best ) {
+		best->hits++;
+		best->time = time( NULL );
+	}
+	return best;
+}
+
+/**
+*	@brief	Returns the entry with exactly this address/mask, if any. Addresses
+*			are compared by their masked part only.
+**/
+addrmatch_t *SV_FindAddressMatch( addrlist_t *list, const netadr_t *address, const netadr_t *mask ) {
+	addrtrie_t **root = addrtrie_root( list, address->type );
+	if ( !root ) {
+		return nullptr;
+	}
+
+	const netadrip_t prefix = addrtrie_masked( address, mask );
+	const int bits = addrtrie_mask_bits( mask );
+	for ( addrtrie_t *node = *root; node && node->bits <= bits; ) {
+		if ( addrtrie_common_bits( &node->prefix, &prefix, node->bits ) < node->bits ) {
+			break;
+		}
+		if ( node->bits == bits ) {
+			return node->match;
+		}
+		node = node->child[ addrtrie_bit( &prefix, node->bits ) ];
+	}
+	return nullptr;
+}
+
+/**
+*	@brief	Appends a new entry to the list.
+**/
+addrmatch_t *SV_AddAddressMatch( addrlist_t *list, const netadr_t *address, const netadr_t *mask, const char *comment ) {
+	const size_t len = strlen( comment );
+	addrmatch_t *match = static_cast<addrmatch_t *>( Z_Malloc( sizeof( *match ) + len ) );
+	match->addr = *address;
+	match->mask = *mask;
+	match->hits = 0;
+	match->time = 0;
+	match->sequence = list->sequence++;
+	memcpy( match->comment, comment, len + 1 );
+	List_Append( &list->entries, &match->entry );
+	addrtrie_insert( list, match );
+	return match;
+}
+
+/**
+*	@brief	Removes and frees the entry.
+**/
+void SV_RemoveAddressMatch( addrlist_t *list, addrmatch_t *match ) {
+	List_Remove( &match->entry );
+	Z_Free( match );
+	addrtrie_rebuild( list );
+}
+
+/**
+*	@brief	Removes and frees all entries.
+**/
+void SV_ClearAddressMatches( addrlist_t *list ) {
+	addrmatch_t *match, *next;
+	LIST_FOR_EACH_SAFE( addrmatch_t, match, next, &list->entries, entry ) {
+		Z_Free( match );
+	}
+	List_Init( &list->entries );
+	addrtrie_rebuild( list );
+}
@@ -0,0 +1,34 @@
+/*********************************************************************
+*
+*
+*	Server: Address/Mask Lists.
+*
+*
+********************************************************************/
+#pragma once
+
+
+/**
+*	@brief	Returns the oldest entry of the list whose address/mask covers 'address',
+*			bumping its hit counter. Costs a single trie walk of at most the address
+*			length in bits.
+**/
+addrmatch_t *SV_MatchAddress( addrlist_t *list, netadr_t *address );
+/**
+*	@brief	Returns the entry with exactly this address/mask, if any. Addresses
+*			are compared by their masked part only.
+**/
+addrmatch_t *SV_FindAddressMatch( addrlist_t *list, const netadr_t *address, const netadr_t *mask );
+
+/**
+*	@brief	Appends a new entry to the list.
+**/
+addrmatch_t *SV_AddAddressMatch( addrlist_t *list, const netadr_t *address, const netadr_t *mask, const char *comment );
+/**
+*	@brief	Removes and frees the entry.
+**/
+void SV_RemoveAddressMatch( addrlist_t *list, addrmatch_t *match );
+/**
+*	@brief	Removes and frees all entries.
+**/
+void SV_ClearAddressMatches( addrlist_t *list );
@@ -0,0 +1,582 @@
+/********************************************************************
+*
+*
+*	Server: Packet Capture and Replay.
+*
+*	A capture records the map command, the server/latched/game cvars and
+*	the random seed the level was spawned with, followed by every SV_Frame
+*	call (its frame time) and every datagram SV_PacketEvent was handed
+*	during it. Captures always start with a map being spawned and end with
+*	the next map change or server shutdown.
+*
+*	A replay loads a capture, sets the cvars and spawns the same map with
+*	the sockets closed, then runs the recorded frames back to back, each
+*	fed with the datagrams recorded for it. That exercises the same
+*	SV_RunGameFrame, SV_BuildClientFrame and delta encoding work offline,
+*	and the time taken by each frame is reported.
+*
+*	Capture file layout (gzipped, little endian):
+*		u32 magic, u32 version, u32 seed, string mapcmd,
+*		u16 numcvars, { string name, string value } * numcvars,
+*		records: u8 op, then for SVCAP_FRAME u16 msec, and for SVCAP_PACKET
+*		u8 address type, u16 port (network order), 4 or 16 address bytes
+*		for IPv4/IPv6, u16 length and the datagram itself.
+*	Strings are a u16 length followed by the characters.
+*
+*
+********************************************************************/
+#include "server/sv_server.h"
+#include "server/sv_capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define SVCAP_MAGIC     MakeLittleLong( 'S', 'V', 'C', 'P' )
+#define SVCAP_VERSION   1
+
+//! Cvars stored in a capture, those that can change what the level does.
+#define SVCAP_CVAR_FLAGS    ( CVAR_SERVERINFO | CVAR_LATCH | CVAR_GAME )
+
+typedef enum {
+	SVCAP_END,
+	SVCAP_FRAME,
+	SVCAP_PACKET
+} svcap_op_t;
+
+//! Capture state.
+static struct {
+	//! Waiting for the next map to be spawned.
+	bool armed;
+	bool active;
+	qhandle_t file;
+	char name[ MAX_OSPATH ];
+
+	//! Records are collected here and written out in larger blocks.
+	byte buffer[ 0x10000 ];
+	size_t buffered;
+
+	uint64_t frames;
+	uint64_t packets;
+	uint64_t packetBytes;
+} sv_capture;
+
+//! Replay state.
+static struct {
+	//! Loaded, waiting for the map command to spawn the level.
+	bool pending;
+	bool active;
+	char name[ MAX_OSPATH ];
+
+	std::vector<byte> data;
+	size_t readcount;
+	uint32_t seed;
+
+	//! Optional per frame timings, as CSV.
+	qhandle_t csv;
+
+	uint64_t frames;
+	uint64_t packets;
+	uint64_t recordedMsec;
+	//! Time taken by each frame that ran the game, in microseconds.
+	std::vector<double> gameFrameTimes;
+	std::chrono::steady_clock::time_point startTime;
+} sv_replay;
+
+
+
+/**
+*
+*
+*	Capture Writing:
+*
+*
+**/
+static void SV_Capture_Flush( void ) {
+	if ( sv_capture.buffered ) {
+		FS_Write( sv_capture.buffer, sv_capture.buffered, sv_capture.file );
+		sv_capture.buffered = 0;
+	}
+}
+
+/**
+*	@return	A pointer to 'len' bytes in the record buffer, flushing it first if needed.
+**/
+static byte *SV_Capture_Space( const size_t len ) {
+	if ( sv_capture.buffered + len > sizeof( sv_capture.buffer ) ) {
+		SV_Capture_Flush();
+	}
+	byte *space = sv_capture.buffer + sv_capture.buffered;
+	sv_capture.buffered += len;
+	return space;
+}
+
+static void SV_Capture_WriteUint8( const uint8_t v ) {
+	*SV_Capture_Space( 1 ) = v;
+}
+
+static void SV_Capture_WriteUint16( const uint16_t v ) {
+	WL16( SV_Capture_Space( 2 ), v );
+}
+
+static void SV_Capture_WriteUint32( const uint32_t v ) {
+	WL32( SV_Capture_Space( 4 ), v );
+}
+
+static void SV_Capture_WriteData( const void *data, const size_t len ) {
+	memcpy( SV_Capture_Space( len ), data, len );
+}
+
+static void SV_Capture_WriteString( const char *s ) {
+	const size_t len = std::min<size_t>( strlen( s ), UINT16_MAX );
+	SV_Capture_WriteUint16( len );
+	SV_Capture_WriteData( s, len );
+}
+
+/**
+*	@brief	Writes the header and seeds the random generator the level is spawned with.
+**/
+static void SV_Capture_Begin( const mapcmd_t *cmd ) {
+	const uint32_t seed = (uint32_t)time( NULL ) ^ (uint32_t)Sys_Milliseconds();
+	Q_srand( seed );
+
+	SV_Capture_WriteUint32( SVCAP_MAGIC );
+	SV_Capture_WriteUint32( SVCAP_VERSION );
+	SV_Capture_WriteUint32( seed );
+	SV_Capture_WriteString( cmd->buffer );
+
+	uint16_t numCvars = 0;
+	for ( cvar_t *var = cvar_vars; var; var = var->next ) {
+		if ( ( var->flags & SVCAP_CVAR_FLAGS ) && !( var->flags & ( CVAR_ROM | CVAR_PRIVATE ) ) ) {
+			numCvars++;
+		}
+	}
+	SV_Capture_WriteUint16( numCvars );
+	for ( cvar_t *var = cvar_vars; var; var = var->next ) {
+		if ( ( var->flags & SVCAP_CVAR_FLAGS ) && !( var->flags & ( CVAR_ROM | CVAR_PRIVATE ) ) ) {
+			SV_Capture_WriteString( var->name );
+			SV_Capture_WriteString( var->latched_string ? var->latched_string : var->string );
+		}
+	}
+
+	sv_capture.armed = false;
+	sv_capture.active = true;
+	sv_capture.frames = sv_capture.packets = sv_capture.packetBytes = 0;
+	Com_Printf( "Capturing server input to %s.\n", sv_capture.name );
+}
+
+static void SV_Capture_End( void ) {
+	if ( sv_capture.active ) {
+		SV_Capture_WriteUint8( SVCAP_END );
+		SV_Capture_Flush();
+		Com_Printf( "Stopped capturing %s: %" PRIu64 " frames, %" PRIu64 " packets (%" PRIu64 " bytes).\n",
+			sv_capture.name, sv_capture.frames, sv_capture.packets, sv_capture.packetBytes );
+	} else if ( sv_capture.armed ) {
+		Com_Printf( "Cancelled capture %s.\n", sv_capture.name );
+	}
+
+	if ( sv_capture.file ) {
+		FS_CloseFile( sv_capture.file );
+	}
+	sv_capture.file = 0;
+	sv_capture.buffered = 0;
+	sv_capture.armed = sv_capture.active = false;
+}
+
+/**
+*	@brief	Records the frame time of the SV_Frame call about to run.
+**/
+void SV_Capture_Frame( const uint64_t msec ) {
+	if ( !sv_capture.active ) {
+		return;
+	}
+	SV_Capture_WriteUint8( SVCAP_FRAME );
+	SV_Capture_WriteUint16( (uint16_t)std::min<uint64_t>( msec, UINT16_MAX ) );
+	sv_capture.frames++;
+}
+
+/**
+*	@brief	Records the datagram in msg_read, as received from net_from.
+**/
+void SV_Capture_Packet( void ) {
+	if ( !sv_capture.active ) {
+		return;
+	}
+
+	SV_Capture_WriteUint8( SVCAP_PACKET );
+	SV_Capture_WriteUint8( net_from.type );
+	SV_Capture_WriteData( &net_from.port, 2 );
+	if ( net_from.type == NA_IP6 ) {
+		SV_Capture_WriteData( net_from.ip.u8, 16 );
+	} else if ( net_from.type != NA_LOOPBACK ) {
+		SV_Capture_WriteData( net_from.ip.u8, 4 );
+	}
+	SV_Capture_WriteUint16( msg_read.cursize );
+	SV_Capture_WriteData( msg_read.data, msg_read.cursize );
+
+	sv_capture.packets++;
+	sv_capture.packetBytes += msg_read.cursize;
+}
+
+
+
+/**
+*
+*
+*	Replay:
+*
+*
+**/
+/**
+*	@return	A pointer to the next 'len' bytes of the capture, nullptr if it is truncated.
+**/
+static const byte *SV_Replay_Read( const size_t len ) {
+	if ( sv_replay.readcount + len > sv_replay.data.size() ) {
+		sv_replay.readcount = sv_replay.data.size();
+		return nullptr;
+	}
+	const byte *data = sv_replay.data.data() + sv_replay.readcount;
+	sv_replay.readcount += len;
+	return data;
+}
+
+static const int32_t SV_Replay_ReadUint8( void ) {
+	const byte *p = SV_Replay_Read( 1 );
+	return p ? *p : -1;
+}
+
+static const uint32_t SV_Replay_ReadUint16( void ) {
+	const byte *p = SV_Replay_Read( 2 );
+	return p ? RL16( p ) : 0;
+}
+
+static const uint32_t SV_Replay_ReadUint32( void ) {
+	const byte *p = SV_Replay_Read( 4 );
+	return p ? RL32( p ) : 0;
+}
+
+static void SV_Replay_ReadString( char *dest, const size_t size ) {
+	const uint32_t len = SV_Replay_ReadUint16();
+	const byte *p = SV_Replay_Read( len );
+	const size_t copy = p ? std::min<size_t>( len, size - 1 ) : 0;
+	memcpy( dest, p, copy );
+	dest[ copy ] = 0;
+}
+
+static double SV_Replay_Percentile( const std::vector<double> &sorted, const double fraction ) {
+	if ( sorted.empty() ) {
+		return 0;
+	}
+	return sorted[ std::min( sorted.size() - 1, (size_t)( fraction * sorted.size() ) ) ];
+}
+
+/**
+*	@brief	Prints the timing report and stops the server the replay ran on.
+**/
+static void SV_Replay_Finish( void ) {
+	const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - sv_replay.startTime ).count();
+
+	std::vector<double> &times = sv_replay.gameFrameTimes;
+	std::sort( times.begin(), times.end() );
+	double total = 0;
+	for ( const double t : times ) {
+		total += t;
+	}
+
+	Com_Printf( "Replay of %s finished: %" PRIu64 " frames, %zu game frames, %" PRIu64 " packets.\n",
+		sv_replay.name, sv_replay.frames, times.size(), sv_replay.packets );
+	Com_Printf( "Recorded %.2f s ran in %.2f s (%.1fx).\n", sv_replay.recordedMsec / 1000.0, elapsed,
+		elapsed > 0 ? sv_replay.recordedMsec / 1000.0 / elapsed : 0.0 );
+	Com_Printf( "Game frame ms: mean %.3f, min %.3f, median %.3f, 95%% %.3f, 99%% %.3f, max %.3f\n",
+		times.empty() ? 0.0 : total / times.size() / 1000.0,
+		times.empty() ? 0.0 : times.front() / 1000.0,
+		SV_Replay_Percentile( times, 0.5 ) / 1000.0, SV_Replay_Percentile( times, 0.95 ) / 1000.0,
+		SV_Replay_Percentile( times, 0.99 ) / 1000.0, times.empty() ? 0.0 : times.back() / 1000.0 );
+
+	if ( sv_replay.csv ) {
+		FS_CloseFile( sv_replay.csv );
+		sv_replay.csv = 0;
+	}
+	sv_replay.active = false;
+	sv_replay.data.clear();
+	sv_replay.data.shrink_to_fit();
+	times.clear();
+
+	// Clients of the capture would only time out, don't keep the level running.
+	Cbuf_AddText( &cmd_buffer, "killserver\n" );
+}
+
+/**
+*	@return	True while a capture is being replayed.
+**/
+const bool SV_Replay_Active( void ) {
+	return sv_replay.active;
+}
+
+/**
+*	@brief	Runs the next recorded frame through 'runFrame' with its recorded frame time
+*			and accounts how long it took. Finishes the replay at the end of the capture.
+**/
+const int64_t SV_Replay_RunFrame( int64_t ( *runFrame )( uint64_t msec ) ) {
+	if ( SV_Replay_ReadUint8() != SVCAP_FRAME ) {
+		SV_Replay_Finish();
+		return 0;
+	}
+
+	const uint64_t msec = SV_Replay_ReadUint16();
+	const int64_t framenum = sv.framenum;
+	const uint64_t packets = sv_replay.packets;
+
+	const auto start = std::chrono::steady_clock::now();
+	runFrame( msec );
+	const double usec = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count();
+
+	const bool gameFrame = sv.framenum != framenum;
+	if ( gameFrame ) {
+		sv_replay.gameFrameTimes.push_back( usec );
+	}
+	if ( sv_replay.csv ) {
+		FS_FPrintf( sv_replay.csv, "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%d,%.1f\n",
+			sv_replay.frames, msec, sv_replay.packets - packets, gameFrame, usec );
+	}
+	sv_replay.frames++;
+	sv_replay.recordedMsec += msec;
+
+	// Run the next frame right away.
+	return 0;
+}
+
+/**
+*	@brief	Hands the packets recorded for the current frame to 'packetCallback'.
+**/
+void SV_Replay_DeliverPackets( void ( *packetCallback )( void ) ) {
+	while ( sv_replay.readcount < sv_replay.data.size() && sv_replay.data[ sv_replay.readcount ] == SVCAP_PACKET ) {
+		sv_replay.readcount++;
+
+		netadr_t from = {};
+		from.type = (netadrtype_t)SV_Replay_ReadUint8();
+		const byte *port = SV_Replay_Read( 2 );
+		if ( port ) {
+			memcpy( &from.port, port, 2 );
+		}
+		if ( from.type == NA_IP6 || from.type == NA_IP ) {
+			const size_t len = from.type == NA_IP6 ? 16 : 4;
+			const byte *ip = SV_Replay_Read( len );
+			if ( ip ) {
+				memcpy( from.ip.u8, ip, len );
+			}
+		}
+		const uint32_t len = SV_Replay_ReadUint16();
+		const byte *data = SV_Replay_Read( len );
+		if ( !data || len > sizeof( msg_read_buffer ) ) {
+			break;
+		}
+
+		net_from = from;
+		memcpy( msg_read_buffer, data, len );
+		SZ_Init( &msg_read, msg_read_buffer, sizeof( msg_read_buffer ) );
+		msg_read.cursize = len;
+		sv_replay.packets++;
+
+		packetCallback();
+	}
+}
+
+/**
+*	@brief	Reads the whole capture into memory, so the replay doesn't wait on disk.
+**/
+static bool SV_Replay_Load( const char *arg ) {
+	qhandle_t f = FS_EasyOpenFile( sv_replay.name, sizeof( sv_replay.name ), FS_MODE_READ | FS_FLAG_GZIP, "captures/", arg, ".svcap" );
+	if ( !f ) {
+		return false;
+	}
+
+	sv_replay.data.clear();
+	byte chunk[ 0x10000 ];
+	int ret;
+	while ( ( ret = FS_Read( chunk, sizeof( chunk ), f ) ) > 0 ) {
+		sv_replay.data.insert( sv_replay.data.end(), chunk, chunk + ret );
+	}
+	FS_CloseFile( f );
+	if ( ret < 0 ) {
+		Com_EPrintf( "Couldn't read %s: %s\n", sv_replay.name, Q_ErrorString( ret ) );
+		return false;
+	}
+
+	sv_replay.readcount = 0;
+	if ( SV_Replay_ReadUint32() != SVCAP_MAGIC || SV_Replay_ReadUint32() != SVCAP_VERSION ) {
+		Com_EPrintf( "%s is not a version %d server capture.\n", sv_replay.name, SVCAP_VERSION );
+		return false;
+	}
+	return true;
+}
+
+/**
+*	@brief	Spawns the captured level with the sockets closed, and with the same random
+*			seed so challenges and the spawn count match what the captured clients saw.
+**/
+static void SV_Replay_Begin( void ) {
+	Q_srand( sv_replay.seed );
+
+	NET_Config( NET_NONE );
+
+	sv_replay.pending = false;
+	sv_replay.active = true;
+	sv_replay.frames = sv_replay.packets = sv_replay.recordedMsec = 0;
+	sv_replay.gameFrameTimes.clear();
+	sv_replay.startTime = std::chrono::steady_clock::now();
+	Com_Printf( "Replaying %s.\n", sv_replay.name );
+}
+
+
+
+/**
+*
+*
+*	Hooks:
+*
+*
+**/
+/**
+*	@brief	Starts an armed capture or a pending replay when a map is spawned, and ends
+*			a running capture on map changes.
+**/
+void SV_Capture_SpawnServer( const mapcmd_t *cmd ) {
+	if ( sv_replay.pending ) {
+		SV_Replay_Begin();
+	} else if ( sv_capture.active ) {
+		SV_Capture_End();
+	} else if ( sv_capture.armed ) {
+		SV_Capture_Begin( cmd );
+	}
+}
+
+/**
+*	@brief	Ends a running capture or replay. A pending replay survives, it shuts down
+*			the running server itself before spawning its map.
+**/
+void SV_Capture_Shutdown( void ) {
+	if ( sv_capture.active ) {
+		SV_Capture_End();
+	}
+	if ( sv_replay.active ) {
+		Com_Printf( "Replay of %s aborted.\n", sv_replay.name );
+		if ( sv_replay.csv ) {
+			FS_CloseFile( sv_replay.csv );
+			sv_replay.csv = 0;
+		}
+		sv_replay.active = false;
+		sv_replay.data.clear();
+		sv_replay.gameFrameTimes.clear();
+	}
+}
+
+
+
+/**
+*
+*
+*	Commands:
+*
+*
+**/
+static void SV_Capture_f( void ) {
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: %s <filename>\n"
+			"Captures every datagram the server receives, starting with the next map.\n", Cmd_Argv( 0 ) );
+		return;
+	}
+	if ( sv_capture.armed || sv_capture.active ) {
+		Com_Printf( "Already capturing to %s.\n", sv_capture.name );
+		return;
+	}
+	if ( sv_replay.pending || sv_replay.active ) {
+		Com_Printf( "Can't capture while replaying.\n" );
+		return;
+	}
+
+	sv_capture.file = FS_EasyOpenFile( sv_capture.name, sizeof( sv_capture.name ), FS_MODE_WRITE | FS_FLAG_GZIP, "captures/", Cmd_Argv( 1 ), ".svcap" );
+	if ( !sv_capture.file ) {
+		return;
+	}
+
+	sv_capture.armed = true;
+	sv_capture.buffered = 0;
+	Com_Printf( "Capture to %s starts with the next map.\n", sv_capture.name );
+}
+
+static void SV_StopCapture_f( void ) {
+	if ( !sv_capture.armed && !sv_capture.active ) {
+		Com_Printf( "Not capturing.\n" );
+		return;
+	}
+	SV_Capture_End();
+}
+
+static void SV_Replay_f( void ) {
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: %s <filename> [csvfile]\n"
+			"Replays a server capture at full speed and reports frame timings,\n"
+			"optionally writing the time of every frame to a CSV file.\n", Cmd_Argv( 0 ) );
+		return;
+	}
+	if ( sv_capture.armed || sv_capture.active ) {
+		Com_Printf( "Can't replay while capturing.\n" );
+		return;
+	}
+	if ( sv_replay.pending || sv_replay.active ) {
+		Com_Printf( "Already replaying %s.\n", sv_replay.name );
+		return;
+	}
+
+	if ( !SV_Replay_Load( Cmd_Argv( 1 ) ) ) {
+		return;
+	}
+
+	char mapcmd[ MAX_QPATH ];
+	sv_replay.seed = SV_Replay_ReadUint32();
+	SV_Replay_ReadString( mapcmd, sizeof( mapcmd ) );
+
+	// Restore the cvars the level was spawned with.
+	const uint32_t numCvars = SV_Replay_ReadUint16();
+	for ( uint32_t i = 0; i < numCvars; i++ ) {
+		char name[ MAX_QPATH ], value[ MAX_STRING_CHARS ];
+		SV_Replay_ReadString( name, sizeof( name ) );
+		SV_Replay_ReadString( value, sizeof( value ) );
+		Cvar_SetEx( name, value, FROM_CONSOLE );
+	}
+	if ( sv_replay.readcount >= sv_replay.data.size() ) {
+		Com_EPrintf( "%s is truncated.\n", sv_replay.name );
+		sv_replay.data.clear();
+		return;
+	}
+
+	if ( Cmd_Argc() > 2 ) {
+		char csvname[ MAX_OSPATH ];
+		sv_replay.csv = FS_EasyOpenFile( csvname, sizeof( csvname ), FS_MODE_WRITE | FS_FLAG_TEXT, "captures/", Cmd_Argv( 2 ), ".csv" );
+		if ( sv_replay.csv ) {
+			FS_FPrintf( sv_replay.csv, "frame,msec,packets,gameframe,usec\n" );
+		}
+	}
+
+	// Start from a fresh server so latched cvars apply and the level spawns like it did.
+	if ( svs.initialized ) {
+		SV_Shutdown( "Server is replaying a capture.\n", ERR_DISCONNECT );
+	}
+	sv_replay.pending = true;
+	Cbuf_AddText( &cmd_buffer, va( "map \"%s\"\n", mapcmd ) );
+}
+
+static const cmdreg_t c_capture[] = {
+	{ "sv_capture", SV_Capture_f },
+	{ "sv_stopcapture", SV_StopCapture_f },
+	{ "sv_replay", SV_Replay_f },
+	{ NULL }
+};
+
+/**
+*	@brief	Registers the "sv_capture", "sv_stopcapture" and "sv_replay" commands.
+**/
+void SV_RegisterCapture( void ) {
+	Cmd_Register( c_capture );
+}
@@ -0,0 +1,48 @@
+/*********************************************************************
+*
+*
+*	Server: Packet Capture and Replay.
+*
+*
+********************************************************************/
+#pragma once
+
+
+/**
+*	@return	True while a capture is being replayed, SV_Frame then runs the recorded
+*			frames back to back and takes its input from the capture instead of sockets.
+**/
+const bool SV_Replay_Active( void );
+/**
+*	@brief	Runs the next recorded frame through 'runFrame' with its recorded frame time
+*			and accounts how long it took. Finishes the replay at the end of the capture.
+**/
+const int64_t SV_Replay_RunFrame( int64_t ( *runFrame )( uint64_t msec ) );
+/**
+*	@brief	Hands the packets recorded for the current frame to 'packetCallback', one at
+*			a time in msg_read with net_from set, the same way NET_GetPackets does.
+**/
+void SV_Replay_DeliverPackets( void ( *packetCallback )( void ) );
+
+/**
+*	@brief	Records the frame time of the SV_Frame call about to run.
+**/
+void SV_Capture_Frame( const uint64_t msec );
+/**
+*	@brief	Records the datagram in msg_read, as received from net_from.
+**/
+void SV_Capture_Packet( void );
+
+/**
+*	@brief	Starts an armed capture or a pending replay when a map is spawned, and ends
+*			a running capture on map changes. Called before anything random is drawn.
+**/
+void SV_Capture_SpawnServer( const mapcmd_t *cmd );
+/**
+*	@brief	Ends a running capture or replay.
+**/
+void SV_Capture_Shutdown( void );
+/**
+*	@brief	Registers the "sv_capture", "sv_stopcapture" and "sv_replay" commands.
+**/
+void SV_RegisterCapture( void );
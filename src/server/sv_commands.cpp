@@ -17,6 +17,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 */
 
 #include "server/sv_server.h"
+#include "server/sv_addrmatch.h"
 #include "server/sv_commands.h"
 #include "server/sv_init.h"
 #include "server/sv_models.h"
@@ -486,13 +487,9 @@ static void SV_Kick_f(void)
     if (!strcmp(Cmd_Argv(0), "kickban")) {
         netadr_t *addr = &sv_client->netchan.remote_address;
         if (addr->type == NA_IP || addr->type == NA_IP6) {
-            addrmatch_t *match = static_cast<addrmatch_t*>( Z_Malloc(sizeof(*match)) ); // WID: C++20: Added cast.
-            match->addr = *addr;
-            make_mask(&match->mask, addr->type, addr->type == NA_IP6 ? 64 : 32);
-            match->hits = 0;
-            match->time = 0;
-            match->comment[0] = 0;
-            List_Append(&sv_banlist, &match->entry);
+            netadr_t mask;
+            make_mask(&mask, addr->type, addr->type == NA_IP6 ? 64 : 32);
+            SV_AddAddressMatch(&sv_banlist, addr, &mask, "");
         }
     }
 
@@ -1051,12 +1048,11 @@ static size_t format_mask(addrmatch_t *match, char *buf, size_t buf_size)
     return Q_snprintf(buf, buf_size, "%s/%d", NET_BaseAdrToString(&match->addr), i);
 }
 
-void SV_AddMatch_f(list_t *list)
+void SV_AddMatch_f(addrlist_t *list)
 {
     char *s, buf[MAX_QPATH];
     addrmatch_t *match;
     netadr_t addr, mask;
-    size_t len;
 
     if (Cmd_Argc() < 2) {
         Com_Printf("Usage: %s <address[/mask]> [comment]\n", Cmd_Argv(0));
@@ -1068,30 +1064,20 @@ void SV_AddMatch_f(list_t *list)
         return;
     }
 
-    LIST_FOR_EACH(addrmatch_t, match, list, entry) {
-        if (NET_IsEqualBaseAdr(&match->addr, &addr) &&
-            NET_IsEqualBaseAdr(&match->mask, &mask)) {
-            format_mask(match, buf, sizeof(buf));
-            Com_Printf("Entry %s already exists.\n", buf);
-            return;
-        }
+    match = SV_FindAddressMatch(list, &addr, &mask);
+    if (match) {
+        format_mask(match, buf, sizeof(buf));
+        Com_Printf("Entry %s already exists.\n", buf);
+        return;
     }
 
-    s = Cmd_ArgsFrom(2);
-    len = strlen(s);
-    match = static_cast<addrmatch_t*>( Z_Malloc(sizeof(*match) + len) ); // WID: C++20: Added cast.
-    match->addr = addr;
-    match->mask = mask;
-    match->hits = 0;
-    match->time = 0;
-    memcpy(match->comment, s, len + 1);
-    List_Append(list, &match->entry);
+    SV_AddAddressMatch(list, &addr, &mask, Cmd_ArgsFrom(2));
 }
 
-void SV_DelMatch_f(list_t *list)
+void SV_DelMatch_f(addrlist_t *list)
 {
     char *s;
-    addrmatch_t *match, *next;
+    addrmatch_t *match;
     netadr_t addr, mask;
     int i;
 
@@ -1100,26 +1086,24 @@ void SV_DelMatch_f(list_t *list)
         return;
     }
 
-    if (LIST_EMPTY(list)) {
+    if (LIST_EMPTY(&list->entries)) {
         Com_Printf("Address list is empty.\n");
         return;
     }
 
     s = Cmd_Argv(1);
     if (!strcmp(s, "all")) {
-        LIST_FOR_EACH_SAFE(addrmatch_t, match, next, list, entry) {
-            Z_Free(match);
-        }
-        List_Init(list);
+        SV_ClearAddressMatches(list);
         return;
     }
 
     // numeric values are just slot numbers
     if (COM_IsUint(s)) {
         i = atoi(s);
-        match = LIST_INDEX(addrmatch_t, i - 1, list, entry);
+        match = LIST_INDEX(addrmatch_t, i - 1, &list->entries, entry);
         if (match) {
-            goto remove;
+            SV_RemoveAddressMatch(list, match);
+            return;
         }
         Com_Printf("No such index: %d\n", i);
         return;
@@ -1129,33 +1113,102 @@ void SV_DelMatch_f(list_t *list)
         return;
     }
 
-    LIST_FOR_EACH(addrmatch_t, match, list, entry) {
-        if (NET_IsEqualBaseAdr(&match->addr, &addr) &&
-            NET_IsEqualBaseAdr(&match->mask, &mask)) {
-remove:
-            List_Remove(&match->entry);
-            Z_Free(match);
-            return;
-        }
+    match = SV_FindAddressMatch(list, &addr, &mask);
+    if (match) {
+        SV_RemoveAddressMatch(list, match);
+        return;
     }
     Com_Printf("No such entry: %s\n", s);
 }
 
-void SV_ListMatches_f(list_t *list)
+static char *trim_whitespace(char *s)
+{
+    char *end;
+
+    while (*s && Q_isspace(*s))
+        s++;
+    for (end = s + strlen(s); end > s && Q_isspace(end[-1]); end--)
+        ;
+    *end = 0;
+    return s;
+}
+
+// Bulk adds "address[/mask] [comment]" lines, skipping blank lines,
+// comments and entries that already exist.
+void SV_ImportMatches_f(addrlist_t *list)
+{
+    char *data, *line, *next, *p;
+    netadr_t addr, mask;
+    int ret, linenum, added, skipped, bad;
+
+    if (Cmd_Argc() != 2) {
+        Com_Printf("Usage: %s <filename>\n", Cmd_Argv(0));
+        return;
+    }
+
+    ret = FS_LoadFile(Cmd_Argv(1), (void **)&data);
+    if (!data) {
+        Com_Printf("Couldn't load %s: %s\n", Cmd_Argv(1), Q_ErrorString(ret));
+        return;
+    }
+
+    linenum = added = skipped = bad = 0;
+    for (line = data; line; line = next) {
+        linenum++;
+        next = strchr(line, '\n');
+        if (next) {
+            *next++ = 0;
+        }
+
+        line = trim_whitespace(line);
+        if (!*line || *line == '#' || !strncmp(line, "//", 2)) {
+            continue;
+        }
+
+        // split off the comment
+        for (p = line; *p && !Q_isspace(*p); p++)
+            ;
+        if (*p) {
+            *p++ = 0;
+            p = trim_whitespace(p);
+        }
+
+        if (!parse_mask(line, &addr, &mask)) {
+            Com_Printf("...on line %d\n", linenum);
+            bad++;
+            continue;
+        }
+
+        if (SV_FindAddressMatch(list, &addr, &mask)) {
+            skipped++;
+            continue;
+        }
+
+        SV_AddAddressMatch(list, &addr, &mask, p);
+        added++;
+    }
+
+    FS_FreeFile(data);
+
+    Com_Printf("Imported %d entries from %s, %d already present, %d bad.\n",
+               added, Cmd_Argv(1), skipped, bad);
+}
+
+void SV_ListMatches_f(addrlist_t *list)
 {
     addrmatch_t *match;
     char last[MAX_QPATH];
     char addr[MAX_QPATH];
     int id = 0;
 
-    if (LIST_EMPTY(list)) {
+    if (LIST_EMPTY(&list->entries)) {
         Com_Printf("Address list is empty.\n");
         return;
     }
 
     Com_Printf("id address/mask       hits last hit     comment\n"
                "-- ------------------ ---- ------------ -------\n");
-    LIST_FOR_EACH(addrmatch_t, match, list, entry) {
+    LIST_FOR_EACH(addrmatch_t, match, &list->entries, entry) {
         format_mask(match, addr, sizeof(addr));
         if (!match->time) {
             strcpy(last, "never");
@@ -1181,6 +1234,10 @@ static void SV_ListBans_f(void)
 {
     SV_ListMatches_f(&sv_banlist);
 }
+static void SV_ImportBans_f(void)
+{
+    SV_ImportMatches_f(&sv_banlist);
+}
 
 static void SV_AddBlackHole_f(void)
 {
@@ -1194,6 +1251,10 @@ static void SV_ListBlackHoles_f(void)
 {
     SV_ListMatches_f(&sv_blacklist);
 }
+static void SV_ImportBlackHoles_f(void)
+{
+    SV_ImportMatches_f(&sv_blacklist);
+}
 
 static void SV_AddStuffCmd(list_t *list, int arg, const char *what)
 {
@@ -1682,9 +1743,11 @@ static const cmdreg_t c_server[] = {
     { "addban", SV_AddBan_f },
     { "delban", SV_DelBan_f },
     { "listbans", SV_ListBans_f },
+    { "importbans", SV_ImportBans_f },
     { "addblackhole", SV_AddBlackHole_f },
     { "delblackhole", SV_DelBlackHole_f },
     { "listblackholes", SV_ListBlackHoles_f },
+    { "importblackholes", SV_ImportBlackHoles_f },
     { "addstuffcmd", SV_AddStuffCmd_f, SV_StuffCmd_c },
     { "delstuffcmd", SV_DelStuffCmd_f, SV_StuffCmd_c },
     { "liststuffcmds", SV_ListStuffCmds_f, SV_StuffCmd_c },
@@ -55,12 +55,6 @@ void SV_RateRecharge( ratelimit_t *r );
 void SV_RateInit( ratelimit_t *r, const char *s );
 
 
-/**
-*	@brief
-**/
-addrmatch_t *SV_MatchAddress( list_t *list, netadr_t *address );
-
-
 /**
 *	@brief
 **/
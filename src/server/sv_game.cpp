@@ -20,7 +20,10 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "server/sv_server.h"
 #include "server/sv_game.h"
 #include "server/sv_models.h"
+#include "server/sv_mvd.h"
+#include "server/sv_save.h"
 #include "server/sv_send.h"
+#include "server/sv_user.h"
 #include "server/sv_world.h"
 
 #include "shared/cm/cm_entity.h"
@@ -152,6 +155,7 @@ static void PF_Unicast(edict_ptr_t *ent, bool reliable)
 		flags |= MSG_COMPRESS_AUTO;
 	}
 
+	SV_MvdRecord_Message( clientNum );
 	SV_ClientAddMessage( client, flags );
 
 	// fix anti-kicking exploit for broken mods
@@ -216,6 +220,8 @@ static void PF_bprintf(int level, const char *fmt, ...)
         //Com_LPrintf( (print_type_t)level, "%s", string );
     }
 
+    SV_MvdRecord_Message( -1 );
+
     FOR_EACH_CLIENT(client) {
         if ( client->state != cs_spawned ) {
             continue;
@@ -293,6 +299,8 @@ static void PF_cprintf(edict_ptr_t *ent, int level, const char *fmt, ...)
     MSG_WriteUint8(level);
     MSG_WriteData(msg, len + 1);
 
+    SV_MvdRecord_Message( clientNum );
+
     if (level >= client->messagelevel) {
         SV_ClientAddMessage(client, MSG_RELIABLE);
     }
@@ -434,6 +442,9 @@ static void PF_configstring(int index, const char *val)
 	memcpy( dst, val, len );
 	dst[ len ] = 0;
 
+	// connecting clients need a freshly encoded gamestate
+	SV_InvalidateGameStateCache();
+
 	if ( sv.state == ss_loading ) {
 		return;
 	}
@@ -444,6 +455,8 @@ static void PF_configstring(int index, const char *val)
 	MSG_WriteData( val, len );
 	MSG_WriteUint8( 0 );
 
+	SV_MvdRecord_Message( -1 );
+
 	FOR_EACH_CLIENT( client ) {
 		if ( client->state < cs_primed ) {
 			continue;
@@ -515,6 +528,12 @@ const cm_trace_t q_gameabi PF_SV_Trace( const Vector3 *start, const Vector3 *min
     return SV_Trace( *start, mins, maxs, *end, passEdict, contentmask );
 }
 
+const cm_trace_t q_gameabi PF_SV_LagTrace( const Vector3 *start, const Vector3 *mins,
+    const Vector3 *maxs, const Vector3 *end,
+    edict_ptr_t *passEdict, const cm_contents_t contentmask ) {
+    return SV_LagTrace( *start, mins, maxs, *end, passEdict, contentmask );
+}
+
 const cm_trace_t q_gameabi PF_SV_Clip( edict_ptr_t *clip, const Vector3 *start, const Vector3 *mins,
     const Vector3 *maxs, const Vector3 *end,
     const cm_contents_t contentmask ) {
@@ -644,6 +663,9 @@ static void SV_StartSound( const Vector3 *origin, edict_ptr_t *edict,
 		return;
 	}
 
+	// archive the positioned sound for everyone
+	SV_MvdRecord_Message( -1 );
+
 	leaf1 = NULL;
 	if ( !( channel & CHAN_NO_PHS_ADD ) ) {
 		leaf1 = CM_PointLeaf( &sv.cm, &origin->x );
@@ -1109,6 +1131,7 @@ void SV_InitGameProgs(void) {
 
     imports.BoxEdicts = SV_AreaEdicts;
     imports.trace = PF_SV_Trace;
+    imports.lagtrace = PF_SV_LagTrace;
 	imports.clip = PF_SV_Clip;
     imports.pointcontents = SV_PointContents;
     imports.linkentity = PF_LinkEdict;
@@ -1172,6 +1195,8 @@ void SV_InitGameProgs(void) {
     imports.args = Cmd_RawArgs;
     imports.AddCommandString = PF_AddCommandString;
 
+    imports.WriteSaveFile = SV_SaveWriter_WriteFile;
+
     /**
     *
     *   Other:
@@ -17,6 +17,8 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 */
 
 #include "server/sv_server.h"
+#include "server/sv_capture.h"
+#include "server/sv_mvd.h"
 #include "server/sv_commands.h"
 #include "server/sv_game.h"
 #include "server/sv_init.h"
@@ -104,6 +106,9 @@ void SV_SpawnServer(mapcmd_t *cmd)
         warning_printed = true;
     }
 
+    // multi view demos end with their level
+    SV_MvdRecord_Stop();
+
     // everyone needs to reconnect
     FOR_EACH_CLIENT( client ) {
         SV_ClientReset( client );
@@ -121,6 +126,9 @@ void SV_SpawnServer(mapcmd_t *cmd)
 
     // wipe the entire per-level structure
     memset( &sv, 0, sizeof( sv ) );
+
+    // start or end a capture, this seeds the random generator for it
+    SV_Capture_SpawnServer( cmd );
     sv.spawncount = Q_rand() & 0x7fffffff;
 
     // set legacy spawncounts
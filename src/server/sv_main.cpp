@@ -17,12 +17,16 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 */
 
 #include "server/sv_server.h"
+#include "server/sv_addrmatch.h"
+#include "server/sv_capture.h"
+#include "server/sv_mvd.h"
 #include "server/sv_commands.h"
 #include "server/sv_game.h"
 #include "server/sv_models.h"
 #include "server/sv_send.h"
 #include "server/sv_save.h"
 #include "server/sv_user.h"
+#include "server/sv_world.h"
 
 
 #include "client/input.h"
@@ -35,8 +39,8 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 master_t    sv_masters[MAX_MASTERS];   // address of group servers
 
-LIST_DECL(sv_banlist);
-LIST_DECL(sv_blacklist);
+addrlist_t  sv_banlist = { { &sv_banlist.entries, &sv_banlist.entries } };
+addrlist_t  sv_blacklist = { { &sv_blacklist.entries, &sv_blacklist.entries } };
 LIST_DECL(sv_cmdlist_connect);
 LIST_DECL(sv_cmdlist_begin);
 LIST_DECL(sv_lrconlist);
@@ -92,6 +96,7 @@ cvar_t  *sv_calcpings_method = nullptr;
 cvar_t  *sv_changemapcmd = nullptr;
 cvar_t  *sv_max_download_size = nullptr;
 cvar_t  *sv_max_packet_entities = nullptr;
+cvar_t  *sv_maxrewind = nullptr;
 
 cvar_t  *sv_allow_map = nullptr;
 cvar_t  *sv_cinematics = nullptr;
@@ -350,21 +355,6 @@ void SV_RateInit(ratelimit_t *r, const char *s)
     r->cost = rate2credits(rate);
 }
 
-addrmatch_t *SV_MatchAddress(list_t *list, netadr_t *addr)
-{
-    addrmatch_t *match;
-
-    LIST_FOR_EACH(addrmatch_t, match, list, entry) {
-        if (NET_IsEqualBaseAdrMask(addr, &match->addr, &match->mask)) {
-            match->hits++;
-            match->time = time(NULL);
-            return match;
-        }
-    }
-
-    return NULL;
-}
-
 /*
 ==============================================================================
 
@@ -1421,6 +1411,8 @@ static void SV_PacketEvent(void)
     netchan_t   *netchan;
     int         qport;
 
+    SV_Capture_Packet();
+
     if ( msg_read.cursize < 4 ) {
         return;
     }
@@ -1810,7 +1802,7 @@ static void SV_MasterShutdown(void)
 
 /*
 ==================
-SV_Frame
+SV_RunFrame
 
 Some things like MVD client connections and command buffer
 processing are run even when server is not yet initalized.
@@ -1818,7 +1810,7 @@ processing are run even when server is not yet initalized.
 Returns amount of extra frametime available for sleeping on IO.
 ==================
 */
-int64_t SV_Frame(uint64_t msec)
+static int64_t SV_RunFrame(uint64_t msec)
 {
 #if USE_CLIENT
     time_before_svgame = time_after_svgame = 0;
@@ -1832,8 +1824,12 @@ int64_t SV_Frame(uint64_t msec)
         Cbuf_Execute( &cmd_buffer );
     }
 
-    // read packets from UDP clients
-    NET_GetPackets(NS_SERVER, SV_PacketEvent);
+    // read packets from UDP clients, or from the capture being replayed
+    if (SV_Replay_Active()) {
+        SV_Replay_DeliverPackets(SV_PacketEvent);
+    } else {
+        NET_GetPackets(NS_SERVER, SV_PacketEvent);
+    }
 
     if (svs.initialized) {
         // deliver fragments and reliable messages for connecting clients
@@ -1862,6 +1858,9 @@ int64_t SV_Frame(uint64_t msec)
         // send messages back to the UDP clients
         SV_SendClientMessages();
 
+        // archive the frame if recording a multi view demo
+        SV_MvdRecord_Frame();
+
         // send a heartbeat to the master if needed
         SV_MasterHeartbeat();
 
@@ -1893,6 +1892,23 @@ int64_t SV_Frame(uint64_t msec)
     return 0;
 }
 
+/*
+==================
+SV_Frame
+
+Runs a regular server frame, or the next frame of a capture being replayed.
+==================
+*/
+int64_t SV_Frame(uint64_t msec)
+{
+    if (SV_Replay_Active()) {
+        return SV_Replay_RunFrame(SV_RunFrame);
+    }
+
+    SV_Capture_Frame(msec);
+    return SV_RunFrame(msec);
+}
+
 //============================================================================
 
 /*
@@ -2060,6 +2076,8 @@ void SV_Init(void) {
     SV_InitOperatorCommands();
     // Register savegames.
     SV_RegisterSavegames();
+    SV_RegisterCapture();
+    SV_RegisterMvdRecord();
     // Initialize model cache system.
     SV_Models_Init();
 
@@ -2127,6 +2145,7 @@ void SV_Init(void) {
     sv_lan_force_rate = Cvar_Get("sv_lan_force_rate", "0", CVAR_LATCH);
     sv_max_download_size = Cvar_Get( "sv_max_download_size", "8388608", 0 );
     sv_max_packet_entities = Cvar_Get( "sv_max_packet_entities", STRINGIFY( MAX_PACKET_ENTITIES ), 0 );
+    sv_maxrewind = Cvar_Get( "sv_maxrewind", "200", 0 );
 	// WID: 40hz:
 	//sv_min_rate = Cvar_Get("sv_min_rate", "16", CVAR_LATCH);
 	sv_min_rate = Cvar_Get( "sv_min_rate", std::to_string( CLIENT_RATE_MIN ).c_str( ), CVAR_LATCH );
@@ -2251,6 +2270,9 @@ void SV_Shutdown(const char *finalmsg, error_type_t type)
     if (!sv_registered)
         return;
 
+    SV_Capture_Shutdown();
+    SV_MvdRecord_Stop();
+    SV_SaveWriter_Shutdown();
     SV_FinalMessage(finalmsg, type);
     SV_MasterShutdown();
     SV_ShutdownGameProgs();
@@ -2262,6 +2284,8 @@ void SV_Shutdown(const char *finalmsg, error_type_t type)
     SKM_PoseCache_ClearCache( svs.serverPoseCache );
 
     // free current level
+    SV_ClearLagHistory();
+    SV_FreeGameStateCache();
     CM_FreeMap(&sv.cm);
     memset(&sv, 0, sizeof(sv));
 
@@ -0,0 +1,558 @@
+/********************************************************************
+*
+*
+*	Server: Multi View Demo Recording.
+*
+*	Instead of one demo per client, a multi view demo (.mvd2) holds the
+*	state of the whole level: every entity and the player state of every
+*	spawned client, each delta compressed against the previous frame, and
+*	the messages the game sent to anyone. On playback the client picks any
+*	player as the point of view and turns it into regular frames, see
+*	client/cl_mvd.cpp.
+*
+*	The file uses the client demo framing (see MVD_MAGIC in protocol.h),
+*	one block per server frame. Blocks are handed to a writer thread that
+*	does the gzip compression and file writes, so all the frame thread pays
+*	for is the delta encoding and a copy into the ring buffer.
+*
+*
+********************************************************************/
+#include "server/sv_server.h"
+#include "server/sv_entities.h"
+#include "server/sv_mvd.h"
+
+#include "system/pthread.h"
+
+//! Size of the ring buffer blocks are queued in for the writer thread.
+#define MVD_RING_SIZE   ( 4 * 1024 * 1024 )
+//! Room kept free in a frame record for the end of the entity list.
+#define MVD_FRAME_SLACK 16
+
+//! Recording state.
+static struct {
+	bool active;
+	qhandle_t file;
+	char name[ MAX_OSPATH ];
+
+	//! Message records collected since the last frame.
+	sizebuf_t records;
+	byte recordsBuffer[ MAX_MSGLEN ];
+
+	//! Baselines as written in the gamestate, and the entity states of the last frame.
+	//! Entities that weren't part of the last frame have a number of 0.
+	entity_state_t *baselines;
+	entity_state_t *entities;
+	int32_t numEntities;
+	//! Player states of the last frame.
+	player_state_t players[ MAX_CLIENTS ];
+	bool playersPresent[ MAX_CLIENTS ];
+
+	//! The first frame carries the portal states.
+	bool firstFrame;
+	//! Frame records that didn't fit all entities.
+	uint64_t framesOverflowed;
+
+	uint64_t frames;
+	uint64_t bytes;
+	uint64_t startTime;
+
+	//! Writer thread, consumes the ring between tail and head.
+	pthread_t thread;
+	pthread_mutex_t lock;
+	//! Signalled when data was queued or the thread should finish.
+	pthread_cond_t wake;
+	//! Signalled when the thread made room in the ring.
+	pthread_cond_t space;
+	byte *ring;
+	uint64_t head;
+	uint64_t tail;
+	bool terminate;
+	//! Set by the writer thread when a write failed.
+	bool failed;
+	int error;
+} sv_mvd;
+
+
+
+/**
+*
+*
+*	Writer Thread:
+*
+*
+**/
+static void *SV_MvdRecord_WriterThread( void *arg ) {
+	pthread_mutex_lock( &sv_mvd.lock );
+	while ( 1 ) {
+		while ( sv_mvd.head == sv_mvd.tail && !sv_mvd.terminate ) {
+			pthread_cond_wait( &sv_mvd.wake, &sv_mvd.lock );
+		}
+		if ( sv_mvd.head == sv_mvd.tail ) {
+			break;
+		}
+
+		// Write out the contiguous part, without holding the lock.
+		const size_t offset = sv_mvd.tail % MVD_RING_SIZE;
+		const size_t len = std::min<uint64_t>( sv_mvd.head - sv_mvd.tail, MVD_RING_SIZE - offset );
+		pthread_mutex_unlock( &sv_mvd.lock );
+
+		const int ret = FS_Write( sv_mvd.ring + offset, len, sv_mvd.file );
+
+		pthread_mutex_lock( &sv_mvd.lock );
+		if ( ret != len ) {
+			sv_mvd.failed = true;
+			sv_mvd.error = ret < 0 ? ret : Q_ERR_FAILURE;
+			// Drop whatever is left, the main thread stops recording.
+			sv_mvd.tail = sv_mvd.head;
+		} else {
+			sv_mvd.tail += len;
+		}
+		pthread_cond_signal( &sv_mvd.space );
+	}
+	pthread_mutex_unlock( &sv_mvd.lock );
+
+	return NULL;
+}
+
+/**
+*	@brief	Copies 'len' bytes into the ring, waiting for the writer thread if it is full.
+**/
+static void SV_MvdRecord_Queue( const void *data, const size_t len ) {
+	const byte *src = static_cast<const byte *>( data );
+
+	pthread_mutex_lock( &sv_mvd.lock );
+	while ( MVD_RING_SIZE - ( sv_mvd.head - sv_mvd.tail ) < len && !sv_mvd.failed ) {
+		pthread_cond_wait( &sv_mvd.space, &sv_mvd.lock );
+	}
+	if ( !sv_mvd.failed ) {
+		const size_t offset = sv_mvd.head % MVD_RING_SIZE;
+		const size_t first = std::min( len, MVD_RING_SIZE - offset );
+		memcpy( sv_mvd.ring + offset, src, first );
+		memcpy( sv_mvd.ring, src + first, len - first );
+		sv_mvd.head += len;
+	}
+	pthread_mutex_unlock( &sv_mvd.lock );
+
+	pthread_cond_signal( &sv_mvd.wake );
+	sv_mvd.bytes += len;
+}
+
+/**
+*	@brief	Queues a block made of 'a' followed by 'b'.
+**/
+static void SV_MvdRecord_QueueBlock( const sizebuf_t *a, const sizebuf_t *b ) {
+	const size_t len = a->cursize + ( b ? b->cursize : 0 );
+	if ( !len ) {
+		return;
+	}
+
+	byte header[ 4 ];
+	WL32( header, (uint32_t)len );
+	SV_MvdRecord_Queue( header, 4 );
+	SV_MvdRecord_Queue( a->data, a->cursize );
+	if ( b && b->cursize ) {
+		SV_MvdRecord_Queue( b->data, b->cursize );
+	}
+}
+
+
+
+/**
+*
+*
+*	Recording:
+*
+*
+**/
+/**
+*	@return	False if the entity isn't part of frames, otherwise true with its recorded state in 'state'.
+**/
+static const bool SV_MvdRecord_EntityState( const int32_t number, entity_state_t *state ) {
+	sv_edict_t *ent = EDICT_FOR_NUMBER( number );
+	if ( !ent || ( !ent->inUse && ( g_features->integer & GMF_PROPERINUSE ) ) ) {
+		return false;
+	}
+	if ( ent->svFlags & SVF_NOCLIENT ) {
+		return false;
+	}
+
+	// Same rules as SV_BuildClientFrame, minus the PVS culling which is up to playback.
+	const bool isTempEventEntity = ( ent->s.entityType - ge->GetTempEventEntityTypeOffset() > 0 );
+	if ( !( ent->svFlags & SVF_NO_CULL ) && !isTempEventEntity ) {
+		if ( !ent->s.modelindex && !ent->s.entityFlags && !ent->s.sound && !EV_GetEntityEventValue( ent->s.event ) ) {
+			return false;
+		}
+	}
+
+	*state = ent->s;
+	state->number = number;
+	state->solid = static_cast<cm_solid_t>( sv.entities[ number ].solid32 );
+	return true;
+}
+
+/**
+*	@brief	Writes the serverdata, configstrings and baselines, split into as many
+*			gamestate blocks as needed.
+**/
+static void SV_MvdRecord_WriteGamestate( void ) {
+	// Default point of view, the first player in game.
+	int32_t pov = 0;
+	client_t *client;
+	FOR_EACH_CLIENT( client ) {
+		if ( client->state == cs_spawned ) {
+			pov = client->number;
+			break;
+		}
+	}
+
+	MSG_WriteUint8( mvd_gamestate );
+	MSG_WriteUint8( svc_serverdata );
+	MSG_WriteInt32( PROTOCOL_VERSION_Q2RTXPERIMENTAL );
+	MSG_WriteInt32( sv.spawncount );
+	MSG_WriteUint8( 1 );	// demos are always attract loops
+	MSG_WriteUint8( ge->GetRequestedGameModeType() );
+	MSG_WriteString( fs_game->string );
+	MSG_WriteInt16( pov );
+	MSG_WriteString( sv.configstrings[ CS_NAME ] );
+
+	for ( int32_t i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		const char *string = sv.configstrings[ i ];
+		if ( !string[ 0 ] ) {
+			continue;
+		}
+		const size_t length = Q_strnlen( string, MAX_CS_STRING_LENGTH );
+		if ( msg_write.cursize + length + 4 > msg_write.maxsize ) {
+			SV_MvdRecord_QueueBlock( &msg_write, nullptr );
+			SZ_Clear( &msg_write );
+			MSG_WriteUint8( mvd_gamestate );
+		}
+		MSG_WriteUint8( svc_configstring );
+		MSG_WriteInt16( i );
+		MSG_WriteData( string, length );
+		MSG_WriteUint8( 0 );
+	}
+
+	const int32_t tempEntityOffset = ge->GetTempEventEntityTypeOffset();
+	for ( int32_t i = 1; i < sv_mvd.numEntities; i++ ) {
+		sv_edict_t *ent = EDICT_FOR_NUMBER( i );
+		if ( ( g_features->integer & GMF_PROPERINUSE ) && !ent->inUse ) {
+			continue;
+		}
+		if ( !ES_INUSE( &ent->s ) ) {
+			continue;
+		}
+
+		entity_state_t *base = &sv_mvd.baselines[ i ];
+		*base = ent->s;
+		base->number = i;
+		base->solid = static_cast<cm_solid_t>( sv.entities[ i ].solid32 );
+
+		if ( msg_write.cursize + MAX_PACKETENTITY_BYTES > msg_write.maxsize ) {
+			SV_MvdRecord_QueueBlock( &msg_write, nullptr );
+			SZ_Clear( &msg_write );
+			MSG_WriteUint8( mvd_gamestate );
+		}
+		MSG_WriteUint8( svc_spawnbaseline );
+		MSG_WriteDeltaEntity( NULL, base, MSG_ES_FORCE, tempEntityOffset );
+	}
+
+	MSG_WriteUint8( svc_stufftext );
+	MSG_WriteString( "precache\n" );
+
+	SV_MvdRecord_QueueBlock( &msg_write, nullptr );
+	SZ_Clear( &msg_write );
+}
+
+/**
+*	@brief	Archives the message in msg_write, as sent to the client in 'clientSlot',
+*			or to everyone for a slot of -1.
+**/
+void SV_MvdRecord_Message( const int32_t clientSlot ) {
+	if ( !sv_mvd.active || !msg_write.cursize ) {
+		return;
+	}
+
+	// Nothing that would make the demo player execute or disconnect.
+	const int32_t cmd = msg_write.data[ 0 ];
+	if ( cmd == svc_stufftext || cmd == svc_disconnect || cmd == svc_reconnect ) {
+		return;
+	}
+
+	const size_t header = ( clientSlot >= 0 ? 4 : 3 );
+	if ( msg_write.cursize > UINT16_MAX ) {
+		return;
+	}
+	if ( sv_mvd.records.cursize + header + msg_write.cursize > sv_mvd.records.maxsize ) {
+		// Flush as a block of its own, the frame comes with the next one.
+		SV_MvdRecord_QueueBlock( &sv_mvd.records, nullptr );
+		SZ_Clear( &sv_mvd.records );
+	}
+
+	if ( clientSlot >= 0 ) {
+		SZ_WriteUint8( &sv_mvd.records, mvd_unicast );
+		SZ_WriteUint8( &sv_mvd.records, clientSlot );
+	} else {
+		SZ_WriteUint8( &sv_mvd.records, mvd_multicast );
+	}
+	SZ_WriteUint16( &sv_mvd.records, msg_write.cursize );
+	SZ_WriteData( &sv_mvd.records, msg_write.data, msg_write.cursize );
+}
+
+/**
+*	@brief	Writes the player states of all spawned clients, delta compressed against
+*			their state in the last frame.
+**/
+static void SV_MvdRecord_WritePlayers( void ) {
+	bool present[ MAX_CLIENTS ] = {};
+	int32_t count = 0;
+
+	client_t *client;
+	FOR_EACH_CLIENT( client ) {
+		if ( client->state == cs_spawned && client->number < MAX_CLIENTS && EDICT_FOR_NUMBER( client->number + 1 )->client ) {
+			present[ client->number ] = true;
+			count++;
+		}
+	}
+
+	MSG_WriteUint16( count );
+	for ( int32_t i = 0; i < MAX_CLIENTS; i++ ) {
+		if ( !present[ i ] ) {
+			sv_mvd.playersPresent[ i ] = false;
+			continue;
+		}
+
+		// Work on a copy, the game's player state is not ours to modify.
+		player_state_t ps = EDICT_FOR_NUMBER( i + 1 )->client->ps;
+		if ( !VALIDATE_CLIENTNUM( ps.clientNumber ) ) {
+			ps.clientNumber = i;
+		}
+
+		MSG_WriteUint8( i );
+		MSG_WriteDeltaPlayerstate( sv_mvd.playersPresent[ i ] ? &sv_mvd.players[ i ] : nullptr, &ps );
+		sv_mvd.players[ i ] = ps;
+		sv_mvd.playersPresent[ i ] = true;
+	}
+}
+
+/**
+*	@brief	Writes every entity that is part of the frame, delta compressed against the
+*			last frame, or against its baseline when it is new.
+**/
+static void SV_MvdRecord_WriteEntities( void ) {
+	const int32_t tempEntityOffset = ge->GetTempEventEntityTypeOffset();
+	const int32_t numEntities = std::min( ge->edictPool->num_edicts, MAX_PACKET_ENTITIES );
+	const int32_t count = std::max( numEntities, sv_mvd.numEntities );
+	bool overflowed = false;
+
+	for ( int32_t i = 1; i < count; i++ ) {
+		entity_state_t *oldent = &sv_mvd.entities[ i ];
+		entity_state_t newent;
+		const bool inFrame = ( i < numEntities && SV_MvdRecord_EntityState( i, &newent ) );
+
+		if ( !inFrame && !oldent->number ) {
+			continue;
+		}
+
+		// An entity that doesn't fit keeps its old state, and is caught up on next frame.
+		if ( msg_write.cursize + MAX_PACKETENTITY_BYTES > msg_write.maxsize - MVD_FRAME_SLACK ) {
+			overflowed = true;
+			continue;
+		}
+
+		if ( !inFrame ) {
+			MSG_WriteDeltaEntity( oldent, NULL, MSG_ES_FORCE, tempEntityOffset );
+			oldent->number = 0;
+		} else if ( oldent->number ) {
+			// Players are always 'newentities', to keep their old_origin.
+			const msgEsFlags_t flags = ( i <= sv_maxclients->integer ? MSG_ES_NEWENTITY : MSG_ES_NONE );
+			MSG_WriteDeltaEntity( oldent, &newent, flags, tempEntityOffset );
+			*oldent = newent;
+		} else {
+			const entity_state_t *base = ( sv_mvd.baselines[ i ].number ? &sv_mvd.baselines[ i ] : &nullEntityState );
+			MSG_WriteDeltaEntity( base, &newent, static_cast<msgEsFlags_t>( MSG_ES_FORCE | MSG_ES_NEWENTITY ), tempEntityOffset );
+			*oldent = newent;
+		}
+	}
+	MSG_WriteInt16( 0 );
+
+	sv_mvd.numEntities = numEntities;
+	if ( overflowed && !sv_mvd.framesOverflowed++ ) {
+		Com_WPrintf( "%s: frame %" PRId64 " doesn't fit all entities, some will lag behind.\n", sv_mvd.name, sv.framenum );
+	}
+}
+
+/**
+*	@brief	Archives the entity and player states of the frame that was just run.
+**/
+void SV_MvdRecord_Frame( void ) {
+	if ( !sv_mvd.active ) {
+		return;
+	}
+	if ( sv_mvd.failed ) {
+		Com_EPrintf( "Couldn't write %s: %s\n", sv_mvd.name, Q_ErrorString( sv_mvd.error ) );
+		SV_MvdRecord_Stop();
+		return;
+	}
+
+	SZ_Clear( &msg_write );
+	MSG_WriteUint8( mvd_frame );
+	MSG_WriteIntBase128( sv.framenum );
+
+	// Portal states go with the first frame, later changes are multicasts.
+	if ( sv_mvd.firstFrame ) {
+		byte portalBits[ MAX_MAP_PORTAL_BYTES ] = {};
+		const int32_t numPortalBits = CM_WritePortalBits( &sv.cm, portalBits );
+		MSG_WriteUint8( numPortalBits );
+		MSG_WriteData( portalBits, numPortalBits );
+		sv_mvd.firstFrame = false;
+	} else {
+		MSG_WriteUint8( 0 );
+	}
+
+	SV_MvdRecord_WritePlayers();
+	SV_MvdRecord_WriteEntities();
+
+	// Keep blocks within what the client can read in one go.
+	if ( sv_mvd.records.cursize + msg_write.cursize > MAX_MSGLEN ) {
+		SV_MvdRecord_QueueBlock( &sv_mvd.records, nullptr );
+		SZ_Clear( &sv_mvd.records );
+	}
+	SV_MvdRecord_QueueBlock( &sv_mvd.records, &msg_write );
+	SZ_Clear( &sv_mvd.records );
+	SZ_Clear( &msg_write );
+
+	sv_mvd.frames++;
+}
+
+/**
+*	@brief	Opens the file, starts the writer thread and writes the gamestate.
+**/
+static void SV_MvdRecord_Start( const char *name ) {
+	sv_mvd.file = FS_EasyOpenFile( sv_mvd.name, sizeof( sv_mvd.name ), FS_MODE_WRITE | FS_FLAG_GZIP, "demos/", name, ".mvd2" );
+	if ( !sv_mvd.file ) {
+		return;
+	}
+
+	sv_mvd.ring = static_cast<byte *>( SV_Malloc( MVD_RING_SIZE ) );
+	sv_mvd.head = sv_mvd.tail = 0;
+	sv_mvd.terminate = sv_mvd.failed = false;
+	sv_mvd.error = 0;
+	pthread_mutex_init( &sv_mvd.lock, NULL );
+	pthread_cond_init( &sv_mvd.wake, NULL );
+	pthread_cond_init( &sv_mvd.space, NULL );
+	if ( pthread_create( &sv_mvd.thread, NULL, SV_MvdRecord_WriterThread, NULL ) ) {
+		Com_EPrintf( "Couldn't create the demo writer thread.\n" );
+		Z_Free( sv_mvd.ring );
+		sv_mvd.ring = nullptr;
+		FS_CloseFile( sv_mvd.file );
+		sv_mvd.file = 0;
+		return;
+	}
+
+	SZ_TagInit( &sv_mvd.records, sv_mvd.recordsBuffer, sizeof( sv_mvd.recordsBuffer ), "mvd_records" );
+	sv_mvd.baselines = static_cast<entity_state_t *>( SV_Mallocz( sizeof( entity_state_t ) * MAX_PACKET_ENTITIES ) );
+	sv_mvd.entities = static_cast<entity_state_t *>( SV_Mallocz( sizeof( entity_state_t ) * MAX_PACKET_ENTITIES ) );
+	sv_mvd.numEntities = std::min( ge->edictPool->num_edicts, MAX_PACKET_ENTITIES );
+	memset( sv_mvd.playersPresent, 0, sizeof( sv_mvd.playersPresent ) );
+	sv_mvd.firstFrame = true;
+	sv_mvd.framesOverflowed = 0;
+	sv_mvd.frames = sv_mvd.bytes = 0;
+	sv_mvd.startTime = Sys_Milliseconds();
+	sv_mvd.active = true;
+
+	const uint32_t magic = MVD_MAGIC;
+	SV_MvdRecord_Queue( &magic, 4 );
+	SZ_Clear( &msg_write );
+	SV_MvdRecord_WriteGamestate();
+
+	Com_Printf( "Recording multi view demo to %s.\n", sv_mvd.name );
+}
+
+/**
+*	@brief	Ends a running recording, waiting for the writer thread to flush it out.
+**/
+void SV_MvdRecord_Stop( void ) {
+	if ( !sv_mvd.active ) {
+		return;
+	}
+	sv_mvd.active = false;
+
+	// Flush messages recorded after the last frame, then the end of demo marker.
+	SV_MvdRecord_QueueBlock( &sv_mvd.records, nullptr );
+	SZ_Clear( &sv_mvd.records );
+	const uint32_t eof = (uint32_t)-1;
+	SV_MvdRecord_Queue( &eof, 4 );
+
+	pthread_mutex_lock( &sv_mvd.lock );
+	sv_mvd.terminate = true;
+	pthread_mutex_unlock( &sv_mvd.lock );
+	pthread_cond_signal( &sv_mvd.wake );
+	pthread_join( sv_mvd.thread, NULL );
+	pthread_mutex_destroy( &sv_mvd.lock );
+	pthread_cond_destroy( &sv_mvd.wake );
+	pthread_cond_destroy( &sv_mvd.space );
+
+	FS_CloseFile( sv_mvd.file );
+	sv_mvd.file = 0;
+
+	Z_Free( sv_mvd.ring );
+	Z_Free( sv_mvd.baselines );
+	Z_Free( sv_mvd.entities );
+	sv_mvd.ring = nullptr;
+	sv_mvd.baselines = sv_mvd.entities = nullptr;
+
+	const uint64_t msec = Sys_Milliseconds() - sv_mvd.startTime;
+	Com_Printf( "Stopped recording %s: %" PRIu64 " frames in %" PRIu64 " seconds, %" PRIu64 " bytes before compression.\n",
+		sv_mvd.name, sv_mvd.frames, msec / 1000, sv_mvd.bytes );
+	if ( sv_mvd.framesOverflowed ) {
+		Com_Printf( "%" PRIu64 " frames didn't fit all entities.\n", sv_mvd.framesOverflowed );
+	}
+}
+
+
+
+/**
+*
+*
+*	Commands:
+*
+*
+**/
+static void SV_MvdRecord_f( void ) {
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: %s <filename>\n"
+			"Records every entity and player of the level into a multi view demo.\n", Cmd_Argv( 0 ) );
+		return;
+	}
+	if ( sv_mvd.active ) {
+		Com_Printf( "Already recording to %s.\n", sv_mvd.name );
+		return;
+	}
+	if ( sv.state != ss_game ) {
+		Com_Printf( "No game is running.\n" );
+		return;
+	}
+
+	SV_MvdRecord_Start( Cmd_Argv( 1 ) );
+}
+
+static void SV_MvdStop_f( void ) {
+	if ( !sv_mvd.active ) {
+		Com_Printf( "Not recording a multi view demo.\n" );
+		return;
+	}
+	SV_MvdRecord_Stop();
+}
+
+static const cmdreg_t c_mvd[] = {
+	{ "mvdrecord", SV_MvdRecord_f },
+	{ "mvdstop", SV_MvdStop_f },
+	{ NULL }
+};
+
+/**
+*	@brief	Registers the "mvdrecord" and "mvdstop" commands.
+**/
+void SV_RegisterMvdRecord( void ) {
+	Cmd_Register( c_mvd );
+}
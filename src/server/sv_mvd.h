@@ -0,0 +1,28 @@
+/*********************************************************************
+*
+*
+*	Server: Multi View Demo Recording.
+*
+*
+********************************************************************/
+#pragma once
+
+
+/**
+*	@brief	Archives the message in msg_write, as sent to the client in 'clientSlot',
+*			or to everyone for a slot of -1.
+**/
+void SV_MvdRecord_Message( const int32_t clientSlot );
+/**
+*	@brief	Archives the entity and player states of the frame that was just run.
+**/
+void SV_MvdRecord_Frame( void );
+
+/**
+*	@brief	Ends a running recording, waiting for the writer thread to flush it out.
+**/
+void SV_MvdRecord_Stop( void );
+/**
+*	@brief	Registers the "mvdrecord" and "mvdstop" commands.
+**/
+void SV_RegisterMvdRecord( void );
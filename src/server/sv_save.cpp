@@ -20,6 +20,9 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "server/sv_commands.h"
 #include "server/sv_init.h"
 #include "server/sv_world.h"
+#include "server/sv_save.h"
+
+#include "system/pthread.h"
 
 
 
@@ -58,6 +61,9 @@ with this program; if not, write to the Free Software Foundation, Inc.,
     #ifdef clamp
     #undef clamp
     #endif
+#include <io.h>
+#else
+#include <unistd.h>
 #endif
 
 #define SAVE_MAGIC1     MakeLittleLong('S','S','V','2')
@@ -73,6 +79,274 @@ cvar_t *sv_savedir = NULL;
 // * Still, allow it as an option for cautious people. */
 //cvar_t *sv_force_enhanced_savegames = NULL;
 
+/*
+==============================================================================
+
+BACKGROUND SAVE WRITER
+
+The game serializes savegames into memory and hands them over here. They are
+compressed and written out in order by a single writer thread, to a temporary
+file that is synced and then renamed over the destination, so an interrupted
+write never leaves a truncated savegame behind.
+
+Anything that reads, copies or removes save files must call SV_SaveWriter_Flush
+first. Queue memory is only ever allocated and freed on the main thread.
+
+==============================================================================
+*/
+
+typedef struct save_job_s {
+    struct save_job_s   *next;
+    char        path[MAX_OSPATH];
+    byte        *data;
+    size_t      length;
+    // set by the writer thread
+    bool        done;
+    bool        failed;
+} save_job_t;
+
+static struct {
+    pthread_t       thread;
+    bool            running;
+    bool            terminate;
+    pthread_mutex_t lock;
+    // signalled when a job was queued or the thread should finish
+    pthread_cond_t  wake;
+    // signalled when a job is done
+    pthread_cond_t  done;
+    // all jobs, in order, until reaped by the main thread
+    save_job_t      *head;
+    save_job_t      **tail;
+    // first job the writer thread hasn't started on
+    save_job_t      *next;
+} sv_savewriter = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .tail = &sv_savewriter.head,
+};
+
+/*
+==================
+write_save_job
+
+Runs on the writer thread. Uses plain stdio and malloc only.
+==================
+*/
+static bool write_save_job(const save_job_t *job)
+{
+    char tmppath[MAX_OSPATH + 4];
+    const byte *out = job->data;
+    size_t outlen = job->length;
+    byte *compressed = NULL;
+    FILE *fp;
+    bool ok;
+
+    if (Q_concat(tmppath, sizeof(tmppath), job->path, ".tmp") >= sizeof(tmppath))
+        return false;
+
+#if USE_ZLIB
+    // gzip wrapped, so plain gzopen/gzread can load the result
+    z_stream z = {};
+    if (deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    outlen = deflateBound(&z, job->length);
+    compressed = static_cast<byte *>( malloc(outlen) );
+    if (!compressed) {
+        deflateEnd(&z);
+        return false;
+    }
+
+    z.next_in = job->data;
+    z.avail_in = job->length;
+    z.next_out = compressed;
+    z.avail_out = outlen;
+    ok = deflate(&z, Z_FINISH) == Z_STREAM_END;
+    outlen = z.total_out;
+    deflateEnd(&z);
+    if (!ok) {
+        free(compressed);
+        return false;
+    }
+    out = compressed;
+#endif
+
+    fp = fopen(tmppath, "wb");
+    if (!fp) {
+        free(compressed);
+        return false;
+    }
+
+    ok = fwrite(out, 1, outlen, fp) == outlen && !fflush(fp);
+#ifdef _WIN32
+    ok = ok && !_commit(_fileno(fp));
+#else
+    ok = ok && !fsync(fileno(fp));
+#endif
+    ok = !fclose(fp) && ok;
+    free(compressed);
+
+    if (ok) {
+#ifdef _WIN32
+        ok = MoveFileExA(tmppath, job->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        ok = !rename(tmppath, job->path);
+#endif
+    }
+    if (!ok)
+        remove(tmppath);
+
+    return ok;
+}
+
+static void *savewriter_thread(void *arg)
+{
+    pthread_mutex_lock(&sv_savewriter.lock);
+    while (1) {
+        while (!sv_savewriter.next && !sv_savewriter.terminate)
+            pthread_cond_wait(&sv_savewriter.wake, &sv_savewriter.lock);
+        if (!sv_savewriter.next)
+            break;
+
+        save_job_t *job = sv_savewriter.next;
+        sv_savewriter.next = job->next;
+        pthread_mutex_unlock(&sv_savewriter.lock);
+
+        const bool ok = write_save_job(job);
+
+        pthread_mutex_lock(&sv_savewriter.lock);
+        job->failed = !ok;
+        job->done = true;
+        pthread_cond_broadcast(&sv_savewriter.done);
+    }
+    pthread_mutex_unlock(&sv_savewriter.lock);
+
+    return NULL;
+}
+
+/*
+==================
+reap_save_jobs
+
+Frees the jobs the writer thread is done with. Called with the lock held.
+Returns -1 if any of them failed.
+==================
+*/
+static int reap_save_jobs(void)
+{
+    save_job_t *job;
+    int ret = 0;
+
+    while ((job = sv_savewriter.head) != NULL && job->done) {
+        if (job->failed) {
+            Com_EPrintf("Couldn't write %s\n", job->path);
+            ret = -1;
+        }
+        sv_savewriter.head = job->next;
+        Z_Free(job->data);
+        Z_Free(job);
+    }
+    if (!sv_savewriter.head)
+        sv_savewriter.tail = &sv_savewriter.head;
+
+    return ret;
+}
+
+/*
+==================
+SV_SaveWriter_WriteFile
+
+Queues a copy of the data to be compressed and written to the OS path.
+==================
+*/
+void SV_SaveWriter_WriteFile(const char *filename, const void *data, const size_t length)
+{
+    save_job_t *job = static_cast<save_job_t *>( SV_Mallocz(sizeof(*job)) );
+
+    if (Q_strlcpy(job->path, filename, sizeof(job->path)) >= sizeof(job->path)) {
+        Z_Free(job);
+        Com_Error(ERR_DROP, "%s: oversize filename", __func__);
+    }
+    job->data = static_cast<byte *>( SV_Malloc(length) );
+    job->length = length;
+    memcpy(job->data, data, length);
+
+    if (!sv_savewriter.running) {
+        sv_savewriter.terminate = false;
+        if (pthread_create(&sv_savewriter.thread, NULL, savewriter_thread, NULL)) {
+            // no thread, write it out right away
+            if (!write_save_job(job))
+                Com_EPrintf("Couldn't write %s\n", job->path);
+            Z_Free(job->data);
+            Z_Free(job);
+            return;
+        }
+        sv_savewriter.running = true;
+    }
+
+    pthread_mutex_lock(&sv_savewriter.lock);
+    reap_save_jobs();
+    *sv_savewriter.tail = job;
+    sv_savewriter.tail = &job->next;
+    if (!sv_savewriter.next)
+        sv_savewriter.next = job;
+    pthread_mutex_unlock(&sv_savewriter.lock);
+    pthread_cond_signal(&sv_savewriter.wake);
+}
+
+/*
+==================
+SV_SaveWriter_Flush
+
+Waits for all queued saves to hit the disk. Returns -1 if any of them
+failed since the last flush.
+==================
+*/
+int SV_SaveWriter_Flush(void)
+{
+    int ret;
+
+    if (!sv_savewriter.running)
+        return 0;
+
+    pthread_mutex_lock(&sv_savewriter.lock);
+    while (1) {
+        save_job_t *job = sv_savewriter.head;
+        while (job && job->done)
+            job = job->next;
+        if (!job)
+            break;
+        pthread_cond_wait(&sv_savewriter.done, &sv_savewriter.lock);
+    }
+    ret = reap_save_jobs();
+    pthread_mutex_unlock(&sv_savewriter.lock);
+
+    return ret;
+}
+
+/*
+==================
+SV_SaveWriter_Shutdown
+
+Flushes the queue and stops the writer thread.
+==================
+*/
+void SV_SaveWriter_Shutdown(void)
+{
+    if (!sv_savewriter.running)
+        return;
+
+    SV_SaveWriter_Flush();
+
+    pthread_mutex_lock(&sv_savewriter.lock);
+    sv_savewriter.terminate = true;
+    pthread_mutex_unlock(&sv_savewriter.lock);
+    pthread_cond_signal(&sv_savewriter.wake);
+    pthread_join(sv_savewriter.thread, NULL);
+    sv_savewriter.running = false;
+}
+
 static int write_server_file(bool autosave)
 {
     char        name[MAX_OSPATH];
@@ -238,6 +512,9 @@ static int wipe_save_dir(const char *dir)
     void **list;
     int i, count, ret = 0;
 
+    // don't let a queued save land after the wipe
+    SV_SaveWriter_Flush();
+
     if ((list = list_save_dir(dir, &count)) == NULL)
         return 0;
 
@@ -253,6 +530,9 @@ static int copy_save_dir(const char *src, const char *dst)
     void **list;
     int i, count, ret = 0;
 
+    if (SV_SaveWriter_Flush())
+        return -1;
+
     if ((list = list_save_dir(src, &count)) == NULL)
         return -1;
 
@@ -268,6 +548,9 @@ static int read_binary_file(const char *name)
     qhandle_t f;
     int64_t len;
 
+    // the game files are read right after, make sure they are complete
+    SV_SaveWriter_Flush();
+
     len = FS_OpenFile(name, &f, FS_MODE_READ | FS_TYPE_REAL | FS_PATH_GAME);
     if (!f)
         return -1;
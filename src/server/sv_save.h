@@ -27,4 +27,19 @@ void SV_RegisterSavegames( void );
 /**
 *	@brief
 **/
-const int32_t SV_NoSaveGames( void );
\ No newline at end of file
+const int32_t SV_NoSaveGames( void );
+
+/**
+*	@brief	Queues a copy of 'data' to be compressed and written to the OS path 'filename'
+*			by the background save writer. The file is replaced atomically once written.
+**/
+void SV_SaveWriter_WriteFile( const char *filename, const void *data, const size_t length );
+/**
+*	@brief	Waits for all queued saves to be written out.
+*	@return	-1 if any of them failed since the last flush, 0 otherwise.
+**/
+int SV_SaveWriter_Flush( void );
+/**
+*	@brief	Flushes the queue and stops the writer thread.
+**/
+void SV_SaveWriter_Shutdown( void );
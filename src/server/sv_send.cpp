@@ -20,6 +20,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "server/sv_server.h"
 #include "server/sv_commands.h"
 #include "server/sv_entities.h"
+#include "server/sv_mvd.h"
 #include "server/sv_send.h"
 #include "server/sv_user.h"
 
@@ -286,6 +287,9 @@ void SV_Multicast(const vec3_t origin, multicast_t to, bool reliable) {
 	if ( reliable )
 		flags |= MSG_RELIABLE;
 
+	// archive it for everyone, multi view demos aren't culled
+	SV_MvdRecord_Message( -1 );
+
 	// send the data to all relevent clients
 	FOR_EACH_CLIENT( client ) {
 		if ( client->state < cs_primed ) {
@@ -326,13 +330,14 @@ void SV_Multicast(const vec3_t origin, multicast_t to, bool reliable) {
 		return true;
 	}
 
-	static int compress_message( client_t *client ) {
+	/**
+	*	@brief	Deflates msg_write into a svc_zpacket at svs.z_buffer.
+	*	@return	Length of the packet, or 0 on failure.
+	**/
+	static int deflate_message( const char *name ) {
 		int     ret, len;
 		byte *hdr;
 
-		if ( !client->has_zlib )
-			return 0;
-
 		svs.z.next_in = msg_write.data;
 		svs.z.avail_in = msg_write.cursize;
 		svs.z.next_out = svs.z_buffer + ZPACKET_HEADER;
@@ -346,7 +351,7 @@ void SV_Multicast(const vec3_t origin, multicast_t to, bool reliable) {
 
 		if ( ret != Z_STREAM_END ) {
 			Com_WPrintf( "Error %d compressing %zu bytes message for %s\n",
-						ret, msg_write.cursize, client->name );
+						ret, msg_write.cursize, name );
 			return 0;
 		}
 
@@ -365,14 +370,40 @@ void SV_Multicast(const vec3_t origin, multicast_t to, bool reliable) {
 
 		return len + ZPACKET_HEADER;
 	}
+
+	static int compress_message( client_t *client ) {
+		if ( !client->has_zlib )
+			return 0;
+
+		return deflate_message( client->name );
+	}
 	static byte *get_compressed_data( void ) {
 		return svs.z_buffer;
 	}
 #else
 	#define can_auto_compress(c)    false
+	#define deflate_message(n)      0
 	#define compress_message(c)     0
 	#define get_compressed_data()   NULL
 #endif
+
+/**
+*	@brief	Compresses the current write buffer into a svc_zpacket, for messages that are
+*			encoded once and then handed out to several zlib capable clients.
+*	@return	Length of the packet at *data, or 0 if it couldn't be compressed.
+**/
+int SV_CompressMessage( byte **data ) {
+	*data = get_compressed_data();
+	return deflate_message( "shared message" );
+}
+
+/**
+*	@brief	Adds an already encoded message, as built by SV_CompressMessage or copied out
+*			of msg_write earlier, to the client's message list.
+**/
+void SV_ClientAddEncodedMessage( client_t *client, const byte *data, const size_t len, const int32_t flags ) {
+	add_message( client, const_cast<byte *>( data ), len, flags & MSG_RELIABLE );
+}
 /*
 =======================
 SV_ClientAddMessage
@@ -689,6 +720,9 @@ void SV_SendClientMessages(void)
     client_t    *client;
     size_t      cursize;
 
+    // queue datagrams and send them all at once
+    NET_BeginSendBatch();
+
     // send a message to each connected client
     FOR_EACH_CLIENT(client) {
         if (!CLIENT_ACTIVE(client))
@@ -726,6 +760,8 @@ finish:
         // clear all unreliable messages still left
         finish_frame(client);
     }
+
+    NET_EndSendBatch();
 }
 
 static void write_pending_download(client_t *client)
@@ -29,5 +29,7 @@ void SV_BroadcastPrintf( int level, const char *fmt, ... ) q_printf( 2, 3 );
 void SV_ClientCommand( client_t *cl, const char *fmt, ... ) q_printf( 2, 3 );
 void SV_BroadcastCommand( const char *fmt, ... ) q_printf( 1, 2 );
 void SV_ClientAddMessage( client_t *client, int flags );
+int SV_CompressMessage( byte **data );
+void SV_ClientAddEncodedMessage( client_t *client, const byte *data, const size_t len, const int32_t flags );
 void SV_ShutdownClientSend( client_t *client );
 void SV_InitClientSend( client_t *newcl );
\ No newline at end of file
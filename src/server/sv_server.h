@@ -81,6 +81,7 @@ extern cvar_t       *sv_calcpings_method;
 extern cvar_t       *sv_changemapcmd;
 extern cvar_t       *sv_max_download_size;
 extern cvar_t       *sv_max_packet_entities;
+extern cvar_t       *sv_maxrewind;
 
 extern cvar_t       *sv_allow_map;
 extern cvar_t       *sv_cinematics;
@@ -578,9 +579,32 @@ typedef struct {
     netadr_t    mask;
     unsigned    hits;
     time_t      time;   // time of the last hit
+    unsigned    sequence;   // insertion order, the oldest entry wins on overlap
     char        comment[1];
 } addrmatch_t;
 
+/**
+*   @brief  Path compressed binary trie node, covering every address that shares
+*           the first 'bits' bits of 'prefix'.
+**/
+typedef struct addrtrie_s {
+    struct addrtrie_s   *child[2];
+    netadrip_t  prefix;
+    int         bits;
+    addrmatch_t *match;     // entry for exactly this prefix, if any
+} addrtrie_t;
+
+/**
+*   @brief  Address/mask list (ban list, blackhole list), kept in insertion order
+*           for listing and indexed by a trie per address family for lookups.
+**/
+typedef struct {
+    list_t      entries;
+    addrtrie_t  *ipv4;
+    addrtrie_t  *ipv6;
+    unsigned    sequence;
+} addrlist_t;
+
 /**
 *   @brief  StuffCmd Commands.
 **/
@@ -716,8 +740,8 @@ typedef struct server_static_s {
 
 extern master_t     sv_masters[MAX_MASTERS];    // address of the master server
 
-extern list_t       sv_banlist;
-extern list_t       sv_blacklist;
+extern addrlist_t   sv_banlist;
+extern addrlist_t   sv_blacklist;
 extern list_t       sv_cmdlist_connect;
 extern list_t       sv_cmdlist_begin;
 extern list_t       sv_lrconlist;
@@ -160,6 +160,160 @@ static void write_gamestate(void) {
     SV_ClientAddMessage( sv_client, MSG_GAMESTATE );
 }
 
+//-----------------------------------------------------------------------------------------------
+/**
+*
+*
+*   Shared GameState Cache:
+*
+*   Every client connecting to the same map, and configstring generation, receives
+*   the very same configstring and baseline streams. These are encoded, and compressed,
+*   only once by the first client to need them, and handed out from here to all others.
+*
+*
+**/
+//! Baselines older than this(in milliseconds) are rebuilt, so that late joiners get
+//! baselines for the entities that were spawned in the meantime.
+static constexpr uint64_t GAMESTATE_CACHE_MAX_AGE = 10000;
+
+//! A single encoded gamestate message.
+typedef struct {
+    //! Offset and length of the plain message in the cache data.
+    size_t  offset;
+    size_t  length;
+    //! Offset and length of the svc_zpacket, a length of 0 if compression didn't pay off.
+    size_t  zoffset;
+    size_t  zlength;
+} gamestate_message_t;
+
+static struct {
+    //! Cleared whenever a configstring changes.
+    bool            valid;
+    //! Server spawn, entity state flags and time the cache was built for.
+    int64_t         spawncount;
+    msgEsFlags_t    esFlags;
+    uint64_t        buildTime;
+
+    //! The baselines shared by all clients receiving the cached streams.
+    entity_state_t  *baselines[ SV_BASELINES_CHUNKS ];
+
+    //! Encoded messages, plain and compressed.
+    gamestate_message_t *messages;
+    int32_t         numMessages;
+    int32_t         maxMessages;
+    byte            *data;
+    size_t          size;
+    size_t          allocated;
+    //! True once the messages have been encoded for the cached baselines.
+    bool            encoded;
+} sv_gamestate;
+
+/**
+*   @brief  Appends 'len' bytes to the cache data.
+*   @return Offset of the appended bytes.
+**/
+static size_t append_gamestate_data( const byte *data, const size_t len ) {
+    if ( sv_gamestate.size + len > sv_gamestate.allocated ) {
+        sv_gamestate.allocated = std::max( sv_gamestate.allocated * 2, sv_gamestate.size + len );
+        sv_gamestate.data = static_cast<byte *>( Z_Realloc( sv_gamestate.data, sv_gamestate.allocated ) );
+    }
+    memcpy( sv_gamestate.data + sv_gamestate.size, data, len );
+    sv_gamestate.size += len;
+    return sv_gamestate.size - len;
+}
+
+/**
+*   @brief  Moves the message in msg_write into the cache, along with its compressed form.
+**/
+static void add_gamestate_message( void ) {
+    if ( !msg_write.cursize ) {
+        return;
+    }
+
+    if ( sv_gamestate.numMessages == sv_gamestate.maxMessages ) {
+        sv_gamestate.maxMessages = std::max( sv_gamestate.maxMessages * 2, 16 );
+        sv_gamestate.messages = static_cast<gamestate_message_t *>( Z_Realloc( sv_gamestate.messages, sizeof( gamestate_message_t ) * sv_gamestate.maxMessages ) );
+    }
+
+    gamestate_message_t *message = &sv_gamestate.messages[ sv_gamestate.numMessages++ ];
+    message->length = msg_write.cursize;
+    message->offset = append_gamestate_data( msg_write.data, msg_write.cursize );
+    message->zoffset = message->zlength = 0;
+
+    // Compress it regardless of the current client, any zlib capable client connecting later benefits.
+    byte *zdata = nullptr;
+    const int zlength = SV_CompressMessage( &zdata );
+    if ( zlength > 0 && (size_t)zlength < msg_write.cursize ) {
+        message->zlength = zlength;
+        message->zoffset = append_gamestate_data( zdata, zlength );
+    }
+
+    SZ_Clear( &msg_write );
+}
+
+/**
+*   @brief  Marks the cache as stale, called whenever a configstring changes.
+**/
+void SV_InvalidateGameStateCache( void ) {
+    sv_gamestate.valid = false;
+}
+
+/**
+*   @brief  Releases all memory held by the cache.
+**/
+void SV_FreeGameStateCache( void ) {
+    for ( int32_t i = 0; i < SV_BASELINES_CHUNKS; i++ ) {
+        Z_Freep( (void **)&sv_gamestate.baselines[ i ] );
+    }
+    Z_Free( sv_gamestate.messages );
+    Z_Free( sv_gamestate.data );
+    memset( &sv_gamestate, 0, sizeof( sv_gamestate ) );
+}
+
+/**
+*   @brief  Copies the baseline chunks of 'src' over those of 'dst', allocating and
+*           clearing chunks as needed.
+**/
+static void copy_baselines( entity_state_t **dst, entity_state_t *const *src ) {
+    for ( int32_t i = 0; i < SV_BASELINES_CHUNKS; i++ ) {
+        if ( src[ i ] ) {
+            if ( !dst[ i ] ) {
+                dst[ i ] = static_cast<entity_state_t *>( SV_Malloc( sizeof( entity_state_t ) * SV_BASELINES_PER_CHUNK ) );
+            }
+            memcpy( dst[ i ], src[ i ], sizeof( entity_state_t ) * SV_BASELINES_PER_CHUNK );
+        } else if ( dst[ i ] ) {
+            memset( dst[ i ], 0, sizeof( entity_state_t ) * SV_BASELINES_PER_CHUNK );
+        }
+    }
+}
+
+/**
+*   @brief  Gives sv_client its baselines, from the cache if it is still up to date,
+*           or by creating them anew and starting over with a fresh cache otherwise.
+**/
+static void SV_SetupClientBaselines( void ) {
+    if ( sv_gamestate.valid
+        && sv_gamestate.spawncount == sv.spawncount
+        && sv_gamestate.esFlags == sv_client->esFlags
+        && svs.realtime - sv_gamestate.buildTime < GAMESTATE_CACHE_MAX_AGE ) {
+        copy_baselines( sv_client->baselines, sv_gamestate.baselines );
+        return;
+    }
+
+    // Create baselines for this client, and share them with whoever follows.
+    SV_CreateBaselines();
+    copy_baselines( sv_gamestate.baselines, sv_client->baselines );
+
+    sv_gamestate.valid = true;
+    sv_gamestate.spawncount = sv.spawncount;
+    sv_gamestate.esFlags = sv_client->esFlags;
+    sv_gamestate.buildTime = svs.realtime;
+    // The messages are encoded by the first client to get to SV_SendGameState.
+    sv_gamestate.numMessages = 0;
+    sv_gamestate.size = 0;
+    sv_gamestate.encoded = false;
+}
+
 //-----------------------------------------------------------------------------------------------
 /**
 *
@@ -179,7 +333,7 @@ static void write_configstring_stream( void ) {
 
 	// Write a packet full of data.
 	for ( int32_t i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
-        const char *string = sv_client->configstrings[ i ];
+        const char *string = sv.configstrings[ i ];
 		if ( !string[ 0 ] ) {
 			continue;
 		}
@@ -190,7 +344,7 @@ static void write_configstring_stream( void ) {
 			// Terminate the configstring stream packet.
 			MSG_WriteInt16( MAX_CONFIGSTRINGS );
 			// Add the message to be send to the client.
-			SV_ClientAddMessage( sv_client, MSG_GAMESTATE );
+			add_gamestate_message();
 			// Start a new configstring stream message.
 			MSG_WriteUint8( svc_configstringstream );
 		}
@@ -204,7 +358,7 @@ static void write_configstring_stream( void ) {
 	// -- End of configstrings.
 	MSG_WriteInt16( MAX_CONFIGSTRINGS );
 	// Add the message to be send to the client.
-	SV_ClientAddMessage( sv_client, MSG_GAMESTATE );
+	add_gamestate_message();
 }
 
 static void write_baseline_stream( void ) {
@@ -227,7 +381,7 @@ static void write_baseline_stream( void ) {
 			// check if this baseline will overflow
 			if ( msg_write.cursize + MAX_PACKETENTITY_BYTES > msg_write.maxsize ) {
 				MSG_WriteInt16( 0 );
-				SV_ClientAddMessage( sv_client, MSG_GAMESTATE );
+				add_gamestate_message();
 				MSG_WriteUint8( svc_baselinestream );
 			}
 			write_baseline( base );
@@ -235,7 +389,30 @@ static void write_baseline_stream( void ) {
 	}
 
 	MSG_WriteInt16( 0 );
-	SV_ClientAddMessage( sv_client, MSG_GAMESTATE );
+	add_gamestate_message();
+}
+
+/**
+*   @brief  Sends the configstring and baseline streams to sv_client, encoding them
+*           into the cache first if that hasn't happened yet for its baselines.
+**/
+static void SV_SendGameState( void ) {
+    // The baselines of sv_client are those of the cache, see SV_SetupClientBaselines.
+    if ( !sv_gamestate.encoded ) {
+        SZ_Clear( &msg_write );
+        write_configstring_stream();
+        write_baseline_stream();
+        sv_gamestate.encoded = true;
+    }
+
+    for ( int32_t i = 0; i < sv_gamestate.numMessages; i++ ) {
+        const gamestate_message_t *message = &sv_gamestate.messages[ i ];
+        if ( sv_client->has_zlib && message->zlength ) {
+            SV_ClientAddEncodedMessage( sv_client, sv_gamestate.data + message->zoffset, message->zlength, MSG_GAMESTATE );
+        } else {
+            SV_ClientAddEncodedMessage( sv_client, sv_gamestate.data + message->offset, message->length, MSG_GAMESTATE );
+        }
+    }
 }
 //--------------------------------------------------------------------------------
 static void stuff_cmds(list_t *list)
@@ -340,8 +517,8 @@ void SV_New_f(void)
     // to make sure the protocol is right, and to set the gamedir
     //
 
-    // create baselines for this client
-    SV_CreateBaselines();
+    // create baselines for this client, or share those of the gamestate cache
+    SV_SetupClientBaselines();
 
     // send the serverdata
     MSG_WriteUint8(svc_serverdata);
@@ -391,8 +568,7 @@ void SV_New_f(void)
 
     // send gamestate
     //if (sv_client->netchan.type == NETCHAN_NEW) {
-	write_configstring_stream( );
-	write_baseline_stream( );
+	SV_SendGameState( );
     //    write_gamestate();
     //} else {
     //    write_configstrings();
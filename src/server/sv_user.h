@@ -12,4 +12,6 @@ void SV_New_f( void );
 void SV_Begin_f( void );
 void SV_ExecuteClientMessage( client_t *cl );
 void SV_CloseDownload( client_t *client );
-cvarban_t *SV_CheckInfoBans( const char *info, bool match_only );
\ No newline at end of file
+cvarban_t *SV_CheckInfoBans( const char *info, bool match_only );
+void SV_InvalidateGameStateCache( void );
+void SV_FreeGameStateCache( void );
\ No newline at end of file
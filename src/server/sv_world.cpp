@@ -48,6 +48,28 @@ static sv_edict_t      **sector_list;
 static int          sector_count, sector_maxcount;
 static int          sector_type;
 
+//! Number of linked positions kept for each lag compensated entity.
+#define SV_LAG_HISTORY  32
+#define SV_LAG_MASK     ( SV_LAG_HISTORY - 1 )
+
+/**
+*   @brief  Position and bounds of an entity as it was linked at the end of a server frame.
+**/
+typedef struct {
+    int64_t framenum;
+    Vector3 origin;
+    Vector3 mins, maxs;
+    Vector3 absMin, absMax;
+} sv_lag_record_t;
+
+typedef struct {
+    sv_lag_record_t records[ SV_LAG_HISTORY ];
+    int64_t         head;   //! Total number of records written.
+} sv_lag_history_t;
+
+//! Allocated on demand for players and monsters only.
+static sv_lag_history_t *sv_lagHistory[ MAX_EDICTS ];
+
 
 
 /**
@@ -110,6 +132,9 @@ void SV_ClearWorld(void)
         SV_CreateSectorNode(0, cm->mins, cm->maxs);
     }
 
+    // Positions from the previous map are meaningless.
+    SV_ClearLagHistory();
+
     // Make sure all entities are unlinked.
     for (i = 0; i < ge->edictPool->max_edicts; i++) {
         // Get edict pointer.s
@@ -139,6 +164,81 @@ static inline const bounds_packed_t _MSG_PackBoundsUint32( const Vector3 &mins,
     return MSG_PackBoundsUint32( &mins.x, &maxs.x );
 }
 
+/**
+*	@return	True if 'ent' is a player or monster with box bounds, the kind of
+*			entity hitscan traces are rewound for.
+**/
+static inline const bool SV_IsLagCompensated( const sv_edict_t *ent ) {
+    return ( ent->svFlags & ( SVF_PLAYER | SVF_MONSTER ) )
+        && ( ent->solid == SOLID_BOUNDS_BOX || ent->solid == SOLID_BOUNDS_OCTAGON );
+}
+
+/**
+*	@brief	Stores the position the entity was just linked at for the current server frame.
+*			Relinking within the same frame overwrites the record, so the last link wins.
+**/
+static void SV_RecordLagPosition( sv_edict_t *ent ) {
+    const int32_t entnum = ent->s.number;
+    if ( entnum <= 0 || entnum >= MAX_EDICTS ) {
+        return;
+    }
+
+    sv_lag_history_t *history = sv_lagHistory[ entnum ];
+    if ( !history ) {
+        if ( !SV_IsLagCompensated( ent ) ) {
+            return;
+        }
+        history = sv_lagHistory[ entnum ] = static_cast<sv_lag_history_t *>( SV_Mallocz( sizeof( *history ) ) );
+    } else if ( !ent->linkCount ) {
+        // Freshly spawned into a recycled slot.
+        history->head = 0;
+    }
+
+    sv_lag_record_t *record = &history->records[ ( history->head - 1 ) & SV_LAG_MASK ];
+    if ( !history->head || record->framenum != sv.framenum ) {
+        record = &history->records[ history->head++ & SV_LAG_MASK ];
+    }
+    record->framenum = sv.framenum;
+    record->origin = ent->s.origin;
+    record->mins = ent->mins;
+    record->maxs = ent->maxs;
+    record->absMin = ent->absMin;
+    record->absMax = ent->absMax;
+}
+
+/**
+*	@return	The record of where the entity was at the end of 'framenum', or the oldest one
+*			that is kept if it moved every frame since. nullptr if it has no history.
+**/
+static const sv_lag_record_t *SV_LagPositionForFrame( const int32_t entnum, const int64_t framenum ) {
+    const sv_lag_history_t *history = sv_lagHistory[ entnum ];
+    if ( !history || !history->head ) {
+        return nullptr;
+    }
+
+    const int64_t oldest = std::max<int64_t>( history->head - SV_LAG_HISTORY, 0 );
+    const sv_lag_record_t *record = nullptr;
+    for ( int64_t i = history->head - 1; i >= oldest; i-- ) {
+        record = &history->records[ i & SV_LAG_MASK ];
+        if ( record->framenum <= framenum ) {
+            break;
+        }
+    }
+    return record;
+}
+
+/**
+*   @brief  Frees the position history of all entities.
+**/
+void SV_ClearLagHistory( void ) {
+    for ( int32_t i = 0; i < MAX_EDICTS; i++ ) {
+        if ( sv_lagHistory[ i ] ) {
+            Z_Free( sv_lagHistory[ i ] );
+            sv_lagHistory[ i ] = nullptr;
+        }
+    }
+}
+
 /**
 *   @brief  Needs to be called any time an entity changes origin, mins, maxs,
 *           or solid.  Automatically unlinks if needed.
@@ -242,6 +342,9 @@ void SV_LinkEdict(cm_t *cm, sv_edict_t *ent)
             }
         }
     }
+
+    // Keep track of where it was for lag compensated traces.
+    SV_RecordLagPosition( ent );
 }
 
 /**
@@ -541,13 +644,114 @@ const cm_contents_t SV_PointContents( const Vector3 *p ) {
 	return contents;
 }
 
+/**
+*	@return	True if 'touch' is not to be clipped against by a move of 'passedict' with 'contentmask'.
+**/
+static const bool SV_SkipClipEntity( const sv_edict_t *touch, const sv_edict_t *passedict, const cm_contents_t contentmask ) {
+    if ( touch == nullptr ) {
+        return true;
+    }
+    if ( touch->solid == SOLID_NOT ) {
+        return true;
+    }
+    if ( touch == passedict ) {
+        return true;
+    }
+    if ( passedict ) {
+        if ( touch->owner == passedict )
+            return true;    // Don't clip against own missiles.
+        if ( passedict->owner == touch )
+            return true;    // Don't clip against owner.
+    }
+
+  //      if ( !(contentmask & touch->hullContents ) ) {
+  //          continue;
+		//}
+
+    if ( !( contentmask & CONTENTS_DEADMONSTER )
+        && ( touch->svFlags & SVF_DEADENTITY ) ) {
+        return true;
+    }
+
+    if ( !( contentmask & CONTENTS_PROJECTILE )
+        && ( touch->svFlags & SVF_PROJECTILE ) ) {
+        return true;
+    }
+    if ( !( contentmask & CONTENTS_PLAYER ) 
+        && ( touch->svFlags & SVF_PLAYER ) ) {
+        return true;
+    }
+    return false;
+}
+
+/**
+*	@brief	Clips the move against the hull of 'touch' placed at 'origin', keeping the
+*			result in 'dst' if it is closer than what was hit so far.
+**/
+static void SV_ClipMoveToEntity( sv_edict_t *touch, mnode_t *headnode, const Vector3 &origin,
+                                 const Vector3 &start, const Vector3 *mins,
+                                 const Vector3 *maxs, const Vector3 &end,
+                                 const cm_contents_t contentmask, cm_trace_t *dst )
+{
+    // Use a fresh trace per-entity to avoid stale results influencing others
+    cm_trace_t etrace = {
+        .entityNumber = ENTITYNUM_NONE,
+        .fraction = 1.0,
+        .endpos = end,
+        .plane = {
+            .normal = { 0.0f, 0.0f, 0.0f },
+            .dist = 0.0f,
+            .type = PLANE_NON_AXIAL,
+            .signbits = 0,
+        },
+
+        .surface = &nulltexinfo.c,
+        .material = &cm_default_material,
+
+        .plane2 = {
+            .normal = { 0.0f, 0.0f, 0.0f },
+            .dist = 0.0f,
+            .type = PLANE_NON_AXIAL,
+            .signbits = 0,
+        },
+    };
+
+    // might intersect, so do an exact clip
+    CM_TransformedBoxTrace( &sv.cm, &etrace, start, end, mins, maxs,
+                           headnode, contentmask,
+                           &origin.x, &touch->s.angles.x);
+
+    //CM_ClipEntity( &sv.cm, dst, &trace, touch->s.number );
+
+    if ( etrace.allsolid ) {
+        dst->allsolid = true;
+        etrace.entityNumber = touch->s.number;
+    } else if ( etrace.startsolid ) {
+        dst->startsolid = true;
+        etrace.entityNumber = touch->s.number;
+    }
+
+    if ( etrace.fraction < dst->fraction ) {
+        // make sure we keep a startsolid from a previous trace
+        const int32_t oldStartSolid = dst->startsolid;
+        etrace.entityNumber = touch->s.number;
+        *dst = etrace;
+        // jmarshall
+        const int32_t startsolid = (int32_t)dst->startsolid | oldStartSolid;
+        dst->startsolid = (bool)startsolid;
+    }
+}
+
 /**
 *	@brief	SV_ClipMoveToEntities
+*	@param	rewindFrame	If >= 0, lag compensated entities are clipped against at the
+*						position they had at the end of that server frame instead.
 **/
 static void SV_ClipMoveToEntities(const Vector3 &start, const Vector3 *mins,
                                   const Vector3 *maxs, const Vector3 &end,
                                   const Vector3 &moveMins, const Vector3 &moveMaxs,
-                                  sv_edict_t *passedict, const cm_contents_t contentmask, cm_trace_t *dst )
+                                  sv_edict_t *passedict, const cm_contents_t contentmask, cm_trace_t *dst,
+                                  const int64_t rewindFrame = -1 )
 {
     int         i, num;
     sv_edict_t     *touchlist[MAX_EDICTS], *touch;
@@ -558,112 +762,73 @@ static void SV_ClipMoveToEntities(const Vector3 &start, const Vector3 *mins,
     // be careful, it is possible to have an entity in this
     // list removed before we get to it (killtriggered)
     for (i = 0; i < num; i++) {
-        // Use a fresh trace per-entity to avoid stale results influencing others
-        cm_trace_t etrace = {
-            .entityNumber = ENTITYNUM_NONE,
-            .fraction = 1.0,
-            .endpos = end,
-            .plane = {
-                .normal = { 0.0f, 0.0f, 0.0f },
-                .dist = 0.0f,
-                .type = PLANE_NON_AXIAL,
-                .signbits = 0,
-            },
-
-            .surface = &nulltexinfo.c,
-            .material = &cm_default_material,
-
-            .plane2 = {
-                .normal = { 0.0f, 0.0f, 0.0f },
-                .dist = 0.0f,
-                .type = PLANE_NON_AXIAL,
-                .signbits = 0,
-            },
-        };
         // early out if we already know everything is solid from previous world or entity hits
         if ( dst->allsolid ) {
             return;
         }
 
         touch = touchlist[ i ];
-        if ( touch == nullptr ) {
+        if ( SV_SkipClipEntity( touch, passedict, contentmask ) ) {
             continue;
         }
-        if ( touch->solid == SOLID_NOT ) {
+        // Clipped against where it used to be further on.
+        if ( rewindFrame >= 0 && sv_lagHistory[ touch->s.number ] && SV_IsLagCompensated( touch ) ) {
             continue;
         }
-        if ( touch == passedict ) {
-            continue;
-        }
-        //if ( dst->allsolid ) {
-        //    return;
-        //}
-        if ( passedict ) {
-            if ( touch->owner == passedict )
-                continue;    // Don't clip against own missiles.
-            if ( passedict->owner == touch )
-                continue;    // Don't clip against owner.
-        }
 
-  //      if ( !(contentmask & touch->hullContents ) ) {
-  //          continue;
-		//}
+        SV_ClipMoveToEntity( touch, SV_HullForEntity( touch ), touch->s.origin, start, mins, maxs, end, contentmask, dst );
+    }
 
-        if ( !( contentmask & CONTENTS_DEADMONSTER )
-            && ( touch->svFlags & SVF_DEADENTITY ) ) {
+    if ( rewindFrame < 0 ) {
+        return;
+    }
+
+    // Lag compensated entities aren't relinked, the move bounds are tested against
+    // their recorded boxes instead of the sector tree.
+    for ( i = 1; i < ge->edictPool->num_edicts && i < MAX_EDICTS; i++ ) {
+        if ( dst->allsolid ) {
+            return;
+        }
+        if ( !sv_lagHistory[ i ] ) {
             continue;
         }
 
-        if ( !( contentmask & CONTENTS_PROJECTILE )
-            && ( touch->svFlags & SVF_PROJECTILE ) ) {
+        touch = EDICT_FOR_NUMBER( i );
+        if ( !touch || !touch->inUse || !touch->area.prev || !SV_IsLagCompensated( touch ) ) {
             continue;
         }
-        if ( !( contentmask & CONTENTS_PLAYER ) 
-            && ( touch->svFlags & SVF_PLAYER ) ) {
+        if ( SV_SkipClipEntity( touch, passedict, contentmask ) ) {
             continue;
         }
 
-        // might intersect, so do an exact clip
-        CM_TransformedBoxTrace( &sv.cm, &etrace, start, end, mins, maxs,
-                               SV_HullForEntity(touch), contentmask,
-                               &touch->s.origin.x, &touch->s.angles.x);
-
-        //CM_ClipEntity( &sv.cm, dst, &trace, touch->s.number );
-
-        if ( etrace.allsolid ) {
-            dst->allsolid = true;
-            etrace.entityNumber = touch->s.number;
-        } else if ( etrace.startsolid ) {
-            dst->startsolid = true;
-            etrace.entityNumber = touch->s.number;
+        const sv_lag_record_t *record = SV_LagPositionForFrame( i, rewindFrame );
+        if ( !record ) {
+            continue;
         }
-
-        if ( etrace.fraction < dst->fraction ) {
-            // make sure we keep a startsolid from a previous trace
-            const int32_t oldStartSolid = dst->startsolid;
-            etrace.entityNumber = touch->s.number;
-            *dst = etrace;
-            // jmarshall
-            const int32_t startsolid = (int32_t)dst->startsolid | oldStartSolid;
-            dst->startsolid = (bool)startsolid;
+        if ( record->absMin[0] > moveMaxs[0]
+            || record->absMin[1] > moveMaxs[1]
+            || record->absMin[2] > moveMaxs[2]
+            || record->absMax[0] < moveMins[0]
+            || record->absMax[1] < moveMins[1]
+            || record->absMax[2] < moveMins[2] ) {
+            continue;        // not touching
         }
+
+        mnode_t *headnode = ( touch->solid == SOLID_BOUNDS_OCTAGON )
+            ? CM_HeadnodeForOctagon( &sv.cm, &record->mins.x, &record->maxs.x, touch->hullContents )
+            : CM_HeadnodeForBox( &sv.cm, &record->mins.x, &record->maxs.x, touch->hullContents );
+        SV_ClipMoveToEntity( touch, headnode, record->origin, start, mins, maxs, end, contentmask, dst );
     }
 }
 
 /**
-*	@description	mins and maxs are relative
-*
-*					if the entire move stays in a solid volume, trace.allsolid will be set,
-*					trace.startsolid will be set, and trace.fraction will be 0
-*
-*					if the starting point is in a solid, it will be allowed to move out
-*					to an open area
-*
-*					passedict is explicitly excluded from clipping checks (normally NULL)
+*	@brief	Traces through the world and its entities, with lag compensated entities
+*			at their position of 'rewindFrame' if that is >= 0.
 **/
-const cm_trace_t q_gameabi SV_Trace( const Vector3 &start, const Vector3 *mins,
+static const cm_trace_t SV_TraceAtFrame( const Vector3 &start, const Vector3 *mins,
                            const Vector3 *maxs, const Vector3 &end,
-                           edict_ptr_t *passEdict, const cm_contents_t contentmask)
+                           edict_ptr_t *passEdict, const cm_contents_t contentmask,
+                           const int64_t rewindFrame )
 {
 	// Initialize to no collision for the initial trace.
     cm_trace_t trace = {
@@ -730,12 +895,57 @@ const cm_trace_t q_gameabi SV_Trace( const Vector3 &start, const Vector3 *mins,
         moveMins, moveMaxs,
         passEdict,
         contentmask, 
-        &trace
+        &trace,
+        rewindFrame
     );
 
     return trace;
 }
 
+/**
+*	@description	mins and maxs are relative
+*
+*					if the entire move stays in a solid volume, trace.allsolid will be set,
+*					trace.startsolid will be set, and trace.fraction will be 0
+*
+*					if the starting point is in a solid, it will be allowed to move out
+*					to an open area
+*
+*					passedict is explicitly excluded from clipping checks (normally NULL)
+**/
+const cm_trace_t q_gameabi SV_Trace( const Vector3 &start, const Vector3 *mins,
+                           const Vector3 *maxs, const Vector3 &end,
+                           edict_ptr_t *passEdict, const cm_contents_t contentmask)
+{
+    return SV_TraceAtFrame( start, mins, maxs, end, passEdict, contentmask, -1 );
+}
+
+/**
+*	@brief	Like SV_Trace(), but when passedict is a client, players and monsters are
+*			clipped against where they were in the last frame that client acknowledged,
+*			going back no more than sv_maxrewind milliseconds.
+**/
+const cm_trace_t q_gameabi SV_LagTrace( const Vector3 &start, const Vector3 *mins,
+                           const Vector3 *maxs, const Vector3 &end,
+                           edict_ptr_t *passEdict, const cm_contents_t contentmask )
+{
+    int64_t rewindFrame = -1;
+
+    const int32_t entnum = passEdict ? NUMBER_OF_EDICT( passEdict ) : 0;
+    if ( sv_maxrewind->integer > 0 && entnum >= 1 && entnum <= sv_maxclients->integer ) {
+        const client_t *client = &svs.client_pool[ entnum - 1 ];
+        if ( client->state == cs_spawned && client->lastframe > 0 ) {
+            const int64_t maxFrames = (int64_t)( sv_maxrewind->integer / SV_FRAMETIME );
+            const int64_t frames = std::min( client->framenum - client->lastframe, maxFrames );
+            if ( frames > 0 ) {
+                rewindFrame = sv.framenum - frames;
+            }
+        }
+    }
+
+    return SV_TraceAtFrame( start, mins, maxs, end, passEdict, contentmask, rewindFrame );
+}
+
 /**
 *	@brief	Like SV_Trace(), but clip to specified entity only.
 *			Can be used to clip to SOLID_TRIGGER by its BSP tree.
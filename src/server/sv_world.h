@@ -39,6 +39,11 @@ void PF_UnlinkEdict( edict_ptr_t *ent );
 void SV_LinkEdict( cm_t *cm, sv_edict_t *ent );
 void PF_LinkEdict( edict_ptr_t *ent );
 
+/**
+*   @brief  Frees the linked position history kept for lag compensated traces.
+**/
+void SV_ClearLagHistory( void );
+
 
 
 /**
@@ -81,6 +86,15 @@ const cm_trace_t q_gameabi SV_Trace( const Vector3 &start, const Vector3 *mins,
     const Vector3 *maxs, const Vector3 &end,
     edict_ptr_t *passedict, const cm_contents_t contentmask );
 
+/**
+*	@brief	Like SV_Trace(), but when passedict is a client, players and monsters are
+*			clipped against where they were in the last frame that client acknowledged,
+*			going back no more than sv_maxrewind milliseconds.
+**/
+const cm_trace_t q_gameabi SV_LagTrace( const Vector3 &start, const Vector3 *mins,
+    const Vector3 *maxs, const Vector3 &end,
+    edict_ptr_t *passedict, const cm_contents_t contentmask );
+
 /**
 *	@brief	Like SV_Trace(), but clip to specified entity only.
 *			Can be used to clip to SOLID_TRIGGER by its BSP tree.
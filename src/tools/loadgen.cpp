@@ -0,0 +1,880 @@
+/********************************************************************
+*
+*
+*	Headless dedicated server load generator.
+*
+*	Connects N simulated clients over UDP to a running server, walks
+*	each of them through the same challenge/connect/new/begin sequence
+*	the real client uses and then streams batched user commands at a
+*	fixed packet rate, the way CL_SendBatchedCmd does. It links the
+*	engine's messaging and net channel code, so the wire format always
+*	matches the server being tested.
+*
+*	Server messages are only parsed as far as needed: the leading
+*	reliable commands (for svc_serverdata, reconnects and disconnects)
+*	and the svc_frame header of each unreliable packet. Frame arrival
+*	times stand in for the server frame time, since that is what a
+*	client can observe of it.
+*
+*	Usage: q2rtxp-loadgen [options] [host[:port]]
+*
+*		-n <clients>	Number of simulated clients. (8)
+*		-t <seconds>	Test duration, 0 runs until interrupted. (30)
+*		-f <pps>		Packets (and user commands) sent per second. (40)
+*		-m <pattern>	idle, random, or the path of a command script. (random)
+*		-r <rate>		Userinfo "rate" of each client. (100000)
+*		-i <seconds>	Interval between progress reports. (5)
+*		-w <password>	Server password.
+*		-s <seed>		Seed for the random pattern. (1234)
+*
+*	Command scripts hold one move per line, repeated for 'packets' packets
+*	and cycled, each client starting at a different line:
+*		<packets> <forward> <side> <up> <pitch> <yaw> [buttons]
+*
+*	The server needs enough free client slots and, when all clients come
+*	from one address, "sv_iplimit 0".
+*
+*
+********************************************************************/
+#include "shared/shared.h"
+#include "common/common.h"
+#include "common/cvar.h"
+#include "common/huffman.h"
+#include "common/messaging.h"
+#include "common/net/chan.h"
+#include "common/net/net.h"
+#include "common/protocol.h"
+#include "common/sizebuf.h"
+#include "common/zone.h"
+#include "system/system.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+//! Interval between challenge/connect retransmits, in milliseconds.
+static constexpr uint64_t LOADGEN_RESEND_TIME = 1000;
+//! A client that received nothing for this long is dropped and reconnected.
+static constexpr uint64_t LOADGEN_TIMEOUT = 5000;
+//! Delay between the first connect of consecutive clients, avoids a challenge flood.
+static constexpr uint64_t LOADGEN_CONNECT_STAGGER = 50;
+//! Version string sent in the userinfo and as the answer to the version probe.
+static constexpr const char *LOADGEN_VERSION = "Q2RTXPerimental loadgen";
+
+
+
+/**
+*
+*
+*	Engine Glue:
+*
+*	The common messaging and net channel code expects these from the
+*	engine, the load generator provides minimal versions of them.
+*
+*
+**/
+uint64_t com_localTime;
+
+//! Set around packet processing so that Com_Error(ERR_DROP) only drops the client at hand.
+static jmp_buf loadgen_abortframe;
+static bool loadgen_abortframe_set;
+
+void Com_LPrintf( print_type_t type, const char *fmt, ... ) {
+	if ( type == PRINT_DEVELOPER ) {
+		return;
+	}
+	va_list argptr;
+	va_start( argptr, fmt );
+	vfprintf( type == PRINT_ERROR || type == PRINT_WARNING ? stderr : stdout, fmt, argptr );
+	va_end( argptr );
+}
+
+void Com_Error( error_type_t code, const char *fmt, ... ) {
+	char msg[ MAXERRORMSG ];
+	va_list argptr;
+	va_start( argptr, fmt );
+	Q_vsnprintf( msg, sizeof( msg ), fmt, argptr );
+	va_end( argptr );
+
+	if ( code != ERR_FATAL && loadgen_abortframe_set ) {
+		fprintf( stderr, "ERROR: %s\n", msg );
+		longjmp( loadgen_abortframe, -1 );
+	}
+
+	fprintf( stderr, "FATAL: %s\n", msg );
+	exit( EXIT_FAILURE );
+}
+
+/**
+*	@brief	Cvars are never changed, every lookup gets its own default valued instance.
+**/
+cvar_t *Cvar_Get( const char *var_name, const char *value, int flags ) {
+	cvar_t *var = static_cast<cvar_t *>( calloc( 1, sizeof( *var ) ) );
+	var->name = strdup( var_name );
+	var->string = strdup( value );
+	var->default_string = var->string;
+	var->flags = flags;
+	var->value = atof( value );
+	var->integer = atoi( value );
+	return var;
+}
+
+int Cvar_ClampInteger( cvar_t *var, int min, int max ) {
+	var->integer = std::clamp( var->integer, min, max );
+	return var->integer;
+}
+
+void *Z_TagMalloc( size_t size, memtag_t tag ) {
+	void *ptr = malloc( size );
+	if ( !ptr ) {
+		Com_Error( ERR_FATAL, "%s: couldn't allocate %zu bytes", __func__, size );
+	}
+	return ptr;
+}
+
+void Z_Free( void *ptr ) {
+	free( ptr );
+}
+
+const uint64_t Sys_Milliseconds( void ) {
+	static const auto start = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ).count();
+}
+
+char *NET_AdrToString( const netadr_t *a ) {
+	static char s[ MAX_QPATH ];
+	char ip[ INET_ADDRSTRLEN ];
+	if ( !inet_ntop( AF_INET, &a->ip, ip, sizeof( ip ) ) ) {
+		strcpy( ip, "<invalid>" );
+	}
+	Q_snprintf( s, sizeof( s ), "%s:%u", ip, BigShort( a->port ) );
+	return s;
+}
+
+
+
+/**
+*
+*
+*	Simulated Clients:
+*
+*
+**/
+typedef enum {
+	//! Waiting for the initial connect, staggered per client.
+	LG_IDLE,
+	//! Sent 'getchallenge'.
+	LG_CHALLENGING,
+	//! Sent 'connect'.
+	LG_CONNECTING,
+	//! Got 'client_connect' and sent 'new', waiting for svc_serverdata.
+	LG_CONNECTED,
+	//! Sent 'begin', streaming user commands.
+	LG_SPAWNED
+} loadgen_state_t;
+
+typedef struct {
+	uint64_t bytesIn, bytesOut;
+	uint64_t packetsIn, packetsOut;
+	uint64_t frames;
+	uint64_t suppressed;
+	//! Sum and maximum of the time between consecutive svc_frame packets.
+	uint64_t frameIntervalSum, frameIntervalMax, frameIntervals;
+	//! Frame numbers the server advanced while we received 'frames' of them.
+	int64_t framesSkipped;
+	uint64_t reconnects;
+} loadgen_stats_t;
+
+typedef struct {
+	int32_t number;
+	int fd;
+	loadgen_state_t state;
+
+	netchan_t netchan;
+	int32_t qport;
+	int32_t challenge;
+	int32_t spawnCount;
+
+	//! Time of the last connectionless request, or of the first one for LG_IDLE.
+	uint64_t connectTime;
+	//! Time the last connection attempt started, for timing out handshakes.
+	uint64_t attemptTime;
+	uint64_t nextPacketTime;
+
+	//! Command ring, indexed by command number & CMD_MASK.
+	usercmd_t cmds[ CMD_BACKUP ];
+	int64_t commandNumber;
+	//! Last command number included in each outgoing packet, by sequence & CMD_MASK.
+	int64_t packetCommandNumber[ CMD_BACKUP ];
+
+	//! Last svc_frame seen, -1 until the first.
+	int64_t frameNumber;
+	uint64_t frameTime;
+
+	//! Random pattern state.
+	std::mt19937 rng;
+	uint64_t nextMoveChange;
+	usercmd_t move;
+	//! Script pattern state.
+	size_t scriptLine;
+	int32_t scriptRepeat;
+
+	loadgen_stats_t stats;
+	//! Stats at the last progress report.
+	loadgen_stats_t reported;
+	//! Net channel counters carried over reconnects.
+	uint64_t totalDropped, totalReceived;
+} loadgen_client_t;
+
+typedef struct {
+	int32_t packets;
+	float forward, side, up;
+	float pitch, yaw;
+	uint16_t buttons;
+} loadgen_scriptmove_t;
+
+static struct {
+	int32_t numClients = 8;
+	double duration = 30;
+	int32_t packetRate = 40;
+	const char *pattern = "random";
+	int32_t rate = 100000;
+	double reportInterval = 5;
+	const char *password = "";
+	uint32_t seed = 1234;
+} loadgen_options;
+
+static netadr_t loadgen_server;
+static std::vector<loadgen_client_t *> loadgen_clients;
+static std::vector<loadgen_scriptmove_t> loadgen_script;
+//! The client whose socket NET_SendPacket uses.
+static loadgen_client_t *loadgen_current;
+static volatile sig_atomic_t loadgen_quit;
+
+bool NET_SendPacket( netsrc_t sock, const void *data, size_t len, const netadr_t *to ) {
+	if ( !loadgen_current ) {
+		return false;
+	}
+
+	struct sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = to->port;
+	memcpy( &addr.sin_addr, &to->ip, 4 );
+	if ( sendto( loadgen_current->fd, data, len, 0, (struct sockaddr *)&addr, sizeof( addr ) ) < 0 ) {
+		if ( errno != EWOULDBLOCK && errno != ECONNREFUSED ) {
+			fprintf( stderr, "client %d: sendto: %s\n", loadgen_current->number, strerror( errno ) );
+		}
+		return false;
+	}
+
+	loadgen_current->stats.bytesOut += len;
+	loadgen_current->stats.packetsOut++;
+	return true;
+}
+
+/**
+*	@brief	Closes the net channel and starts over with a new challenge.
+**/
+static void LoadGen_Reconnect( loadgen_client_t *cl, const char *reason ) {
+	printf( "client %d: %s, reconnecting\n", cl->number, reason );
+	if ( cl->netchan.message_buf ) {
+		cl->totalDropped += cl->netchan.total_dropped;
+		cl->totalReceived += cl->netchan.total_received;
+		Netchan_Close( &cl->netchan );
+	}
+	cl->state = LG_CHALLENGING;
+	cl->connectTime = 0;
+	cl->attemptTime = com_localTime;
+	cl->frameNumber = -1;
+	cl->stats.reconnects++;
+}
+
+/**
+*	@brief	Appends a string command to the reliable message.
+**/
+static void LoadGen_ClientCommand( loadgen_client_t *cl, const char *string ) {
+	MSG_WriteUint8( clc_stringcmd );
+	MSG_WriteString( string );
+	MSG_FlushTo( &cl->netchan.message );
+}
+
+/**
+*	@brief	Sends 'getchallenge' or 'connect', retransmitting until the server answers.
+**/
+static void LoadGen_CheckForResend( loadgen_client_t *cl ) {
+	if ( cl->state == LG_IDLE ) {
+		if ( com_localTime < cl->connectTime ) {
+			return;
+		}
+		cl->state = LG_CHALLENGING;
+		cl->connectTime = 0;
+		cl->attemptTime = com_localTime;
+	}
+
+	if ( cl->state != LG_CHALLENGING && cl->state != LG_CONNECTING ) {
+		return;
+	}
+	if ( cl->connectTime && com_localTime - cl->connectTime < LOADGEN_RESEND_TIME ) {
+		return;
+	}
+	cl->connectTime = com_localTime;
+
+	if ( cl->state == LG_CHALLENGING ) {
+		OOB_PRINT( NS_CLIENT, &loadgen_server, "getchallenge\n" );
+		return;
+	}
+
+	char userinfo[ MAX_INFO_STRING ];
+	Q_snprintf( userinfo, sizeof( userinfo ), "\\name\\loadgen%03d\\rate\\%d\\version\\%s%s%s",
+		cl->number, loadgen_options.rate, LOADGEN_VERSION,
+		loadgen_options.password[ 0 ] ? "\\password\\" : "", loadgen_options.password );
+
+	char data[ MAX_PACKETLEN ];
+	Q_snprintf( data, sizeof( data ), "connect %i %i %i \"%s\"\n", PROTOCOL_VERSION_Q2RTXPERIMENTAL,
+		cl->qport, cl->challenge, userinfo );
+	Netchan_OutOfBandData( NS_CLIENT, &loadgen_server, (byte *)data, strlen( data ) );
+}
+
+/**
+*	@brief	Handles the 'challenge', 'client_connect' and 'print' replies.
+**/
+static void LoadGen_ConnectionlessPacket( loadgen_client_t *cl, const byte *data, const size_t len ) {
+	std::string text( (const char *)data + 4, len - 4 );
+
+	if ( !text.compare( 0, 10, "challenge " ) ) {
+		if ( cl->state != LG_CHALLENGING ) {
+			return;
+		}
+		cl->challenge = atoi( text.c_str() + 10 );
+		cl->state = LG_CONNECTING;
+		cl->connectTime = 0;
+		LoadGen_CheckForResend( cl );
+	} else if ( !text.compare( 0, 14, "client_connect" ) ) {
+		if ( cl->state != LG_CONNECTING ) {
+			return;
+		}
+		Netchan_Setup( &cl->netchan, NS_CLIENT, &loadgen_server, cl->qport, 1024, PROTOCOL_VERSION_Q2RTXPERIMENTAL );
+		LoadGen_ClientCommand( cl, "new" );
+		cl->state = LG_CONNECTED;
+		cl->nextPacketTime = com_localTime;
+		// Sequences start over, so do the commands each packet covers.
+		std::fill_n( cl->packetCommandNumber, CMD_BACKUP, cl->commandNumber );
+	} else if ( !text.compare( 0, 6, "print\n" ) ) {
+		// Rejections, the next resend tries again.
+		printf( "client %d: %s", cl->number, text.c_str() + 6 );
+	}
+}
+
+/**
+*	@brief	Parses the reliable commands at the start of the message up to the
+*			first one whose layout isn't known here, that is as far as needed to
+*			get the spawn count or to notice a map change or disconnect.
+**/
+static void LoadGen_ParseReliable( loadgen_client_t *cl ) {
+	char string[ MAX_STRING_CHARS ];
+
+	while ( msg_read.readcount < msg_read.cursize ) {
+		const int32_t cmd = MSG_ReadUint8();
+		switch ( cmd ) {
+		case svc_nop:
+			break;
+		case svc_print:
+			MSG_ReadUint8();
+			MSG_ReadString( string, sizeof( string ) );
+			break;
+		case svc_centerprint:
+			MSG_ReadString( string, sizeof( string ) );
+			break;
+		case svc_stufftext:
+			MSG_ReadString( string, sizeof( string ) );
+			if ( !strncmp( string, "reconnect", 9 ) && cl->state == LG_SPAWNED ) {
+				// Map change, ask for the new gamestate on the same channel.
+				LoadGen_ClientCommand( cl, "new" );
+				cl->state = LG_CONNECTED;
+				cl->frameNumber = -1;
+			}
+			break;
+		case svc_disconnect:
+			LoadGen_Reconnect( cl, "server disconnected" );
+			return;
+		case svc_serverdata: {
+			MSG_ReadInt32(); // protocol
+			cl->spawnCount = MSG_ReadInt32();
+			if ( cl->state != LG_CONNECTED ) {
+				return;
+			}
+			// Answer the version probe up front, SV_Begin_f drops clients without one.
+			LoadGen_ClientCommand( cl, va( "\177c version %s", LOADGEN_VERSION ) );
+			LoadGen_ClientCommand( cl, va( "begin %i", cl->spawnCount ) );
+			cl->state = LG_SPAWNED;
+			cl->frameNumber = -1;
+			cl->frameTime = 0;
+			printf( "client %d: spawned, spawncount %d\n", cl->number, cl->spawnCount );
+			return;
+		}
+		default:
+			return;
+		}
+	}
+}
+
+/**
+*	@brief	Reads the svc_frame header that starts every unreliable only packet.
+**/
+static void LoadGen_ParseFrameHeader( loadgen_client_t *cl ) {
+	if ( cl->state != LG_SPAWNED || MSG_ReadUint8() != svc_frame ) {
+		return;
+	}
+
+	const int64_t frameNumber = MSG_ReadIntBase128();
+	MSG_ReadIntBase128(); // delta frame
+	const int32_t suppressCount = MSG_ReadUint8();
+	if ( frameNumber <= cl->frameNumber ) {
+		return;
+	}
+
+	loadgen_stats_t *stats = &cl->stats;
+	if ( cl->frameNumber >= 0 ) {
+		const uint64_t interval = com_localTime - cl->frameTime;
+		stats->frameIntervalSum += interval;
+		stats->frameIntervalMax = std::max( stats->frameIntervalMax, interval );
+		stats->frameIntervals++;
+		stats->framesSkipped += frameNumber - cl->frameNumber - 1;
+	}
+	stats->frames++;
+	stats->suppressed += suppressCount;
+	cl->frameNumber = frameNumber;
+	cl->frameTime = com_localTime;
+}
+
+static void LoadGen_PacketEvent( loadgen_client_t *cl, byte *data, const size_t len ) {
+	cl->stats.bytesIn += len;
+	cl->stats.packetsIn++;
+
+	if ( len < 4 ) {
+		return;
+	}
+	if ( *(int32_t *)data == -1 ) {
+		LoadGen_ConnectionlessPacket( cl, data, len );
+		return;
+	}
+	if ( cl->state < LG_CONNECTED || len < 16 ) {
+		return;
+	}
+
+	memcpy( msg_read_buffer, data, len );
+	SZ_Init( &msg_read, msg_read_buffer, sizeof( msg_read_buffer ) );
+	msg_read.cursize = len;
+
+	// A toggled incoming reliable sequence means the payload starts with reliable data.
+	const bool reliableSequence = cl->netchan.incoming_reliable_sequence;
+	if ( !NetchanQ2RTXPerimental_Process( &cl->netchan ) ) {
+		return;
+	}
+
+	if ( cl->netchan.incoming_reliable_sequence != reliableSequence ) {
+		LoadGen_ParseReliable( cl );
+	} else {
+		LoadGen_ParseFrameHeader( cl );
+	}
+}
+
+/**
+*	@brief	Generates the next user command for the selected pattern.
+**/
+static void LoadGen_BuildCommand( loadgen_client_t *cl, usercmd_t *cmd ) {
+	*cmd = {};
+
+	if ( !loadgen_script.empty() ) {
+		const loadgen_scriptmove_t *move = &loadgen_script[ cl->scriptLine ];
+		cmd->forwardmove = move->forward;
+		cmd->sidemove = move->side;
+		cmd->upmove = move->up;
+		cmd->angles.x = move->pitch;
+		cmd->angles.y = move->yaw;
+		cmd->buttons = move->buttons;
+		if ( ++cl->scriptRepeat >= move->packets ) {
+			cl->scriptRepeat = 0;
+			cl->scriptLine = ( cl->scriptLine + 1 ) % loadgen_script.size();
+		}
+	} else if ( !strcmp( loadgen_options.pattern, "random" ) ) {
+		// Hold a random direction for a while, turning and occasionally jumping or firing.
+		if ( com_localTime >= cl->nextMoveChange ) {
+			std::uniform_int_distribution<int> dir( -1, 1 );
+			std::uniform_real_distribution<float> turn( -180.0f, 180.0f );
+			std::uniform_int_distribution<int> hold( 250, 2000 );
+			std::uniform_int_distribution<int> chance( 0, 99 );
+			cl->move.forwardmove = dir( cl->rng ) * 300.0f;
+			cl->move.sidemove = dir( cl->rng ) * 300.0f;
+			cl->move.angles.z = turn( cl->rng ); // turn rate, degrees per second
+			cl->move.buttons = ( chance( cl->rng ) < 10 ? BUTTON_JUMP : 0 ) | ( chance( cl->rng ) < 20 ? BUTTON_PRIMARY_FIRE : 0 );
+			cl->nextMoveChange = com_localTime + hold( cl->rng );
+		}
+		cl->move.angles.y = fmodf( cl->move.angles.y + cl->move.angles.z / loadgen_options.packetRate, 360.0f );
+		cmd->forwardmove = cl->move.forwardmove;
+		cmd->sidemove = cl->move.sidemove;
+		cmd->angles.y = cl->move.angles.y;
+		cmd->buttons = cl->move.buttons;
+	}
+
+	if ( cmd->buttons ) {
+		cmd->buttons |= BUTTON_ANY;
+	} else {
+		cmd->buttons = BUTTON_NONE;
+	}
+	cmd->msec = 1000.0 / loadgen_options.packetRate;
+	cmd->frameNumber = cl->frameNumber;
+	cmd->serverTime = cl->frameNumber > 0 ? (uint64_t)( cl->frameNumber * BASE_FRAMETIME ) : 0;
+}
+
+/**
+*	@brief	Sends a new command along with the ones of the previous packets,
+*			the same batching CL_SendBatchedCmd does.
+**/
+static void LoadGen_SendCommand( loadgen_client_t *cl ) {
+	const int64_t seq = cl->netchan.outgoing_sequence;
+
+	cl->commandNumber++;
+	LoadGen_BuildCommand( cl, &cl->cmds[ cl->commandNumber & CMD_MASK ] );
+	cl->packetCommandNumber[ seq & CMD_MASK ] = cl->commandNumber;
+
+	const int64_t numDups = MAX_PACKET_FRAMES - 1;
+
+	MSG_BeginWriting();
+	if ( cl->frameNumber < 0 ) {
+		MSG_WriteUint8( clc_move_nodelta );
+	} else {
+		MSG_WriteUint8( clc_move_batched );
+		MSG_WriteIntBase128( cl->frameNumber );
+	}
+	MSG_WriteUint8( numDups );
+
+	const usercmd_t *oldcmd = nullptr;
+	for ( int64_t i = seq - numDups; i <= seq; i++ ) {
+		const int64_t to = cl->packetCommandNumber[ i & CMD_MASK ];
+		const int64_t from = cl->packetCommandNumber[ ( i - 1 ) & CMD_MASK ];
+		const int64_t numCmds = std::clamp<int64_t>( to - from, 0, MAX_PACKET_USERCMDS - 1 );
+		MSG_WriteBits( numCmds, 8 );
+		for ( int64_t j = to - numCmds + 1; j <= to; j++ ) {
+			const usercmd_t *cmd = &cl->cmds[ j & CMD_MASK ];
+			MSG_WriteDeltaUserCommand( oldcmd, cmd, PROTOCOL_VERSION_Q2RTXPERIMENTAL );
+			oldcmd = cmd;
+		}
+	}
+
+	NetchanQ2RTXPerimental_Transmit( &cl->netchan, msg_write.cursize, msg_write.data );
+	SZ_Clear( &msg_write );
+}
+
+/**
+*	@brief	Handles resends, timeouts and the outgoing packet of a client.
+**/
+static void LoadGen_RunClient( loadgen_client_t *cl ) {
+	LoadGen_CheckForResend( cl );
+
+	if ( cl->state >= LG_CHALLENGING && cl->state <= LG_CONNECTING ) {
+		if ( com_localTime - cl->attemptTime > LOADGEN_TIMEOUT ) {
+			LoadGen_Reconnect( cl, "connection attempt timed out" );
+		}
+		return;
+	}
+	if ( cl->state < LG_CONNECTED ) {
+		return;
+	}
+
+	if ( com_localTime - cl->netchan.last_received > LOADGEN_TIMEOUT ) {
+		LoadGen_Reconnect( cl, "timed out" );
+		return;
+	}
+	if ( cl->netchan.fatal_error ) {
+		LoadGen_Reconnect( cl, "net channel error" );
+		return;
+	}
+
+	if ( com_localTime < cl->nextPacketTime ) {
+		return;
+	}
+	// Keep the rate steady without bursting after a stall.
+	cl->nextPacketTime = std::max( cl->nextPacketTime + 1000 / loadgen_options.packetRate, com_localTime );
+
+	if ( cl->state == LG_SPAWNED ) {
+		LoadGen_SendCommand( cl );
+	} else if ( NetchanQ2RTXPerimental_ShouldUpdate( &cl->netchan ) ) {
+		cl->packetCommandNumber[ cl->netchan.outgoing_sequence & CMD_MASK ] = cl->commandNumber;
+		NetchanQ2RTXPerimental_Transmit( &cl->netchan, 0, "" );
+	}
+}
+
+
+
+/**
+*
+*
+*	Setup and Reports:
+*
+*
+**/
+static bool LoadGen_ParseAddress( const char *s, netadr_t *adr ) {
+	std::string host = s;
+	std::string port = va( "%d", PORT_SERVER );
+	const size_t colon = host.rfind( ':' );
+	if ( colon != std::string::npos ) {
+		port = host.substr( colon + 1 );
+		host.resize( colon );
+	}
+
+	struct addrinfo hints = {}, *res = nullptr;
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	if ( getaddrinfo( host.c_str(), port.c_str(), &hints, &res ) || !res ) {
+		return false;
+	}
+
+	const struct sockaddr_in *addr = (const struct sockaddr_in *)res->ai_addr;
+	*adr = {};
+	adr->type = NA_IP;
+	memcpy( &adr->ip, &addr->sin_addr, 4 );
+	adr->port = addr->sin_port;
+	freeaddrinfo( res );
+	return true;
+}
+
+static bool LoadGen_LoadScript( const char *path ) {
+	FILE *f = fopen( path, "r" );
+	if ( !f ) {
+		return false;
+	}
+
+	char line[ 256 ];
+	while ( fgets( line, sizeof( line ), f ) ) {
+		loadgen_scriptmove_t move = {};
+		unsigned buttons = 0;
+		if ( line[ 0 ] == '#' || sscanf( line, "%d %f %f %f %f %f %u", &move.packets, &move.forward, &move.side, &move.up, &move.pitch, &move.yaw, &buttons ) < 6 ) {
+			continue;
+		}
+		move.packets = std::max( 1, move.packets );
+		move.buttons = buttons;
+		loadgen_script.push_back( move );
+	}
+	fclose( f );
+	return !loadgen_script.empty();
+}
+
+static loadgen_client_t *LoadGen_CreateClient( const int32_t number ) {
+	const int fd = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+	if ( fd < 0 ) {
+		fprintf( stderr, "socket: %s\n", strerror( errno ) );
+		return nullptr;
+	}
+	fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+
+	loadgen_client_t *cl = new loadgen_client_t();
+	cl->number = number;
+	cl->fd = fd;
+	cl->state = LG_IDLE;
+	cl->qport = ( Sys_Milliseconds() + number * 7919 ) & 0xffff;
+	cl->connectTime = com_localTime + number * LOADGEN_CONNECT_STAGGER;
+	cl->frameNumber = -1;
+	cl->rng.seed( loadgen_options.seed + number );
+	cl->scriptLine = loadgen_script.empty() ? 0 : number % loadgen_script.size();
+	return cl;
+}
+
+static double LoadGen_Percent( const uint64_t part, const uint64_t total ) {
+	return total ? 100.0 * part / total : 0.0;
+}
+
+/**
+*	@brief	Prints one line of totals for the stats since the last report.
+**/
+static void LoadGen_Report( const double seconds ) {
+	loadgen_stats_t delta = {};
+	int32_t spawned = 0;
+	for ( loadgen_client_t *cl : loadgen_clients ) {
+		const loadgen_stats_t &s = cl->stats, &r = cl->reported;
+		delta.bytesIn += s.bytesIn - r.bytesIn;
+		delta.bytesOut += s.bytesOut - r.bytesOut;
+		delta.frames += s.frames - r.frames;
+		delta.framesSkipped += s.framesSkipped - r.framesSkipped;
+		delta.suppressed += s.suppressed - r.suppressed;
+		delta.frameIntervalSum += s.frameIntervalSum - r.frameIntervalSum;
+		delta.frameIntervals += s.frameIntervals - r.frameIntervals;
+		delta.frameIntervalMax = std::max( delta.frameIntervalMax, s.frameIntervalMax );
+		cl->reported = s;
+		spawned += cl->state == LG_SPAWNED;
+	}
+
+	printf( "[%4d/%-4d spawned] in %8.1f kB/s  out %7.1f kB/s  frames %7.1f/s  interval %5.1f ms (max %3" PRIu64 ")  skipped %5.2f%%  suppressed %" PRIu64 "\n",
+		spawned, (int32_t)loadgen_clients.size(),
+		delta.bytesIn / 1024.0 / seconds, delta.bytesOut / 1024.0 / seconds,
+		delta.frames / seconds,
+		delta.frameIntervals ? (double)delta.frameIntervalSum / delta.frameIntervals : 0.0, delta.frameIntervalMax,
+		LoadGen_Percent( delta.framesSkipped, delta.frames + delta.framesSkipped ), delta.suppressed );
+}
+
+/**
+*	@brief	Prints the per client totals of the whole run.
+**/
+static void LoadGen_FinalReport( const double seconds ) {
+	printf( "\n%-6s %10s %10s %8s %8s %9s %9s %8s %8s %6s\n",
+		"client", "in kB/s", "out kB/s", "frames", "loss %", "int. ms", "max ms", "skip %", "suppr.", "reconn" );
+	for ( loadgen_client_t *cl : loadgen_clients ) {
+		const loadgen_stats_t &s = cl->stats;
+		uint64_t dropped = cl->totalDropped, received = cl->totalReceived;
+		if ( cl->netchan.message_buf ) {
+			dropped += cl->netchan.total_dropped;
+			received += cl->netchan.total_received;
+		}
+		printf( "%-6d %10.1f %10.1f %8" PRIu64 " %8.2f %9.2f %9" PRIu64 " %8.2f %8" PRIu64 " %6" PRIu64 "\n",
+			cl->number, s.bytesIn / 1024.0 / seconds, s.bytesOut / 1024.0 / seconds, s.frames,
+			LoadGen_Percent( dropped, received ),
+			s.frameIntervals ? (double)s.frameIntervalSum / s.frameIntervals : 0.0, s.frameIntervalMax,
+			LoadGen_Percent( s.framesSkipped, s.frames + s.framesSkipped ), s.suppressed, s.reconnects );
+	}
+}
+
+static void LoadGen_Signal( int sig ) {
+	loadgen_quit = 1;
+}
+
+static void LoadGen_Usage( void ) {
+	fprintf( stderr, "usage: q2rtxp-loadgen [-n clients] [-t seconds] [-f pps] [-m idle|random|<script>] "
+		"[-r rate] [-i report seconds] [-w password] [-s seed] [host[:port]]\n" );
+	exit( EXIT_FAILURE );
+}
+
+int main( int argc, char **argv ) {
+	const char *address = "127.0.0.1";
+	for ( int i = 1; i < argc; i++ ) {
+		const char *arg = argv[ i ];
+		if ( arg[ 0 ] != '-' ) {
+			address = arg;
+			continue;
+		}
+		if ( i + 1 >= argc || arg[ 2 ] ) {
+			LoadGen_Usage();
+		}
+		const char *value = argv[ ++i ];
+		switch ( arg[ 1 ] ) {
+		case 'n': loadgen_options.numClients = std::max( 1, atoi( value ) ); break;
+		case 't': loadgen_options.duration = std::max( 0.0, atof( value ) ); break;
+		case 'f': loadgen_options.packetRate = std::clamp( atoi( value ), 1, 1000 ); break;
+		case 'm': loadgen_options.pattern = value; break;
+		case 'r': loadgen_options.rate = std::max( 0, atoi( value ) ); break;
+		case 'i': loadgen_options.reportInterval = std::max( 0.1, atof( value ) ); break;
+		case 'w': loadgen_options.password = value; break;
+		case 's': loadgen_options.seed = strtoul( value, nullptr, 10 ); break;
+		default: LoadGen_Usage();
+		}
+	}
+
+	if ( !LoadGen_ParseAddress( address, &loadgen_server ) ) {
+		fprintf( stderr, "couldn't resolve %s\n", address );
+		return EXIT_FAILURE;
+	}
+	if ( strcmp( loadgen_options.pattern, "idle" ) && strcmp( loadgen_options.pattern, "random" ) && !LoadGen_LoadScript( loadgen_options.pattern ) ) {
+		fprintf( stderr, "couldn't load command script %s\n", loadgen_options.pattern );
+		return EXIT_FAILURE;
+	}
+
+	signal( SIGINT, LoadGen_Signal );
+	signal( SIGTERM, LoadGen_Signal );
+
+	Netchan_Init();
+	com_localTime = Sys_Milliseconds();
+
+	for ( int32_t i = 0; i < loadgen_options.numClients; i++ ) {
+		loadgen_client_t *cl = LoadGen_CreateClient( i );
+		if ( !cl ) {
+			return EXIT_FAILURE;
+		}
+		loadgen_clients.push_back( cl );
+	}
+
+	printf( "%d clients -> %s, %d packets/s, pattern %s\n", loadgen_options.numClients, NET_AdrToString( &loadgen_server ),
+		loadgen_options.packetRate, loadgen_options.pattern );
+
+	std::vector<struct pollfd> pfds( loadgen_clients.size() );
+	for ( size_t i = 0; i < loadgen_clients.size(); i++ ) {
+		pfds[ i ].fd = loadgen_clients[ i ]->fd;
+		pfds[ i ].events = POLLIN;
+	}
+
+	const uint64_t startTime = com_localTime;
+	uint64_t reportTime = startTime;
+	byte packet[ MAX_PACKETLEN ];
+
+	while ( !loadgen_quit ) {
+		com_localTime = Sys_Milliseconds();
+		if ( loadgen_options.duration && com_localTime - startTime >= loadgen_options.duration * 1000 ) {
+			break;
+		}
+
+		for ( loadgen_client_t *cl : loadgen_clients ) {
+			loadgen_current = cl;
+			loadgen_abortframe_set = true;
+			if ( setjmp( loadgen_abortframe ) ) {
+				LoadGen_Reconnect( cl, "message error" );
+				continue;
+			}
+			LoadGen_RunClient( cl );
+		}
+
+		if ( poll( pfds.data(), pfds.size(), 1 ) > 0 ) {
+			com_localTime = Sys_Milliseconds();
+			for ( size_t i = 0; i < pfds.size(); i++ ) {
+				if ( !( pfds[ i ].revents & POLLIN ) ) {
+					continue;
+				}
+				loadgen_client_t *cl = loadgen_current = loadgen_clients[ i ];
+				ssize_t len;
+				while ( ( len = recv( cl->fd, packet, sizeof( packet ), 0 ) ) > 0 ) {
+					if ( setjmp( loadgen_abortframe ) ) {
+						LoadGen_Reconnect( cl, "message error" );
+						break;
+					}
+					LoadGen_PacketEvent( cl, packet, len );
+				}
+			}
+		}
+		loadgen_abortframe_set = false;
+		loadgen_current = nullptr;
+
+		if ( com_localTime - reportTime >= loadgen_options.reportInterval * 1000 ) {
+			LoadGen_Report( ( com_localTime - reportTime ) / 1000.0 );
+			reportTime = com_localTime;
+		}
+	}
+
+	// Tell the server to free the slots right away.
+	for ( loadgen_client_t *cl : loadgen_clients ) {
+		loadgen_current = cl;
+		if ( cl->state >= LG_CONNECTED ) {
+			LoadGen_ClientCommand( cl, "disconnect" );
+			NetchanQ2RTXPerimental_Transmit( &cl->netchan, 0, "" );
+		}
+	}
+
+	LoadGen_FinalReport( std::max<uint64_t>( 1, com_localTime - startTime ) / 1000.0 );
+
+	for ( loadgen_client_t *cl : loadgen_clients ) {
+		close( cl->fd );
+		delete cl;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/********************************************************************
+*
+*
+*	Headless DMA mixer benchmark.
+*
+*	Mixes N synthetic channels into a paint buffer with every mixer
+*	kernel implementation the CPU supports, verifies that each one is
+*	bit identical to the scalar reference and reports samples/sec.
+*
+*	Usage: q2rtxp-mix-bench [channels] [seconds per test]
+*
+*
+********************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../client/sound/mix.h"
+
+//! Same as the DMA backend's paint buffer.
+static constexpr int PAINTBUFFER_SIZE = 2048;
+//! Length of each synthetic sound, in samples. Odd so the kernel tails get exercised.
+static constexpr int SFX_LENGTH = 44100 + 7;
+
+static const char *paint_names[ MIX_PAINT_NUM ] = {
+	"mono8", "stereo-dmix8", "stereo-full8", "mono16", "stereo-dmix16", "stereo-full16",
+};
+
+/**
+*	@brief	A synthetic channel, playing from a random offset with random volumes.
+**/
+struct bench_channel_t {
+	int pos;
+	float leftvol;
+	float rightvol;
+};
+
+static std::vector<uint8_t> sfx_data[ MIX_PAINT_NUM ];
+
+/**
+*	@brief	Fills the synthetic sounds with white noise.
+**/
+static void Bench_GenerateSounds( std::mt19937 &rng ) {
+	for ( int i = 0; i < MIX_PAINT_NUM; i++ ) {
+		const int width = i < MIX_PAINT_MONO16 ? 1 : 2;
+		const int channels = ( i == MIX_PAINT_MONO8 || i == MIX_PAINT_MONO16 ) ? 1 : 2;
+		sfx_data[ i ].resize( (size_t)SFX_LENGTH * width * channels );
+		for ( uint8_t &b : sfx_data[ i ] ) {
+			b = (uint8_t)rng();
+		}
+	}
+}
+
+/**
+*	@brief	Mixes all channels into 'paint' once, the same way PaintChannels does.
+**/
+static void Bench_MixOnce( const mix_kernels_t *k, const mix_paint_t func, const std::vector<bench_channel_t> &channels, samplepair_t *paint, const int count ) {
+	const int width = func < MIX_PAINT_MONO16 ? 1 : 2;
+	const int numch = ( func == MIX_PAINT_MONO8 || func == MIX_PAINT_MONO16 ) ? 1 : 2;
+	const float scale = width == 1 ? 256.0f : 1.0f;
+
+	memset( paint, 0, sizeof( *paint ) * count );
+	for ( const bench_channel_t &ch : channels ) {
+		const uint8_t *data = sfx_data[ func ].data() + (size_t)ch.pos * width * numch;
+		k->paint[ func ]( data, count, ch.leftvol * scale, ch.rightvol * scale, paint );
+	}
+}
+
+/**
+*	@brief	Sets up the underwater "high shelf" filter the DMA backend uses at 44.1kHz.
+**/
+static void Bench_InitFilter( mix_filter_t *f ) {
+	const float gain = 0.25f;
+	const float w0 = 3.14159265358979323846f * 2.0f * ( 5000.0f / 44100.0f );
+	const float cos_w0 = cosf( w0 );
+	const float alpha = sinf( w0 ) / 2.0f * 1.41421356237309504880f;
+	const float sqrtgain_alpha_2 = 2.0f * sqrtf( gain ) * alpha;
+
+	const float a0 = ( gain + 1.0f ) - ( gain - 1.0f ) * cos_w0 + sqrtgain_alpha_2;
+	f->b0 = gain * ( ( gain + 1.0f ) + ( gain - 1.0f ) * cos_w0 + sqrtgain_alpha_2 ) / a0;
+	f->b1 = gain * ( ( gain - 1.0f ) + ( gain + 1.0f ) * cos_w0 ) * -2.0f / a0;
+	f->b2 = gain * ( ( gain + 1.0f ) + ( gain - 1.0f ) * cos_w0 - sqrtgain_alpha_2 ) / a0;
+	f->a1 = ( ( gain - 1.0f ) - ( gain + 1.0f ) * cos_w0 ) * 2.0f / a0;
+	f->a2 = ( ( gain + 1.0f ) - ( gain - 1.0f ) * cos_w0 - sqrtgain_alpha_2 ) / a0;
+	f->z1[ 0 ] = f->z1[ 1 ] = f->z2[ 0 ] = f->z2[ 1 ] = 0;
+}
+
+/**
+*	@return	True if both buffers are bit identical.
+**/
+template<typename T>
+static bool Bench_Identical( const std::vector<T> &a, const std::vector<T> &b ) {
+	return a.size() == b.size() && !memcmp( a.data(), b.data(), a.size() * sizeof( T ) );
+}
+
+int main( int argc, char **argv ) {
+	const int numChannels = argc > 1 ? std::max( 1, atoi( argv[ 1 ] ) ) : 32;
+	const double seconds = argc > 2 ? std::max( 0.05, atof( argv[ 2 ] ) ) : 0.5;
+
+	std::mt19937 rng( 1234 );
+	Bench_GenerateSounds( rng );
+
+	std::vector<bench_channel_t> channels( numChannels );
+	for ( bench_channel_t &ch : channels ) {
+		ch.pos = (int)( rng() % ( SFX_LENGTH - PAINTBUFFER_SIZE ) );
+		ch.leftvol = ( rng() % 1000 ) / 1000.0f;
+		ch.rightvol = ( rng() % 1000 ) / 1000.0f;
+	}
+
+	printf( "mixing %d channels into %d sample blocks, %.2fs per test\n\n", numChannels, PAINTBUFFER_SIZE, seconds );
+
+	// Reference output from the scalar kernels.
+	const mix_kernels_t *scalar = Mix_GetKernels( MIX_IMPL_SCALAR );
+	std::vector<samplepair_t> reference[ MIX_PAINT_NUM ];
+	std::vector<int16_t> referenceOut[ MIX_PAINT_NUM ];
+	std::vector<samplepair_t> referenceFiltered[ MIX_PAINT_NUM ];
+	for ( int f = 0; f < MIX_PAINT_NUM; f++ ) {
+		reference[ f ].resize( PAINTBUFFER_SIZE );
+		Bench_MixOnce( scalar, (mix_paint_t)f, channels, reference[ f ].data(), PAINTBUFFER_SIZE );
+
+		referenceOut[ f ].resize( PAINTBUFFER_SIZE * 2 );
+		scalar->transfer_stereo16( reference[ f ].data(), PAINTBUFFER_SIZE, referenceOut[ f ].data() );
+
+		mix_filter_t filter;
+		Bench_InitFilter( &filter );
+		referenceFiltered[ f ] = reference[ f ];
+		scalar->filter_stereo( &filter, referenceFiltered[ f ].data(), PAINTBUFFER_SIZE );
+	}
+
+	bool allIdentical = true;
+	std::vector<samplepair_t> paint( PAINTBUFFER_SIZE );
+	std::vector<int16_t> out( PAINTBUFFER_SIZE * 2 );
+
+	printf( "%-8s %-14s %14s %14s %14s %s\n", "impl", "kernel", "paint Ms/s", "transfer Ms/s", "filter Ms/s", "result" );
+	for ( int impl = 0; impl < MIX_NUM_IMPLS; impl++ ) {
+		const mix_kernels_t *k = Mix_GetKernels( (mix_impl_t)impl );
+		if ( !k ) {
+			continue;
+		}
+
+		for ( int f = 0; f < MIX_PAINT_NUM; f++ ) {
+			// Verify against the scalar reference.
+			Bench_MixOnce( k, (mix_paint_t)f, channels, paint.data(), PAINTBUFFER_SIZE );
+			bool identical = Bench_Identical( paint, reference[ f ] );
+			k->transfer_stereo16( paint.data(), PAINTBUFFER_SIZE, out.data() );
+			identical &= Bench_Identical( out, referenceOut[ f ] );
+			mix_filter_t filter;
+			Bench_InitFilter( &filter );
+			k->filter_stereo( &filter, paint.data(), PAINTBUFFER_SIZE );
+			identical &= Bench_Identical( paint, referenceFiltered[ f ] );
+			allIdentical &= identical;
+
+			// Paint: samples are counted per channel mixed.
+			using clock = std::chrono::steady_clock;
+			uint64_t iterations = 0;
+			auto start = clock::now();
+			double elapsed = 0;
+			do {
+				Bench_MixOnce( k, (mix_paint_t)f, channels, paint.data(), PAINTBUFFER_SIZE );
+				iterations++;
+				elapsed = std::chrono::duration<double>( clock::now() - start ).count();
+			} while ( elapsed < seconds );
+			const double paintRate = (double)iterations * PAINTBUFFER_SIZE * numChannels / elapsed / 1e6;
+
+			// Transfer.
+			iterations = 0;
+			start = clock::now();
+			do {
+				k->transfer_stereo16( paint.data(), PAINTBUFFER_SIZE, out.data() );
+				iterations++;
+				elapsed = std::chrono::duration<double>( clock::now() - start ).count();
+			} while ( elapsed < seconds / 4 );
+			const double transferRate = (double)iterations * PAINTBUFFER_SIZE / elapsed / 1e6;
+
+			// Filter, the shelf filter has unity DC gain so running it repeatedly stays bounded.
+			iterations = 0;
+			start = clock::now();
+			do {
+				k->filter_stereo( &filter, paint.data(), PAINTBUFFER_SIZE );
+				iterations++;
+				elapsed = std::chrono::duration<double>( clock::now() - start ).count();
+			} while ( elapsed < seconds / 4 );
+			const double filterRate = (double)iterations * PAINTBUFFER_SIZE / elapsed / 1e6;
+
+			printf( "%-8s %-14s %14.1f %14.1f %14.1f %s\n", k->name, paint_names[ f ], paintRate, transferRate, filterRate, identical ? "ok" : "MISMATCH" );
+		}
+	}
+
+	printf( "\n%s\n", allIdentical ? "all implementations match the scalar reference" : "ERROR: output mismatch against the scalar reference" );
+	return allIdentical ? EXIT_SUCCESS : EXIT_FAILURE;
+}